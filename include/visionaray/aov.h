@@ -0,0 +1,168 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_AOV_H
+#define VSNRAY_AOV_H 1
+
+#include <type_traits>
+
+#include "detail/macros.h"
+#include "math/simd/type_traits.h"
+#include "math/forward.h"
+#include "math/limits.h"
+#include "math/matrix.h"
+#include "math/snorm.h"
+#include "math/unorm.h"
+#include "math/vector.h"
+#include "aligned_vector.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// AOV (arbitrary output variable) channels
+//
+// The built-in kernels record the channels of their kernel_params (see
+// with_aovs()) at the first hit of each primary ray and return them w/
+// the result_record. The schedulers store them to the AOV buffers of the
+// render target. AOVs are taken from the first sample of a pixel and are
+// overwritten every frame, they are not accumulated.
+//
+
+namespace aov
+{
+
+enum channel
+{
+    None    = 0x00,
+    Albedo  = 0x01, // Reflectance of the material times texture color
+    Normal  = 0x02, // World space shading normal
+    Depth   = 0x04, // Distance from the ray origin to the hit point
+    PrimID  = 0x08, // Primitive ID, -1 for no hit
+    InstID  = 0x10, // Instance ID, geometry ID w/o instancing, -1 for no hit
+    Motion  = 0x20, // Screen space motion since the last frame (fraction of the viewport)
+
+    All     = 0x3F
+};
+
+} // aov
+
+
+//-------------------------------------------------------------------------------------------------
+// AOV values of one ray (or a packet of rays), lanes w/o hit keep the defaults
+//
+
+template <typename T>
+struct aov_record
+{
+    using scalar_type = T;
+    using int_type    = simd::int_type_t<T>;
+
+    vector<3, T> albedo  = vector<3, T>(0.0);
+    vector<3, T> normal  = vector<3, T>(0.0);
+    T            depth   = numeric_limits<T>::max();
+    int_type     prim_id = int_type(-1);
+    int_type     inst_id = int_type(-1);
+    vector<2, T> motion  = vector<2, T>(0.0);
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// AOV parameters for kernel_params
+//
+// Channels is a combination of aov::channel flags. The view-projection
+// matrices of the current and the previous frame are used to compute
+// motion vectors, objects themselves are assumed to be static.
+//
+
+template <unsigned Channels>
+struct aov_params
+{
+    enum { channels = Channels };
+
+    mat4 view_proj;
+    mat4 prev_view_proj;
+};
+
+template <>
+struct aov_params<aov::None>
+{
+    enum { channels = aov::None };
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// References to the AOV buffers of a render target
+//
+// One plane per channel (SoA). Albedo and normals are either stored w/
+// 32-bit floats or w/ 16-bit unorm resp. snorm components, only one of the
+// two planes is set. Planes of disabled channels are nullptr.
+//
+
+struct aov_ref
+{
+    vec3*                   albedo;
+    vector<3, unorm<16>>*   albedo16;
+    vec3*                   normal;
+    vector<3, snorm<16>>*   normal16;
+    float*                  depth;
+    int*                    prim_id;
+    int*                    inst_id;
+    vec2*                   motion;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// AOV buffers for CPU render targets
+//
+
+class aov_buffers
+{
+public:
+
+    // Enable channels (aov::channel flags), compact selects 16-bit storage
+    // for albedo and normals. Takes effect w/ the next call to resize()
+    void set_channels(unsigned channels, bool compact = false);
+
+    unsigned channels() const;
+    bool compact() const;
+
+    void resize(int w, int h);
+
+    // Reset to the defaults of aov_record
+    void clear();
+
+    aov_ref ref();
+
+    vec3 const*                 albedo() const;
+    vector<3, unorm<16>> const* albedo16() const;
+    vec3 const*                 normal() const;
+    vector<3, snorm<16>> const* normal16() const;
+    float const*                depth() const;
+    int const*                  prim_id() const;
+    int const*                  inst_id() const;
+    vec2 const*                 motion() const;
+
+private:
+
+    unsigned channels_ = aov::None;
+    bool compact_ = false;
+
+    aligned_vector<vec3>                 albedo_;
+    aligned_vector<vector<3, unorm<16>>> albedo16_;
+    aligned_vector<vec3>                 normal_;
+    aligned_vector<vector<3, snorm<16>>> normal16_;
+    aligned_vector<float>                depth_;
+    aligned_vector<int>                  prim_id_;
+    aligned_vector<int>                  inst_id_;
+    aligned_vector<vec2>                 motion_;
+
+};
+
+} // visionaray
+
+#include "detail/aov.inl"
+
+#endif // VSNRAY_AOV_H
@@ -0,0 +1,140 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_DENOISER_H
+#define VSNRAY_DENOISER_H 1
+
+#include "detail/thread_pool.h"
+#include "math/vector.h"
+#include "aligned_vector.h"
+#include "aov.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Parameters of the edge-avoiding a-trous filter
+//
+// Weights between two pixels p and q are the product of the B3-spline
+// kernel and a Gaussian of the feature distances, e.g.
+//
+//      w(p,q) = exp(-|n(p) - n(q)|^2 / sigma_normal^2) * ...
+//
+// sigma_color is halved w/ each iteration (Dammertz et al. 2010). Depth
+// distances are relative to the depth of p and to the pixel distance
+// between p and q, so that slanted surfaces are not treated as edges.
+//
+
+struct atrous_params
+{
+    // Number of filter passes, pass i uses a step width of 2^i pixels
+    unsigned iterations = 5;
+
+    float sigma_color  = 1.0f;
+    float sigma_normal = 0.3f;
+    float sigma_depth  = 0.05f;
+    float sigma_albedo = 0.1f;
+
+    // Blend w/ the reprojected history of the last frame, requires the
+    // motion AOV. History is rejected where depth or normals disagree
+    bool  temporal = false;
+
+    // Weight of the current frame in the temporal blend
+    float temporal_alpha = 0.2f;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Edge-avoiding a-trous wavelet denoiser for CPU render targets
+//
+// Filters a color buffer (typically the accum buffer) guided by the
+// normal, depth and (optionally) albedo AOVs of the render target's
+// aov_buffers. Color is demodulated by albedo before filtering, so that
+// texture detail is preserved, and remodulated afterwards. Alpha is
+// passed through unchanged.
+//
+// Feature buffers are converted to padded SoA planes once per frame, the
+// filter passes process rows w/ the widest SIMD floats the ISA supports
+// and are parallelized over tiles of rows on a thread_pool.
+//
+
+class atrous_denoiser
+{
+public:
+
+    explicit atrous_denoiser(thread_pool& pool);
+
+    // Planes point into the denoiser's own buffer
+    atrous_denoiser(atrous_denoiser const&) = delete;
+    atrous_denoiser& operator=(atrous_denoiser const&) = delete;
+
+    atrous_params& params();
+    atrous_params const& params() const;
+
+    // Filter the width x height color buffer, output may alias color
+    void apply(vec4 const* color, aov_buffers const& aovs, int width, int height, vec4* output);
+
+    // Convenience overload, filters the render target's accum buffer
+    template <typename RenderTarget>
+    void apply(RenderTarget const& rt, vec4* output);
+
+    // Discard the temporal history, e.g. after a scene change
+    void reset_history();
+
+private:
+
+    // Planes point into one buffer, aligned for the widest SIMD loads
+    using plane = float*;
+
+    struct plane3
+    {
+        plane x;
+        plane y;
+        plane z;
+    };
+
+    thread_pool& pool_;
+
+    atrous_params params_;
+
+    int width_  = 0;
+    int height_ = 0;
+    int pad_    = 0;
+    int stride_ = 0;
+
+    // Size of a plane in floats
+    size_t plane_size_ = 0;
+
+    aligned_vector<float, 64> planes_;
+
+    plane3  color_;
+    plane3  temp_;
+    plane3  normal_;
+    plane3  albedo_;
+    plane   depth_;
+    plane   mask_;
+
+    // Temporal history, illumination after the first pass
+    bool    history_valid_ = false;
+    plane3  history_color_;
+    plane3  history_normal_;
+    plane   history_depth_;
+
+    void resize(int width, int height);
+    void load(vec4 const* color, aov_buffers const& aovs);
+    void reproject(aov_buffers const& aovs);
+    void filter_pass(plane3 const& src, plane3& dst, unsigned iteration);
+    void update_history(plane3 const& illum);
+    void store(vec4 const* color, vec4* output);
+
+    int index(int x, int y) const;
+
+};
+
+} // visionaray
+
+#include "detail/denoiser.inl"
+
+#endif // VSNRAY_DENOISER_H
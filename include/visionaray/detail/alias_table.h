@@ -0,0 +1,161 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_DETAIL_ALIAS_TABLE_H
+#define VSNRAY_DETAIL_ALIAS_TABLE_H 1
+
+#include <type_traits>
+#include <vector>
+
+#include "../math/simd/gather.h"
+#include "../math/simd/type_traits.h"
+#include "../math/detail/math.h"
+#include "macros.h"
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Alias tables (Walker 1977, Vose 1991)
+//
+// Bin i is picked with probability prob[i] / n, otherwise its alias.
+// Weights must be nonnegative and must not all be zero.
+//
+
+inline void build_alias_table(double const* weights, int n, float* prob, int* alias)
+{
+    double total = 0.0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        total += weights[i];
+    }
+
+    // Split bins into those with less and those with more than the
+    // average weight, then fill up each small bin with the remainder
+    // of a large one
+
+    std::vector<double> q(n);
+    std::vector<int> small;
+    std::vector<int> large;
+
+    for (int i = 0; i < n; ++i)
+    {
+        q[i] = weights[i] / total * n;
+
+        if (q[i] < 1.0)
+        {
+            small.push_back(i);
+        }
+        else
+        {
+            large.push_back(i);
+        }
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        small.pop_back();
+
+        int l = large.back();
+        large.pop_back();
+
+        prob[s] = static_cast<float>(q[s]);
+        alias[s] = l;
+
+        q[l] = (q[l] + q[s]) - 1.0;
+
+        if (q[l] < 1.0)
+        {
+            small.push_back(l);
+        }
+        else
+        {
+            large.push_back(l);
+        }
+    }
+
+    // Left over bins are (up to rounding) full
+    for (int i : large)
+    {
+        prob[i] = 1.0f;
+        alias[i] = i;
+    }
+
+    for (int i : small)
+    {
+        prob[i] = 1.0f;
+        alias[i] = i;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Table lookups, gather for SIMD indices
+//
+
+VSNRAY_FUNC
+inline float load(float const* base_addr, int index)
+{
+    return base_addr[index];
+}
+
+VSNRAY_FUNC
+inline int load(int const* base_addr, int index)
+{
+    return base_addr[index];
+}
+
+template <
+    typename T,
+    typename I,
+    typename = typename std::enable_if<simd::is_simd_vector<I>::value>::type
+    >
+inline auto load(T const* base_addr, I const& index)
+    -> decltype(gather(base_addr, index))
+{
+    return gather(base_addr, index);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Pick a bin of the alias table that starts at offset with u in [0..1)
+//
+// u_remapped is uniformly distributed in [0..1) inside the bin, e.g.
+// to pick a position in a texel.
+//
+
+template <typename F, typename I = simd::int_type_t<F>>
+VSNRAY_FUNC
+inline I sample_alias_table(
+        float const*    prob,
+        int const*      alias,
+        I const&        offset,
+        int             n,
+        F const&        u,
+        F&              u_remapped
+        )
+{
+    F x = u * F(static_cast<float>(n));
+    I bin = min(convert_to_int(x), I(n - 1));
+    F frac = x - convert_to_float(bin);
+
+    F p = load(prob, offset + bin);
+    auto take = frac < p;
+
+    // Division by zero in the lanes that are not selected
+    u_remapped = select(take, frac / p, (frac - p) / (F(1.0) - p));
+    u_remapped = min(u_remapped, F(0.99999994f));
+
+    return select(take, bin, load(alias, offset + bin));
+}
+
+} // detail
+} // visionaray
+
+#endif // VSNRAY_DETAIL_ALIAS_TABLE_H
@@ -0,0 +1,265 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include "../math/simd/type_traits.h"
+#include "../math/vector.h"
+#include "../get_surface.h"
+#include "../intersector.h"
+#include "../result_record.h"
+#include "../sampling.h"
+#include "../traverse.h"
+#include "macros.h"
+
+namespace visionaray
+{
+namespace ambient_occlusion
+{
+
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Occlusion ray directions
+//
+// The samples of one hit point form a Fibonacci lattice in [0,1)^2. The
+// lattice is shifted by one 2D point from the generator (Cranley-Patterson
+// rotation) and mapped to the cosine-weighted hemisphere around w. With
+// low-discrepancy generators, the shifts are stratified over the pixel
+// samples as well.
+//
+
+template <typename S>
+VSNRAY_FUNC
+inline vector<3, S> occlusion_dir(
+        unsigned                i,
+        unsigned                num_samples,
+        S const&                u1,
+        S const&                u2,
+        vector<3, S> const&     u,
+        vector<3, S> const&     v,
+        vector<3, S> const&     w
+        )
+{
+    // i / golden ratio, modulo 1
+    float fib = i * 0.6180339887f;
+    fib -= static_cast<float>(static_cast<int>(fib));
+
+    S x = (S(static_cast<float>(i)) + u1) / S(static_cast<float>(num_samples));
+    S y = S(fib) + u2;
+    y = select(y >= S(1.0), y - S(1.0), y);
+
+    auto sp = cosine_sample_hemisphere(x, y);
+    return normalize(sp.x * u + sp.y * v + sp.z * w);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Fraction of occlusion rays that hit a primitive before tmax
+//
+// Packets: each sample is traced as one packet w/ any_hit().
+//
+
+template <typename Primitives, typename Intersector, typename S>
+VSNRAY_FUNC
+inline S occluded_fraction(
+        Primitives              begin,
+        Primitives              end,
+        Intersector&            isect,
+        vector<3, S> const&     origin,
+        vector<3, S> const&     u,
+        vector<3, S> const&     v,
+        vector<3, S> const&     w,
+        S const&                tmax,
+        S const&                u1,
+        S const&                u2,
+        unsigned                num_samples
+        )
+{
+    S occluded(0.0);
+
+    for (unsigned i = 0; i < num_samples; ++i)
+    {
+        basic_ray<S> ray(origin, occlusion_dir(i, num_samples, u1, u2, u, v, w), S(0.0), tmax);
+
+        auto hit_rec = any_hit(ray, begin, end, isect);
+
+        occluded += select(hit_rec.hit, S(1.0), S(0.0));
+    }
+
+    return occluded / S(static_cast<float>(num_samples));
+}
+
+#if VSNRAY_CPU_MODE
+
+// Single rays on the CPU: the rays of one hit point are batched into
+// SIMD packets, they share their origin and are traced coherently
+
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX512F)
+using occlusion_float = simd::float16;
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX)
+using occlusion_float = simd::float8;
+#else
+using occlusion_float = simd::float4;
+#endif
+
+template <typename Primitives>
+inline float occluded_fraction(
+        Primitives              begin,
+        Primitives              end,
+        default_intersector&    isect,
+        vector<3, float> const& origin,
+        vector<3, float> const& u,
+        vector<3, float> const& v,
+        vector<3, float> const& w,
+        float                   tmax,
+        float                   u1,
+        float                   u2,
+        unsigned                num_samples
+        )
+{
+    using F = occlusion_float;
+    using V = vector<3, F>;
+
+    unsigned const N = simd::num_elements<F>::value;
+
+    float occluded = 0.0f;
+
+    for (unsigned first = 0; first < num_samples; first += N)
+    {
+        simd::aligned_array_t<F> xs;
+        simd::aligned_array_t<F> ys;
+        simd::aligned_array_t<F> zs;
+        simd::aligned_array_t<F> tmaxs;
+
+        for (unsigned i = 0; i < N; ++i)
+        {
+            unsigned index = first + i;
+
+            vec3 dir = occlusion_dir(index, num_samples, u1, u2, u, v, w);
+            xs[i] = dir.x;
+            ys[i] = dir.y;
+            zs[i] = dir.z;
+
+            // Padding lanes have empty ray intervals
+            tmaxs[i] = index < num_samples ? tmax : 0.0f;
+        }
+
+        basic_ray<F> ray(V(origin), V(F(xs), F(ys), F(zs)), F(0.0), F(tmaxs));
+
+        auto hit_rec = any_hit(ray, begin, end, isect);
+
+        simd::aligned_array_t<F> hits;
+        store(hits, select(hit_rec.hit & (F(tmaxs) > F(0.0)), F(1.0), F(0.0)));
+
+        for (unsigned i = 0; i < N; ++i)
+        {
+            occluded += hits[i];
+        }
+    }
+
+    return occluded / static_cast<float>(num_samples);
+}
+
+#endif // VSNRAY_CPU_MODE
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// Ambient occlusion kernel
+//
+// Shades primary hits w/ the fraction of the cosine-weighted hemisphere
+// that is not occluded within radius. The kernel consumes two generator
+// dimensions per pixel sample, blend the results over frames (e.g. w/
+// pixel_sampler::sobol_blend_type) to converge.
+//
+
+template <typename Params>
+struct kernel
+{
+
+    Params params;
+
+    // Occlusion rays per pixel sample
+    unsigned samples = 8;
+
+    // Occluders farther away than radius are ignored
+    float radius = 1.0f;
+
+    template <typename R>
+    using result_type = result_record<typename R::scalar_type, visionaray::detail::aov_channels<Params>::value>;
+
+    template <typename Intersector, typename R, typename Generator>
+    VSNRAY_FUNC result_type<R> operator()(
+            Intersector&    isect,
+            R               ray,
+            Generator&      gen
+            ) const
+    {
+        using S = typename R::scalar_type;
+        using V = vector<3, S>;
+
+        result_type<R> result;
+
+        auto hit_rec = closest_hit(ray, params.prims.begin, params.prims.end, isect);
+
+        // Drawn before branching, so that every sample consumes the same dimensions
+        S u1 = gen.next();
+        S u2 = gen.next();
+
+        vector<4, S> bgcolor(params.background.intensity(ray.dir), S(1.0));
+
+        if (any(hit_rec.hit))
+        {
+            hit_rec.isect_pos = ray.ori + ray.dir * hit_rec.t;
+
+            auto surf = get_surface(hit_rec, params, ray);
+
+            visionaray::detail::record_aovs(result, hit_rec, surf, ray, params);
+
+            V w = faceforward(surf.geometric_normal, -ray.dir, surf.geometric_normal);
+            V u;
+            V v;
+            make_orthonormal_basis(u, v, w);
+
+            // Lanes w/o a hit have empty ray intervals and are skipped by traversal
+            S tmax = select(hit_rec.hit, S(radius), S(0.0));
+
+            S occluded = detail::occluded_fraction(
+                    params.prims.begin,
+                    params.prims.end,
+                    isect,
+                    V(hit_rec.isect_pos + w * S(params.epsilon)),
+                    u,
+                    v,
+                    w,
+                    tmax,
+                    u1,
+                    u2,
+                    samples
+                    );
+
+            S visibility = S(1.0) - occluded;
+
+            result.color = select(hit_rec.hit, vector<4, S>(V(visibility), S(1.0)), bgcolor);
+            result.depth = hit_rec.t;
+        }
+        else
+        {
+            result.color = bgcolor;
+        }
+
+        result.hit = hit_rec.hit;
+        return result;
+    }
+
+    template <typename R, typename Generator>
+    VSNRAY_FUNC result_type<R> operator()(R ray, Generator& gen) const
+    {
+        default_intersector ignore;
+        return (*this)(ignore, ray, gen);
+    }
+};
+
+} // ambient_occlusion
+} // visionaray
@@ -0,0 +1,413 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <algorithm>
+#include <cstddef>
+
+#include "../math/simd/type_traits.h"
+#include "../array.h"
+#include "../packet_traits.h"
+#include "../spectrum.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// aov_buffers members
+//
+
+inline void aov_buffers::set_channels(unsigned channels, bool compact)
+{
+    channels_ = channels;
+    compact_ = compact;
+}
+
+inline unsigned aov_buffers::channels() const
+{
+    return channels_;
+}
+
+inline bool aov_buffers::compact() const
+{
+    return compact_;
+}
+
+inline void aov_buffers::resize(int w, int h)
+{
+    auto size = [&](unsigned channel, bool enable = true)
+    {
+        return (channels_ & channel) && enable ? static_cast<size_t>(w) * h : size_t(0);
+    };
+
+    albedo_.resize(size(aov::Albedo, !compact_));
+    albedo16_.resize(size(aov::Albedo, compact_));
+    normal_.resize(size(aov::Normal, !compact_));
+    normal16_.resize(size(aov::Normal, compact_));
+    depth_.resize(size(aov::Depth));
+    prim_id_.resize(size(aov::PrimID));
+    inst_id_.resize(size(aov::InstID));
+    motion_.resize(size(aov::Motion));
+
+    // Release the memory of disabled channels
+    albedo_.shrink_to_fit();
+    albedo16_.shrink_to_fit();
+    normal_.shrink_to_fit();
+    normal16_.shrink_to_fit();
+    depth_.shrink_to_fit();
+    prim_id_.shrink_to_fit();
+    inst_id_.shrink_to_fit();
+    motion_.shrink_to_fit();
+
+    clear();
+}
+
+inline void aov_buffers::clear()
+{
+    aov_record<float> dflt;
+
+    std::fill(albedo_.begin(), albedo_.end(), dflt.albedo);
+    std::fill(albedo16_.begin(), albedo16_.end(), vector<3, unorm<16>>(dflt.albedo));
+    std::fill(normal_.begin(), normal_.end(), dflt.normal);
+    std::fill(normal16_.begin(), normal16_.end(), vector<3, snorm<16>>(dflt.normal));
+    std::fill(depth_.begin(), depth_.end(), dflt.depth);
+    std::fill(prim_id_.begin(), prim_id_.end(), dflt.prim_id);
+    std::fill(inst_id_.begin(), inst_id_.end(), dflt.inst_id);
+    std::fill(motion_.begin(), motion_.end(), dflt.motion);
+}
+
+inline aov_ref aov_buffers::ref()
+{
+    auto data = [](auto& buffer) { return buffer.empty() ? nullptr : buffer.data(); };
+
+    return {
+        data(albedo_),
+        data(albedo16_),
+        data(normal_),
+        data(normal16_),
+        data(depth_),
+        data(prim_id_),
+        data(inst_id_),
+        data(motion_)
+        };
+}
+
+inline vec3 const* aov_buffers::albedo() const
+{
+    return albedo_.data();
+}
+
+inline vector<3, unorm<16>> const* aov_buffers::albedo16() const
+{
+    return albedo16_.data();
+}
+
+inline vec3 const* aov_buffers::normal() const
+{
+    return normal_.data();
+}
+
+inline vector<3, snorm<16>> const* aov_buffers::normal16() const
+{
+    return normal16_.data();
+}
+
+inline float const* aov_buffers::depth() const
+{
+    return depth_.data();
+}
+
+inline int const* aov_buffers::prim_id() const
+{
+    return prim_id_.data();
+}
+
+inline int const* aov_buffers::inst_id() const
+{
+    return inst_id_.data();
+}
+
+inline vec2 const* aov_buffers::motion() const
+{
+    return motion_.data();
+}
+
+
+namespace simd
+{
+
+//-------------------------------------------------------------------------------------------------
+// SIMD conversions
+//
+
+template <
+    typename T,
+    typename = typename std::enable_if<is_simd_vector<T>::value>::type
+    >
+inline array<aov_record<float>, num_elements<T>::value> unpack(aov_record<T> const& rec)
+{
+    using float_array = aligned_array_t<T>;
+    using int_array = aligned_array_t<int_type_t<T>>;
+
+    auto albedo = unpack(rec.albedo);
+    auto normal = unpack(rec.normal);
+    auto motion = unpack(rec.motion);
+
+    float_array depth;
+    int_array prim_id;
+    int_array inst_id;
+
+    store(depth, rec.depth);
+    store(prim_id, rec.prim_id);
+    store(inst_id, rec.inst_id);
+
+    array<aov_record<float>, num_elements<T>::value> result;
+
+    for (int i = 0; i < num_elements<T>::value; ++i)
+    {
+        result[i].albedo  = albedo[i];
+        result[i].normal  = normal[i];
+        result[i].depth   = depth[i];
+        result[i].prim_id = prim_id[i];
+        result[i].inst_id = inst_id[i];
+        result[i].motion  = motion[i];
+    }
+
+    return result;
+}
+
+} // simd
+
+
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// AOV channels requested by kernel params and returned by kernels
+//
+
+template <typename Params, typename = void>
+struct aov_channels
+{
+    enum { value = aov::None };
+};
+
+template <typename Params>
+struct aov_channels<Params, typename std::enable_if<unsigned(Params::aov_params_type::channels) != aov::None>::type>
+{
+    enum { value = Params::aov_params_type::channels };
+};
+
+template <typename RR, typename = void>
+struct has_aovs : std::false_type
+{
+};
+
+template <typename RR>
+struct has_aovs<RR, typename std::enable_if<unsigned(RR::aov_channels) != aov::None>::type> : std::true_type
+{
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Project a homogeneous point to normalized device coordinates
+//
+
+template <typename T>
+VSNRAY_FUNC
+inline vector<2, T> project_to_ndc(mat4 const& m, vector<4, T> const& p)
+{
+    auto row = [&](int r)
+    {
+        return T(m(r, 0)) * p.x + T(m(r, 1)) * p.y + T(m(r, 2)) * p.z + T(m(r, 3)) * p.w;
+    };
+
+    T w = row(3);
+    return vector<2, T>(row(0) / w, row(1) / w);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Record the AOVs of the first hit in a kernel's result record
+//
+
+template <typename RR, typename HR, typename Surface, typename R, typename Params>
+VSNRAY_FUNC
+inline auto record_aovs(
+        RR&             /* */,
+        HR const&       /* */,
+        Surface const&  /* */,
+        R const&        /* */,
+        Params const&   /* */
+        )
+    -> typename std::enable_if<!has_aovs<RR>::value>::type
+{
+}
+
+template <typename RR, typename HR, typename Surface, typename R, typename Params>
+VSNRAY_FUNC
+inline auto record_aovs(
+        RR&             result,
+        HR const&       hit_rec,
+        Surface const&  surf,
+        R const&        ray,
+        Params const&   params
+        )
+    -> typename std::enable_if<has_aovs<RR>::value>::type
+{
+    using S = typename R::scalar_type;
+    using I = simd::int_type_t<S>;
+    using V = vector<3, S>;
+
+    enum { Channels = RR::aov_channels };
+
+    auto hit = hit_rec.hit;
+    auto& rec = result.aov;
+
+    if (Channels & aov::Albedo)
+    {
+        rec.albedo = select(hit, to_rgb(surf.material.albedo()) * V(surf.tex_color), rec.albedo);
+    }
+
+    if (Channels & aov::Normal)
+    {
+        rec.normal = select(hit, V(surf.shading_normal), rec.normal);
+    }
+
+    if (Channels & aov::Depth)
+    {
+        rec.depth = select(hit, hit_rec.t, rec.depth);
+    }
+
+    if (Channels & aov::PrimID)
+    {
+        rec.prim_id = select(hit, I(hit_rec.prim_id), rec.prim_id);
+    }
+
+    if (Channels & aov::InstID)
+    {
+        I inst_id = select(hit_rec.inst_id < I(0), I(hit_rec.geom_id), I(hit_rec.inst_id));
+        rec.inst_id = select(hit, inst_id, rec.inst_id);
+    }
+
+    if (Channels & aov::Motion)
+    {
+        vector<4, S> pos(ray.ori + ray.dir * hit_rec.t, S(1.0));
+
+        auto curr = project_to_ndc(params.aovs.view_proj, pos);
+        auto prev = project_to_ndc(params.aovs.prev_view_proj, pos);
+
+        // NDC span two units across the viewport
+        rec.motion = select(hit, (curr - prev) * S(0.5), rec.motion);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Store the AOVs of a result record to the AOV buffers of a render target
+//
+
+VSNRAY_FUNC
+inline void store_aov(aov_ref const& ref, int index, aov_record<float> const& aov)
+{
+    if (ref.albedo)
+    {
+        ref.albedo[index] = aov.albedo;
+    }
+    else if (ref.albedo16)
+    {
+        ref.albedo16[index] = vector<3, unorm<16>>(aov.albedo);
+    }
+
+    if (ref.normal)
+    {
+        ref.normal[index] = aov.normal;
+    }
+    else if (ref.normal16)
+    {
+        ref.normal16[index] = vector<3, snorm<16>>(aov.normal);
+    }
+
+    if (ref.depth)
+    {
+        ref.depth[index] = aov.depth;
+    }
+
+    if (ref.prim_id)
+    {
+        ref.prim_id[index] = aov.prim_id;
+    }
+
+    if (ref.inst_id)
+    {
+        ref.inst_id[index] = aov.inst_id;
+    }
+
+    if (ref.motion)
+    {
+        ref.motion[index] = aov.motion;
+    }
+}
+
+template <typename RR, typename RenderTargetRef>
+VSNRAY_FUNC
+inline auto store_aovs(
+        RR const&               /* */,
+        RenderTargetRef         /* */,
+        int                     /* x */,
+        int                     /* y */,
+        int                     /* width */,
+        int                     /* height */
+        )
+    -> typename std::enable_if<!has_aovs<RR>::value>::type
+{
+}
+
+template <typename RR, typename RenderTargetRef>
+VSNRAY_FUNC
+inline auto store_aovs(
+        RR const&               result,
+        RenderTargetRef         rt_ref,
+        int                     x,
+        int                     y,
+        int                     width,
+        int                     height
+        )
+    -> typename std::enable_if<has_aovs<RR>::value && !simd::is_simd_vector<typename RR::scalar_type>::value>::type
+{
+    VSNRAY_UNUSED(height);
+
+    store_aov(rt_ref.aovs(), y * width + x, result.aov);
+}
+
+template <typename RR, typename RenderTargetRef>
+inline auto store_aovs(
+        RR const&               result,
+        RenderTargetRef         rt_ref,
+        int                     x,
+        int                     y,
+        int                     width,
+        int                     height
+        )
+    -> typename std::enable_if<has_aovs<RR>::value && simd::is_simd_vector<typename RR::scalar_type>::value>::type
+{
+    using S = typename RR::scalar_type;
+
+    auto aovs = simd::unpack(result.aov);
+
+    int const w = packet_size<S>::w;
+    int const h = packet_size<S>::h;
+
+    for (int row = 0; row < h; ++row)
+    {
+        for (int col = 0; col < w; ++col)
+        {
+            if (x + col < width && y + row < height)
+            {
+                store_aov(rt_ref.aovs(), (y + row) * width + (x + col), aovs[row * w + col]);
+            }
+        }
+    }
+}
+
+} // detail
+} // visionaray
@@ -6,9 +6,13 @@
 #ifndef VSNRAY_DETAIL_BASIC_SCHED_H
 #define VSNRAY_DETAIL_BASIC_SCHED_H 1
 
+#include <type_traits>
+
 namespace visionaray
 {
 
+class sched_profiler;
+
 template <typename Backend, typename R>
 class basic_sched
 {
@@ -23,11 +27,24 @@ public:
     template <typename ...Args>
     void reset(Args&&... args);
 
+    // Record per-tile timings, pass nullptr to disable
+    void set_profiler(sched_profiler* profiler);
+
 private:
 
+    // Per-packet kernels
+    template <typename K, typename SP>
+    void frame_impl(std::false_type /* wavefront */, K kernel, SP sched_params);
+
+    // Wavefront kernels, traced tile by tile (see kernel_is_wavefront)
+    template <typename K, typename SP>
+    void frame_impl(std::true_type /* wavefront */, K kernel, SP sched_params);
+
     Backend backend_;
 
-    unsigned frame_id_;
+    unsigned frame_id_ = 0;
+
+    sched_profiler* profiler_ = nullptr;
 
 };
 
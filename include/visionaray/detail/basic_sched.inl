@@ -1,14 +1,23 @@
 // This file is distributed under the MIT license.
 // See the LICENSE file for details.
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "../make_generator.h"
 #include "../make_random_seed.h"
 #include "../packet_traits.h"
+#include "../random_generator.h"
+#include "../result_record.h"
 #include "range.h"
 #include "sched_common.h"
+#include "sched_profiler.h"
+#include "scratch_arena.h"
 
 namespace visionaray
 {
@@ -61,6 +70,465 @@ void call_sample_pixel(
             );
 }
 
+
+
+//-------------------------------------------------------------------------------------------------
+// Wavefront kernels
+//
+// Kernels that define is_wavefront are not invoked per packet. The
+// scheduler generates the primary rays for all pixels and samples of a
+// tile and hands them to kernel.trace() in one batch. The kernel
+// returns one result per ray, and the scheduler resolves the results
+// with the pixel sampler.
+//
+
+template <typename K>
+class kernel_is_wavefront
+{
+private:
+
+    template <typename U>
+    static std::true_type  test(typename U::is_wavefront*);
+
+    template <typename U>
+    static std::false_type test(...);
+
+public:
+
+    using type = decltype( test<typename std::decay<K>::type>(nullptr) );
+
+};
+
+template <typename R, typename Generator, typename Camera>
+inline R make_primary_ray_for_sample(
+        R                           /* */,
+        pixel_sampler::uniform_type ps,
+        Generator&                  gen,
+        int                         x,
+        int                         y,
+        int                         width,
+        int                         height,
+        unsigned                    sample,
+        Camera const&               cam
+        )
+{
+    return detail::make_primary_ray(R{}, ps, gen, x, y, width, height, sample, cam);
+}
+
+template <typename R, typename Generator, typename Camera>
+inline R make_primary_ray_for_sample(
+        R                               /* */,
+        pixel_sampler::jittered_type    ps,
+        Generator&                      gen,
+        int                             x,
+        int                             y,
+        int                             width,
+        int                             height,
+        unsigned                        /* sample */,
+        Camera const&                   cam
+        )
+{
+    return detail::make_primary_ray(R{}, ps, gen, x, y, width, height, cam);
+}
+
+// Same as the packet samplers from sched_common.h, for a single pixel
+template <typename RenderTargetRef>
+inline void store_pixel(
+        pixel_sampler::uniform_type     /* */,
+        RenderTargetRef                 rt_ref,
+        int                             x,
+        int                             y,
+        int                             width,
+        int                             height,
+        result_record<float> const&     rr
+        )
+{
+    detail::pixel_access::store(
+            pixel_format_constant<RenderTargetRef::color_format>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            rr.color,
+            rt_ref.color()
+            );
+
+    if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
+    {
+        detail::pixel_access::store(
+                pixel_format_constant<RenderTargetRef::depth_format>{},
+                pixel_format_constant<PF_DEPTH32F>{},
+                x,
+                y,
+                width,
+                height,
+                rr.depth,
+                rt_ref.depth()
+                );
+    }
+}
+
+template <typename RenderTargetRef>
+inline void store_pixel(
+        pixel_sampler::jittered_type    /* */,
+        RenderTargetRef                 rt_ref,
+        int                             x,
+        int                             y,
+        int                             width,
+        int                             height,
+        result_record<float> const&     rr
+        )
+{
+    detail::pixel_access::store(
+            pixel_format_constant<RenderTargetRef::color_format>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            rr.color,
+            rt_ref.color()
+            );
+}
+
+template <
+    typename T,
+    typename B,
+    typename RenderTargetRef,
+    typename = typename std::enable_if<RenderTargetRef::accum_format != PF_UNSPECIFIED>::type
+    >
+inline void store_pixel(
+        pixel_sampler::basic_jittered_blend_type<T, B> ps,
+        RenderTargetRef                                rt_ref,
+        int                                            x,
+        int                                            y,
+        int                                            width,
+        int                                            height,
+        result_record<float> const&                    rr
+        )
+{
+    detail::pixel_access::blend(
+            pixel_format_constant<RenderTargetRef::accum_format>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            rr.color,
+            rt_ref.accum(),
+            ps.sfactor,
+            ps.dfactor
+            );
+
+    vector<4, float> blended_color;
+
+    detail::pixel_access::get(
+            pixel_format_constant<PF_RGBA32F>{},
+            pixel_format_constant<RenderTargetRef::accum_format>{},
+            x,
+            y,
+            width,
+            height,
+            blended_color,
+            rt_ref.accum()
+            );
+
+    detail::pixel_access::store(
+            pixel_format_constant<RenderTargetRef::color_format>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            blended_color,
+            rt_ref.color()
+            );
+
+    if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
+    {
+        detail::pixel_access::store(
+                pixel_format_constant<RenderTargetRef::depth_format>{},
+                pixel_format_constant<PF_DEPTH32F>{},
+                x,
+                y,
+                width,
+                height,
+                rr.depth,
+                rt_ref.depth()
+                );
+    }
+}
+
+template <
+    typename T,
+    typename B,
+    typename RenderTargetRef,
+    typename = typename std::enable_if<RenderTargetRef::accum_format != PF_UNSPECIFIED>::type
+    >
+inline void store_pixel(
+        pixel_sampler::basic_adaptive_blend_type<T, B> /* */,
+        RenderTargetRef                                rt_ref,
+        int                                            x,
+        int                                            y,
+        int                                            width,
+        int                                            height,
+        result_record<float> const&                    rr
+        )
+{
+    detail::accumulate_adaptive(rt_ref, x, y, width, height, rr.color);
+
+    if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
+    {
+        detail::pixel_access::store(
+                pixel_format_constant<RenderTargetRef::depth_format>{},
+                pixel_format_constant<PF_DEPTH32F>{},
+                x,
+                y,
+                width,
+                height,
+                rr.depth,
+                rt_ref.depth()
+                );
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Adaptive sampling
+//
+// Before a frame, the scheduler determines which tiles still need
+// samples. A tile is skipped when all its pixels have enough samples and
+// a relative error below the threshold. Converged tiles receive no more
+// samples, so they remain converged until the moments buffer is cleared.
+//
+
+// All tiles are active w/ the other pixel samplers
+template <typename PxSamplerT, typename RenderTargetRef>
+inline void find_active_tiles(
+        PxSamplerT              /* */,
+        RenderTargetRef         /* */,
+        int                     /* tile width */,
+        int                     /* tile height */,
+        std::vector<char>&      active
+        )
+{
+    active.clear();
+}
+
+template <typename T, typename B, typename RenderTargetRef>
+inline void find_active_tiles(
+        pixel_sampler::basic_adaptive_blend_type<T, B> ps,
+        RenderTargetRef                                rt_ref,
+        int                                            tile_width,
+        int                                            tile_height,
+        std::vector<char>&                             active
+        )
+{
+    int width = rt_ref.width();
+    int height = rt_ref.height();
+
+    int num_tiles_x = div_up(width, tile_width);
+    int num_tiles_y = div_up(height, tile_height);
+
+    active.assign(num_tiles_x * num_tiles_y, 0);
+
+    // Frames blend the average of spp samples, the moments count frames
+    float min_frames = static_cast<float>(std::max(div_up(ps.min_samples, ps.spp), 2U));
+
+    auto const* moments = rt_ref.moments();
+    assert(moments != nullptr);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            auto const& m = moments[y * width + x];
+
+            if (m.z < min_frames || m.w > ps.threshold)
+            {
+                active[(y / tile_height) * num_tiles_x + x / tile_width] = 1;
+            }
+        }
+    }
+}
+
+inline bool tile_active(std::vector<char> const& active, int x, int y, int tile_width, int tile_height, int width)
+{
+    return active.empty() || active[(y / tile_height) * div_up(width, tile_width) + x / tile_width];
+}
+
+// Paths of wavefront kernels always need numbers, pixel samplers w/o a
+// generator (e.g. uniform_type) use random_generator
+
+template <typename PxSamplerT>
+using has_void_generator = std::is_same<
+        typename detail::make_generator_impl<float, PxSamplerT>::generator_type,
+        detail::void_generator<float>
+        >;
+
+template <typename PxSamplerT>
+using tile_generator_t = typename std::conditional<
+        has_void_generator<PxSamplerT>::value,
+        random_generator<float>,
+        typename detail::make_generator_impl<float, PxSamplerT>::generator_type
+        >::type;
+
+template <typename PxSamplerT>
+inline random_generator<float> make_tile_generator(
+        std::true_type      /* void generator */,
+        PxSamplerT          /* */,
+        int                 x,
+        int                 y,
+        int                 width,
+        unsigned            sample
+        )
+{
+    return random_generator<float>(make_random_seed(y * width + x, static_cast<int>(sample)));
+}
+
+template <typename PxSamplerT>
+inline tile_generator_t<PxSamplerT> make_tile_generator(
+        std::false_type     /* void generator */,
+        PxSamplerT          ps,
+        int                 x,
+        int                 y,
+        int                 width,
+        unsigned            sample
+        )
+{
+    return make_pixel_generator(float{}, ps, x, y, width, static_cast<int>(sample));
+}
+
+// Generate primary rays for a tile, trace them, resolve and store the results
+template <typename Trace, typename PxSamplerT, typename RenderTargetRef, typename Camera>
+inline void sample_tile(
+        Trace const&            trace,
+        PxSamplerT              ps,
+        RenderTargetRef         rt_ref,
+        range2d<int> const&     tile,
+        unsigned                frame_id,
+        int                     width,
+        int                     height,
+        Camera const&           cam
+        )
+{
+    using ray_type = basic_ray<float>;
+    using generator_type = tile_generator_t<PxSamplerT>;
+
+    unsigned spp = samples_per_pixel(ps);
+    unsigned num_pixels = static_cast<unsigned>(tile.rows().length() * tile.cols().length());
+    unsigned count = num_pixels * spp;
+
+    scratch_arena& arena = this_thread_scratch_arena();
+
+    ray_type* rays = arena.allocate<ray_type>(count);
+    generator_type* gens = arena.allocate<generator_type>(count);
+    result_record<float>* results = arena.allocate<result_record<float>>(count);
+
+    // Each sample gets its own generator, the paths are traced independently
+    unsigned i = 0;
+
+    for (int y = tile.cols().begin(); y < tile.cols().end(); ++y)
+    {
+        for (int x = tile.rows().begin(); x < tile.rows().end(); ++x)
+        {
+            for (unsigned s = 0; s < spp; ++s)
+            {
+                new (gens + i) generator_type(make_tile_generator(has_void_generator<PxSamplerT>{}, ps, x, y, width, frame_id * spp + s));
+
+                rays[i] = make_primary_ray_for_sample(ray_type{}, ps, gens[i], x, y, width, height, s, cam);
+
+                ++i;
+            }
+        }
+    }
+
+    trace(rays, gens, results, count);
+
+    i = 0;
+
+    for (int y = tile.cols().begin(); y < tile.cols().end(); ++y)
+    {
+        for (int x = tile.rows().begin(); x < tile.rows().end(); ++x)
+        {
+            result_record<float> rr;
+
+            for (unsigned s = 0; s < spp; ++s)
+            {
+                auto result = results[i];
+
+                // Arbitrarily assign the depth of _one_ pixel that recorded a hit
+                if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
+                {
+                    result.depth = result.hit ? detail::depth_transform(rays[i], result.depth, cam) : 1.0f;
+                    rr.depth += result.depth;
+                }
+
+                rr.hit |= result.hit;
+                rr.color += result.color;
+
+                ++i;
+            }
+
+            rr.color /= static_cast<float>(spp);
+            rr.depth /= static_cast<float>(spp);
+
+            store_pixel(ps, rt_ref, x, y, width, height, rr);
+        }
+    }
+}
+
+template <typename R, typename K, typename SP>
+void call_sample_tile(
+        std::false_type     /* has intersector */,
+        R const&            /* */,
+        K const&            kernel,
+        SP const&           sparams,
+        range2d<int> const& tile,
+        unsigned            frame_id
+        )
+{
+    sample_tile(
+            [&](basic_ray<float> const* rays, auto* gens, result_record<float>* results, unsigned count)
+            {
+                kernel.trace(R{}, rays, gens, results, count);
+            },
+            sparams.sample_params,
+            sparams.rt.ref(),
+            tile,
+            frame_id,
+            sparams.rt.width(),
+            sparams.rt.height(),
+            sparams.cam
+            );
+}
+
+template <typename R, typename K, typename SP>
+void call_sample_tile(
+        std::true_type      /* has intersector */,
+        R const&            /* */,
+        K const&            kernel,
+        SP const&           sparams,
+        range2d<int> const& tile,
+        unsigned            frame_id
+        )
+{
+    sample_tile(
+            [&](basic_ray<float> const* rays, auto* gens, result_record<float>* results, unsigned count)
+            {
+                kernel.trace(sparams.intersector, R{}, rays, gens, results, count);
+            },
+            sparams.sample_params,
+            sparams.rt.ref(),
+            tile,
+            frame_id,
+            sparams.rt.width(),
+            sparams.rt.height(),
+            sparams.cam
+            );
+}
+
 } // basic_sched_impl
 
 
@@ -83,6 +551,39 @@ void basic_sched<B, R>::frame(K kernel, SP sched_params)
 
     sched_params.rt.begin_frame();
 
+    detail::require_moments(sched_params.sample_params, sched_params.rt);
+
+    if (profiler_ != nullptr)
+    {
+        profiler_->begin_frame(
+                frame_id_,
+                sched_params.rt.width(),
+                sched_params.rt.height()
+                );
+    }
+
+    frame_impl(
+            typename basic_sched_impl::kernel_is_wavefront<K>::type(),
+            kernel,
+            sched_params
+            );
+
+    if (profiler_ != nullptr)
+    {
+        profiler_->end_frame();
+    }
+
+    sched_params.rt.end_frame();
+
+    sched_params.cam.end_frame();
+
+    ++frame_id_;
+}
+
+template <typename B, typename R>
+template <typename K, typename SP>
+void basic_sched<B, R>::frame_impl(std::false_type /* wavefront */, K kernel, SP sched_params)
+{
     int pw = packet_size<typename R::scalar_type>::w;
     int ph = packet_size<typename R::scalar_type>::h;
 
@@ -96,21 +597,31 @@ void basic_sched<B, R>::frame(K kernel, SP sched_params)
     int nx = sched_params.rt.width();
     int ny = sched_params.rt.height();
 
+    std::vector<char> active;
+    basic_sched_impl::find_active_tiles(sched_params.sample_params, sched_params.rt.ref(), dx, dy, active);
+
     backend_.for_each_packet(
         tiled_range2d<int>(x0, nx, dx, y0, ny, dy), pw, ph,
-        [=](int x, int y)
+        [=, &active](int x, int y)
         {
+            if (!basic_sched_impl::tile_active(active, x, y, dx, dy, nx))
+            {
+                return;
+            }
+
             using S = typename R::scalar_type;
             using I = typename simd::int_type<S>::type;
 
             expand_pixel<S> ep;
-            auto seed = make_random_seed(
-                convert_to_int(ep.y(y)) * sched_params.rt.width() + convert_to_int(ep.x(x)),
+            auto gen = make_pixel_generator(
+                S{},
+                sched_params.sample_params,
+                convert_to_int(ep.x(x)),
+                convert_to_int(ep.y(y)),
+                sched_params.rt.width(),
                 I(frame_id_)
                 );
 
-            auto gen = make_generator(S{}, sched_params.sample_params, seed);
-
             basic_sched_impl::call_sample_pixel(
                     typename detail::sched_params_has_intersector<SP>::type(),
                     R{},
@@ -123,13 +634,59 @@ void basic_sched<B, R>::frame(K kernel, SP sched_params)
                     sched_params.rt.height(),
                     sched_params.cam
                     );
+
+            if (profiler_ != nullptr)
+            {
+                // Pixels of the packet that lie inside the image
+                uint64_t num_pixels = static_cast<uint64_t>(std::min(pw, nx - x)) * std::min(ph, ny - y);
+                detail::tile_sample_count() += num_pixels * samples_per_pixel(sched_params.sample_params);
+            }
         });
+}
 
-    sched_params.rt.end_frame();
+template <typename B, typename R>
+template <typename K, typename SP>
+void basic_sched<B, R>::frame_impl(std::true_type /* wavefront */, K kernel, SP sched_params)
+{
+    // Tiles are not split into packets, the kernel forms packets itself
+    int dx = 16;
+    int dy = 16;
 
-    sched_params.cam.end_frame();
+    int x0 = 0;
+    int y0 = 0;
 
-    ++frame_id_;
+    int nx = sched_params.rt.width();
+    int ny = sched_params.rt.height();
+
+    unsigned frame_id = frame_id_;
+
+    std::vector<char> active;
+    basic_sched_impl::find_active_tiles(sched_params.sample_params, sched_params.rt.ref(), dx, dy, active);
+
+    backend_.for_each_tile(
+        tiled_range2d<int>(x0, nx, dx, y0, ny, dy),
+        [=, &active](range2d<int> const& r)
+        {
+            if (!basic_sched_impl::tile_active(active, r.rows().begin(), r.cols().begin(), dx, dy, nx))
+            {
+                return;
+            }
+
+            basic_sched_impl::call_sample_tile(
+                    typename detail::sched_params_has_intersector<SP>::type(),
+                    R{},
+                    kernel,
+                    sched_params,
+                    r,
+                    frame_id
+                    );
+
+            if (profiler_ != nullptr)
+            {
+                uint64_t num_pixels = static_cast<uint64_t>(r.rows().length()) * r.cols().length();
+                detail::tile_sample_count() += num_pixels * samples_per_pixel(sched_params.sample_params);
+            }
+        });
 }
 
 template <typename B, typename R>
@@ -139,4 +696,11 @@ void basic_sched<B, R>::reset(Args&&... args)
     backend_.reset(std::forward<Args>(args)...);
 }
 
+template <typename B, typename R>
+void basic_sched<B, R>::set_profiler(sched_profiler* profiler)
+{
+    profiler_ = profiler;
+    backend_.profiler_ = profiler;
+}
+
 } // visionaray
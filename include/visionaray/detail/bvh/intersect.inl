@@ -53,7 +53,6 @@ inline auto intersect(
     using HR = hit_record_bvh<R, decltype(isect(ray, std::declval<typename BVH::primitive_type>()))>;
 
     using I = typename simd::int_type_t<T>;
-    using M = typename simd::mask_type_t<T>;
 
     HR result;
 
@@ -126,7 +125,8 @@ next:
 
                 I sign((int)node.ordered_traversal_sign);
                 I sign_rd = reinterpret_as_int(ray.dir[node.ordered_traversal_axis]) >> 31;
-                unsigned near_addr = any(M(sign ^ sign_rd));
+                // Sign bit set <=> traverse the far child first
+                unsigned near_addr = any((sign ^ sign_rd) < I(0));
                 unsigned far_addr = !near_addr;
 
                 st.push(node.get_child(far_addr));
@@ -22,6 +22,7 @@
 #include <intrin.h>
 #endif
 
+#include "../parallel_algorithm.h"
 #include "build_top_down.h"
 
 namespace visionaray
@@ -496,6 +497,9 @@ struct lbvh_builder
     aligned_vector<prim_ref> prim_refs;
     aligned_vector<aabb> prim_bounds;
 
+    // Pool to sort morton codes on, set by build(..., pool)
+    thread_pool* sort_pool = nullptr;
+
     VSNRAY_FUNC
     int find_split(prim_ref const* refs, int first, int last) const
     {
@@ -541,6 +545,17 @@ struct lbvh_builder
         return tree;
     }
 
+    // Same, morton codes are sorted in parallel on pool
+    template <typename Tree, typename P>
+    Tree build(Tree /* */, P* primitives, size_t num_prims, thread_pool& pool, int max_leaf_size = -1)
+    {
+        sort_pool = &pool;
+        Tree tree = build(Tree{}, primitives, num_prims, max_leaf_size);
+        sort_pool = nullptr;
+
+        return tree;
+    }
+
     template <typename I>
     leaf_info init(I first, I last)
     {
@@ -593,7 +608,21 @@ struct lbvh_builder
                     );
         }
 
-        std::stable_sort(prim_refs.begin(), prim_refs.end());
+        if (sort_pool != nullptr)
+        {
+            // 30-bit morton codes
+            paralgo::radix_sort_by(
+                    *sort_pool,
+                    prim_refs.begin(),
+                    prim_refs.end(),
+                    [](prim_ref const& ref) { return ref.morton_code; },
+                    30
+                    );
+        }
+        else
+        {
+            std::stable_sort(prim_refs.begin(), prim_refs.end());
+        }
 
         return { 0, static_cast<int>(last - first), scene_bounds };
     }
@@ -29,33 +29,38 @@ namespace visionaray
 // From:
 // https://research.nvidia.com/publication/simple-analytic-approximations-cie-xyz-color-matching-functions
 //
+// Also evaluate SIMD vectors of wavelengths
+//
 
+template <typename T>
 VSNRAY_FUNC
-inline float cie_x(float lambda)
+inline T cie_x(T const& lambda)
 {
-    float t1 = (lambda - 442.0f) * ((lambda < 442.0f) ? 0.0624f : 0.0374f);
-    float t2 = (lambda - 599.8f) * ((lambda < 599.8f) ? 0.0264f : 0.0323f);
-    float t3 = (lambda - 501.1f) * ((lambda < 501.1f) ? 0.0490f : 0.0382f);
+    T t1 = (lambda - T(442.0f)) * select(lambda < T(442.0f), T(0.0624f), T(0.0374f));
+    T t2 = (lambda - T(599.8f)) * select(lambda < T(599.8f), T(0.0264f), T(0.0323f));
+    T t3 = (lambda - T(501.1f)) * select(lambda < T(501.1f), T(0.0490f), T(0.0382f));
 
-    return 0.362f * exp(-0.5f * t1 * t1) + 1.056f * exp(-0.5f * t2 * t2) - 0.065f * exp(-0.5f * t3 * t3);
+    return T(0.362f) * exp(T(-0.5f) * t1 * t1) + T(1.056f) * exp(T(-0.5f) * t2 * t2) - T(0.065f) * exp(T(-0.5f) * t3 * t3);
 }
 
+template <typename T>
 VSNRAY_FUNC
-inline float cie_y(float lambda)
+inline T cie_y(T const& lambda)
 {
-    float t1 = (lambda - 568.8f) * ((lambda < 568.8f) ? 0.0213f : 0.0247f);
-    float t2 = (lambda - 530.9f) * ((lambda < 530.9f) ? 0.0613f : 0.0322f);
+    T t1 = (lambda - T(568.8f)) * select(lambda < T(568.8f), T(0.0213f), T(0.0247f));
+    T t2 = (lambda - T(530.9f)) * select(lambda < T(530.9f), T(0.0613f), T(0.0322f));
 
-    return 0.821f * exp(-0.5f * t1 * t1) + 0.286f * exp(-0.5f * t2 * t2);
+    return T(0.821f) * exp(T(-0.5f) * t1 * t1) + T(0.286f) * exp(T(-0.5f) * t2 * t2);
 }
 
+template <typename T>
 VSNRAY_FUNC
-inline float cie_z(float lambda)
+inline T cie_z(T const& lambda)
 {
-    float t1 = (lambda - 437.0f) * ((lambda < 437.0f) ? 0.0845f : 0.0278f);
-    float t2 = (lambda - 459.0f) * ((lambda < 459.0f) ? 0.0385f : 0.0725f);
+    T t1 = (lambda - T(437.0f)) * select(lambda < T(437.0f), T(0.0845f), T(0.0278f));
+    T t2 = (lambda - T(459.0f)) * select(lambda < T(459.0f), T(0.0385f), T(0.0725f));
 
-    return 1.217f * exp(-0.5f * t1 * t1) + 0.681f * exp(-0.5f * t2 * t2);
+    return T(1.217f) * exp(T(-0.5f) * t1 * t1) + T(0.681f) * exp(T(-0.5f) * t2 * t2);
 }
 
 
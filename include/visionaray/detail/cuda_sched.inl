@@ -49,13 +49,15 @@ __global__ void render(
     }
 
     expand_pixel<S> ep;
-    auto seed = make_random_seed(
-        convert_to_int(ep.y(y)) * rt_ref.width() + convert_to_int(ep.x(x)),
+    auto gen = make_pixel_generator(
+        S{},
+        sample_params,
+        convert_to_int(ep.x(x)),
+        convert_to_int(ep.y(y)),
+        rt_ref.width(),
         I(frame_id)
         );
 
-    auto gen = make_generator(S{}, sample_params, seed);
-
     sample_pixel(
             kernel,
             sample_params,
@@ -98,14 +100,15 @@ __global__ void render(
     }
 
     expand_pixel<S> ep;
-    auto seed = make_random_seed(
-        convert_to_int(ep.y(y)) * rt_ref.width() + convert_to_int(ep.x(x)),
+    auto gen = make_pixel_generator(
+        S{},
+        sample_params,
+        convert_to_int(ep.x(x)),
+        convert_to_int(ep.y(y)),
+        rt_ref.width(),
         I(frame_id)
         );
 
-    // TODO: support any sampler
-    random_generator<typename R::scalar_type> gen(seed);
-
     sample_pixel(
             detail::have_intersector_tag(),
             intersector,
@@ -229,6 +232,8 @@ void cuda_sched<R>::frame(K kernel, SP sched_params, size_t smem, cudaStream_t c
 
     sched_params.rt.begin_frame();
 
+    detail::require_moments(sched_params.sample_params, sched_params.rt);
+
     detail::cuda_sched_impl_frame<R>(
             kernel,
             sched_params,
@@ -0,0 +1,531 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+#include "../math/simd/simd.h"
+#include "../math/math.h"
+#include "parallel_for.h"
+#include "range.h"
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// SIMD float type for the filter passes
+//
+
+// Filter taps are loaded from arbitrary addresses, load_unaligned() can
+// only be overloaded for one width, so the loads are implemented here
+
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX512F)
+using denoiser_float = simd::float16;
+
+VSNRAY_FORCE_INLINE denoiser_float denoiser_load(float const* src)
+{
+    return _mm512_loadu_ps(src);
+}
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX)
+using denoiser_float = simd::float8;
+
+VSNRAY_FORCE_INLINE denoiser_float denoiser_load(float const* src)
+{
+    return _mm256_loadu_ps(src);
+}
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_SSE2)
+using denoiser_float = simd::float4;
+
+VSNRAY_FORCE_INLINE denoiser_float denoiser_load(float const* src)
+{
+    return simd::load_unaligned(src);
+}
+#else
+using denoiser_float = simd::float4;
+
+// The NEON and builtin constructors don't require alignment
+VSNRAY_FORCE_INLINE denoiser_float denoiser_load(float const* src)
+{
+    return denoiser_float(src);
+}
+#endif
+
+// exp(-x) for x in [0..80], the edge-stopping weights don't need the
+// range checks of simd::exp(). 2^fract is approximated w/ the degree 5
+// polynomial of pow2_t<5>, the exponent is at least -116, so 2^int can
+// be assembled from its bits w/o producing subnormals
+VSNRAY_FORCE_INLINE denoiser_float denoiser_exp_neg(denoiser_float const& x)
+{
+    using F = denoiser_float;
+    using I = simd::int_type<F>::type;
+
+    F y = x * F(-constants::log2_e<float>());
+    F yi = floor(y);
+    F yf = y - yi;
+
+    F p(1.8968500441332026E-3f);
+    p = p * yf + F(8.9477503096873079E-3f);
+    p = p * yf + F(5.5855296413199085E-2f);
+    p = p * yf + F(2.4014712313022102E-1f);
+    p = p * yf + F(6.9315298010274962E-1f);
+    p = p * yf + F(1.0f);
+
+    return reinterpret_as_float((convert_to_int(yi) + I(127)) << 23) * p;
+}
+
+// Rows per tile for parallel_for
+static const int DenoiserTileRows = 8;
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// atrous_denoiser members
+//
+
+inline atrous_denoiser::atrous_denoiser(thread_pool& pool)
+    : pool_(pool)
+{
+}
+
+inline atrous_params& atrous_denoiser::params()
+{
+    return params_;
+}
+
+inline atrous_params const& atrous_denoiser::params() const
+{
+    return params_;
+}
+
+inline void atrous_denoiser::apply(
+        vec4 const*         color,
+        aov_buffers const&  aovs,
+        int                 width,
+        int                 height,
+        vec4*               output
+        )
+{
+    resize(width, height);
+    load(color, aovs);
+
+    bool temporal = params_.temporal && aovs.motion() != nullptr;
+
+    if (temporal && history_valid_)
+    {
+        reproject(aovs);
+    }
+
+    if (temporal && params_.iterations == 0)
+    {
+        update_history(color_);
+    }
+
+    for (unsigned i = 0; i < params_.iterations; ++i)
+    {
+        filter_pass(color_, temp_, i);
+
+        // SVGF keeps the output of the first pass as history
+        if (temporal && i == 0)
+        {
+            update_history(temp_);
+        }
+
+        std::swap(color_, temp_);
+    }
+
+    history_valid_ = history_valid_ && temporal;
+
+    store(color, output);
+}
+
+template <typename RenderTarget>
+inline void atrous_denoiser::apply(RenderTarget const& rt, vec4* output)
+{
+    static_assert(
+            std::is_same<typename std::decay<decltype(*rt.accum())>::type, vec4>::value,
+            "Accum buffer must have format PF_RGBA32F"
+            );
+
+    apply(rt.accum(), rt.aovs(), rt.width(), rt.height(), output);
+}
+
+inline void atrous_denoiser::reset_history()
+{
+    history_valid_ = false;
+}
+
+inline void atrous_denoiser::resize(int width, int height)
+{
+    using F = detail::denoiser_float;
+
+    // Taps of the last pass reach 2 * 2^(iterations-1) pixels to the left and
+    // to the right, SIMD loads of the last lanes run over by up to one vector
+    int lanes = simd::num_elements<F>::value;
+    int reach = params_.iterations > 0 ? 2 << (params_.iterations - 1) : 0;
+    int pad = round_up(std::max(reach, lanes), 16);
+
+    if (width == width_ && height == height_ && pad == pad_)
+    {
+        return;
+    }
+
+    width_  = width;
+    height_ = height;
+
+    // A filter tap loads from 11 planes and 5 rows. Rows and planes are an
+    // odd number of cache lines (16 floats) apart, so that the loads don't
+    // map to the same cache sets
+    auto odd_cache_lines = [](size_t n)
+    {
+        n = round_up(n, size_t(16));
+        return (n / 16) % 2 == 0 ? n + 16 : n;
+    };
+
+    pad_ = pad;
+    stride_ = static_cast<int>(odd_cache_lines(pad_ + round_up(width, 16) + pad_));
+
+    plane_size_ = odd_cache_lines(static_cast<size_t>(stride_) * height);
+
+    // color, temp, normal, albedo, history color and history normal w/ 3
+    // planes, depth, mask and history depth w/ one plane
+    planes_.assign(plane_size_ * (6 * 3 + 3), 0.0f);
+
+    float* next = planes_.data();
+
+    for (plane3* p : { &color_, &temp_, &normal_, &albedo_, &history_color_, &history_normal_ })
+    {
+        p->x = next;
+        p->y = next + plane_size_;
+        p->z = next + plane_size_ * 2;
+        next += plane_size_ * 3;
+    }
+
+    depth_ = next;
+    mask_ = next + plane_size_;
+    history_depth_ = next + plane_size_ * 2;
+
+    // Padding is masked out
+    for (int y = 0; y < height; ++y)
+    {
+        std::fill(mask_ + index(0, y), mask_ + index(width, y), 1.0f);
+    }
+
+    history_valid_ = false;
+}
+
+inline void atrous_denoiser::load(vec4 const* color, aov_buffers const& aovs)
+{
+    parallel_for(
+        pool_,
+        tiled_range1d<int>(0, height_, detail::DenoiserTileRows),
+        [&](range1d<int> const& r)
+        {
+            for (int y = r.begin(); y != r.end(); ++y)
+            {
+                for (int x = 0; x < width_; ++x)
+                {
+                    int src = y * width_ + x;
+                    int dst = index(x, y);
+
+                    vec3 albedo(1.0f);
+                    vec3 normal(0.0f);
+                    float depth = 0.0f;
+
+                    if (aovs.albedo() != nullptr)
+                    {
+                        albedo = aovs.albedo()[src];
+                    }
+                    else if (aovs.albedo16() != nullptr)
+                    {
+                        albedo = vec3(aovs.albedo16()[src]);
+                    }
+
+                    if (aovs.normal() != nullptr)
+                    {
+                        normal = aovs.normal()[src];
+                    }
+                    else if (aovs.normal16() != nullptr)
+                    {
+                        normal = vec3(aovs.normal16()[src]);
+                    }
+
+                    if (aovs.depth() != nullptr)
+                    {
+                        depth = aovs.depth()[src];
+                    }
+
+                    // Demodulate, no-hit pixels and black surfaces are not
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        albedo[i] = albedo[i] > 1e-3f ? albedo[i] : 1.0f;
+                    }
+
+                    vec3 illum = color[src].xyz() / albedo;
+
+                    color_.x[dst] = illum.x;
+                    color_.y[dst] = illum.y;
+                    color_.z[dst] = illum.z;
+
+                    normal_.x[dst] = normal.x;
+                    normal_.y[dst] = normal.y;
+                    normal_.z[dst] = normal.z;
+
+                    albedo_.x[dst] = albedo.x;
+                    albedo_.y[dst] = albedo.y;
+                    albedo_.z[dst] = albedo.z;
+
+                    depth_[dst] = depth;
+                }
+            }
+        }
+        );
+}
+
+inline void atrous_denoiser::reproject(aov_buffers const& aovs)
+{
+    bool test_normals = aovs.normal() != nullptr || aovs.normal16() != nullptr;
+    float alpha = params_.temporal_alpha;
+
+    parallel_for(
+        pool_,
+        tiled_range1d<int>(0, height_, detail::DenoiserTileRows),
+        [&](range1d<int> const& r)
+        {
+            for (int y = r.begin(); y != r.end(); ++y)
+            {
+                for (int x = 0; x < width_; ++x)
+                {
+                    vec2 motion = aovs.motion()[y * width_ + x];
+
+                    // Nearest pixel in the last frame
+                    int px = static_cast<int>(std::floor(x + 0.5f - motion.x * width_));
+                    int py = static_cast<int>(std::floor(y + 0.5f - motion.y * height_));
+
+                    if (px < 0 || px >= width_ || py < 0 || py >= height_)
+                    {
+                        continue;
+                    }
+
+                    int p = index(x, y);
+                    int q = index(px, py);
+
+                    // Reject disocclusions
+                    float z = depth_[p];
+                    float zq = history_depth_[q];
+
+                    if (std::abs(z - zq) > 0.1f * std::abs(z))
+                    {
+                        continue;
+                    }
+
+                    if (test_normals)
+                    {
+                        float d = normal_.x[p] * history_normal_.x[q]
+                                + normal_.y[p] * history_normal_.y[q]
+                                + normal_.z[p] * history_normal_.z[q];
+
+                        if (d < 0.9f)
+                        {
+                            continue;
+                        }
+                    }
+
+                    color_.x[p] = lerp_r(history_color_.x[q], color_.x[p], alpha);
+                    color_.y[p] = lerp_r(history_color_.y[q], color_.y[p], alpha);
+                    color_.z[p] = lerp_r(history_color_.z[q], color_.z[p], alpha);
+                }
+            }
+        }
+        );
+}
+
+inline void atrous_denoiser::filter_pass(plane3 const& src, plane3& dst, unsigned iteration)
+{
+    using F = detail::denoiser_float;
+
+    static const float kernel[] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+    int const lanes = simd::num_elements<F>::value;
+    int const step = 1 << iteration;
+
+    float sigma_color = params_.sigma_color / step;
+
+    F inv_sigma_color2(1.0f / (sigma_color * sigma_color));
+    F inv_sigma_normal2(1.0f / (params_.sigma_normal * params_.sigma_normal));
+    F inv_sigma_albedo2(1.0f / (params_.sigma_albedo * params_.sigma_albedo));
+
+    // Per tap constants: B3-spline weight and 1 / (sigma_depth * pixel distance)^2,
+    // the depth change is then relative to the center depth w/o a division per tap
+    float tap_weight[5][5];
+    float tap_inv_dist2[5][5];
+
+    float sigma_depth2 = params_.sigma_depth * params_.sigma_depth;
+
+    for (int dy = -2; dy <= 2; ++dy)
+    {
+        for (int dx = -2; dx <= 2; ++dx)
+        {
+            float dist2 = float(dx * dx + dy * dy) * step * step;
+
+            tap_weight[dy + 2][dx + 2] = kernel[std::abs(dx)] * kernel[std::abs(dy)];
+            tap_inv_dist2[dy + 2][dx + 2] = dist2 > 0.0f ? 1.0f / (sigma_depth2 * dist2) : 0.0f;
+        }
+    }
+
+    auto sqr = [](F const& x) { return x * x; };
+
+    parallel_for(
+        pool_,
+        tiled_range1d<int>(0, height_, detail::DenoiserTileRows),
+        [&](range1d<int> const& r)
+        {
+            using detail::denoiser_load;
+            using detail::denoiser_exp_neg;
+
+            for (int y = r.begin(); y != r.end(); ++y)
+            {
+                for (int x = 0; x < width_; x += lanes)
+                {
+                    // Centers are aligned
+                    int p = index(x, y);
+
+                    F cpx(src.x + p);
+                    F cpy(src.y + p);
+                    F cpz(src.z + p);
+
+                    F npx(normal_.x + p);
+                    F npy(normal_.y + p);
+                    F npz(normal_.z + p);
+
+                    F apx(albedo_.x + p);
+                    F apy(albedo_.y + p);
+                    F apz(albedo_.z + p);
+
+                    F zp(depth_ + p);
+                    F mp(mask_ + p);
+
+                    // Clamped so that the square is a normal float, also handles inf
+                    F inv_zp2 = F(1.0f) / sqr(min(max(abs(zp), F(1e-6f)), F(1e18f)));
+
+                    // Center tap, all distances are zero
+                    F w = F(tap_weight[2][2]) * mp;
+
+                    F sumx = w * cpx;
+                    F sumy = w * cpy;
+                    F sumz = w * cpz;
+                    F sumw = w;
+
+                    for (int dy = -2; dy <= 2; ++dy)
+                    {
+                        int yy = y + dy * step;
+
+                        if (yy < 0 || yy >= height_)
+                        {
+                            continue;
+                        }
+
+                        for (int dx = -2; dx <= 2; ++dx)
+                        {
+                            if (dx == 0 && dy == 0)
+                            {
+                                continue;
+                            }
+
+                            int q = index(x + dx * step, yy);
+
+                            F cqx = denoiser_load(src.x + q);
+                            F cqy = denoiser_load(src.y + q);
+                            F cqz = denoiser_load(src.z + q);
+
+                            F nqx = denoiser_load(normal_.x + q);
+                            F nqy = denoiser_load(normal_.y + q);
+                            F nqz = denoiser_load(normal_.z + q);
+
+                            F aqx = denoiser_load(albedo_.x + q);
+                            F aqy = denoiser_load(albedo_.y + q);
+                            F aqz = denoiser_load(albedo_.z + q);
+
+                            F zq = denoiser_load(depth_ + q);
+                            F mq = denoiser_load(mask_ + q);
+
+                            F e = (sqr(cpx - cqx) + sqr(cpy - cqy) + sqr(cpz - cqz)) * inv_sigma_color2
+                                + (sqr(npx - nqx) + sqr(npy - nqy) + sqr(npz - nqz)) * inv_sigma_normal2
+                                + (sqr(apx - aqx) + sqr(apy - aqy) + sqr(apz - aqz)) * inv_sigma_albedo2
+                                + sqr(zp - zq) * inv_zp2 * F(tap_inv_dist2[dy + 2][dx + 2]);
+
+                            // Clamp to the range of denoiser_exp_neg(), also handles inf
+                            w = F(tap_weight[dy + 2][dx + 2]) * mq * denoiser_exp_neg(min(e, F(80.0f)));
+
+                            sumx += w * cqx;
+                            sumy += w * cqy;
+                            sumz += w * cqz;
+                            sumw += w;
+                        }
+                    }
+
+                    // Lanes in the padding have zero weight and produce zeros
+                    F inv_sumw = F(1.0f) / max(sumw, F(1e-20f));
+
+                    simd::store(dst.x + p, sumx * inv_sumw);
+                    simd::store(dst.y + p, sumy * inv_sumw);
+                    simd::store(dst.z + p, sumz * inv_sumw);
+                }
+            }
+        }
+        );
+}
+
+inline void atrous_denoiser::update_history(plane3 const& illum)
+{
+    std::copy(illum.x, illum.x + plane_size_, history_color_.x);
+    std::copy(illum.y, illum.y + plane_size_, history_color_.y);
+    std::copy(illum.z, illum.z + plane_size_, history_color_.z);
+
+    std::copy(normal_.x, normal_.x + plane_size_, history_normal_.x);
+    std::copy(normal_.y, normal_.y + plane_size_, history_normal_.y);
+    std::copy(normal_.z, normal_.z + plane_size_, history_normal_.z);
+
+    std::copy(depth_, depth_ + plane_size_, history_depth_);
+
+    history_valid_ = true;
+}
+
+inline void atrous_denoiser::store(vec4 const* color, vec4* output)
+{
+    parallel_for(
+        pool_,
+        tiled_range1d<int>(0, height_, detail::DenoiserTileRows),
+        [&](range1d<int> const& r)
+        {
+            for (int y = r.begin(); y != r.end(); ++y)
+            {
+                for (int x = 0; x < width_; ++x)
+                {
+                    int p = index(x, y);
+                    int i = y * width_ + x;
+
+                    // Remodulate
+                    vec3 rgb(
+                            color_.x[p] * albedo_.x[p],
+                            color_.y[p] * albedo_.y[p],
+                            color_.z[p] * albedo_.z[p]
+                            );
+
+                    output[i] = vec4(rgb, color[i].w);
+                }
+            }
+        }
+        );
+}
+
+inline int atrous_denoiser::index(int x, int y) const
+{
+    return y * stride_ + pad_ + x;
+}
+
+} // visionaray
@@ -1,9 +1,138 @@
 // This file is distributed under the MIT license.
 // See the LICENSE file for details.
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../math/constants.h"
+#include "../math/simd/type_traits.h"
+#include "alias_table.h"
+#include "color_conversion.h"
+
 namespace visionaray
 {
 
+//-------------------------------------------------------------------------------------------------
+// environment_map_distribution members
+//
+
+template <typename Texture>
+inline environment_map_distribution::environment_map_distribution(Texture const& tex)
+{
+    build(tex);
+}
+
+template <typename Texture>
+inline void environment_map_distribution::build(Texture const& tex)
+{
+    int width = static_cast<int>(tex.width());
+    int height = static_cast<int>(tex.height());
+
+    width_ = 0;
+    height_ = 0;
+
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    auto data = tex.data();
+
+    // Luminance weighted by the area of the texel on the sphere
+    std::vector<double> func(width * height);
+    std::vector<double> row_sums(height);
+    double sum = 0.0;
+
+    for (int y = 0; y < height; ++y)
+    {
+        double sin_theta = std::sin(constants::pi<double>() * (y + 0.5) / height);
+
+        row_sums[y] = 0.0;
+
+        for (int x = 0; x < width; ++x)
+        {
+            auto texel = data[y * width + x];
+            vec3 rgb(static_cast<float>(texel.x), static_cast<float>(texel.y), static_cast<float>(texel.z));
+
+            double f = std::max(static_cast<double>(rgb_to_luminance(rgb)), 0.0) * sin_theta;
+
+            func[y * width + x] = f;
+            row_sums[y] += f;
+        }
+
+        sum += row_sums[y];
+    }
+
+    if (!(sum > 0.0))
+    {
+        // Black environment, not importance sampled
+        return;
+    }
+
+    marginal_prob_.resize(height);
+    marginal_alias_.resize(height);
+    conditional_prob_.resize(width * height);
+    conditional_alias_.resize(width * height);
+    pdf_.resize(width * height);
+
+    detail::build_alias_table(row_sums.data(), height, marginal_prob_.data(), marginal_alias_.data());
+
+    for (int y = 0; y < height; ++y)
+    {
+        if (row_sums[y] > 0.0)
+        {
+            detail::build_alias_table(
+                    func.data() + y * width,
+                    width,
+                    conditional_prob_.data() + y * width,
+                    conditional_alias_.data() + y * width
+                    );
+        }
+        else
+        {
+            // Never picked by the marginal table
+            for (int x = 0; x < width; ++x)
+            {
+                conditional_prob_[y * width + x] = 1.0f;
+                conditional_alias_[y * width + x] = x;
+            }
+        }
+    }
+
+    // Each texel covers 1 / (width * height) of the texture coordinate domain
+    for (int i = 0; i < width * height; ++i)
+    {
+        pdf_[i] = static_cast<float>(func[i] / sum * width * height);
+    }
+
+    width_ = width;
+    height_ = height;
+}
+
+inline environment_map_distribution_ref environment_map_distribution::ref() const
+{
+    environment_map_distribution_ref result;
+
+    if (width_ > 0 && height_ > 0)
+    {
+        result.marginal_prob = marginal_prob_.data();
+        result.marginal_alias = marginal_alias_.data();
+        result.conditional_prob = conditional_prob_.data();
+        result.conditional_alias = conditional_alias_.data();
+        result.pdf = pdf_.data();
+        result.width = width_;
+        result.height = height_;
+    }
+
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// environment_light members
+//
+
 template <typename T, typename Texture>
 template <typename U>
 VSNRAY_FUNC vector<3, U> environment_light<T, Texture>::intensity(vector<3, U> const& dir) const
@@ -22,6 +151,122 @@ VSNRAY_FUNC vector<3, U> environment_light<T, Texture>::intensity(vector<3, U> c
     return tex2D(texture_, tc).xyz() * vector<3, U>(to_rgb(scale_));
 }
 
+template <typename T, typename Texture>
+template <typename Generator, typename U>
+VSNRAY_FUNC light_sample<U> environment_light<T, Texture>::sample(vector<3, U> const& reference_point, Generator& gen) const
+{
+    VSNRAY_UNUSED(reference_point);
+
+    using I = simd::int_type_t<U>;
+
+    light_sample<U> result;
+
+    auto u1 = gen.next();
+    auto u2 = gen.next();
+
+    if (!importance_sampled())
+    {
+        result.dir = vector<3, U>(U(0.0), U(1.0), U(0.0));
+        result.pdf = U(0.0);
+        result.dist = U(HUGE_VAL);
+        result.intensity = vector<3, U>(U(0.0));
+        result.normal = -result.dir;
+        result.area = U(1.0);
+        result.delta_light = U(0.0) != U(0.0);
+        return result;
+    }
+
+    int width = distribution_.width;
+    int height = distribution_.height;
+
+    // Pick a row, then a texel in that row, and a position in the texel
+    U v_remapped;
+    I y = detail::sample_alias_table(
+            distribution_.marginal_prob,
+            distribution_.marginal_alias,
+            I(0),
+            height,
+            u2,
+            v_remapped
+            );
+
+    U u_remapped;
+    I x = detail::sample_alias_table(
+            distribution_.conditional_prob,
+            distribution_.conditional_alias,
+            y * I(width),
+            width,
+            u1,
+            u_remapped
+            );
+
+    U u = (convert_to_float(x) + u_remapped) / U(static_cast<float>(width));
+    U v = (convert_to_float(y) + v_remapped) / U(static_cast<float>(height));
+
+    // Inverse of the mapping in intensity()
+    U theta = v * constants::pi<U>();
+    U phi = u * constants::two_pi<U>();
+
+    U sin_theta = sin(theta);
+
+    vector<3, U> d(sin_theta * sin(phi), cos(theta), sin_theta * cos(phi));
+    vector<3, U> dir = normalize((matrix<4, 4, U>(light_to_world_transform_) * vector<4, U>(d, U(0.0))).xyz());
+
+    // Jacobian of the mapping from texture coordinates to directions: 2 pi^2 sin(theta)
+    U pdf_uv = detail::load(distribution_.pdf, y * I(width) + x);
+
+    result.dir = dir;
+    result.pdf = select(
+            sin_theta > U(0.0),
+            pdf_uv / (U(2.0) * constants::pi<U>() * constants::pi<U>() * sin_theta),
+            U(0.0)
+            );
+    result.dist = U(HUGE_VAL);
+    result.intensity = intensity(dir);
+    result.normal = -dir;
+    result.area = U(1.0);
+    result.delta_light = U(0.0) != U(0.0);
+
+    return result;
+}
+
+template <typename T, typename Texture>
+template <typename U>
+VSNRAY_FUNC U environment_light<T, Texture>::pdf(vector<3, U> const& dir) const
+{
+    using I = simd::int_type_t<U>;
+
+    if (!importance_sampled())
+    {
+        return U(0.0);
+    }
+
+    int width = distribution_.width;
+    int height = distribution_.height;
+
+    vector<3, U> d = normalize((matrix<4, 4, U>(world_to_light_transform_) * vector<4, U>(dir, U(0.0))).xyz());
+
+    auto phi = atan2(d.x, d.z);
+    phi = select(phi < U(0.0), phi + constants::two_pi<U>(), phi);
+
+    U cos_theta = clamp(d.y, U(-1.0), U(1.0));
+    U sin_theta = sqrt(max(U(0.0), U(1.0) - cos_theta * cos_theta));
+
+    U u = phi / constants::two_pi<U>();
+    U v = acos(cos_theta) * constants::inv_pi<U>();
+
+    I x = clamp(convert_to_int(u * U(static_cast<float>(width))), I(0), I(width - 1));
+    I y = clamp(convert_to_int(v * U(static_cast<float>(height))), I(0), I(height - 1));
+
+    U pdf_uv = detail::load(distribution_.pdf, y * I(width) + x);
+
+    return select(
+            sin_theta > U(0.0),
+            pdf_uv / (U(2.0) * constants::pi<U>() * constants::pi<U>() * sin_theta),
+            U(0.0)
+            );
+}
+
 template <typename T, typename Texture>
 VSNRAY_FUNC
 Texture& environment_light<T, Texture>::texture()
@@ -72,6 +317,27 @@ matrix<4, 4, T> environment_light<T, Texture>::world_to_light_transform() const
     return world_to_light_transform_;
 }
 
+template <typename T, typename Texture>
+VSNRAY_FUNC
+void environment_light<T, Texture>::set_distribution(environment_map_distribution_ref const& distribution)
+{
+    distribution_ = distribution;
+}
+
+template <typename T, typename Texture>
+VSNRAY_FUNC
+environment_map_distribution_ref const& environment_light<T, Texture>::distribution() const
+{
+    return distribution_;
+}
+
+template <typename T, typename Texture>
+VSNRAY_FUNC
+bool environment_light<T, Texture>::importance_sampled() const
+{
+    return distribution_.width > 0 && distribution_.height > 0;
+}
+
 template <typename T, typename Texture>
 VSNRAY_FUNC
 environment_light<T, Texture>::operator bool() const
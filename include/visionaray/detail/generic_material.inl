@@ -1,6 +1,9 @@
 // This file is distributed under the MIT license.
 // See the LICENSE file for details.
 
+#include <type_traits>
+#include <utility>
+
 #include "../array.h"
 #include "../material.h"
 
@@ -18,6 +21,13 @@ inline generic_material<T, Ts...>::generic_material(M<typename T::scalar_type> c
 {
 }
 
+template <typename T, typename ...Ts>
+VSNRAY_FUNC
+inline spectrum<typename T::scalar_type> generic_material<T, Ts...>::albedo() const
+{
+    return apply_visitor( albedo_visitor(), *this );
+}
+
 template <typename T, typename ...Ts>
 VSNRAY_FUNC
 inline spectrum<typename T::scalar_type> generic_material<T, Ts...>::ambient() const
@@ -63,6 +73,20 @@ inline typename SR::scalar_type generic_material<T, Ts...>::pdf(
 // Private variant visitors
 //
 
+template <typename T, typename ...Ts>
+struct generic_material<T, Ts...>::albedo_visitor
+{
+    using Base = generic_material<T, Ts...>;
+    using return_type = spectrum<typename Base::scalar_type>;
+
+    template <typename X>
+    VSNRAY_FUNC
+    return_type operator()(X const& ref) const
+    {
+        return ref.albedo();
+    }
+};
+
 template <typename T, typename ...Ts>
 struct generic_material<T, Ts...>::ambient_visitor
 {
@@ -151,12 +175,43 @@ struct generic_material<T, Ts...>::pdf_visitor
 };
 
 
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Check if N copies of material M can be packed into a SIMD material
+//
+
+template <typename S, typename M, typename = void>
+struct has_simd_material : std::false_type
+{
+};
+
+template <typename S, typename M>
+struct has_simd_material<
+        S,
+        M,
+        decltype(void(simd::pack(std::declval<array<M, simd::num_elements<S>::value>>())))
+        >
+    : std::true_type
+{
+};
+
+} // detail
+
+
 namespace simd
 {
 
 //-------------------------------------------------------------------------------------------------
 // SIMD type used internally. Contains N generic materials
 //
+// Material functions are dispatched once per material type that is
+// present in the packet: the lanes storing that type are packed into
+// its SIMD type (e.g. plastic<float8>), which is evaluated for all
+// lanes and blended into the result with the type's lane mask. Types
+// without a SIMD type are evaluated lane by lane.
+//
 
 template <unsigned N, typename ...Ts>
 class generic_material
@@ -187,16 +242,47 @@ public:
     }
 
     VSNRAY_FUNC
-    spectrum<scalar_type> ambient() const
+    spectrum<scalar_type> albedo() const
     {
-        array<spectrum<float>, N> amb;
-
-        for (unsigned i = 0; i < N; ++i)
-        {
-            amb[i] = mats_[i].ambient();
-        }
+        spectrum<scalar_type> result(0.0);
+        array<spectrum<float>, N> alb = {};
+        array<bool, N> scalar_lanes = {};
+
+        for_each_type(
+            [&](auto const& mat, mask_type_t<scalar_type> const& mask)
+            {
+                result = select(mask, mat.albedo(), result);
+            },
+            [&](auto const& mat, unsigned i)
+            {
+                alb[i] = mat.albedo();
+                scalar_lanes[i] = true;
+            }
+            );
+
+        return select(make_mask(scalar_lanes), pack(alb), result);
+    }
 
-        return pack(amb);
+    VSNRAY_FUNC
+    spectrum<scalar_type> ambient() const
+    {
+        spectrum<scalar_type> result(0.0);
+        array<spectrum<float>, N> amb = {};
+        array<bool, N> scalar_lanes = {};
+
+        for_each_type(
+            [&](auto const& mat, mask_type_t<scalar_type> const& mask)
+            {
+                result = select(mask, mat.ambient(), result);
+            },
+            [&](auto const& mat, unsigned i)
+            {
+                amb[i] = mat.ambient();
+                scalar_lanes[i] = true;
+            }
+            );
+
+        return select(make_mask(scalar_lanes), pack(amb), result);
     }
 
 
@@ -204,16 +290,32 @@ public:
     VSNRAY_FUNC
     spectrum<scalar_type> shade(SR const& sr) const
     {
-        auto srs = unpack(sr);
-
-        array<spectrum<float>, N> shaded;
-
-        for (unsigned i = 0; i < N; ++i)
-        {
-            shaded[i] = mats_[i].shade(srs[i]);
-        }
-
-        return pack(shaded);
+        spectrum<scalar_type> result(0.0);
+        array<spectrum<float>, N> shaded = {};
+        array<bool, N> scalar_lanes = {};
+
+        decltype(unpack(sr)) srs;
+        bool unpacked = false;
+
+        for_each_type(
+            [&](auto const& mat, mask_type_t<scalar_type> const& mask)
+            {
+                result = select(mask, mat.shade(sr), result);
+            },
+            [&](auto const& mat, unsigned i)
+            {
+                if (!unpacked)
+                {
+                    srs = unpack(sr);
+                    unpacked = true;
+                }
+
+                shaded[i] = mat.shade(srs[i]);
+                scalar_lanes[i] = true;
+            }
+            );
+
+        return select(make_mask(scalar_lanes), pack(shaded), result);
     }
 
     template <typename SR, typename Generator>
@@ -229,22 +331,53 @@ public:
         using float_array = aligned_array_t<scalar_type>;
         using int_array = aligned_array_t<int_type_t<scalar_type>>;
 
-        auto srs = unpack(sr);
-
-        array<vector<3, float>, N> rds;
-        float_array                pdfs;
-        int_array                  inters;
-        array<spectrum<float>, N>  sampled;
-
-        for (unsigned i = 0; i < N; ++i)
-        {
-            sampled[i] = mats_[i].sample(srs[i], rds[i], pdfs[i], inters[i], gen.get_generator(i));
-        }
-
-        refl_dir = pack(rds);
-        pdf = scalar_type(pdfs);
-        inter = int_type_t<scalar_type>(inters);
-        return pack(sampled);
+        spectrum<scalar_type> result(0.0);
+        refl_dir = vector<3, scalar_type>(0.0);
+        pdf = scalar_type(0.0);
+        inter = int_type_t<scalar_type>(0);
+
+        array<vector<3, float>, N> rds = {};
+        float_array                pdfs = {};
+        int_array                  inters = {};
+        array<spectrum<float>, N>  sampled = {};
+        array<bool, N>             scalar_lanes = {};
+
+        decltype(unpack(sr)) srs;
+        bool unpacked = false;
+
+        for_each_type(
+            [&](auto const& mat, mask_type_t<scalar_type> const& mask)
+            {
+                vector<3, scalar_type> rd(0.0);
+                scalar_type p(0.0);
+                int_type_t<scalar_type> it(0);
+
+                auto s = mat.sample(sr, rd, p, it, gen);
+
+                result   = select(mask, s, result);
+                refl_dir = select(mask, rd, refl_dir);
+                pdf      = select(mask, p, pdf);
+                inter    = select(mask, it, inter);
+            },
+            [&](auto const& mat, unsigned i)
+            {
+                if (!unpacked)
+                {
+                    srs = unpack(sr);
+                    unpacked = true;
+                }
+
+                sampled[i] = mat.sample(srs[i], rds[i], pdfs[i], inters[i], gen.get_generator(i));
+                scalar_lanes[i] = true;
+            }
+            );
+
+        auto mask = make_mask(scalar_lanes);
+
+        refl_dir = select(mask, pack(rds), refl_dir);
+        pdf      = select(mask, scalar_type(pdfs), pdf);
+        inter    = select(mask, int_type_t<scalar_type>(inters), inter);
+        return select(mask, pack(sampled), result);
     }
 
     template <typename SR, typename Interaction>
@@ -254,23 +387,128 @@ public:
         using float_array = aligned_array_t<scalar_type>;
         using int_array = aligned_array_t<int_type_t<scalar_type>>;
 
-        auto srs = unpack(sr);
+        scalar_type result(0.0);
+        float_array pdfs = {};
+        array<bool, N> scalar_lanes = {};
+
+        decltype(unpack(sr)) srs;
         int_array inters;
-        store(inters, inter);
+        bool unpacked = false;
+
+        for_each_type(
+            [&](auto const& mat, mask_type_t<scalar_type> const& mask)
+            {
+                result = select(mask, mat.pdf(sr, inter), result);
+            },
+            [&](auto const& mat, unsigned i)
+            {
+                if (!unpacked)
+                {
+                    srs = unpack(sr);
+                    store(inters, inter);
+                    unpacked = true;
+                }
+
+                pdfs[i] = mat.pdf(srs[i], inters[i]);
+                scalar_lanes[i] = true;
+            }
+            );
+
+        return select(make_mask(scalar_lanes), scalar_type(pdfs), result);
+    }
 
-        float_array pdfs;
+private:
+
+    array<single_material, N> mats_;
+
+    static mask_type_t<scalar_type> make_mask(array<bool, N> const& lanes)
+    {
+        aligned_array_t<scalar_type> arr;
 
         for (unsigned i = 0; i < N; ++i)
         {
-            pdfs[i] = mats_[i].pdf(srs[i], inters[i]);
+            arr[i] = lanes[i] ? 1.0f : 0.0f;
         }
 
-        return scalar_type(pdfs);
+        // Masks are not necessarily int vectors (e.g. AVX-512 bit masks)
+        return scalar_type(arr) != scalar_type(0.0f);
     }
 
-private:
+    // Call simd_func(material, mask) once for each material type that is
+    // present in the packet and that has a SIMD type, and
+    // scalar_func(material, lane) for each lane storing another type
+    template <typename SimdFunc, typename ScalarFunc>
+    void for_each_type(SimdFunc simd_func, ScalarFunc scalar_func) const
+    {
+        int dummy[] = { 0, (visit_type<Ts>(simd_func, scalar_func), 0)... };
+        VSNRAY_UNUSED(dummy);
+    }
 
-    array<single_material, N> mats_;
+    template <typename M, typename SimdFunc, typename ScalarFunc>
+    void visit_type(SimdFunc& simd_func, ScalarFunc& scalar_func) const
+    {
+        array<bool, N> lanes;
+        int first = -1;
+
+        for (unsigned i = 0; i < N; ++i)
+        {
+            lanes[i] = mats_[i].template as<M>() != nullptr;
+
+            if (lanes[i] && first < 0)
+            {
+                first = static_cast<int>(i);
+            }
+        }
+
+        if (first >= 0)
+        {
+            visit_type<M>(
+                    lanes,
+                    first,
+                    simd_func,
+                    scalar_func,
+                    visionaray::detail::has_simd_material<scalar_type, M>{}
+                    );
+        }
+    }
+
+    template <typename M, typename SimdFunc, typename ScalarFunc>
+    void visit_type(
+            array<bool, N> const& lanes,
+            int                   first,
+            SimdFunc&             simd_func,
+            ScalarFunc&           /* scalar_func */,
+            std::true_type        /* has SIMD type */
+            ) const
+    {
+        // Lanes storing other types get a copy of the first material
+        array<M, N> mats;
+
+        for (unsigned i = 0; i < N; ++i)
+        {
+            mats[i] = *mats_[lanes[i] ? i : first].template as<M>();
+        }
+
+        simd_func(pack(mats), make_mask(lanes));
+    }
+
+    template <typename M, typename SimdFunc, typename ScalarFunc>
+    void visit_type(
+            array<bool, N> const& lanes,
+            int                   /* first */,
+            SimdFunc&             /* simd_func */,
+            ScalarFunc&           scalar_func,
+            std::false_type       /* has SIMD type */
+            ) const
+    {
+        for (unsigned i = 0; i < N; ++i)
+        {
+            if (lanes[i])
+            {
+                scalar_func(*mats_[i].template as<M>(), i);
+            }
+        }
+    }
 
 };
 
@@ -0,0 +1,340 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <algorithm>
+#include <vector>
+
+#include "../math/simd/gather.h"
+#include "alias_table.h"
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Emitters are ordered by (geom_id, prim_id)
+//
+
+template <typename I>
+VSNRAY_FUNC
+inline auto emitter_less(I const& geom_id1, I const& prim_id1, I const& geom_id2, I const& prim_id2)
+    -> decltype(geom_id1 < geom_id2)
+{
+    return (geom_id1 < geom_id2) | ((geom_id1 == geom_id2) & (prim_id1 < prim_id2));
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// light_alias_table_ref members
+//
+
+inline light_alias_table_ref::light_alias_table_ref(
+        float const* prob,
+        int const*   alias,
+        float const* pmf,
+        int const*   emitter_geom_ids,
+        int const*   emitter_prim_ids,
+        int const*   emitter_lights,
+        int          num_lights,
+        int          num_emitters
+        )
+    : prob_(prob)
+    , alias_(alias)
+    , pmf_(pmf)
+    , emitter_geom_ids_(emitter_geom_ids)
+    , emitter_prim_ids_(emitter_prim_ids)
+    , emitter_lights_(emitter_lights)
+    , num_lights_(num_lights)
+    , num_emitters_(num_emitters)
+{
+}
+
+VSNRAY_FUNC
+inline int light_alias_table_ref::sample(int /* num_lights */, vec3 const& /* pos */, vec3 const& /* n */, float u, float& pmf) const
+{
+    pmf = 0.0f;
+
+    if (num_lights_ <= 0)
+    {
+        return -1;
+    }
+
+    float u_remapped = 0.0f;
+    int light_id = detail::sample_alias_table(prob_, alias_, 0, num_lights_, u, u_remapped);
+
+    if (pmf_[light_id] <= 0.0f)
+    {
+        return -1;
+    }
+
+    pmf = pmf_[light_id];
+    return light_id;
+}
+
+VSNRAY_FUNC
+inline float light_alias_table_ref::emitter_pmf(int /* num_lights */, vec3 const& /* pos */, vec3 const& /* n */, int geom_id, int prim_id) const
+{
+    // Binary search, emitters are sorted by (geom_id, prim_id)
+    int first = 0;
+    int last = num_emitters_;
+
+    while (first < last)
+    {
+        int mid = first + (last - first) / 2;
+
+        if (detail::emitter_less(emitter_geom_ids_[mid], emitter_prim_ids_[mid], geom_id, prim_id))
+        {
+            first = mid + 1;
+        }
+        else
+        {
+            last = mid;
+        }
+    }
+
+    if (first == num_emitters_ || emitter_geom_ids_[first] != geom_id || emitter_prim_ids_[first] != prim_id)
+    {
+        return 0.0f;
+    }
+
+    return pmf_[emitter_lights_[first]];
+}
+
+template <typename T, typename>
+inline simd::int_type_t<T> light_alias_table_ref::sample(
+        int                     /* num_lights */,
+        vector<3, T> const&     /* pos */,
+        vector<3, T> const&     /* n */,
+        T const&                u,
+        T&                      pmf
+        ) const
+{
+    using I = simd::int_type_t<T>;
+
+    if (num_lights_ <= 0)
+    {
+        pmf = T(0.0);
+        return I(-1);
+    }
+
+    T u_remapped;
+    I light_id = detail::sample_alias_table(prob_, alias_, I(0), num_lights_, u, u_remapped);
+
+    pmf = gather(pmf_, light_id);
+
+    auto valid = pmf > T(0.0);
+    pmf = select(valid, pmf, T(0.0));
+    return select(valid, light_id, I(-1));
+}
+
+template <typename T, typename I, typename>
+inline T light_alias_table_ref::emitter_pmf(
+        int                     /* num_lights */,
+        vector<3, T> const&     /* pos */,
+        vector<3, T> const&     /* n */,
+        I const&                geom_id,
+        I const&                prim_id
+        ) const
+{
+    if (num_emitters_ <= 0)
+    {
+        return T(0.0);
+    }
+
+    // Branchless binary search, the same number of steps for all lanes.
+    // base is the last emitter that is less than the key, or 0
+    I base(0);
+    int count = num_emitters_;
+
+    while (count > 1)
+    {
+        int half = count / 2;
+        I mid = base + I(half);
+
+        auto less = detail::emitter_less(
+                gather(emitter_geom_ids_, mid),
+                gather(emitter_prim_ids_, mid),
+                geom_id,
+                prim_id
+                );
+
+        base = select(less, mid, base);
+        count -= half;
+    }
+
+    auto less = detail::emitter_less(
+            gather(emitter_geom_ids_, base),
+            gather(emitter_prim_ids_, base),
+            geom_id,
+            prim_id
+            );
+
+    I index = min(select(less, base + I(1), base), I(num_emitters_ - 1));
+
+    auto found = (gather(emitter_geom_ids_, index) == geom_id) & (gather(emitter_prim_ids_, index) == prim_id);
+
+    return select(found, gather(pmf_, gather(emitter_lights_, index)), T(0.0));
+}
+
+VSNRAY_FUNC
+inline float light_alias_table_ref::pmf(int light_id) const
+{
+    if (light_id < 0 || light_id >= num_lights_)
+    {
+        return 0.0f;
+    }
+
+    return pmf_[light_id];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// light_alias_table members
+//
+
+template <typename Lights>
+inline light_alias_table::light_alias_table(Lights begin, Lights end)
+{
+    build(begin, end);
+}
+
+template <typename Lights>
+inline void light_alias_table::build(Lights begin, Lights end)
+{
+    int num_lights = static_cast<int>(end - begin);
+
+    prob_.resize(num_lights);
+    alias_.resize(num_lights);
+    pmf_.resize(num_lights);
+
+    emitter_geom_ids_.clear();
+    emitter_prim_ids_.clear();
+    emitter_lights_.clear();
+
+    // Light power, w/ accumulation in double precision
+    std::vector<double> power(num_lights);
+    std::vector<int> unbounded;
+
+    double bounded_power = 0.0;
+    int num_bounded = 0;
+
+    std::vector<int> emitters;
+
+    for (int i = 0; i < num_lights; ++i)
+    {
+        light_bounds lb;
+
+        if (get_light_bounds(begin[i], lb))
+        {
+            power[i] = std::max(static_cast<double>(lb.phi), 0.0);
+            bounded_power += power[i];
+            num_bounded += power[i] > 0.0 ? 1 : 0;
+        }
+        else
+        {
+            unbounded.push_back(i);
+        }
+
+        int geom_id = 0;
+        int prim_id = 0;
+
+        if (get_light_geometry_id(begin[i], geom_id, prim_id))
+        {
+            emitter_geom_ids_.push_back(geom_id);
+            emitter_prim_ids_.push_back(prim_id);
+            emitters.push_back(i);
+        }
+    }
+
+    double mean_power = num_bounded > 0 && bounded_power > 0.0 ? bounded_power / num_bounded : 1.0;
+
+    double total_power = bounded_power;
+
+    for (int i : unbounded)
+    {
+        power[i] = mean_power;
+        total_power += mean_power;
+    }
+
+    for (int i = 0; i < num_lights; ++i)
+    {
+        pmf_[i] = total_power > 0.0 ? static_cast<float>(power[i] / total_power) : 0.0f;
+    }
+
+    if (total_power > 0.0)
+    {
+        detail::build_alias_table(power.data(), num_lights, prob_.data(), alias_.data());
+    }
+    else
+    {
+        // No light is picked, sample() checks the pmf
+        std::fill(prob_.begin(), prob_.end(), 1.0f);
+
+        for (int i = 0; i < num_lights; ++i)
+        {
+            alias_[i] = i;
+        }
+    }
+
+
+    // Sort emitters by (geom_id, prim_id)
+
+    std::vector<int> order(emitters.size());
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = static_cast<int>(i);
+    }
+
+    std::sort(
+            order.begin(),
+            order.end(),
+            [&](int a, int b)
+            {
+                return detail::emitter_less(
+                        emitter_geom_ids_[a],
+                        emitter_prim_ids_[a],
+                        emitter_geom_ids_[b],
+                        emitter_prim_ids_[b]
+                        );
+            }
+            );
+
+    aligned_vector<int> geom_ids(order.size());
+    aligned_vector<int> prim_ids(order.size());
+    emitter_lights_.resize(order.size());
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        geom_ids[i] = emitter_geom_ids_[order[i]];
+        prim_ids[i] = emitter_prim_ids_[order[i]];
+        emitter_lights_[i] = emitters[order[i]];
+    }
+
+    emitter_geom_ids_.swap(geom_ids);
+    emitter_prim_ids_.swap(prim_ids);
+}
+
+inline light_alias_table_ref light_alias_table::ref() const
+{
+    return light_alias_table_ref(
+            prob_.data(),
+            alias_.data(),
+            pmf_.data(),
+            emitter_geom_ids_.data(),
+            emitter_prim_ids_.data(),
+            emitter_lights_.data(),
+            static_cast<int>(pmf_.size()),
+            static_cast<int>(emitter_lights_.size())
+            );
+}
+
+inline size_t light_alias_table::num_lights() const
+{
+    return pmf_.size();
+}
+
+} // visionaray
@@ -0,0 +1,779 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "../math/constants.h"
+#include "../math/limits.h"
+#include "color_conversion.h"
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Helpers for cone and angle arithmetic
+//
+
+// cos(max(0, a - b)) and sin(max(0, a - b)) from sines and cosines
+VSNRAY_FUNC
+inline float cos_sub_clamped(float sin_a, float cos_a, float sin_b, float cos_b)
+{
+    return cos_a > cos_b ? 1.0f : cos_a * cos_b + sin_a * sin_b;
+}
+
+VSNRAY_FUNC
+inline float sin_sub_clamped(float sin_a, float cos_a, float sin_b, float cos_b)
+{
+    return cos_a > cos_b ? 0.0f : sin_a * cos_b - cos_a * sin_b;
+}
+
+VSNRAY_FUNC
+inline float sin_from_cos(float cos_theta)
+{
+    return sqrt(max(0.0f, 1.0f - cos_theta * cos_theta));
+}
+
+// Rotate v by theta around (unit) axis k
+inline vec3 rotate(vec3 const& v, vec3 const& k, float theta)
+{
+    float c = std::cos(theta);
+    float s = std::sin(theta);
+    return v * c + cross(k, v) * s + k * dot(k, v) * (1.0f - c);
+}
+
+// Cone that contains the cones (wa, cos_a) and (wb, cos_b)
+inline void cone_union(vec3 const& wa, float cos_a, vec3 const& wb, float cos_b, vec3& w, float& cos_theta)
+{
+    float theta_a = std::acos(clamp(cos_a, -1.0f, 1.0f));
+    float theta_b = std::acos(clamp(cos_b, -1.0f, 1.0f));
+    float theta_d = std::acos(clamp(dot(wa, wb), -1.0f, 1.0f));
+
+    if (std::min(theta_d + theta_b, constants::pi<float>()) <= theta_a)
+    {
+        w = wa;
+        cos_theta = cos_a;
+        return;
+    }
+
+    if (std::min(theta_d + theta_a, constants::pi<float>()) <= theta_b)
+    {
+        w = wb;
+        cos_theta = cos_b;
+        return;
+    }
+
+    float theta_o = (theta_a + theta_d + theta_b) / 2.0f;
+
+    vec3 wr = cross(wa, wb);
+
+    if (theta_o >= constants::pi<float>() || dot(wr, wr) == 0.0f)
+    {
+        w = wa;
+        cos_theta = -1.0f;
+        return;
+    }
+
+    w = rotate(wa, normalize(wr), theta_o - theta_a);
+    cos_theta = std::cos(theta_o);
+}
+
+inline light_bounds combine(light_bounds const& a, light_bounds const& b)
+{
+    // Lights w/o power do not contribute to the bounds
+    if (a.phi == 0.0f)
+    {
+        return b;
+    }
+
+    if (b.phi == 0.0f)
+    {
+        return a;
+    }
+
+    light_bounds result;
+    result.bounds = visionaray::combine(a.bounds, b.bounds);
+    cone_union(a.axis, a.cos_theta_o, b.axis, b.cos_theta_o, result.axis, result.cos_theta_o);
+    result.cos_theta_e = std::min(a.cos_theta_e, b.cos_theta_e);
+    result.phi = a.phi + b.phi;
+    result.two_sided = a.two_sided || b.two_sided;
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Estimate of the contribution of the lights in lb to a point with
+// normal n (not considered if n is the null vector)
+//
+
+VSNRAY_FUNC
+inline float importance(light_bounds const& lb, vec3 const& pos, vec3 const& n)
+{
+    vec3 pc = lb.bounds.center();
+    vec3 d = pos - pc;
+
+    float len = length(d);
+    float d2 = max(len * len, length(lb.bounds.size()) / 2.0f);
+    d2 = max(d2, numeric_limits<float>::min());
+
+    vec3 wi = len > 0.0f ? d / len : lb.axis;
+
+    float cos_theta_w = dot(wi, lb.axis);
+    if (lb.two_sided)
+    {
+        cos_theta_w = abs(cos_theta_w);
+    }
+    float sin_theta_w = sin_from_cos(cos_theta_w);
+
+    // Cone of directions subtended by the bounds' bounding sphere
+    float r2 = dot(lb.bounds.size(), lb.bounds.size()) / 4.0f;
+    float cos_theta_b = len * len < r2 ? -1.0f : sqrt(max(0.0f, 1.0f - r2 / (len * len)));
+    float sin_theta_b = sin_from_cos(cos_theta_b);
+
+    // Minimum angle between emitter normals and wi
+    float sin_theta_o = sin_from_cos(lb.cos_theta_o);
+    float cos_theta_x = cos_sub_clamped(sin_theta_w, cos_theta_w, sin_theta_o, lb.cos_theta_o);
+    float sin_theta_x = sin_sub_clamped(sin_theta_w, cos_theta_w, sin_theta_o, lb.cos_theta_o);
+    float cos_theta_p = cos_sub_clamped(sin_theta_x, cos_theta_x, sin_theta_b, cos_theta_b);
+
+    if (cos_theta_p <= lb.cos_theta_e)
+    {
+        return 0.0f;
+    }
+
+    float result = lb.phi * cos_theta_p / d2;
+
+    if (dot(n, n) > 0.0f)
+    {
+        float cos_theta_i = abs(dot(wi, n));
+        float sin_theta_i = sin_from_cos(cos_theta_i);
+        result *= cos_sub_clamped(sin_theta_i, cos_theta_i, sin_theta_b, cos_theta_b);
+    }
+
+    return max(result, 0.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Surface area orientation heuristic (SAOH) cost of a cluster
+//
+
+inline float light_bounds_cost(light_bounds const& lb, aabb const& parent, int axis)
+{
+    if (lb.phi == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float pi = constants::pi<float>();
+
+    float theta_o = std::acos(clamp(lb.cos_theta_o, -1.0f, 1.0f));
+    float theta_e = std::acos(clamp(lb.cos_theta_e, -1.0f, 1.0f));
+    float theta_w = std::min(theta_o + theta_e, pi);
+    float sin_theta_o = sin_from_cos(lb.cos_theta_o);
+
+    float m_omega = 2.0f * pi * (1.0f - lb.cos_theta_o)
+                  + pi / 2.0f * (2.0f * theta_w * sin_theta_o - std::cos(theta_o - 2.0f * theta_w)
+                               - 2.0f * theta_o * sin_theta_o + lb.cos_theta_o);
+
+    // Penalize splits along short axes
+    vec3 diag = parent.size();
+    float kr = diag[axis] > 0.0f ? max_element(diag) / diag[axis] : 0.0f;
+
+    return lb.phi * m_omega * kr * surface_area(lb.bounds);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Visitors for generic lights
+//
+
+struct light_bounds_visitor
+{
+    using return_type = bool;
+
+    light_bounds& lb;
+
+    template <typename X>
+    bool operator()(X const& ref) const
+    {
+        return get_light_bounds(ref, lb);
+    }
+};
+
+struct light_geometry_id_visitor
+{
+    using return_type = bool;
+
+    int& geom_id;
+    int& prim_id;
+
+    template <typename X>
+    bool operator()(X const& ref) const
+    {
+        return get_light_geometry_id(ref, geom_id, prim_id);
+    }
+};
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// Light bounds
+//
+
+template <typename L>
+inline bool get_light_bounds(L const& /* light */, light_bounds& /* lb */)
+{
+    return false;
+}
+
+template <typename T>
+inline bool get_light_bounds(point_light<T> const& light, light_bounds& lb)
+{
+    vec3 pos(light.position());
+
+    // Intensity (w/ attenuation) at unit distance, sample() scales by pi
+    vec3 intensity(light.intensity(vector<3, T>(pos + vec3(1.0f, 0.0f, 0.0f))));
+
+    lb.bounds = aabb(pos, pos);
+    lb.axis = vec3(0.0f, 0.0f, 1.0f);
+    lb.cos_theta_o = -1.0f;
+    lb.cos_theta_e = 0.0f;
+    lb.phi = 4.0f * constants::pi<float>() * constants::pi<float>() * rgb_to_luminance(intensity);
+    lb.two_sided = false;
+    return true;
+}
+
+template <typename T>
+inline bool get_light_bounds(spot_light<T> const& light, light_bounds& lb)
+{
+    vec3 pos(light.position());
+    vec3 dir = normalize(vec3(light.spot_direction()));
+
+    // Intensity on the axis at unit distance, sample() scales by pi
+    vec3 intensity(light.intensity(vector<3, T>(pos + dir)));
+
+    float cos_cutoff = std::cos(static_cast<float>(light.spot_cutoff()));
+
+    lb.bounds = aabb(pos, pos);
+    lb.axis = dir;
+    lb.cos_theta_o = 1.0f;
+    lb.cos_theta_e = cos_cutoff;
+    lb.phi = 2.0f * constants::pi<float>() * (1.0f - cos_cutoff) * constants::pi<float>() * rgb_to_luminance(intensity);
+    lb.two_sided = false;
+    return true;
+}
+
+template <typename T, typename Geometry>
+inline bool get_light_bounds(area_light<T, Geometry> const& light, light_bounds& lb)
+{
+    vec3 pos(light.position());
+    vec3 radiance(light.intensity(pos));
+
+    lb.bounds = aabb(get_bounds(light.geometry()));
+    lb.axis = vec3(0.0f, 0.0f, 1.0f);
+    lb.cos_theta_o = -1.0f;
+    lb.cos_theta_e = 0.0f;
+    lb.phi = constants::pi<float>() * static_cast<float>(area(light.geometry())) * rgb_to_luminance(radiance);
+    lb.two_sided = false;
+    return true;
+}
+
+template <typename T, typename P>
+inline bool get_light_bounds(area_light<T, basic_triangle<3, T, P>> const& light, light_bounds& lb)
+{
+    auto const& tri = light.geometry();
+
+    vec3 pos(light.position());
+    vec3 radiance(light.intensity(pos));
+    vec3 n(cross(tri.e1, tri.e2));
+
+    if (dot(n, n) == 0.0f)
+    {
+        // Degenerate, never sampled
+        n = vec3(0.0f, 0.0f, 1.0f);
+        radiance = vec3(0.0f);
+    }
+
+    // Kernels treat area lights as two-sided
+    lb.bounds = aabb(get_bounds(tri));
+    lb.axis = normalize(n);
+    lb.cos_theta_o = 1.0f;
+    lb.cos_theta_e = 0.0f;
+    lb.phi = 2.0f * constants::pi<float>() * static_cast<float>(area(tri)) * rgb_to_luminance(radiance);
+    lb.two_sided = true;
+    return true;
+}
+
+template <typename ...Ts>
+inline bool get_light_bounds(generic_light<Ts...> const& light, light_bounds& lb)
+{
+    return apply_visitor(detail::light_bounds_visitor{ lb }, light);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Light geometry ids
+//
+
+template <typename L>
+inline bool get_light_geometry_id(L const& /* light */, int& /* geom_id */, int& /* prim_id */)
+{
+    return false;
+}
+
+template <typename T, typename Geometry>
+inline bool get_light_geometry_id(area_light<T, Geometry> const& light, int& geom_id, int& prim_id)
+{
+    geom_id = static_cast<int>(light.geometry().geom_id);
+    prim_id = static_cast<int>(light.geometry().prim_id);
+    return true;
+}
+
+template <typename ...Ts>
+inline bool get_light_geometry_id(generic_light<Ts...> const& light, int& geom_id, int& prim_id)
+{
+    return apply_visitor(detail::light_geometry_id_visitor{ geom_id, prim_id }, light);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// light_bvh_ref members
+//
+
+inline light_bvh_ref::light_bvh_ref(
+        light_bvh_node const*    nodes,
+        light_bvh_light const*   lights,
+        int const*               infinite_lights,
+        light_bvh_emitter const* emitters,
+        int                      num_nodes,
+        int                      num_lights,
+        int                      num_infinite_lights,
+        int                      num_emitters
+        )
+    : nodes_(nodes)
+    , lights_(lights)
+    , infinite_lights_(infinite_lights)
+    , emitters_(emitters)
+    , num_nodes_(num_nodes)
+    , num_lights_(num_lights)
+    , num_infinite_lights_(num_infinite_lights)
+    , num_emitters_(num_emitters)
+{
+}
+
+VSNRAY_FUNC
+inline int light_bvh_ref::sample(int /* num_lights */, vec3 const& pos, vec3 const& n, float u, float& pmf) const
+{
+    float one_minus_epsilon = 1.0f - numeric_limits<float>::epsilon();
+
+    float p_inf = infinite_probability();
+
+    if (u < p_inf)
+    {
+        int i = static_cast<int>(u / p_inf * num_infinite_lights_);
+        i = i < num_infinite_lights_ ? i : num_infinite_lights_ - 1;
+
+        pmf = p_inf / num_infinite_lights_;
+        return infinite_lights_[i];
+    }
+
+    pmf = 0.0f;
+
+    if (num_nodes_ == 0)
+    {
+        return -1;
+    }
+
+    u = min((u - p_inf) / (1.0f - p_inf), one_minus_epsilon);
+
+    float p = 1.0f - p_inf;
+    int index = 0;
+
+    while (!nodes_[index].is_leaf)
+    {
+        int second = nodes_[index].index;
+
+        float c0 = detail::importance(nodes_[index + 1].bounds, pos, n);
+        float c1 = detail::importance(nodes_[second].bounds, pos, n);
+
+        if (c0 == 0.0f && c1 == 0.0f)
+        {
+            return -1;
+        }
+
+        float p0 = c0 / (c0 + c1);
+
+        if (u < p0)
+        {
+            u = min(u / p0, one_minus_epsilon);
+            p *= p0;
+            index = index + 1;
+        }
+        else
+        {
+            u = min((u - p0) / (1.0f - p0), one_minus_epsilon);
+            p *= 1.0f - p0;
+            index = second;
+        }
+    }
+
+    // Single light that does not contribute
+    if (index == 0 && detail::importance(nodes_[0].bounds, pos, n) == 0.0f)
+    {
+        return -1;
+    }
+
+    pmf = p;
+    return nodes_[index].index;
+}
+
+VSNRAY_FUNC
+inline float light_bvh_ref::emitter_pmf(int /* num_lights */, vec3 const& pos, vec3 const& n, int geom_id, int prim_id) const
+{
+    uint64_t key = (static_cast<uint64_t>(static_cast<unsigned>(geom_id)) << 32) | static_cast<unsigned>(prim_id);
+
+    // Binary search, emitters are sorted by key
+    int first = 0;
+    int last = num_emitters_;
+
+    while (first < last)
+    {
+        int mid = first + (last - first) / 2;
+
+        if (emitters_[mid].key < key)
+        {
+            first = mid + 1;
+        }
+        else
+        {
+            last = mid;
+        }
+    }
+
+    if (first == num_emitters_ || emitters_[first].key != key)
+    {
+        return 0.0f;
+    }
+
+    return pmf(pos, n, emitters_[first].light_id);
+}
+
+VSNRAY_FUNC
+inline float light_bvh_ref::pmf(vec3 const& pos, vec3 const& n, int light_id) const
+{
+    if (light_id < 0 || light_id >= num_lights_)
+    {
+        return 0.0f;
+    }
+
+    light_bvh_light const& light = lights_[light_id];
+
+    float p_inf = infinite_probability();
+
+    if (light.kind == light_bvh_light::Infinite)
+    {
+        return p_inf / num_infinite_lights_;
+    }
+
+    if (light.kind != light_bvh_light::InTree)
+    {
+        return 0.0f;
+    }
+
+    uint64_t bit_trail = light.bit_trail;
+
+    float p = 1.0f - p_inf;
+    int index = 0;
+
+    while (!nodes_[index].is_leaf)
+    {
+        int second = nodes_[index].index;
+
+        float c0 = detail::importance(nodes_[index + 1].bounds, pos, n);
+        float c1 = detail::importance(nodes_[second].bounds, pos, n);
+
+        if (c0 == 0.0f && c1 == 0.0f)
+        {
+            return 0.0f;
+        }
+
+        if (bit_trail & 1)
+        {
+            p *= c1 / (c0 + c1);
+            index = second;
+        }
+        else
+        {
+            p *= c0 / (c0 + c1);
+            index = index + 1;
+        }
+
+        bit_trail >>= 1;
+    }
+
+    if (index == 0 && detail::importance(nodes_[0].bounds, pos, n) == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    return p;
+}
+
+VSNRAY_FUNC
+inline float light_bvh_ref::infinite_probability() const
+{
+    int num_bvhs = num_nodes_ > 0 ? 1 : 0;
+
+    if (num_infinite_lights_ + num_bvhs == 0)
+    {
+        return 0.0f;
+    }
+
+    return static_cast<float>(num_infinite_lights_) / (num_infinite_lights_ + num_bvhs);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// light_bvh members
+//
+
+template <typename Lights>
+inline light_bvh::light_bvh(Lights begin, Lights end)
+{
+    build(begin, end);
+}
+
+template <typename Lights>
+inline void light_bvh::build(Lights begin, Lights end)
+{
+    int num_lights = static_cast<int>(end - begin);
+
+    nodes_.clear();
+    infinite_lights_.clear();
+    emitters_.clear();
+
+    lights_.resize(num_lights);
+
+    std::vector<build_light> bvh_lights;
+
+    for (int i = 0; i < num_lights; ++i)
+    {
+        lights_[i].bit_trail = 0;
+        lights_[i].kind = light_bvh_light::NotSampled;
+
+        light_bounds lb;
+
+        if (!get_light_bounds(begin[i], lb))
+        {
+            lights_[i].kind = light_bvh_light::Infinite;
+            infinite_lights_.push_back(i);
+        }
+        else if (lb.phi > 0.0f)
+        {
+            bvh_lights.push_back(build_light(i, lb));
+        }
+
+        int geom_id = 0;
+        int prim_id = 0;
+
+        if (get_light_geometry_id(begin[i], geom_id, prim_id))
+        {
+            uint64_t key = (static_cast<uint64_t>(static_cast<unsigned>(geom_id)) << 32) | static_cast<unsigned>(prim_id);
+            emitters_.push_back({ key, i });
+        }
+    }
+
+    std::sort(
+            emitters_.begin(),
+            emitters_.end(),
+            [](light_bvh_emitter const& a, light_bvh_emitter const& b)
+            {
+                return a.key < b.key;
+            }
+            );
+
+    if (!bvh_lights.empty())
+    {
+        build_recursive(bvh_lights, 0, static_cast<int>(bvh_lights.size()), 0, 0);
+    }
+}
+
+inline light_bvh_ref light_bvh::ref() const
+{
+    return light_bvh_ref(
+            nodes_.data(),
+            lights_.data(),
+            infinite_lights_.data(),
+            emitters_.data(),
+            static_cast<int>(nodes_.size()),
+            static_cast<int>(lights_.size()),
+            static_cast<int>(infinite_lights_.size()),
+            static_cast<int>(emitters_.size())
+            );
+}
+
+inline aligned_vector<light_bvh_node> const& light_bvh::nodes() const
+{
+    return nodes_;
+}
+
+inline size_t light_bvh::num_nodes() const
+{
+    return nodes_.size();
+}
+
+inline size_t light_bvh::num_lights() const
+{
+    return lights_.size();
+}
+
+inline light_bounds light_bvh::build_recursive(
+        std::vector<build_light>&   lights,
+        int                         first,
+        int                         last,
+        uint64_t                    bit_trail,
+        int                         depth
+        )
+{
+    if (last - first == 1)
+    {
+        int light_id = lights[first].first;
+
+        nodes_.push_back({ lights[first].second, light_id, 1 });
+
+        lights_[light_id].bit_trail = bit_trail;
+        lights_[light_id].kind = light_bvh_light::InTree;
+
+        return lights[first].second;
+    }
+
+    aabb bounds;
+    aabb centroid_bounds;
+    bounds.invalidate();
+    centroid_bounds.invalidate();
+
+    for (int i = first; i < last; ++i)
+    {
+        bounds.insert(lights[i].second.bounds);
+        centroid_bounds.insert(lights[i].second.bounds.center());
+    }
+
+
+    // Find the split with the lowest SAOH cost
+
+    enum { NumBuckets = 12 };
+
+    float min_cost = std::numeric_limits<float>::max();
+    int min_axis = -1;
+    int min_bucket = -1;
+
+    auto bucket_index = [&](light_bounds const& lb, int axis)
+    {
+        float cmin = centroid_bounds.min[axis];
+        float cmax = centroid_bounds.max[axis];
+        int b = static_cast<int>(NumBuckets * (lb.bounds.center()[axis] - cmin) / (cmax - cmin));
+        return std::max(0, std::min(b, NumBuckets - 1));
+    };
+
+    // Bit trails have 64 bits, fall back to median splits for deep trees
+    if (depth < 32)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (centroid_bounds.max[axis] == centroid_bounds.min[axis])
+            {
+                continue;
+            }
+
+            light_bounds buckets[NumBuckets] = {};
+
+            for (int i = first; i < last; ++i)
+            {
+                int b = bucket_index(lights[i].second, axis);
+                buckets[b] = detail::combine(buckets[b], lights[i].second);
+            }
+
+            for (int b = 0; b < NumBuckets - 1; ++b)
+            {
+                light_bounds below = {};
+                light_bounds above = {};
+
+                for (int i = 0; i <= b; ++i)
+                {
+                    below = detail::combine(below, buckets[i]);
+                }
+
+                for (int i = b + 1; i < NumBuckets; ++i)
+                {
+                    above = detail::combine(above, buckets[i]);
+                }
+
+                float cost = detail::light_bounds_cost(below, bounds, axis)
+                           + detail::light_bounds_cost(above, bounds, axis);
+
+                if (below.phi > 0.0f && above.phi > 0.0f && cost < min_cost)
+                {
+                    min_cost = cost;
+                    min_axis = axis;
+                    min_bucket = b;
+                }
+            }
+        }
+    }
+
+    int mid = first;
+
+    if (min_axis >= 0)
+    {
+        auto it = std::partition(
+                lights.begin() + first,
+                lights.begin() + last,
+                [&](build_light const& l)
+                {
+                    return bucket_index(l.second, min_axis) <= min_bucket;
+                }
+                );
+
+        mid = static_cast<int>(it - lights.begin());
+    }
+
+    if (mid == first || mid == last)
+    {
+        // Median split along the longest axis
+        int axis = static_cast<int>(max_index(centroid_bounds.size()));
+
+        mid = (first + last) / 2;
+
+        std::nth_element(
+                lights.begin() + first,
+                lights.begin() + mid,
+                lights.begin() + last,
+                [&](build_light const& a, build_light const& b)
+                {
+                    return a.second.bounds.center()[axis] < b.second.bounds.center()[axis];
+                }
+                );
+    }
+
+    int index = static_cast<int>(nodes_.size());
+    nodes_.push_back({});
+
+    light_bounds lb0 = build_recursive(lights, first, mid, bit_trail, depth + 1);
+
+    int second = static_cast<int>(nodes_.size());
+
+    light_bounds lb1 = build_recursive(lights, mid, last, bit_trail | (uint64_t(1) << depth), depth + 1);
+
+    light_bounds lb = detail::combine(lb0, lb1);
+
+    nodes_[index] = { lb, second, 0 };
+
+    return lb;
+}
+
+} // visionaray
@@ -0,0 +1,438 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Integer hashing
+//
+
+// lowbias32 (Chris Wellons)
+VSNRAY_FUNC
+inline unsigned mix_bits(unsigned x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+VSNRAY_FUNC
+inline unsigned hash_combine(unsigned seed, unsigned value)
+{
+    return mix_bits(seed ^ (value + 0x9E3779B9u + (seed << 6) + (seed >> 2)));
+}
+
+VSNRAY_FUNC
+inline unsigned hash_pixel(int x, int y)
+{
+    return hash_combine(mix_bits(static_cast<unsigned>(x)), static_cast<unsigned>(y));
+}
+
+VSNRAY_FUNC
+inline unsigned reverse_bits(unsigned x)
+{
+#ifdef __CUDA_ARCH__
+    return __brev(x);
+#else
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00FF00FFu) << 8) | ((x & 0xFF00FF00u) >> 8);
+    x = ((x & 0x0F0F0F0Fu) << 4) | ((x & 0xF0F0F0F0u) >> 4);
+    x = ((x & 0x33333333u) << 2) | ((x & 0xCCCCCCCCu) >> 2);
+    x = ((x & 0x55555555u) << 1) | ((x & 0xAAAAAAAAu) >> 1);
+    return x;
+#endif
+}
+
+// 32-bit fixed point to [0..1)
+VSNRAY_FUNC
+inline float fixed_point_to_float(unsigned x)
+{
+    return static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Owen scrambling (Burley 2020, Practical Hash-based Owen Scrambling)
+//
+
+VSNRAY_FUNC
+inline unsigned laine_karras_permutation(unsigned x, unsigned seed)
+{
+    x += seed;
+    x ^= x * 0x6C50B47Cu;
+    x ^= x * 0xB82F1E52u;
+    x ^= x * 0xC7AFE638u;
+    x ^= x * 0x8D22F6E6u;
+    return x;
+}
+
+VSNRAY_FUNC
+inline unsigned nested_uniform_scramble(unsigned x, unsigned seed)
+{
+    x = reverse_bits(x);
+    x = laine_karras_permutation(x, seed);
+    x = reverse_bits(x);
+    return x;
+}
+
+// First two dimensions of the Sobol sequence, 32-bit fixed point
+VSNRAY_FUNC
+inline unsigned sobol_2d(unsigned index, unsigned dim)
+{
+    if (dim == 0)
+    {
+        return reverse_bits(index);
+    }
+
+    unsigned result = 0;
+
+    for (unsigned v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1)
+    {
+        if (index & 1)
+        {
+            result ^= v;
+        }
+    }
+
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Radical inverse w/ Owen scrambling, each digit is shifted by a hash of
+// the digits before it
+//
+
+VSNRAY_FUNC
+inline float owen_scrambled_radical_inverse(unsigned index, unsigned base, unsigned seed)
+{
+    float inv_base = 1.0f / base;
+    float inv_base_m = 1.0f;
+    unsigned long long reversed_digits = 0;
+    unsigned digit_index = 0;
+
+    // Scramble enough digits to fill the mantissa, including the zeros
+    // past the last digit of index
+    while (1.0f - (base - 1) * inv_base_m < 1.0f)
+    {
+        unsigned next = index / base;
+        unsigned digit = index - next * base;
+
+        unsigned digit_hash = hash_combine(seed ^ static_cast<unsigned>(reversed_digits), digit_index);
+        digit = (digit + digit_hash) % base;
+
+        reversed_digits = reversed_digits * base + digit;
+        inv_base_m *= inv_base;
+        ++digit_index;
+        index = next;
+    }
+
+    float result = inv_base_m * static_cast<float>(reversed_digits);
+    return result < 0.99999994f ? result : 0.99999994f;
+}
+
+VSNRAY_FUNC
+inline unsigned halton_base(unsigned dim)
+{
+    unsigned const primes[] = {
+          2,   3,   5,   7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,
+         59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113, 127, 131,
+        137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+        227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311
+        };
+
+    return primes[dim % 64];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Blue-noise dithered rank-1 lattice
+//
+// Generating vector of an extensible base-2 lattice sequence for up to
+// 2^20 points (Cools, Kuo and Nuyens 2006, lattice-32001-1024-1048575).
+// Point i is frac(radical_inverse_2(i) * g), w/ the radical inverse in
+// 32-bit fixed point that is the low word of reverse_bits(i) * g.
+//
+
+VSNRAY_FUNC
+inline unsigned lattice_generator(unsigned dim)
+{
+    unsigned const g[] = {
+             1, 182667, 469891, 498753, 110745, 446247, 250185, 118627,
+        245333, 283199, 408519, 391023, 246327, 126539, 399185, 461527,
+        300343,  69681, 516695, 436179, 106383, 238523, 413283,  70841,
+         47719, 300129, 113029, 123925, 410745, 211325,  17489, 511893
+        };
+
+    return g[dim % 32];
+}
+
+// Toroidal 64x64 mask, ranks stored as 32-bit fixed point values
+struct blue_noise_mask
+{
+    enum { Size = 64 };
+
+    unsigned values[Size * Size];
+
+    blue_noise_mask();
+};
+
+// Void-and-cluster (Ulichney 1993)
+inline blue_noise_mask::blue_noise_mask()
+{
+    int const n = Size;
+    int const nn = Size * Size;
+
+    float const sigma = 1.5f;
+
+    // Gaussian energy filter over toroidal distances
+    std::vector<float> filter(nn);
+
+    for (int y = 0; y < n; ++y)
+    {
+        for (int x = 0; x < n; ++x)
+        {
+            float dx = static_cast<float>(x < n / 2 ? x : n - x);
+            float dy = static_cast<float>(y < n / 2 ? y : n - y);
+            filter[y * n + x] = std::exp(-(dx * dx + dy * dy) / (2.0f * sigma * sigma));
+        }
+    }
+
+    std::vector<char> bits(nn, 0);
+    std::vector<float> energy(nn, 0.0f);
+
+    auto set_bit = [&](std::vector<char>& b, std::vector<float>& e, int p, bool value)
+    {
+        b[p] = value ? 1 : 0;
+
+        float sign = value ? 1.0f : -1.0f;
+        int px = p % n;
+        int py = p / n;
+
+        for (int y = 0; y < n; ++y)
+        {
+            for (int x = 0; x < n; ++x)
+            {
+                e[y * n + x] += sign * filter[((y - py) & (n - 1)) * n + ((x - px) & (n - 1))];
+            }
+        }
+    };
+
+    // Tightest cluster: the one w/ the highest energy,
+    // largest void: the zero w/ the lowest energy
+    auto tightest_cluster = [&](std::vector<char> const& b, std::vector<float> const& e)
+    {
+        int result = -1;
+
+        for (int p = 0; p < nn; ++p)
+        {
+            if (b[p] && (result < 0 || e[p] > e[result]))
+            {
+                result = p;
+            }
+        }
+
+        return result;
+    };
+
+    auto largest_void = [&](std::vector<char> const& b, std::vector<float> const& e)
+    {
+        int result = -1;
+
+        for (int p = 0; p < nn; ++p)
+        {
+            if (!b[p] && (result < 0 || e[p] < e[result]))
+            {
+                result = p;
+            }
+        }
+
+        return result;
+    };
+
+
+    // Initial binary pattern: random points, relaxed by moving the
+    // tightest cluster to the largest void
+
+    std::minstd_rand rng(42);
+    std::uniform_int_distribution<int> dist(0, nn - 1);
+
+    int num_ones = 0;
+
+    while (num_ones < nn / 10)
+    {
+        int p = dist(rng);
+
+        if (!bits[p])
+        {
+            set_bit(bits, energy, p, true);
+            ++num_ones;
+        }
+    }
+
+    for (;;)
+    {
+        int cluster = tightest_cluster(bits, energy);
+        set_bit(bits, energy, cluster, false);
+
+        int v = largest_void(bits, energy);
+
+        set_bit(bits, energy, v, true);
+
+        if (v == cluster)
+        {
+            break;
+        }
+    }
+
+
+    std::vector<int> ranks(nn);
+
+    // Phase 1: remove the ones of the initial pattern
+    {
+        std::vector<char> b(bits);
+        std::vector<float> e(energy);
+
+        for (int rank = num_ones - 1; rank >= 0; --rank)
+        {
+            int cluster = tightest_cluster(b, e);
+            set_bit(b, e, cluster, false);
+            ranks[cluster] = rank;
+        }
+    }
+
+    // Phases 2 and 3: fill the largest voids. Once the ones are the
+    // majority, the zero w/ the highest energy of zeros (i.e. the
+    // tightest cluster of zeros) is also the one w/ the lowest energy
+    // of ones, so the same criterion applies
+    for (int rank = num_ones; rank < nn; ++rank)
+    {
+        int v = largest_void(bits, energy);
+        set_bit(bits, energy, v, true);
+        ranks[v] = rank;
+    }
+
+    // (rank + 0.5) / nn
+    for (int p = 0; p < nn; ++p)
+    {
+        values[p] = (static_cast<unsigned>(ranks[p]) << 20) + (1u << 19);
+    }
+}
+
+inline blue_noise_mask const& get_blue_noise_mask()
+{
+    static blue_noise_mask mask;
+    return mask;
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// sobol_generator members
+//
+
+template <typename T, typename X>
+VSNRAY_FUNC
+inline sobol_generator<T, X>::sobol_generator(int x, int y, int sample)
+    : seed_(detail::hash_pixel(x, y))
+    , sample_(static_cast<unsigned>(sample))
+    , dim_(0)
+{
+}
+
+template <typename T, typename X>
+VSNRAY_FUNC
+inline T sobol_generator<T, X>::next()
+{
+    unsigned pair = dim_ / 2;
+    unsigned dim = dim_ % 2;
+    ++dim_;
+
+    // Shuffle the sequence per pixel and pair of dimensions, then scramble
+    unsigned pair_seed = detail::hash_combine(seed_, pair);
+    unsigned index = detail::nested_uniform_scramble(sample_, pair_seed);
+
+    unsigned value = detail::sobol_2d(index, dim);
+    value = detail::nested_uniform_scramble(value, detail::hash_combine(pair_seed, dim + 1));
+
+    return T(detail::fixed_point_to_float(value));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// halton_generator members
+//
+
+template <typename T, typename X>
+VSNRAY_FUNC
+inline halton_generator<T, X>::halton_generator(int x, int y, int sample)
+    : seed_(detail::hash_pixel(x, y))
+    , sample_(static_cast<unsigned>(sample))
+    , dim_(0)
+{
+}
+
+template <typename T, typename X>
+VSNRAY_FUNC
+inline T halton_generator<T, X>::next()
+{
+    unsigned dim = dim_++;
+
+    return T(detail::owen_scrambled_radical_inverse(
+            sample_,
+            detail::halton_base(dim),
+            detail::hash_combine(seed_, dim)
+            ));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// blue_noise_generator members
+//
+
+template <typename T, typename X>
+inline blue_noise_generator<T, X>::blue_noise_generator(int x, int y, int sample)
+    : x_(x)
+    , y_(y)
+    , sample_(static_cast<unsigned>(sample))
+    , dim_(0)
+{
+}
+
+template <typename T, typename X>
+inline T blue_noise_generator<T, X>::next()
+{
+    using detail::blue_noise_mask;
+
+    auto const& mask = detail::get_blue_noise_mask();
+
+    unsigned dim = dim_++;
+
+    // Decorrelate the dimensions w/ offsets into the mask from the R2
+    // sequence (Roberts 2018)
+    int ox = static_cast<int>((dim * 3242174889u) >> 26);
+    int oy = static_cast<int>((dim * 2447445413u) >> 26);
+
+    int mx = (x_ + ox) & (blue_noise_mask::Size - 1);
+    int my = (y_ + oy) & (blue_noise_mask::Size - 1);
+
+    unsigned shift = mask.values[my * blue_noise_mask::Size + mx];
+
+    unsigned value = detail::reverse_bits(sample_) * detail::lattice_generator(dim) + shift;
+
+    return T(detail::fixed_point_to_float(value));
+}
+
+} // visionaray
@@ -65,6 +65,68 @@ inline auto unpack(emissive<FloatT> const& mat)
     return result;
 }
 
+// glass --------------------------------------------------
+
+template <size_t N>
+VSNRAY_FUNC
+inline glass<float_from_simd_width_t<N>> pack(array<glass<float>, N> const& mats)
+{
+    using T = float_from_simd_width_t<N>;
+
+    glass<T> result;
+
+    float* kt = reinterpret_cast<float*>(&result.kt());
+    float* kr = reinterpret_cast<float*>(&result.kr());
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        for (int j = 0; j < spectrum<float>::num_samples; ++j)
+        {
+            float* ct_j = reinterpret_cast<float*>(&result.ct()[j]);
+            float* cr_j = reinterpret_cast<float*>(&result.cr()[j]);
+            float* ior_j = reinterpret_cast<float*>(&result.ior()[j]);
+            ct_j[i] = mats[i].ct()[j];
+            cr_j[i] = mats[i].cr()[j];
+            ior_j[i] = mats[i].ior()[j];
+        }
+        kt[i] = mats[i].kt();
+        kr[i] = mats[i].kr();
+    }
+
+    return result;
+}
+
+template <
+    typename FloatT,
+    typename = typename std::enable_if<is_simd_vector<FloatT>::value>::type
+    >
+VSNRAY_FUNC
+inline auto unpack(glass<FloatT> const& mat)
+    -> array<glass<float>, num_elements<FloatT>::value>
+{
+    array<glass<float>, num_elements<FloatT>::value> result;
+
+    float const* kt = reinterpret_cast<float const*>(&mat.kt());
+    float const* kr = reinterpret_cast<float const*>(&mat.kr());
+
+    for (unsigned i = 0; i < num_elements<FloatT>::value; ++i)
+    {
+        for (int j = 0; j < spectrum<float>::num_samples; ++j)
+        {
+            float const* ct_j = reinterpret_cast<float const*>(&mat.ct()[j]);
+            float const* cr_j = reinterpret_cast<float const*>(&mat.cr()[j]);
+            float const* ior_j = reinterpret_cast<float const*>(&mat.ior()[j]);
+            result[i].ct()[j] = ct_j[i];
+            result[i].cr()[j] = cr_j[i];
+            result[i].ior()[j] = ior_j[i];
+        }
+        result[i].kt() = kt[i];
+        result[i].kr() = kr[i];
+    }
+
+    return result;
+}
+
 // matte --------------------------------------------------
 
 template <size_t N>
@@ -123,6 +185,60 @@ inline auto unpack(matte<FloatT> const& mat)
     return result;
 }
 
+// metal --------------------------------------------------
+
+template <size_t N>
+VSNRAY_FUNC
+inline metal<float_from_simd_width_t<N>> pack(array<metal<float>, N> const& mats)
+{
+    using T = float_from_simd_width_t<N>;
+
+    metal<T> result;
+
+    float* roughness = reinterpret_cast<float*>(&result.roughness());
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        for (int j = 0; j < spectrum<float>::num_samples; ++j)
+        {
+            float* ior_j = reinterpret_cast<float*>(&result.ior()[j]);
+            float* abs_j = reinterpret_cast<float*>(&result.absorption()[j]);
+            ior_j[i] = mats[i].ior()[j];
+            abs_j[i] = mats[i].absorption()[j];
+        }
+        roughness[i] = mats[i].roughness();
+    }
+
+    return result;
+}
+
+template <
+    typename FloatT,
+    typename = typename std::enable_if<is_simd_vector<FloatT>::value>::type
+    >
+VSNRAY_FUNC
+inline auto unpack(metal<FloatT> const& mat)
+    -> array<metal<float>, num_elements<FloatT>::value>
+{
+    array<metal<float>, num_elements<FloatT>::value> result;
+
+    float const* roughness = reinterpret_cast<float const*>(&mat.roughness());
+
+    for (unsigned i = 0; i < num_elements<FloatT>::value; ++i)
+    {
+        for (int j = 0; j < spectrum<float>::num_samples; ++j)
+        {
+            float const* ior_j = reinterpret_cast<float const*>(&mat.ior()[j]);
+            float const* abs_j = reinterpret_cast<float const*>(&mat.absorption()[j]);
+            result[i].ior()[j] = ior_j[i];
+            result[i].absorption()[j] = abs_j[i];
+        }
+        result[i].roughness() = roughness[i];
+    }
+
+    return result;
+}
+
 // mirror -------------------------------------------------
 
 template <size_t N>
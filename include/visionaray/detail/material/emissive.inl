@@ -10,6 +10,13 @@ namespace visionaray
 // Public interface
 //
 
+template <typename T>
+VSNRAY_FUNC
+inline spectrum<T> emissive<T>::albedo() const
+{
+    return ce_;
+}
+
 template <typename T>
 VSNRAY_FUNC
 inline spectrum<T> emissive<T>::ambient() const
@@ -8,6 +8,13 @@ namespace visionaray
 // Public interface
 //
 
+template <typename T>
+VSNRAY_FUNC
+inline spectrum<T> glass<T>::albedo() const
+{
+    return ct() * kt();
+}
+
 template <typename T>
 VSNRAY_FUNC
 inline spectrum<T> glass<T>::ambient() const
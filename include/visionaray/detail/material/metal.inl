@@ -8,6 +8,16 @@ namespace visionaray
 // Public interface
 //
 
+template <typename T>
+VSNRAY_FUNC
+inline spectrum<T> metal<T>::albedo() const
+{
+    // Fresnel reflectance at normal incidence
+    auto n = ior();
+    auto k = absorption();
+    return ((n - T(1.0)) * (n - T(1.0)) + k * k) / ((n + T(1.0)) * (n + T(1.0)) + k * k);
+}
+
 template <typename T>
 VSNRAY_FUNC
 inline spectrum<T> metal<T>::ambient() const
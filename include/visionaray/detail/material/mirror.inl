@@ -8,6 +8,13 @@ namespace visionaray
 // Public interface
 //
 
+template <typename T>
+VSNRAY_FUNC
+inline spectrum<T> mirror<T>::albedo() const
+{
+    return cr() * kr();
+}
+
 template <typename T>
 VSNRAY_FUNC
 inline spectrum<T> mirror<T>::ambient() const
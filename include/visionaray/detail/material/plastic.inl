@@ -10,6 +10,13 @@ namespace visionaray
 // Public interface
 //
 
+template <typename T>
+VSNRAY_FUNC
+inline spectrum<T> plastic<T>::albedo() const
+{
+    return cd() * kd();
+}
+
 template <typename T>
 VSNRAY_FUNC
 inline spectrum<T> plastic<T>::ambient() const
@@ -59,6 +59,15 @@ inline R matrix_camera::primary_ray(R /* */, T const& x, T const& y, T const& wi
     r.dir = normalize( d.xyz() / d.w - r.ori );
     r.tmin = T(0.0);
     r.tmax = numeric_limits<T>::max();
+
+    // Ray cone w/ the extent of one pixel: perspective projections have a
+    // spread angle, parallel projections (w' = w) a constant width
+    T pixel_size = T(2.0f / proj_(1, 1)) / height;
+    bool parallel = proj_(3, 3) != 0.0f;
+
+    r.cone_width = parallel ? pixel_size : T(0.0);
+    r.cone_spread = parallel ? T(0.0) : pixel_size;
+
     return r;
 }
 
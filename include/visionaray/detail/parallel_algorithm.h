@@ -0,0 +1,686 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_DETAIL_PARALLEL_ALGORITHM_H
+#define VSNRAY_DETAIL_PARALLEL_ALGORITHM_H 1
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../math/detail/math.h"
+#include "algorithm.h"
+#include "parallel_for.h"
+#include "range.h"
+#include "thread_pool.h"
+
+namespace visionaray
+{
+namespace paralgo
+{
+
+//-------------------------------------------------------------------------------------------------
+// Parallel algorithms running on visionaray::thread_pool
+//
+// All algorithms split the input sequence into contiguous blocks that are
+// distributed over the worker threads. The blocks only depend on the length
+// of the sequence, so results are deterministic and do not depend on the
+// number of threads, also for non-associative operators like floating point
+// addition in reduce and scan.
+//
+// There is no pool shared by the whole application, pass the pool of the
+// scheduler or loader so that the machine is not oversubscribed.
+//
+
+namespace detail
+{
+
+// Sequences shorter than that are processed as a single block
+static const size_t SerialThreshold = 4096;
+
+// The number of blocks only depends on the sequence length, not on the
+// size of the pool, so that results are the same for any pool
+static const size_t MaxBlocks = 256;
+
+inline size_t num_blocks(size_t n)
+{
+    return std::min(MaxBlocks, div_up(std::max(n, size_t(1)), SerialThreshold));
+}
+
+// Range of indices in [0,n) processed by block b out of num_blocks,
+// blocks are never empty as long as num_blocks <= n
+inline range1d<size_t> block_range(size_t b, size_t num_blocks, size_t n)
+{
+    size_t first = n * b / num_blocks;
+    size_t last  = n * (b + 1) / num_blocks;
+    return range1d<size_t>(first, last);
+}
+
+template <typename Func>
+void for_each_block(thread_pool& pool, size_t num_blocks, Func func)
+{
+    if (num_blocks <= 1 || pool.num_threads <= 1)
+    {
+        for (size_t b = 0; b < num_blocks; ++b)
+        {
+            func(b);
+        }
+    }
+    else
+    {
+        parallel_for(pool, range1d<size_t>(0, num_blocks), func);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Stable, parallel counting pass
+//
+// Distributes the indices [0,n) into num_buckets buckets. KEY_OF(i) returns
+// the bucket of index i, SCATTER(i, dst) is called once for each index with
+// its destination position. On exit, BUCKET_OFFSETS (size num_buckets)
+// contains the first position of each bucket.
+//
+// Returns false (and does not call SCATTER) if all indices map to the same
+// bucket and SKIP_UNIFORM is set.
+//
+
+template <typename KeyOf, typename Scatter>
+bool counting_pass(
+        thread_pool&         pool,
+        size_t               n,
+        size_t               num_buckets,
+        KeyOf                key_of,
+        Scatter              scatter,
+        std::vector<size_t>& bucket_offsets,
+        bool                 skip_uniform = false
+        )
+{
+    size_t nb = num_blocks(n);
+
+    // Per-block histograms, stored block after block
+    std::vector<size_t> hist(nb * num_buckets, 0);
+
+    for_each_block(pool, nb, [&](size_t b)
+        {
+            auto r = block_range(b, nb, n);
+            size_t* h = hist.data() + b * num_buckets;
+
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                ++h[key_of(i)];
+            }
+        });
+
+    bucket_offsets.resize(num_buckets);
+
+    // Exclusive scan over buckets (major) and blocks (minor),
+    // this ensures stability
+    size_t sum = 0;
+    for (size_t k = 0; k < num_buckets; ++k)
+    {
+        bucket_offsets[k] = sum;
+
+        size_t bucket_size = 0;
+        for (size_t b = 0; b < nb; ++b)
+        {
+            size_t count = hist[b * num_buckets + k];
+            hist[b * num_buckets + k] = sum;
+            sum += count;
+            bucket_size += count;
+        }
+
+        if (skip_uniform && bucket_size == n)
+        {
+            return false;
+        }
+    }
+
+    for_each_block(pool, nb, [&](size_t b)
+        {
+            auto r = block_range(b, nb, n);
+            size_t* offsets = hist.data() + b * num_buckets;
+
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                scatter(i, offsets[key_of(i)]++);
+            }
+        });
+
+    return true;
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// reduce
+//
+// Reduces the range [first,...,last) using the associative operator OP.
+// INIT is accumulated exactly once.
+//
+
+template <
+    typename InputIt,
+    typename T,
+    typename BinaryOp = std::plus<T>
+    >
+T reduce(thread_pool& pool, InputIt first, InputIt last, T init, BinaryOp op = BinaryOp())
+{
+    size_t n = static_cast<size_t>(std::distance(first, last));
+
+    if (n == 0)
+    {
+        return init;
+    }
+
+    size_t nb = detail::num_blocks(n);
+
+    std::vector<T> partial(nb);
+
+    detail::for_each_block(pool, nb, [&](size_t b)
+        {
+            auto r = detail::block_range(b, nb, n);
+
+            T sum = first[r.begin()];
+            for (size_t i = r.begin() + 1; i != r.end(); ++i)
+            {
+                sum = op(sum, first[i]);
+            }
+            partial[b] = sum;
+        });
+
+    T result = init;
+    for (size_t b = 0; b < nb; ++b)
+    {
+        result = op(result, partial[b]);
+    }
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// inclusive_scan / exclusive_scan
+//
+// Computes prefix sums of [first,...,last) using the associative operator
+// OP and writes them to the range beginning at OUT. OUT may be equal to
+// FIRST (in-place scan).
+//
+// Returns the end of the output sequence.
+//
+
+namespace detail
+{
+
+template <typename InputIt, typename OutputIt, typename T, typename BinaryOp>
+OutputIt scan_impl(
+        thread_pool& pool,
+        InputIt      first,
+        InputIt      last,
+        OutputIt     out,
+        T            init,
+        BinaryOp     op,
+        bool         inclusive
+        )
+{
+    size_t n = static_cast<size_t>(std::distance(first, last));
+
+    if (n == 0)
+    {
+        return out;
+    }
+
+    size_t nb = num_blocks(n);
+
+    // Pass 1: block sums
+    std::vector<T> block_sums(nb);
+
+    if (nb > 1)
+    {
+        for_each_block(pool, nb, [&](size_t b)
+            {
+                auto r = block_range(b, nb, n);
+
+                T sum = first[r.begin()];
+                for (size_t i = r.begin() + 1; i != r.end(); ++i)
+                {
+                    sum = op(sum, first[i]);
+                }
+                block_sums[b] = sum;
+            });
+    }
+
+    // Exclusive scan over block sums
+    std::vector<T> block_offsets(nb);
+    T sum = init;
+    for (size_t b = 0; b < nb; ++b)
+    {
+        block_offsets[b] = sum;
+        sum = op(sum, block_sums[b]);
+    }
+
+    // Pass 2: scan blocks, starting with the block offset
+    for_each_block(pool, nb, [&](size_t b)
+        {
+            auto r = block_range(b, nb, n);
+
+            T sum = block_offsets[b];
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                T val = first[i];
+                if (inclusive)
+                {
+                    sum = op(sum, val);
+                    out[i] = sum;
+                }
+                else
+                {
+                    out[i] = sum;
+                    sum = op(sum, val);
+                }
+            }
+        });
+
+    return out + n;
+}
+
+} // detail
+
+template <
+    typename InputIt,
+    typename OutputIt,
+    typename BinaryOp = std::plus<typename std::iterator_traits<InputIt>::value_type>
+    >
+OutputIt inclusive_scan(thread_pool& pool, InputIt first, InputIt last, OutputIt out, BinaryOp op = BinaryOp())
+{
+    using T = typename std::iterator_traits<InputIt>::value_type;
+
+    size_t n = static_cast<size_t>(std::distance(first, last));
+
+    if (n == 0)
+    {
+        return out;
+    }
+
+    // No neutral element for OP available, so the first element is
+    // used as init and scanned separately
+    T init = first[0];
+    out[0] = init;
+    return detail::scan_impl(pool, first + 1, last, out + 1, init, op, true);
+}
+
+template <
+    typename InputIt,
+    typename OutputIt,
+    typename T,
+    typename BinaryOp = std::plus<T>
+    >
+OutputIt exclusive_scan(thread_pool& pool, InputIt first, InputIt last, OutputIt out, T init, BinaryOp op = BinaryOp())
+{
+    return detail::scan_impl(pool, first, last, out, init, op, false);
+}
+
+//-------------------------------------------------------------------------------------------------
+// copy_if
+//
+// Stream compaction, copies all elements from [first,...,last) for which PRED
+// returns true to the range beginning at OUT. The relative order of the
+// elements is preserved. The output range must not overlap the input range.
+//
+// Returns the end of the output sequence.
+//
+
+template <typename InputIt, typename OutputIt, typename Pred>
+OutputIt copy_if(thread_pool& pool, InputIt first, InputIt last, OutputIt out, Pred pred)
+{
+    size_t n = static_cast<size_t>(std::distance(first, last));
+    size_t nb = detail::num_blocks(n);
+
+    std::vector<size_t> counts(nb + 1, 0);
+
+    detail::for_each_block(pool, nb, [&](size_t b)
+        {
+            auto r = detail::block_range(b, nb, n);
+
+            size_t count = 0;
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                count += pred(first[i]) ? 1 : 0;
+            }
+            counts[b + 1] = count;
+        });
+
+    for (size_t b = 1; b <= nb; ++b)
+    {
+        counts[b] += counts[b - 1];
+    }
+
+    detail::for_each_block(pool, nb, [&](size_t b)
+        {
+            auto r = detail::block_range(b, nb, n);
+
+            size_t dst = counts[b];
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                if (pred(first[i]))
+                {
+                    out[dst++] = first[i];
+                }
+            }
+        });
+
+    return out + counts[nb];
+}
+
+//-------------------------------------------------------------------------------------------------
+// partition
+//
+// Reorders [first,...,last) so that all elements for which PRED returns true
+// precede those for which PRED returns false. The partition is stable.
+//
+// Returns an iterator to the first element of the second group.
+//
+
+template <typename RandIt, typename Pred>
+RandIt partition(thread_pool& pool, RandIt first, RandIt last, Pred pred)
+{
+    using T = typename std::iterator_traits<RandIt>::value_type;
+
+    size_t n = static_cast<size_t>(std::distance(first, last));
+
+    if (n == 0)
+    {
+        return first;
+    }
+
+    size_t nb = detail::num_blocks(n);
+
+    std::vector<T> temp(n);
+    std::vector<unsigned char> flags(n);
+
+    detail::for_each_block(pool, nb, [&](size_t b)
+        {
+            auto r = detail::block_range(b, nb, n);
+
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                flags[i] = pred(first[i]) ? 0 : 1;
+            }
+        });
+
+    std::vector<size_t> offsets;
+    detail::counting_pass(
+            pool,
+            n,
+            2,
+            [&](size_t i) { return flags[i]; },
+            [&](size_t i, size_t dst) { temp[dst] = std::move(first[i]); },
+            offsets
+            );
+
+    detail::for_each_block(pool, nb, [&](size_t b)
+        {
+            auto r = detail::block_range(b, nb, n);
+
+            for (size_t i = r.begin(); i != r.end(); ++i)
+            {
+                first[i] = std::move(temp[i]);
+            }
+        });
+
+    return first + offsets[1];
+}
+
+//-------------------------------------------------------------------------------------------------
+// counting_sort
+//
+// Sorts items based on integer keys in [0..k). Parallel and stable variant
+// of algo::counting_sort().
+//
+// [in] FIRST
+//      Start of the input sequence.
+//
+// [in] LAST
+//      End of the input sequence.
+//
+// [out] OUT
+//      Start of the output sequence.
+//
+// [in,out] COUNTS
+//      Modifiable counts sequence of size k. On exit, contains the
+//      position of the first element of each key in the output sequence.
+//
+// [in] KEY
+//      Sort key function object.
+//
+// Complexity: O(n + k * num_blocks)
+//
+
+template <
+    typename InputIt,
+    typename OutputIt,
+    typename Counts,
+    typename Key = algo::detail::trivial_key
+    >
+void counting_sort(
+        thread_pool& pool,
+        InputIt      first,
+        InputIt      last,
+        OutputIt     out,
+        Counts&      counts,
+        Key          key = Key()
+        )
+{
+    static_assert(
+            std::is_integral<decltype(key(*first))>::value,
+            "counting_sort requires integral key type"
+            );
+
+    size_t n = static_cast<size_t>(std::distance(first, last));
+    size_t k = static_cast<size_t>(std::distance(std::begin(counts), std::end(counts)));
+
+    std::vector<size_t> offsets;
+    detail::counting_pass(
+            pool,
+            n,
+            k,
+            [&](size_t i) { return static_cast<size_t>(key(first[i])); },
+            [&](size_t i, size_t dst) { out[dst] = first[i]; },
+            offsets
+            );
+
+    auto it = std::begin(counts);
+    for (size_t m = 0; m < k; ++m, ++it)
+    {
+        using C = typename std::decay<decltype(*it)>::type;
+        *it = static_cast<C>(offsets[m]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// radix_sort
+//
+// Stable LSD radix sort for unsigned integer keys (32 or 64 bit), eight
+// bits per pass. Passes where all keys share the same digit are skipped.
+//
+// radix_sort(pool, keys_first, keys_last)
+//      Sorts the keys in [keys_first,...,keys_last).
+//
+// radix_sort(pool, keys_first, keys_last, values_first)
+//      Sorts the keys and reorders the payload beginning at
+//      values_first accordingly.
+//
+// radix_sort_by(pool, first, last, key, num_bits)
+//      Sorts arbitrary elements by an unsigned integer key returned from
+//      KEY. Only the lower NUM_BITS of the key are considered.
+//
+
+namespace detail
+{
+
+template <typename T, typename KeyOf, typename Move>
+void radix_sort_impl(
+        thread_pool& pool,
+        size_t       n,
+        unsigned     num_bits,
+        T*           /* key type */,
+        KeyOf        key_of,  // key_of(i, pingpong)
+        Move         move     // move(src, dst, pingpong)
+        )
+{
+    static_assert(std::is_unsigned<T>::value, "radix_sort requires unsigned keys");
+
+    static const unsigned RadixBits = 8;
+    static const size_t   NumBuckets = size_t(1) << RadixBits;
+
+    std::vector<size_t> offsets;
+
+    // Current buffer: 0 - input, 1 - temp
+    unsigned pingpong = 0;
+
+    for (unsigned shift = 0; shift < num_bits; shift += RadixBits)
+    {
+        bool swapped = counting_pass(
+                pool,
+                n,
+                NumBuckets,
+                [&](size_t i) { return static_cast<size_t>((key_of(i, pingpong) >> shift) & (NumBuckets - 1)); },
+                [&](size_t i, size_t dst) { move(i, dst, pingpong); },
+                offsets,
+                true
+                );
+
+        if (swapped)
+        {
+            pingpong = 1 - pingpong;
+        }
+    }
+
+    if (pingpong == 1)
+    {
+        // Result is in temp buffer, copy back
+        size_t nb = num_blocks(n);
+
+        for_each_block(pool, nb, [&](size_t b)
+            {
+                auto r = block_range(b, nb, n);
+
+                for (size_t i = r.begin(); i != r.end(); ++i)
+                {
+                    move(i, i, 1);
+                }
+            });
+    }
+}
+
+} // detail
+
+template <typename RandIt>
+void radix_sort(thread_pool& pool, RandIt keys_first, RandIt keys_last)
+{
+    using K = typename std::iterator_traits<RandIt>::value_type;
+
+    size_t n = static_cast<size_t>(std::distance(keys_first, keys_last));
+
+    std::vector<K> temp(n);
+
+    detail::radix_sort_impl(
+            pool,
+            n,
+            sizeof(K) * 8,
+            (K*)nullptr,
+            [&](size_t i, unsigned pp) { return pp == 0 ? keys_first[i] : temp[i]; },
+            [&](size_t src, size_t dst, unsigned pp)
+            {
+                if (pp == 0)
+                {
+                    temp[dst] = keys_first[src];
+                }
+                else
+                {
+                    keys_first[dst] = temp[src];
+                }
+            }
+            );
+}
+
+template <typename RandIt1, typename RandIt2>
+void radix_sort(thread_pool& pool, RandIt1 keys_first, RandIt1 keys_last, RandIt2 values_first)
+{
+    using K = typename std::iterator_traits<RandIt1>::value_type;
+    using V = typename std::iterator_traits<RandIt2>::value_type;
+
+    size_t n = static_cast<size_t>(std::distance(keys_first, keys_last));
+
+    std::vector<K> temp_keys(n);
+    std::vector<V> temp_values(n);
+
+    detail::radix_sort_impl(
+            pool,
+            n,
+            sizeof(K) * 8,
+            (K*)nullptr,
+            [&](size_t i, unsigned pp) { return pp == 0 ? keys_first[i] : temp_keys[i]; },
+            [&](size_t src, size_t dst, unsigned pp)
+            {
+                if (pp == 0)
+                {
+                    temp_keys[dst] = keys_first[src];
+                    temp_values[dst] = std::move(values_first[src]);
+                }
+                else
+                {
+                    keys_first[dst] = temp_keys[src];
+                    values_first[dst] = std::move(temp_values[src]);
+                }
+            }
+            );
+}
+
+template <typename RandIt, typename Key>
+void radix_sort_by(
+        thread_pool& pool,
+        RandIt       first,
+        RandIt       last,
+        Key          key,
+        unsigned     num_bits = sizeof(decltype(key(*first))) * 8
+        )
+{
+    using K = typename std::decay<decltype(key(*first))>::type;
+    using T = typename std::iterator_traits<RandIt>::value_type;
+
+    size_t n = static_cast<size_t>(std::distance(first, last));
+
+    std::vector<T> temp(n);
+
+    detail::radix_sort_impl(
+            pool,
+            n,
+            num_bits,
+            (K*)nullptr,
+            [&](size_t i, unsigned pp) { return pp == 0 ? key(first[i]) : key(temp[i]); },
+            [&](size_t src, size_t dst, unsigned pp)
+            {
+                if (pp == 0)
+                {
+                    temp[dst] = std::move(first[src]);
+                }
+                else
+                {
+                    first[dst] = std::move(temp[src]);
+                }
+            }
+            );
+}
+} // paralgo
+} // visionaray
+
+#endif // VSNRAY_DETAIL_PARALLEL_ALGORITHM_H
@@ -1,17 +1,25 @@
 // This file is distributed under the MIT license.
 // See the LICENSE file for details.
 
+#include <algorithm>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 
 #include "../math/simd/type_traits.h"
 #include "../math/vector.h"
+#include "../array.h"
 #include "../get_area.h"
 #include "../get_surface.h"
 #include "../result_record.h"
+#include "../sampled_spectrum.h"
 #include "../sampling.h"
 #include "../spectrum.h"
+#include "../surface.h"
 #include "../surface_interaction.h"
 #include "../traverse.h"
+#include "scratch_arena.h"
+#include "wavefront.h"
 
 #ifdef __CUDACC__
 #define CLOCK clock
@@ -21,6 +29,93 @@
 
 namespace visionaray
 {
+
+//-------------------------------------------------------------------------------------------------
+// Environment lights with a sample() function (environment_light) take
+// part in next event estimation when they are importance sampled
+//
+
+namespace detail
+{
+
+template <typename Light>
+VSNRAY_FUNC
+inline bool environment_importance_sampled(Light const& light, std::true_type /* has sample() */)
+{
+    return light.importance_sampled();
+}
+
+template <typename Light>
+VSNRAY_FUNC
+inline bool environment_importance_sampled(Light const& /* light */, std::false_type /* has sample() */)
+{
+    return false;
+}
+
+template <typename Light, typename V, typename Generator>
+VSNRAY_FUNC
+inline auto sample_environment(Light const& light, V const& reference_point, Generator& gen, std::true_type)
+    -> decltype(light.sample(reference_point, gen))
+{
+    return light.sample(reference_point, gen);
+}
+
+template <typename Light, typename V, typename Generator>
+VSNRAY_FUNC
+inline light_sample<typename V::value_type> sample_environment(
+        Light const&        /* light */,
+        V const&            /* reference_point */,
+        Generator&          /* gen */,
+        std::false_type
+        )
+{
+    return zero_light_sample<typename V::value_type>();
+}
+
+template <typename Light, typename V>
+VSNRAY_FUNC
+inline typename V::value_type environment_pdf(Light const& light, V const& dir, std::true_type)
+{
+    return light.pdf(dir);
+}
+
+template <typename Light, typename V>
+VSNRAY_FUNC
+inline typename V::value_type environment_pdf(Light const& /* light */, V const& /* dir */, std::false_type)
+{
+    return typename V::value_type(0.0);
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// Next event estimation
+//
+// Contribution of a light sample w/o throughput and visibility, shared by
+// the kernels for area, point and environment lights. SHADED is the result
+// of shade() for the light direction, LIGHT_PDF the pdf of the sample
+// (including the probability to pick the light) and BRDF_PDF the pdf to
+// sample the same direction w/ the BRDF, for multiple importance sampling
+//
+
+namespace detail
+{
+
+template <typename C, typename S>
+VSNRAY_FUNC
+inline C light_sample_contribution(C const& shaded, S const& ldotn, S const& light_pdf, S const& brdf_pdf)
+{
+    // TODO: inv_pi / dot(n, wi) factor only valid for plastic and matte
+    C src = shaded * constants::inv_pi<S>() / ldotn;
+
+    S mis_weight = power_heuristic(light_pdf, brdf_pdf);
+
+    return mis_weight * src * (ldotn / light_pdf);
+}
+
+} // detail
+
 namespace pathtracing
 {
 
@@ -30,17 +125,20 @@ VSNRAY_FUNC inline vector<4, T> over(vector<4, T> const& a, vector<4, T> const&
     return a + (T(1.0) - a.w) * b;
 }
 
-template <typename Params>
+template <typename Params, typename Transport = rgb_transport>
 struct kernel
 {
 
     Params params;
 
+    template <typename R>
+    using result_type = result_record<typename R::scalar_type, visionaray::detail::aov_channels<Params>::value>;
+
     float heat_map_scale = 1.0f;
     bool perf_debug = false;
 
     template <typename Intersector, typename R, typename Generator>
-    VSNRAY_FUNC result_record<typename R::scalar_type> operator()(
+    VSNRAY_FUNC result_type<R> operator()(
             Intersector& isect,
             R ray,
             Generator& gen
@@ -51,15 +149,26 @@ struct kernel
         using S = typename R::scalar_type;
         using I = simd::int_type_t<S>;
         using V = vector<3, S>;
-        using C = spectrum<S>;
+        using P = typename Transport::template path_state<S>;
+        using C = typename P::color_type;
 
         simd::mask_type_t<S> active_rays = true;
         simd::mask_type_t<S> last_specular = true;
 
-        C intensity(0.0);
-        C throughput(1.0);
+        P path(gen);
 
-        result_record<S> result;
+        C intensity(S(0.0));
+        C throughput(S(1.0));
+
+        // Position, normal and BRDF pdf of the last surface interaction
+        V prev_pos(0.0);
+        V prev_n(0.0);
+        S prev_brdf_pdf(0.0);
+
+        using env_has_sample = detail::has_sample<decltype(params.amb_light), Generator>;
+        bool sample_env = detail::environment_importance_sampled(params.amb_light, env_has_sample{});
+
+        result_type<R> result;
         result.color = vector<4, S>(params.background.intensity(ray.dir), S(1.0));
 
         for (unsigned bounce = 0; bounce < params.num_bounces; ++bounce)
@@ -70,10 +179,18 @@ struct kernel
             auto exited = active_rays & !hit_rec.hit;
 
             auto env = params.amb_light.intensity(ray.dir);
+            S env_pdf = sample_env ? detail::environment_pdf(params.amb_light, ray.dir, env_has_sample{}) : S(0.0);
+
+            S env_weight = select(
+                bounce > 0 && sample_env && !last_specular,
+                power_heuristic(prev_brdf_pdf, env_pdf),
+                S(1.0)
+                );
+
             intensity += select(
                 exited,
-                from_rgb(env) * throughput,
-                C(0.0)
+                env_weight * path.illuminant(from_rgb(env)) * throughput,
+                C(S(0.0))
                 );
 
 
@@ -100,7 +217,12 @@ struct kernel
 
             hit_rec.isect_pos = ray.ori + ray.dir * hit_rec.t;
 
-            auto surf = get_surface(hit_rec, params);
+            auto surf = get_surface(hit_rec, params, ray);
+
+            if (bounce == 0)
+            {
+                visionaray::detail::record_aovs(result, hit_rec, surf, ray, params);
+            }
 
             S brdf_pdf(0.0);
 
@@ -124,23 +246,32 @@ struct kernel
                 auto ldotln = abs(dot(-L, n));
                 auto solid_angle = (ldotln * A) / (ld * ld);
 
+                auto pmf = light_selection_pmf(
+                        params.lights.begin,
+                        params.lights.end,
+                        params.light_selector,
+                        prev_pos,
+                        prev_n,
+                        hit_rec
+                        );
+
                 light_pdf = select(
                     inter == surface_interaction::Emission,
-                    S(1.0) / solid_angle,
+                    pmf / solid_angle,
                     S(0.0)
                     );
             }
 
             S mis_weight = select(
                 bounce > 0 && num_lights > 0 && !last_specular,
-                power_heuristic(brdf_pdf, light_pdf / static_cast<float>(num_lights)),
+                power_heuristic(prev_brdf_pdf, light_pdf),
                 S(1.0)
                 );
 
             intensity += select(
                 active_rays && inter == surface_interaction::Emission,
-                mis_weight * throughput * src,
-                C(0.0)
+                mis_weight * throughput * path.illuminant(src),
+                C(S(0.0))
                 );
 
             active_rays &= inter != surface_interaction::Emission;
@@ -156,7 +287,9 @@ struct kernel
                 auto ls = sample_random_light(
                         params.lights.begin,
                         params.lights.end,
+                        params.light_selector,
                         hit_rec.isect_pos,
+                        n,
                         gen
                         );
 
@@ -174,34 +307,71 @@ struct kernel
                     hit_rec.isect_pos + L * S(params.epsilon), // origin
                     L,                                         // direction
                     S(params.epsilon),                         // tmin
-                    ld - S(params.epsilon)                     // tmax
+                    ld - S(2.0f * params.epsilon)              // tmax, stop short of the light
                     );
 
                 auto lhr = any_hit(shadow_ray, params.prims.begin, params.prims.end, isect);
 
                 auto brdf_pdf = surf.pdf(view_dir, L, inter);
-                auto prob = max_element(throughput.samples());
-                brdf_pdf *= prob;
 
-                // TODO: inv_pi / dot(n, wi) factor only valid for plastic and matte
-                auto src = surf.shade(view_dir, L, ls.intensity) * constants::inv_pi<S>() / ldotn;
+                // ls.pdf includes the probability to pick the light
+                auto contribution = detail::light_sample_contribution(
+                        path.shade(surf, view_dir, L, ls.intensity),
+                        ldotn,
+                        ls.pdf,
+                        brdf_pdf
+                        );
+
+                intensity += select(
+                    active_rays && !lhr.hit && ldotn > S(0.0) && ldotln > S(0.0) && ls.pdf > S(0.0),
+                    throughput * contribution,
+                    C(S(0.0))
+                    );
+            }
+
+            if (sample_env)
+            {
+                auto ls = detail::sample_environment(params.amb_light, hit_rec.isect_pos, gen, env_has_sample{});
+
+                auto L = ls.dir;
+                auto ldotn = dot(L, n);
+
+                R shadow_ray(
+                    hit_rec.isect_pos + L * S(params.epsilon), // origin
+                    L,                                         // direction
+                    S(params.epsilon),                         // tmin
+                    ls.dist                                    // tmax
+                    );
+
+                auto lhr = any_hit(shadow_ray, params.prims.begin, params.prims.end, isect);
 
-                S mis_weight = power_heuristic(ls.pdf / static_cast<float>(num_lights), brdf_pdf);
+                auto brdf_pdf = surf.pdf(view_dir, L, inter);
+
+                auto contribution = detail::light_sample_contribution(
+                        path.shade(surf, view_dir, L, ls.intensity),
+                        ldotn,
+                        ls.pdf,
+                        brdf_pdf
+                        );
 
                 intensity += select(
-                    active_rays && !lhr.hit && ldotn > S(0.0) && ldotln > S(0.0),
-                    mis_weight * throughput * src * (ldotn / ls.pdf) * S(static_cast<float>(num_lights)),
-                    C(0.0)
+                    active_rays && !lhr.hit && ldotn > S(0.0) && ls.pdf > S(0.0),
+                    throughput * contribution,
+                    C(S(0.0))
                     );
             }
 
-            throughput *= src * (dot(n, refl_dir) / brdf_pdf);
-            throughput = select(zero_pdf, C(0.0), throughput);
+            prev_pos = hit_rec.isect_pos;
+            prev_n = n;
+            prev_brdf_pdf = brdf_pdf;
+
+            throughput *= path.reflectance(src) * (dot(n, refl_dir) / brdf_pdf);
+            throughput = select(zero_pdf, C(S(0.0)), throughput);
 
             if (bounce >= 2)
             {
                 // Russian roulette
-                auto prob = max_element(throughput.samples());
+                auto prob = path.max_value(throughput);
                 auto terminate = gen.next() > prob;
                 active_rays &= !terminate;
                 throughput /= prob;
@@ -212,6 +382,9 @@ struct kernel
                 }
             }
 
+            // The cone keeps its spread, surface curvature and roughness are ignored
+            propagate_cone(ray, hit_rec.t);
+
             ray.ori = hit_rec.isect_pos + refl_dir * S(params.epsilon);
             ray.dir = refl_dir;
 
@@ -220,7 +393,7 @@ struct kernel
 
         }
 
-        result.color = select( result.hit, to_rgba(intensity), result.color );
+        result.color = select( result.hit, vector<4, S>(path.to_rgb(intensity), S(1.0)), result.color );
 
         if (perf_debug)
         {
@@ -233,7 +406,7 @@ struct kernel
     }
 
     template <typename R, typename Generator>
-    VSNRAY_FUNC result_record<typename R::scalar_type> operator()(
+    VSNRAY_FUNC result_type<R> operator()(
             R ray,
             Generator& gen
             ) const
@@ -243,5 +416,492 @@ struct kernel
     }
 };
 
+
+
+//-------------------------------------------------------------------------------------------------
+// Wavefront path tracer
+//
+// Computes the same estimate as kernel, but does not trace each packet
+// to completion. The scheduler passes all primary rays of a tile (see
+// kernel_is_wavefront in basic_sched.inl), and each bounce is split into
+// stages that operate on queues of path indices:
+//
+//  - extend:  closest hit for all active paths
+//  - shade:   emission, BRDF sampling, Russian roulette; light and
+//             environment samples are appended to the shadow queue
+//  - connect: any hit for the shadow queue, unoccluded samples are added
+//             to their path
+//
+// Paths that terminate are dropped from the queue (stream compaction),
+// so that packets are refilled with active paths and only the last
+// packet of a queue is partially populated. CPU only, packets must be
+// SIMD ray types. perf_debug is not supported.
+//
+
+template <typename Params>
+struct wavefront_kernel
+{
+    using is_wavefront = void;
+
+    Params params;
+
+    struct path_state
+    {
+        basic_ray<float> ray;
+        spectrum<float>  throughput;
+        spectrum<float>  intensity;
+        float            last_specular;
+        vec3             prev_pos;
+        vec3             prev_n;
+        float            prev_brdf_pdf;
+    };
+
+    struct shadow_sample
+    {
+        basic_ray<float> ray;
+        spectrum<float>  contribution;
+        unsigned         path;
+    };
+
+    template <typename Intersector, typename R, typename Generator>
+    void trace(
+            Intersector&                isect,
+            R                           /* packet type */,
+            basic_ray<float> const*     rays,
+            Generator*                  gens,
+            result_record<float>*       results,
+            unsigned                    count
+            ) const
+    {
+        using S = typename R::scalar_type;
+        using I = simd::int_type_t<S>;
+        using V = vector<3, S>;
+        using C = spectrum<S>;
+
+        static_assert(simd::is_simd_vector<S>::value, "wavefront_kernel requires SIMD ray packets");
+
+        using HR = decltype(closest_hit(R{}, params.prims.begin, params.prims.end, isect));
+        using hit_record_type = typename decltype(simd::unpack(std::declval<HR>()))::value_type;
+        using surface_type = decltype(get_surface(std::declval<hit_record_type>(), params));
+
+        unsigned const N = simd::num_elements<S>::value;
+
+        using env_has_sample = detail::has_sample<decltype(params.amb_light), detail::simd_generator_t<Generator, S>>;
+        bool sample_env = detail::environment_importance_sampled(params.amb_light, env_has_sample{});
+
+        scratch_arena& arena = this_thread_scratch_arena();
+
+        // Up to one light and one environment sample per path
+        path_state* paths = arena.allocate<path_state>(count);
+        shadow_sample* shadow = arena.allocate<shadow_sample>(sample_env ? 2 * count : count);
+        unsigned* queue = arena.allocate<unsigned>(count);
+        unsigned* next = arena.allocate<unsigned>(count);
+        hit_record_type* hits = arena.allocate<hit_record_type>(count);
+        surface_type* surfs = arena.allocate<surface_type>(count);
+        uint64_t* keys = arena.allocate<uint64_t>(count);
+
+
+        // Generate: primary rays are supplied by the scheduler
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            paths[i].ray = rays[i];
+            paths[i].throughput = spectrum<float>(1.0f);
+            paths[i].intensity = spectrum<float>(0.0f);
+            paths[i].last_specular = 1.0f;
+            paths[i].prev_pos = vec3(0.0f);
+            paths[i].prev_n = vec3(0.0f);
+            paths[i].prev_brdf_pdf = 0.0f;
+
+            results[i] = result_record<float>();
+            results[i].color = vector<4, float>(params.background.intensity(rays[i].dir), 1.0f);
+
+            queue[i] = i;
+        }
+
+        unsigned queue_size = count;
+
+        auto num_lights = params.lights.end - params.lights.begin;
+
+        for (unsigned bounce = 0; bounce < params.num_bounces && queue_size > 0; ++bounce)
+        {
+            // Extend: closest hit, then fetch the surface and material of
+            // each hit and compute its sort key
+
+            for (unsigned first = 0; first < queue_size; first += N)
+            {
+                unsigned num_lanes = std::min(N, queue_size - first);
+                unsigned const* q = queue + first;
+
+                R ray = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return paths[q[i]].ray; });
+
+                auto hit_rec = closest_hit(ray, params.prims.begin, params.prims.end, isect);
+                hit_rec.isect_pos = ray.ori + ray.dir * hit_rec.t;
+
+                auto hrs = simd::unpack(hit_rec);
+
+                for (unsigned i = 0; i < num_lanes; ++i)
+                {
+                    hits[q[i]] = hrs[i];
+                    keys[q[i]] = 0;
+
+                    if (hrs[i].hit)
+                    {
+                        int mat_id = hrs[i].inst_id < 0 ? hrs[i].geom_id : hrs[i].inst_id;
+                        surfs[q[i]] = get_surface(hrs[i], params, paths[q[i]].ray);
+                        keys[q[i]] = detail::material_sort_key(params.materials[mat_id], mat_id);
+                    }
+                }
+            }
+
+
+            // Sort the queue so that packets are coherent in material
+
+            std::sort(queue, queue + queue_size, [&](unsigned a, unsigned b)
+            {
+                return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+            });
+
+
+            // Shade
+
+            unsigned next_size = 0;
+            unsigned shadow_size = 0;
+
+            for (unsigned first = 0; first < queue_size; first += N)
+            {
+                unsigned num_lanes = std::min(N, queue_size - first);
+                unsigned const* q = queue + first;
+
+                R ray = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return paths[q[i]].ray; });
+                C throughput = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return paths[q[i]].throughput; });
+                C intensity = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return paths[q[i]].intensity; });
+                auto last_specular = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return paths[q[i]].last_specular; }) != S(0.0);
+                auto gen = detail::gather_generators<S>(num_lanes, [&](unsigned i) { return gens[q[i]]; });
+                auto hit = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return hits[q[i]].hit ? 1.0f : 0.0f; }) != S(0.0);
+                V isect_pos = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return hits[q[i]].isect_pos; });
+                S hit_t = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return hits[q[i]].t; });
+                V prev_pos = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return paths[q[i]].prev_pos; });
+                V prev_n = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return paths[q[i]].prev_n; });
+                S prev_brdf_pdf = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return paths[q[i]].prev_brdf_pdf; });
+
+                auto valid = detail::valid_lanes<S>(num_lanes);
+                auto active_rays = valid & hit;
+
+                // Handle rays that just exited
+                auto exited = valid & !hit;
+
+                auto env = params.amb_light.intensity(ray.dir);
+                S env_pdf = sample_env ? detail::environment_pdf(params.amb_light, ray.dir, env_has_sample{}) : S(0.0);
+
+                S env_weight = select(
+                    bounce > 0 && sample_env && !last_specular,
+                    power_heuristic(prev_brdf_pdf, env_pdf),
+                    S(1.0)
+                    );
+
+                intensity += select(
+                    exited,
+                    env_weight * from_rgb(env) * throughput,
+                    C(0.0)
+                    );
+
+                // Special handling for first bounce
+                if (bounce == 0)
+                {
+                    for (unsigned i = 0; i < num_lanes; ++i)
+                    {
+                        results[q[i]].hit = hits[q[i]].hit;
+                        results[q[i]].depth = hits[q[i]].t;
+                    }
+                }
+
+                auto shade = [&](auto& surf)
+                {
+                    V refl_dir(0.0);
+                    V view_dir = -ray.dir;
+
+                    S brdf_pdf(0.0);
+
+                    I inter = 0;
+                    auto src = surf.sample(view_dir, refl_dir, brdf_pdf, inter, gen);
+
+                    auto zero_pdf = brdf_pdf <= S(0.0);
+
+                    S light_pdf(0.0);
+
+                    if (num_lights > 0 && any(inter == surface_interaction::Emission))
+                    {
+                        S A = detail::gather_lanes<S>(num_lanes, [&](unsigned i)
+                        {
+                            return hits[q[i]].hit ? get_area(params.prims.begin, hits[q[i]]) : 1.0f;
+                        });
+                        auto ld = length(isect_pos - ray.ori);
+                        auto L = normalize(isect_pos - ray.ori);
+                        auto n = surf.geometric_normal;
+                        auto ldotln = abs(dot(-L, n));
+                        auto solid_angle = (ldotln * A) / (ld * ld);
+
+                        S pmf = detail::gather_lanes<S>(num_lanes, [&](unsigned i)
+                        {
+                            return hits[q[i]].hit ? light_selection_pmf(
+                                    params.lights.begin,
+                                    params.lights.end,
+                                    params.light_selector,
+                                    paths[q[i]].prev_pos,
+                                    paths[q[i]].prev_n,
+                                    hits[q[i]]
+                                    ) : 0.0f;
+                        });
+
+                        light_pdf = select(
+                            inter == surface_interaction::Emission,
+                            pmf / solid_angle,
+                            S(0.0)
+                            );
+                    }
+
+                    S mis_weight = select(
+                        bounce > 0 && num_lights > 0 && !last_specular,
+                        power_heuristic(prev_brdf_pdf, light_pdf),
+                        S(1.0)
+                        );
+
+                    intensity += select(
+                        active_rays && inter == surface_interaction::Emission,
+                        mis_weight * throughput * src,
+                        C(0.0)
+                        );
+
+                    active_rays &= inter != surface_interaction::Emission;
+                    active_rays &= !zero_pdf;
+
+                    auto n = surf.shading_normal;
+#if 1
+                    n = faceforward( n, view_dir, surf.geometric_normal );
+#endif
+
+                    if (num_lights > 0)
+                    {
+                        auto ls = sample_random_light(
+                                params.lights.begin,
+                                params.lights.end,
+                                params.light_selector,
+                                isect_pos,
+                                n,
+                                gen
+                                );
+
+                        auto ld = ls.dist;
+                        auto L = normalize(ls.dir);
+
+                        auto ln = select(ls.delta_light, -L, ls.normal);
+#if 1
+                        ln = faceforward( ln, -L, ln );
+#endif
+                        auto ldotn = dot(L, n);
+                        auto ldotln = abs(dot(-L, ln));
+
+                        R shadow_ray(
+                            isect_pos + L * S(params.epsilon),  // origin
+                            L,                                  // direction
+                            S(params.epsilon),                  // tmin
+                            ld - S(2.0f * params.epsilon)       // tmax, stop short of the light
+                            );
+
+                        auto brdf_pdf = surf.pdf(view_dir, L, inter);
+
+                        // ls.pdf includes the probability to pick the light
+                        C contribution = throughput * detail::light_sample_contribution(
+                                surf.shade(view_dir, L, ls.intensity),
+                                ldotn,
+                                ls.pdf,
+                                brdf_pdf
+                                );
+
+                        // Defer the occlusion test to the connect stage
+                        auto connect = detail::unpack_mask(active_rays && ldotn > S(0.0) && ldotln > S(0.0) && ls.pdf > S(0.0));
+                        auto shadow_rays = detail::unpack_lanes(shadow_ray);
+                        auto contributions = detail::unpack_lanes(contribution);
+
+                        for (unsigned i = 0; i < num_lanes; ++i)
+                        {
+                            if (connect[i])
+                            {
+                                shadow[shadow_size++] = { shadow_rays[i], contributions[i], q[i] };
+                            }
+                        }
+                    }
+
+                    if (sample_env)
+                    {
+                        auto ls = detail::sample_environment(params.amb_light, isect_pos, gen, env_has_sample{});
+
+                        auto L = ls.dir;
+                        auto ldotn = dot(L, n);
+
+                        R shadow_ray(
+                            isect_pos + L * S(params.epsilon),  // origin
+                            L,                                  // direction
+                            S(params.epsilon),                  // tmin
+                            ls.dist                             // tmax
+                            );
+
+                        auto brdf_pdf = surf.pdf(view_dir, L, inter);
+
+                        C contribution = throughput * detail::light_sample_contribution(
+                                surf.shade(view_dir, L, ls.intensity),
+                                ldotn,
+                                ls.pdf,
+                                brdf_pdf
+                                );
+
+                        auto connect = detail::unpack_mask(active_rays && ldotn > S(0.0) && ls.pdf > S(0.0));
+                        auto shadow_rays = detail::unpack_lanes(shadow_ray);
+                        auto contributions = detail::unpack_lanes(contribution);
+
+                        for (unsigned i = 0; i < num_lanes; ++i)
+                        {
+                            if (connect[i])
+                            {
+                                shadow[shadow_size++] = { shadow_rays[i], contributions[i], q[i] };
+                            }
+                        }
+                    }
+
+                    prev_pos = isect_pos;
+                    prev_n = n;
+                    prev_brdf_pdf = brdf_pdf;
+
+                    throughput *= src * (dot(n, refl_dir) / brdf_pdf);
+                    throughput = select(zero_pdf, C(0.0), throughput);
+
+                    if (bounce >= 2)
+                    {
+                        // Russian roulette
+                        auto prob = max_element(throughput.samples());
+                        auto terminate = gen.next() > prob;
+                        active_rays &= !terminate;
+                        throughput /= prob;
+                    }
+
+                    propagate_cone(ray, hit_t);
+
+                    ray.ori = isect_pos + refl_dir * S(params.epsilon);
+                    ray.dir = refl_dir;
+
+                    last_specular = inter == surface_interaction::SpecularReflection ||
+                                    inter == surface_interaction::SpecularTransmission;
+                };
+
+                // Shade packets where all lanes share a material with the SIMD
+                // type of that material instead of dispatching per lane
+                auto shade_coherent = [&](auto const& mat)
+                {
+                    using M = typename std::decay<decltype(mat)>::type;
+
+                    auto gn = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return surfs[q[i]].geometric_normal; });
+                    auto sn = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return surfs[q[i]].shading_normal; });
+                    auto tc = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return surfs[q[i]].tex_color; });
+
+                    surface<decltype(gn), decltype(tc), M> surf{ gn, sn, tc, mat };
+                    shade(surf);
+                };
+
+                if (any(active_rays))
+                {
+                    // The queue is sorted, so all lanes share a material
+                    // if the first and the last lane do
+                    bool coherent = keys[q[0]] != 0 && keys[q[0]] == keys[q[num_lanes - 1]];
+
+                    if (!coherent || !detail::with_simd_material<S>(surfs[q[0]].material, shade_coherent))
+                    {
+                        // Misses come first in the sorted queue, they and the
+                        // padding lanes replicate the last lane, which is a hit
+                        array<surface_type, simd::num_elements<S>::value> lanes;
+
+                        for (unsigned i = 0; i < N; ++i)
+                        {
+                            lanes[i] = surfs[q[i < num_lanes && keys[q[i]] != 0 ? i : num_lanes - 1]];
+                        }
+
+                        auto surf = simd::pack(lanes);
+                        shade(surf);
+                    }
+                }
+
+
+                // Write back, active paths are compacted into the next queue
+
+                detail::scatter_lanes(num_lanes, ray, [&](unsigned i, basic_ray<float> const& r) { paths[q[i]].ray = r; });
+                detail::scatter_lanes(num_lanes, throughput, [&](unsigned i, spectrum<float> const& t) { paths[q[i]].throughput = t; });
+                detail::scatter_lanes(num_lanes, intensity, [&](unsigned i, spectrum<float> const& c) { paths[q[i]].intensity = c; });
+                detail::scatter_lanes(num_lanes, select(last_specular, S(1.0), S(0.0)), [&](unsigned i, float f) { paths[q[i]].last_specular = f; });
+                detail::scatter_lanes(num_lanes, prev_pos, [&](unsigned i, vec3 const& p) { paths[q[i]].prev_pos = p; });
+                detail::scatter_lanes(num_lanes, prev_n, [&](unsigned i, vec3 const& n) { paths[q[i]].prev_n = n; });
+                detail::scatter_lanes(num_lanes, prev_brdf_pdf, [&](unsigned i, float p) { paths[q[i]].prev_brdf_pdf = p; });
+                detail::scatter_generators(num_lanes, gen, [&](unsigned i, Generator const& g) { gens[q[i]] = g; });
+
+                auto active = detail::unpack_mask(active_rays);
+
+                for (unsigned i = 0; i < num_lanes; ++i)
+                {
+                    if (active[i])
+                    {
+                        next[next_size++] = q[i];
+                    }
+                }
+            }
+
+
+            // Connect
+
+            for (unsigned first = 0; first < shadow_size; first += N)
+            {
+                unsigned num_lanes = std::min(N, shadow_size - first);
+                shadow_sample const* ss = shadow + first;
+
+                R shadow_ray = detail::gather_lanes<S>(num_lanes, [&](unsigned i) { return ss[i].ray; });
+
+                auto lhr = any_hit(shadow_ray, params.prims.begin, params.prims.end, isect);
+
+                auto occluded = detail::unpack_mask(lhr.hit);
+
+                for (unsigned i = 0; i < num_lanes; ++i)
+                {
+                    if (!occluded[i])
+                    {
+                        paths[ss[i].path].intensity += ss[i].contribution;
+                    }
+                }
+            }
+
+            std::swap(queue, next);
+            queue_size = next_size;
+        }
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            if (results[i].hit)
+            {
+                results[i].color = to_rgba(paths[i].intensity);
+            }
+        }
+    }
+
+    template <typename R, typename Generator>
+    void trace(
+            R                           /* packet type */,
+            basic_ray<float> const*     rays,
+            Generator*                  gens,
+            result_record<float>*       results,
+            unsigned                    count
+            ) const
+    {
+        default_intersector ignore;
+        trace(ignore, R{}, rays, gens, results, count);
+    }
+};
+
 } // pathtracing
 } // visionaray
@@ -116,6 +116,11 @@ inline R pinhole_camera::primary_ray(R /* */, T const& x, T const& y, T const& w
     r.dir = normalize(vector<3, T>(U) * u + vector<3, T>(V) * v + vector<3, T>(W));
     r.tmin = T(0.0);
     r.tmax = numeric_limits<T>::max();
+
+    // Ray cone w/ the spread angle of one pixel (small angle approximation)
+    r.cone_width = T(0.0);
+    r.cone_spread = T(2.0f * length(V) * (image_region_.max.y - image_region_.min.y)) / height;
+
     return r;
 }
 
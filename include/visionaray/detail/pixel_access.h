@@ -13,7 +13,9 @@
 
 #include <type_traits>
 
+#include <visionaray/math/simd/half.h>
 #include <visionaray/math/simd/type_traits.h>
+#include <visionaray/math/half.h>
 #include <visionaray/math/vector.h>
 #include <visionaray/array.h>
 #include <visionaray/packet_traits.h>
@@ -474,6 +476,61 @@ inline void store(
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+// Store SIMD rgba color to RGBA16F render target, convert all lanes at once
+// OutputColor must be vector<4, half>
+//
+
+template <
+    typename OutputColor,
+    typename FloatT,
+    typename = typename std::enable_if<simd::is_simd_vector<FloatT>::value>::type
+    >
+VSNRAY_FUNC
+inline void store(
+        pixel_format_constant<PF_RGBA16F>   /* dst format */,
+        pixel_format_constant<PF_RGBA32F>   /* src format */,
+        int                                 x,
+        int                                 y,
+        int                                 width,
+        int                                 height,
+        vector<4, FloatT> const&            color,
+        OutputColor*                        buffer
+        )
+{
+    using int_array = simd::aligned_array_t<simd::int_type_t<FloatT>>;
+
+    int_array r;
+    int_array g;
+    int_array b;
+    int_array a;
+
+    store(r, simd::float_to_half(color.x));
+    store(g, simd::float_to_half(color.y));
+    store(b, simd::float_to_half(color.z));
+    store(a, simd::float_to_half(color.w));
+
+    const int w = packet_size<FloatT>::w;
+    const int h = packet_size<FloatT>::h;
+
+    for (int row = 0; row < h; ++row)
+    {
+        for (int col = 0; col < w; ++col)
+        {
+            if (x + col < width && y + row < height)
+            {
+                int idx = row * w + col;
+                OutputColor& dst = buffer[(y + row) * width + (x + col)];
+                dst.x.value = static_cast<uint16_t>(r[idx]);
+                dst.y.value = static_cast<uint16_t>(g[idx]);
+                dst.z.value = static_cast<uint16_t>(b[idx]);
+                dst.w.value = static_cast<uint16_t>(a[idx]);
+            }
+        }
+    }
+}
+
+
 //-------------------------------------------------------------------------------------------------
 // Store single SIMD channel to 32-bit FP buffer, no conversion
 // TODO: consolidate various overloads
@@ -650,6 +707,33 @@ inline void get(
     color = simd::pack(out);
 }
 
+//-------------------------------------------------------------------------------------------------
+// Get SoA rgba color from RGBA16F color buffer, convert to float
+//
+
+template <pixel_format DF>
+VSNRAY_FUNC
+inline void get(
+        pixel_format_constant<DF>           /* dst format */,
+        pixel_format_constant<PF_RGBA16F>   /* src format */,
+        int                                 x,
+        int                                 y,
+        int                                 width,
+        int                                 height,
+        vector<4, simd::float4>&            color,
+        vector<4, half> const*              buffer
+        )
+{
+    array<vector<4, float>, 4> out;
+
+    out[0] = ( x      < width &&  y      < height) ? vec4(buffer[ y      * width +  x     ]) : vec4(0.0f);
+    out[1] = ((x + 1) < width &&  y      < height) ? vec4(buffer[ y      * width + (x + 1)]) : vec4(0.0f);
+    out[2] = ( x      < width && (y + 1) < height) ? vec4(buffer[(y + 1) * width +  x     ]) : vec4(0.0f);
+    out[3] = ((x + 1) < width && (y + 1) < height) ? vec4(buffer[(y + 1) * width + (x + 1)]) : vec4(0.0f);
+
+    color = simd::pack(out);
+}
+
 //-------------------------------------------------------------------------------------------------
 // Get SoA simd vector from scalar buffer
 //
@@ -0,0 +1,213 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <type_traits>
+
+#include "../math/simd/gather.h"
+#include "../math/simd/type_traits.h"
+#include "spd/d65.h"
+#include "spd/smits.h"
+#include "color_conversion.h"
+
+namespace visionaray
+{
+
+template <size_t N, typename T>
+constexpr float sampled_wavelengths<N, T>::lambda_min;
+
+template <size_t N, typename T>
+constexpr float sampled_wavelengths<N, T>::lambda_max;
+
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Evaluate a scalar SPD for each SIMD lane
+//
+
+template <typename SPD>
+VSNRAY_FUNC
+inline float sample_spd_lanes(SPD const& spd, float lambda)
+{
+    return spd(lambda);
+}
+
+template <
+    typename SPD,
+    typename F,
+    typename = typename std::enable_if<simd::is_simd_vector<F>::value>::type
+    >
+inline F sample_spd_lanes(SPD const& spd, F const& lambda)
+{
+    simd::aligned_array_t<F> arr;
+    store(arr, lambda);
+
+    for (int i = 0; i < simd::num_elements<F>::value; ++i)
+    {
+        arr[i] = spd(arr[i]);
+    }
+
+    return F(arr);
+}
+
+// Smits basis spectra and D65 in one pass over the lanes
+
+VSNRAY_FUNC
+inline void sample_upsampling_basis(float lambda, float (&result)[8])
+{
+    for (int b = 0; b < 7; ++b)
+    {
+        result[b] = spd_smits(static_cast<spd_smits::basis>(b))(lambda);
+    }
+
+    result[7] = spd_d65{}(lambda);
+}
+
+template <
+    typename F,
+    typename = typename std::enable_if<simd::is_simd_vector<F>::value>::type
+    >
+inline void sample_upsampling_basis(F const& lambda, F (&result)[8])
+{
+    using I = simd::int_type_t<F>;
+
+    // Interpolate the Smits bins w/ gather, see spd_smits::operator()
+    F x = clamp((lambda - F(397.0f)) / F(34.0f), F(0.0f), F(9.0f));
+    I i = min(convert_to_int(x), I(8));
+    F s = x - convert_to_float(i);
+
+    for (int b = 0; b < 7; ++b)
+    {
+        float const* t = spd_smits::table(static_cast<spd_smits::basis>(b));
+        result[b] = lerp_r(gather(t, i), gather(t, i + I(1)), s);
+    }
+
+    result[7] = sample_spd_lanes(spd_d65{}, lambda);
+}
+
+// Integral of cie_y() over [380,720]
+static const float CieYIntegral = 106.93597f;
+
+// Y of spd_d65 (normalized to P(560) = 1) w/ the above normalization
+static const float D65Luminance = 0.988848f;
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// Hero wavelength sampling
+//
+
+template <size_t N, typename T>
+VSNRAY_FUNC
+inline sampled_wavelengths<N, T> sample_wavelengths(T const& u)
+{
+    float lmin = sampled_wavelengths<N, T>::lambda_min;
+    float lmax = sampled_wavelengths<N, T>::lambda_max;
+
+    sampled_wavelengths<N, T> result;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        T x = u + T(static_cast<float>(i) / N);
+        x = select(x >= T(1.0), x - T(1.0), x);
+        result.lambda[i] = T(lmin) + x * T(lmax - lmin);
+    }
+
+    return result;
+}
+
+template <size_t N, typename T, typename SPD>
+VSNRAY_FUNC
+inline vector<N, T> sample_spd(SPD const& spd, sampled_wavelengths<N, T> const& wl)
+{
+    vector<N, T> result;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        result[i] = detail::sample_spd_lanes(spd, wl.lambda[i]);
+    }
+
+    return result;
+}
+
+template <size_t N, typename T>
+VSNRAY_FUNC
+inline vector<3, T> to_xyz(vector<N, T> const& values, sampled_wavelengths<N, T> const& wl)
+{
+    vector<3, T> xyz(0.0);
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        xyz.x += values[i] * cie_x(wl.lambda[i]);
+        xyz.y += values[i] * cie_y(wl.lambda[i]);
+        xyz.z += values[i] * cie_z(wl.lambda[i]);
+    }
+
+    return xyz / (T(N) * sampled_wavelengths<N, T>::pdf() * T(detail::CieYIntegral));
+}
+
+template <size_t N, typename T>
+VSNRAY_FUNC
+inline vector<3, T> to_rgb(vector<N, T> const& values, sampled_wavelengths<N, T> const& wl)
+{
+    return xyz_to_rgb(to_xyz(values, wl));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// rgb_upsampler members
+//
+
+template <size_t N, typename T>
+VSNRAY_FUNC
+inline rgb_upsampler<N, T>::rgb_upsampler(sampled_wavelengths<N, T> const& wl)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        T values[8];
+        detail::sample_upsampling_basis(wl.lambda[i], values);
+
+        for (int b = 0; b < 7; ++b)
+        {
+            basis_[b][i] = values[b];
+        }
+
+        d65_[i] = values[7] / T(detail::D65Luminance);
+    }
+}
+
+template <size_t N, typename T>
+VSNRAY_FUNC
+inline vector<N, T> rgb_upsampler<N, T>::reflectance(vector<3, T> const& rgb) const
+{
+    // Smits: white times the smallest component, the complementary color of
+    // the smallest component and the primary of the largest component make
+    // up the rest
+    T mn = min(rgb.x, min(rgb.y, rgb.z));
+    T mx = max(rgb.x, max(rgb.y, rgb.z));
+    T mid = rgb.x + rgb.y + rgb.z - mn - mx;
+
+    auto complementary = select(
+            rgb.x == mn,
+            basis_[spd_smits::Cyan],
+            select(rgb.y == mn, basis_[spd_smits::Magenta], basis_[spd_smits::Yellow])
+            );
+
+    auto primary = select(
+            rgb.x == mx,
+            basis_[spd_smits::Red],
+            select(rgb.y == mx, basis_[spd_smits::Green], basis_[spd_smits::Blue])
+            );
+
+    return basis_[spd_smits::White] * mn + complementary * (mid - mn) + primary * (mx - mid);
+}
+
+template <size_t N, typename T>
+VSNRAY_FUNC
+inline vector<N, T> rgb_upsampler<N, T>::illuminant(vector<3, T> const& rgb) const
+{
+    return reflectance(rgb) * d65_;
+}
+
+} // visionaray
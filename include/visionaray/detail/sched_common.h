@@ -17,6 +17,7 @@
 #include "../pixel_sampler_types.h"
 #include "../render_target.h"
 #include "../result_record.h"
+#include "color_conversion.h"
 #include "macros.h"
 #include "pixel_access.h"
 #include "tags.h"
@@ -306,6 +307,12 @@ inline void sample_pixel_impl(
 
         auto result = invoke_kernel(kernel, r, gen, x, y);
 
+        // AOVs are taken from the first sample
+        if (s == 0)
+        {
+            store_aovs(result, rt_ref, x, y, width, height);
+        }
+
         // Arbitrarily assign the depth of _one_ pixel that recorded a hit
         if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
         {
@@ -390,6 +397,8 @@ inline void sample_pixel_impl(
 
     auto result = invoke_kernel(kernel, r, gen, x, y);
 
+    store_aovs(result, rt_ref, x, y, width, height);
+
     // Arbitrarily assign the depth of _one_ pixel that recorded a hit
     if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
     {
@@ -417,6 +426,7 @@ inline void sample_pixel_impl(
 template <
     typename K,
     typename T,
+    typename B,
     typename R,
     typename Generator,
     typename RenderTargetRef,
@@ -425,16 +435,16 @@ template <
     >
 VSNRAY_FUNC
 inline void sample_pixel_impl(
-        K                                           kernel,
-        pixel_sampler::basic_jittered_blend_type<T> ps,
-        R                                           /* */,
-        Generator&                                  gen,
-        RenderTargetRef                             rt_ref,
-        int                                         x,
-        int                                         y,
-        int                                         width,
-        int                                         height,
-        Camera const&                               cam
+        K                                              kernel,
+        pixel_sampler::basic_jittered_blend_type<T, B> ps,
+        R                                              /* */,
+        Generator&                                     gen,
+        RenderTargetRef                                rt_ref,
+        int                                            x,
+        int                                            y,
+        int                                            width,
+        int                                            height,
+        Camera const&                                  cam
         )
 {
     using RR = decltype(invoke_kernel(kernel, R{}, gen, x, y));
@@ -457,6 +467,12 @@ inline void sample_pixel_impl(
 
         auto result = invoke_kernel(kernel, r, gen, x, y);
 
+        // AOVs are taken from the first sample
+        if (s == 0)
+        {
+            store_aovs(result, rt_ref, x, y, width, height);
+        }
+
         // Arbitrarily assign the depth of _one_ pixel that recorded a hit
         if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
         {
@@ -489,7 +505,7 @@ inline void sample_pixel_impl(
     AT blended_color;
 
     pixel_access::get(
-            pixel_format_constant<RenderTargetRef::accum_format>{},
+            pixel_format_constant<PF_RGBA32F>{},
             pixel_format_constant<RenderTargetRef::accum_format>{},
             x,
             y,
@@ -501,14 +517,203 @@ inline void sample_pixel_impl(
 
     pixel_access::store(
             pixel_format_constant<RenderTargetRef::color_format>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            blended_color,
+            rt_ref.color()
+            );
+
+    if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
+    {
+        pixel_access::store(
+                pixel_format_constant<RenderTargetRef::depth_format>{},
+                pixel_format_constant<PF_DEPTH32F>{},
+                x,
+                y,
+                width,
+                height,
+                rr.depth,
+                rt_ref.depth()
+                );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Render targets allocate their moments buffer when a scheduler first uses
+// them w/ an adaptive pixel sampler
+//
+
+template <typename PxSamplerT, typename RenderTarget>
+inline void require_moments(PxSamplerT const& /* */, RenderTarget& /* */)
+{
+}
+
+template <typename T, typename B, typename RenderTarget>
+inline void require_moments(pixel_sampler::basic_adaptive_blend_type<T, B> const& /* */, RenderTarget& rt)
+{
+    rt.require_moments();
+}
+
+//-------------------------------------------------------------------------------------------------
+// Adaptive sampling: average the pixel's samples w/ its own sample count and
+// update the moments of its luminance
+//
+
+template <typename RenderTargetRef, typename S>
+VSNRAY_FUNC
+inline void accumulate_adaptive(
+        RenderTargetRef         rt_ref,
+        int                     x,
+        int                     y,
+        int                     width,
+        int                     height,
+        vector<4, S> const&     color
+        )
+{
+    vector<4, S> moments;
+
+    pixel_access::get(
+            pixel_format_constant<PF_RGBA32F>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            moments,
+            rt_ref.moments()
+            );
+
+    S n = moments.z + S(1.0);
+    S lum = rgb_to_luminance(color.xyz());
+    S mean = moments.x + (lum - moments.x) / n;
+    S mean2 = moments.y + (lum * lum - moments.y) / n;
+
+    // Relative standard error of the mean w/ the unbiased sample variance
+    S var = max(mean2 - mean * mean, S(0.0)) * n / max(n - S(1.0), S(1.0));
+    S err = sqrt(var / n) / (mean + S(1e-3));
+
+    pixel_access::store(
+            pixel_format_constant<PF_RGBA32F>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            vector<4, S>(mean, mean2, n, err),
+            rt_ref.moments()
+            );
+
+    pixel_access::blend(
+            pixel_format_constant<RenderTargetRef::accum_format>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            color,
+            rt_ref.accum(),
+            S(1.0) / n,
+            S(1.0) - S(1.0) / n
+            );
+
+    vector<4, S> blended_color;
+
+    pixel_access::get(
+            pixel_format_constant<PF_RGBA32F>{},
             pixel_format_constant<RenderTargetRef::accum_format>{},
             x,
             y,
             width,
             height,
             blended_color,
+            rt_ref.accum()
+            );
+
+    pixel_access::store(
+            pixel_format_constant<RenderTargetRef::color_format>{},
+            pixel_format_constant<PF_RGBA32F>{},
+            x,
+            y,
+            width,
+            height,
+            blended_color,
             rt_ref.color()
             );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Jittered pixel sampler w/ adaptive sample counts, see accumulate_adaptive()
+//
+
+template <
+    typename K,
+    typename T,
+    typename B,
+    typename R,
+    typename Generator,
+    typename RenderTargetRef,
+    typename Camera,
+    typename = typename std::enable_if<RenderTargetRef::accum_format != PF_UNSPECIFIED>::type
+    >
+VSNRAY_FUNC
+inline void sample_pixel_impl(
+        K                                              kernel,
+        pixel_sampler::basic_adaptive_blend_type<T, B> ps,
+        R                                              /* */,
+        Generator&                                     gen,
+        RenderTargetRef                                rt_ref,
+        int                                            x,
+        int                                            y,
+        int                                            width,
+        int                                            height,
+        Camera const&                                  cam
+        )
+{
+    using RR = decltype(invoke_kernel(kernel, R{}, gen, x, y));
+    using S = typename RR::scalar_type;
+
+    RR rr;
+
+    for (unsigned s = 0; s < ps.spp; ++s)
+    {
+        auto r = make_primary_ray(
+                R{},
+                ps,
+                gen,
+                x,
+                y,
+                width,
+                height,
+                cam
+                );
+
+        auto result = invoke_kernel(kernel, r, gen, x, y);
+
+        // AOVs are taken from the first sample
+        if (s == 0)
+        {
+            store_aovs(result, rt_ref, x, y, width, height);
+        }
+
+        // Arbitrarily assign the depth of _one_ pixel that recorded a hit
+        if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
+        {
+            result.depth = select(result.hit, depth_transform(r, result.depth, cam), S(1.0));
+            rr.depth += result.depth;
+        }
+
+        rr.hit |= result.hit;
+        rr.color += result.color;
+    }
+
+    rr.color /= S((float)ps.spp);
+    rr.depth /= S((float)ps.spp);
+
+    accumulate_adaptive(rt_ref, x, y, width, height, rr.color);
 
     if (RenderTargetRef::depth_format != PF_UNSPECIFIED)
     {
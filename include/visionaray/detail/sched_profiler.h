@@ -0,0 +1,222 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_DETAIL_SCHED_PROFILER_H
+#define VSNRAY_DETAIL_SCHED_PROFILER_H 1
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "../pixel_sampler_types.h"
+#include "range.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Timing record for one tile processed by a CPU scheduler
+//
+// Times are in seconds, relative to the profiler's epoch (construction
+// or last call to clear()).
+//
+
+struct tile_timing
+{
+    unsigned frame_id;
+
+    // Pixel range [x0,x1) x [y0,y1)
+    int x0;
+    int x1;
+    int y0;
+    int y1;
+
+    // Index of the worker thread that processed the tile
+    unsigned thread_index;
+
+    // Number of camera samples actually taken inside the tile (e.g. zero
+    // for tiles skipped by adaptive sampling)
+    uint64_t num_samples;
+
+    double begin;
+    double end;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Timing record for a whole frame
+//
+
+struct frame_timing
+{
+    unsigned frame_id;
+
+    int width;
+    int height;
+
+    double begin;
+    double end;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Scheduler profiler
+//
+// Attach to a CPU scheduler with sched.set_profiler(&prof). The scheduler
+// then records a tile_timing for each tile it processes. Use the functions
+// from common/sched_profiler_io.h to export the data as CSV, heat map or
+// Chrome trace.
+//
+
+class sched_profiler
+{
+public:
+
+    using clock = std::chrono::steady_clock;
+
+    sched_profiler()
+        : epoch_(clock::now())
+    {
+    }
+
+    // Seconds since the profiler's epoch
+    double now() const
+    {
+        return std::chrono::duration<double>(clock::now() - epoch_).count();
+    }
+
+    // Remove all records and restart the epoch
+    void clear()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        tiles_.clear();
+        frames_.clear();
+        epoch_ = clock::now();
+    }
+
+
+    //---------------------------------------------------------------------------------------------
+    // Called by the scheduler
+    //
+
+    void begin_frame(unsigned frame_id, int width, int height)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        frame_id_ = frame_id;
+        frames_.push_back({ frame_id, width, height, now(), 0.0 });
+    }
+
+    void end_frame()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (!frames_.empty())
+        {
+            frames_.back().end = now();
+        }
+    }
+
+    void record_tile(
+            range2d<int> const& r,
+            unsigned            thread_index,
+            uint64_t            num_samples,
+            double              begin,
+            double              end
+            )
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        tiles_.push_back({
+                frame_id_,
+                r.rows().begin(),
+                r.rows().end(),
+                r.cols().begin(),
+                r.cols().end(),
+                thread_index,
+                num_samples,
+                begin,
+                end
+                });
+    }
+
+
+    //---------------------------------------------------------------------------------------------
+    // Access recorded data, only call when no frame is being rendered!
+    //
+
+    std::vector<tile_timing> const& tiles() const
+    {
+        return tiles_;
+    }
+
+    std::vector<frame_timing> const& frames() const
+    {
+        return frames_;
+    }
+
+private:
+
+    std::mutex mutex_;
+
+    clock::time_point epoch_;
+
+    unsigned frame_id_ = 0;
+
+    std::vector<tile_timing> tiles_;
+    std::vector<frame_timing> frames_;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Camera samples taken by the calling thread in the tile it currently
+// processes. Backends reset the counter before a tile and pass it to
+// record_tile() afterwards, schedulers add the samples they take.
+//
+
+namespace detail
+{
+
+inline uint64_t& tile_sample_count()
+{
+    static thread_local uint64_t count = 0;
+    return count;
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// Number of camera samples per pixel taken by the built-in pixel samplers
+//
+
+inline unsigned samples_per_pixel(pixel_sampler::base_type const& /* */)
+{
+    return 1;
+}
+
+inline unsigned samples_per_pixel(pixel_sampler::uniform_type const& ps)
+{
+    return ps.ssaa_factor;
+}
+
+template <typename T, typename B>
+inline unsigned samples_per_pixel(pixel_sampler::basic_jittered_blend_type<T, B> const& ps)
+{
+    return ps.spp;
+}
+
+template <typename T, typename B>
+inline unsigned samples_per_pixel(pixel_sampler::basic_adaptive_blend_type<T, B> const& ps)
+{
+    return ps.spp;
+}
+
+} // visionaray
+
+#endif // VSNRAY_DETAIL_SCHED_PROFILER_H
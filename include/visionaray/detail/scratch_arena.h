@@ -0,0 +1,257 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_DETAIL_SCRATCH_ARENA_H
+#define VSNRAY_DETAIL_SCRATCH_ARENA_H 1
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "aligned_allocator.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Scratch arena
+//
+// Bump allocator for temporary, per-thread memory. Memory is handed out
+// from a list of blocks; reset() rewinds the arena but keeps the blocks
+// around, so that after a few warm-up tiles or frames no more calls
+// to the system allocator are issued.
+//
+// Objects allocated from the arena are never destroyed, so only use
+// it for trivially destructible types!
+//
+
+class scratch_arena
+{
+public:
+
+    enum { DefaultBlockSize = 1 << 20 };
+    enum { DefaultAlignment = 64 };
+
+    explicit scratch_arena(size_t block_size = DefaultBlockSize)
+        : block_size_(block_size)
+    {
+    }
+
+    scratch_arena(scratch_arena const&) = delete;
+    scratch_arena& operator=(scratch_arena const&) = delete;
+
+    scratch_arena(scratch_arena&&) = default;
+    scratch_arena& operator=(scratch_arena&&) = default;
+
+    // Allocate size bytes, aligned on an align-byte boundary
+    void* allocate(size_t size, size_t align = DefaultAlignment)
+    {
+        assert(align > 0 && (align & (align - 1)) == 0);
+
+        for (;;)
+        {
+            if (current_ < blocks_.size())
+            {
+                block& b = blocks_[current_];
+
+                uintptr_t base = reinterpret_cast<uintptr_t>(b.data.get());
+                uintptr_t ptr = (base + offset_ + align - 1) & ~(uintptr_t)(align - 1);
+                size_t new_offset = static_cast<size_t>(ptr - base) + size;
+
+                if (new_offset <= b.size)
+                {
+                    offset_ = new_offset;
+                    return reinterpret_cast<void*>(ptr);
+                }
+
+                // Try the next block that is already allocated
+                ++current_;
+                offset_ = 0;
+            }
+            else
+            {
+                // Oversized requests get their own block
+                size_t bs = size + align > block_size_ ? size + align : block_size_;
+                blocks_.emplace_back(bs);
+            }
+        }
+    }
+
+    // Allocate uninitialized storage for count objects of type T
+    template <typename T>
+    T* allocate(size_t count)
+    {
+        static_assert(
+                std::is_trivially_destructible<T>::value,
+                "scratch_arena only supports trivially destructible types"
+                );
+
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Rewind the arena, all memory previously handed out becomes invalid
+    void reset()
+    {
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    // Free all blocks
+    void release()
+    {
+        blocks_.clear();
+        reset();
+    }
+
+    // Number of bytes reserved from the system allocator
+    size_t capacity() const
+    {
+        size_t result = 0;
+
+        for (auto const& b : blocks_)
+        {
+            result += b.size;
+        }
+
+        return result;
+    }
+
+private:
+
+    struct block
+    {
+        struct deleter
+        {
+            void operator()(char* ptr) const
+            {
+                aligned_allocator<char, DefaultAlignment>().deallocate(ptr, 0);
+            }
+        };
+
+        explicit block(size_t s)
+            : data(aligned_allocator<char, DefaultAlignment>().allocate(s))
+            , size(s)
+        {
+        }
+
+        std::unique_ptr<char, deleter> data;
+        size_t size;
+    };
+
+    std::vector<block> blocks_;
+
+    size_t block_size_;
+    size_t current_ = 0;
+    size_t offset_ = 0;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Allocator adapter so that STL containers can draw from a scratch arena
+//
+// deallocate() is a no-op, memory is reclaimed when the arena is reset.
+//
+
+template <typename T>
+class scratch_allocator
+{
+public:
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef size_t size_type;
+
+    explicit scratch_allocator(scratch_arena& arena)
+        : arena_(&arena)
+    {
+    }
+
+    template <typename U>
+    scratch_allocator(scratch_allocator<U> const& rhs)
+        : arena_(rhs.arena())
+    {
+    }
+
+    template <typename U>
+    struct rebind
+    {
+        typedef scratch_allocator<U> other;
+    };
+
+    pointer allocate(size_type n)
+    {
+        return static_cast<pointer>(arena_->allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    void deallocate(pointer /* p */, size_type /* n */)
+    {
+    }
+
+    scratch_arena* arena() const
+    {
+        return arena_;
+    }
+
+    template <typename U>
+    bool operator==(scratch_allocator<U> const& rhs) const
+    {
+        return arena_ == rhs.arena();
+    }
+
+    template <typename U>
+    bool operator!=(scratch_allocator<U> const& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+private:
+
+    scratch_arena* arena_;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Access the scratch arena bound to the calling thread
+//
+// CPU schedulers bind a per-worker arena before invoking the user
+// supplied per-packet function and reset it at tile boundaries.
+//
+
+namespace detail
+{
+
+inline scratch_arena*& current_scratch_arena()
+{
+    static thread_local scratch_arena* arena = nullptr;
+    return arena;
+}
+
+} // detail
+
+inline scratch_arena& this_thread_scratch_arena()
+{
+    scratch_arena*& arena = detail::current_scratch_arena();
+
+    if (arena == nullptr)
+    {
+        // Thread is not managed by a scheduler, fall back to
+        // an arena that lives as long as the thread
+        static thread_local scratch_arena fallback;
+        arena = &fallback;
+    }
+
+    return *arena;
+}
+
+} // visionaray
+
+#endif // VSNRAY_DETAIL_SCRATCH_ARENA_H
@@ -18,14 +18,17 @@ struct kernel
 
     Params params;
 
+    template <typename R>
+    using result_type = result_record<typename R::scalar_type, visionaray::detail::aov_channels<Params>::value>;
+
     template <typename Intersector, typename R>
-    VSNRAY_FUNC result_record<typename R::scalar_type> operator()(Intersector& isect, R ray) const
+    VSNRAY_FUNC result_type<R> operator()(Intersector& isect, R ray) const
     {
         using S = typename R::scalar_type;
         using V = vector<3, S>;
         using C = spectrum<S>;
 
-        result_record<S> result;
+        result_type<R> result;
 
         auto hit_rec = closest_hit(ray, params.prims.begin, params.prims.end, isect);
 
@@ -33,7 +36,10 @@ struct kernel
         {
             hit_rec.isect_pos = ray.ori + ray.dir * hit_rec.t;
 
-            auto surf = get_surface(hit_rec, params);
+            auto surf = get_surface(hit_rec, params, ray);
+
+            visionaray::detail::record_aovs(result, hit_rec, surf, ray, params);
+
             auto env = params.amb_light.intensity(ray.dir);
             auto bgcolor = params.background.intensity(ray.dir);
             auto ambient = surf.material.ambient() * C(from_rgb(env));
@@ -62,7 +68,7 @@ struct kernel
     }
 
     template <typename R>
-    VSNRAY_FUNC result_record<typename R::scalar_type> operator()(R ray) const
+    VSNRAY_FUNC result_type<R> operator()(R ray) const
     {
         default_intersector ignore;
         return (*this)(ignore, ray);
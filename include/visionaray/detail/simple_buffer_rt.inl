@@ -28,6 +28,12 @@ typename simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_type* si
     return accum_buffer.data();
 }
 
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+typename simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments_type* simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments()
+{
+    return moments_buffer.empty() ? nullptr : moments_buffer.data();
+}
+
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 typename simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::color_type const* simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::color() const
 {
@@ -46,6 +52,24 @@ typename simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_type con
     return accum_buffer.data();
 }
 
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+typename simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments_type const* simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments() const
+{
+    return moments_buffer.empty() ? nullptr : moments_buffer.data();
+}
+
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+aov_buffers& simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::aovs()
+{
+    return aov_buffer;
+}
+
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+aov_buffers const& simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::aovs() const
+{
+    return aov_buffer;
+}
+
 
 //-------------------------------------------------------------------------------------------------
 // Interface
@@ -54,7 +78,16 @@ typename simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_type con
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 typename simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::ref_type simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::ref()
 {
-    return { color(), depth(), accum(), width(), height() };
+    return { color(), depth(), accum(), width(), height(), moments(), aov_buffer.ref() };
+}
+
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+void simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::require_moments()
+{
+    if (moments_buffer.empty())
+    {
+        moments_buffer.resize(width() * height(), moments_type(0.0f));
+    }
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
@@ -90,8 +123,8 @@ void simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::clear_depth_buffer
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 void simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::clear_accum_buffer(vec4 const& c)
 {
-    // Convert from RGBA32F to internal color format
-    color_type cc;
+    // Convert from RGBA32F to internal accum format
+    accum_type cc;
     convert(
         pixel_format_constant<AccumFormat>{},
         pixel_format_constant<PF_RGBA32F>{},
@@ -100,6 +133,9 @@ void simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::clear_accum_buffer
         );
 
     std::fill(accum_buffer.begin(), accum_buffer.end(), cc);
+
+    // Accumulation starts over, so does adaptive sampling
+    std::fill(moments_buffer.begin(), moments_buffer.end(), moments_type(0.0f));
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
@@ -129,6 +165,13 @@ void simple_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::resize(int w, int
     {
         accum_buffer.resize(w * h);
     }
+
+    if (!moments_buffer.empty())
+    {
+        moments_buffer.resize(w * h, moments_type(0.0f));
+    }
+
+    aov_buffer.resize(w, h);
 }
 
 } // visionaray
@@ -6,6 +6,7 @@
 #include "../packet_traits.h"
 
 #include "sched_common.h"
+#include "scratch_arena.h"
 
 namespace visionaray
 {
@@ -31,12 +32,17 @@ void simple_sched<R>::frame(K kernel, SP sched_params)
         for (int x = 0; x < sched_params.rt.width(); ++x)
         {
             expand_pixel<S> ep;
-            auto seed = make_random_seed(
-                convert_to_int(ep.y(y)) * sched_params.rt.width() + convert_to_int(ep.x(x)),
+            auto gen = make_pixel_generator(
+                S{},
+                typename SP::pixel_sampler_type{},
+                convert_to_int(ep.x(x)),
+                convert_to_int(ep.y(y)),
+                sched_params.rt.width(),
                 I(frame_id_)
                 );
 
-            auto gen = make_generator(S{}, typename SP::pixel_sampler_type{}, seed);
+            // There are no tiles, scratch memory is valid per packet
+            this_thread_scratch_arena().reset();
 
             sample_pixel(
                     kernel,
@@ -0,0 +1,84 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_DETAIL_SPD_SMITS_H
+#define VSNRAY_DETAIL_SPD_SMITS_H 1
+
+#include "../../math/detail/math.h"
+
+#include "../macros.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Basis spectra for RGB to spectrum conversion
+// From: Smits: An RGB to Spectrum Conversion for Reflectances (1999)
+// 10 bins from 380 to 720 nm, linearly interpolated between bin centers
+//
+
+class spd_smits
+{
+public:
+
+    enum basis
+    {
+        White,
+        Cyan,
+        Magenta,
+        Yellow,
+        Red,
+        Green,
+        Blue
+    };
+
+    VSNRAY_FUNC explicit spd_smits(basis b = White) : basis_(b) {}
+
+    VSNRAY_FUNC float operator()(float lambda) const
+    {
+        float const* t = table(basis_);
+
+        // Bin centers are at 380 + 17 + i * 34 nm
+        float x = (lambda - 397.0f) / 34.0f;
+
+        if (x <= 0.0f)
+        {
+            return t[0];
+        }
+
+        if (x >= 9.0f)
+        {
+            return t[9];
+        }
+
+        int i = static_cast<int>(x);
+        return lerp_r(t[i], t[i + 1], x - i);
+    }
+
+    // The 10 bins of a basis spectrum
+    VSNRAY_FUNC static float const* table(basis b)
+    {
+        static const float data[7][10] = {
+            { 1.0000f, 1.0000f, 0.9999f, 0.9993f, 0.9992f, 0.9998f, 1.0000f, 1.0000f, 1.0000f, 1.0000f }, // White
+            { 0.9710f, 0.9426f, 1.0007f, 1.0007f, 1.0007f, 1.0007f, 0.1564f, 0.0000f, 0.0000f, 0.0000f }, // Cyan
+            { 1.0000f, 1.0000f, 0.9685f, 0.2229f, 0.0000f, 0.0458f, 0.8369f, 1.0000f, 1.0000f, 0.9959f }, // Magenta
+            { 0.0001f, 0.0000f, 0.1088f, 0.6651f, 1.0000f, 1.0000f, 0.9996f, 0.9586f, 0.9685f, 0.9840f }, // Yellow
+            { 0.1012f, 0.0515f, 0.0000f, 0.0000f, 0.0000f, 0.0000f, 0.8325f, 1.0149f, 1.0149f, 1.0149f }, // Red
+            { 0.0000f, 0.0000f, 0.0273f, 0.7937f, 1.0000f, 0.9418f, 0.1719f, 0.0000f, 0.0000f, 0.0025f }, // Green
+            { 1.0000f, 1.0000f, 0.8916f, 0.3323f, 0.0000f, 0.0000f, 0.0003f, 0.0369f, 0.0483f, 0.0496f }  // Blue
+        };
+
+        return data[b];
+    }
+
+private:
+
+    basis basis_;
+
+};
+
+} // visionaray
+
+#endif // VSNRAY_DETAIL_SPD_SMITS_H
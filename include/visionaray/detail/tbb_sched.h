@@ -8,6 +8,7 @@
 
 #include <tbb/blocked_range2d.h>
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #if 1 // TODO: find out when that API changed
 #define TBB_PREVIEW_GLOBAL_CONTROL 1
 #include <tbb/global_control.h>
@@ -15,8 +16,11 @@
 #include <tbb/task_scheduler_init.h>
 #endif
 
+#include "../texture/detail/page_counters.h"
 #include "basic_sched.h"
 #include "range.h"
+#include "sched_profiler.h"
+#include "scratch_arena.h"
 
 namespace visionaray
 {
@@ -41,13 +45,9 @@ struct tbb_sched_backend
 #endif
     }
 
+    // Call func(range2d<int>) for each tile
     template <typename Func>
-    void for_each_packet(
-            tiled_range2d<int> const& tr,
-            int packet_width,
-            int packet_height,
-            Func const& func
-            )
+    void for_each_tile(tiled_range2d<int> const& tr, Func const& func)
     {
         int x0 = tr.rows().begin();
         int y0 = tr.cols().begin();
@@ -60,7 +60,47 @@ struct tbb_sched_backend
 
         tbb::parallel_for(
             tbb::blocked_range2d<int>(x0, nx, dx, y0, ny, dy),
-            [=](tbb::blocked_range2d<int> const& r)
+            [=](tbb::blocked_range2d<int> const& br)
+            {
+                // TBB workers use their thread-local fallback arenas,
+                // scratch memory is only valid for the duration of a tile
+                this_thread_scratch_arena().reset();
+
+                double tile_begin = profiler_ != nullptr ? profiler_->now() : 0.0;
+                detail::tile_sample_count() = 0;
+
+                range2d<int> r(br.rows().begin(), br.rows().end(), br.cols().begin(), br.cols().end());
+
+                func(r);
+
+                // Page cache hits and misses are added once per tile
+                flush_page_counters();
+
+                if (profiler_ != nullptr)
+                {
+                    profiler_->record_tile(
+                            r,
+                            static_cast<unsigned>(tbb::this_task_arena::current_thread_index()),
+                            detail::tile_sample_count(),
+                            tile_begin,
+                            profiler_->now()
+                            );
+                }
+            });
+    }
+
+    // Call func(x, y) for each packet
+    template <typename Func>
+    void for_each_packet(
+            tiled_range2d<int> const& tr,
+            int packet_width,
+            int packet_height,
+            Func const& func
+            )
+    {
+        for_each_tile(
+            tr,
+            [=](range2d<int> const& r)
             {
                 for (int y = r.cols().begin(); y < r.cols().end(); y += packet_height)
                 {
@@ -77,6 +117,9 @@ struct tbb_sched_backend
 #else
     tbb::task_scheduler_init init_;
 #endif
+
+    // Optional, set by basic_sched::set_profiler()
+    sched_profiler* profiler_ = nullptr;
 };
 
 template <typename R>
@@ -17,6 +17,7 @@ inline R thin_lens_camera::primary_ray(
         T const&   height
         ) const
 {
+    // Keeps the ray cone of the pinhole ray, defocus does not widen it
     R r = pinhole_camera::primary_ray(R{}, x, y, width, height);
 
     vector<3, T> lens_du(normalize(U));
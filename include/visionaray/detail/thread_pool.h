@@ -13,7 +13,9 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
+#include "scratch_arena.h"
 #include "semaphore.h"
 
 namespace visionaray
@@ -46,9 +48,12 @@ public:
         threads.reset(new std::thread[num_threads]);
         this->num_threads = num_threads;
 
+        arenas.clear();
+        arenas.resize(num_threads);
+
         for (unsigned i = 0; i < num_threads; ++i)
         {
-            threads[i] = std::thread([this](){ thread_loop(); });
+            threads[i] = std::thread([this, i](){ thread_loop(i); });
         }
     }
 
@@ -59,8 +64,13 @@ public:
             return;
         }
 
-        sync_params.start_threads = true;
-        sync_params.join_threads = true;
+        {
+            // Modify under lock, otherwise workers that are about
+            // to wait on the condition variable may miss the wakeup
+            std::unique_lock<std::mutex> lock(sync_params.mutex);
+            sync_params.start_threads = true;
+            sync_params.join_threads = true;
+        }
         sync_params.threads_start.notify_all();
 
         for (unsigned i = 0; i < num_threads; ++i)
@@ -91,6 +101,14 @@ public:
         return unsigned(-1);
     }
 
+    // Scratch arena owned by the worker with index thread_index.
+    // Inside a work item, prefer this_thread_scratch_arena()
+    scratch_arena& get_scratch_arena(unsigned thread_index)
+    {
+        assert(thread_index < num_threads);
+        return arenas[thread_index];
+    }
+
     template <typename Func>
     void run(Func f, long queue_length)
     {
@@ -103,7 +121,10 @@ public:
         sync_params.work_items_finished_counter = 0;
 
         // Activate persistent threads
-        sync_params.start_threads = true;
+        {
+            std::unique_lock<std::mutex> lock(sync_params.mutex);
+            sync_params.start_threads = true;
+        }
         sync_params.threads_start.notify_all();
 
         // Wait for all threads to finish
@@ -121,6 +142,9 @@ private:
     using func_t = std::function<void(unsigned)>;
     func_t func;
 
+    // One scratch arena per worker thread
+    std::vector<scratch_arena> arenas;
+
 
     struct
     {
@@ -136,8 +160,10 @@ private:
         std::atomic<long>       work_items_finished_counter;
     } sync_params;
 
-    void thread_loop()
+    void thread_loop(unsigned thread_index)
     {
+        detail::current_scratch_arena() = &arenas[thread_index];
+
         for (;;)
         {
             // Wait until activated
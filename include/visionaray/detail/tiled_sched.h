@@ -7,9 +7,12 @@
 #define VSNRAY_DETAIL_TILED_SCHED_H 1
 
 #include "../math/detail/math.h"
+#include "../texture/detail/page_counters.h"
 #include "basic_sched.h"
 #include "parallel_for.h"
 #include "range.h"
+#include "sched_profiler.h"
+#include "scratch_arena.h"
 #include "thread_pool.h"
 
 namespace visionaray
@@ -47,6 +50,40 @@ struct tiled_sched_backend
         pool_.reset(num_threads);
     }
 
+    // Call func(range2d<int>) for each tile
+    template <typename Func>
+    void for_each_tile(tiled_range2d<int> const& tr, Func const& func)
+    {
+        visionaray::parallel_for(
+            pool_,
+            tr,
+            [=](range2d<int> const& r)
+            {
+                // Scratch memory is only valid for the duration of a tile
+                this_thread_scratch_arena().reset();
+
+                double tile_begin = profiler_ != nullptr ? profiler_->now() : 0.0;
+                detail::tile_sample_count() = 0;
+
+                func(r);
+
+                // Page cache hits and misses are added once per tile
+                flush_page_counters();
+
+                if (profiler_ != nullptr)
+                {
+                    profiler_->record_tile(
+                            r,
+                            pool_.get_thread_index(std::this_thread::get_id()),
+                            detail::tile_sample_count(),
+                            tile_begin,
+                            profiler_->now()
+                            );
+                }
+            });
+    }
+
+    // Call func(x, y) for each packet
     template <typename Func>
     void for_each_packet(
             tiled_range2d<int> const& tr,
@@ -66,8 +103,7 @@ struct tiled_sched_backend
         launchDim.y = tr.cols().length();
 #endif
 
-        visionaray::parallel_for(
-            pool_,
+        for_each_tile(
             tr,
             [=](range2d<int> const& r)
             {
@@ -95,6 +131,9 @@ struct tiled_sched_backend
     }
 
     thread_pool pool_;
+
+    // Optional, set by basic_sched::set_profiler()
+    sched_profiler* profiler_ = nullptr;
 };
 
 template <typename R>
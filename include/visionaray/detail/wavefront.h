@@ -0,0 +1,317 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_DETAIL_WAVEFRONT_H
+#define VSNRAY_DETAIL_WAVEFRONT_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "../math/simd/type_traits.h"
+#include "../math/ray.h"
+#include "../math/vector.h"
+#include "../array.h"
+#include "../generic_material.h"
+#include "../random_generator.h"
+#include "../spectrum.h"
+
+//-------------------------------------------------------------------------------------------------
+// Helpers for wavefront kernels
+//
+// Wavefront kernels keep their per-path state in scalar form and fill
+// SIMD packets from queues of path indices. gather_lanes() loads one
+// packet from such a queue, scatter_lanes() writes a packet back. Lanes
+// past the end of a queue are padded with the last valid entry, use
+// valid_lanes() to mask them out.
+//
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Convert between arrays of scalar values and SIMD vectors
+//
+
+template <size_t N>
+inline simd::float_from_simd_width_t<N> pack_lanes(array<float, N> const& arr)
+{
+    using S = simd::float_from_simd_width_t<N>;
+
+    simd::aligned_array_t<S> tmp;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        tmp[i] = arr[i];
+    }
+
+    return S(tmp);
+}
+
+// Vectors, rays, etc.
+template <typename T, size_t N>
+inline auto pack_lanes(array<T, N> const& arr)
+    -> decltype(simd::pack(arr))
+{
+    return simd::pack(arr);
+}
+
+template <size_t N>
+inline spectrum<simd::float_from_simd_width_t<N>> pack_lanes(array<spectrum<float>, N> const& arr)
+{
+    using V = vector<spectrum<float>::num_samples, float>;
+
+    array<V, N> samples;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        samples[i] = arr[i].samples();
+    }
+
+    return spectrum<simd::float_from_simd_width_t<N>>(simd::pack(samples));
+}
+
+template <
+    typename S,
+    typename = typename std::enable_if<simd::is_simd_vector<S>::value>::type
+    >
+inline array<float, simd::num_elements<S>::value> unpack_lanes(S const& v)
+{
+    simd::aligned_array_t<S> tmp;
+    simd::store(tmp, v);
+
+    array<float, simd::num_elements<S>::value> result;
+
+    for (int i = 0; i < simd::num_elements<S>::value; ++i)
+    {
+        result[i] = tmp[i];
+    }
+
+    return result;
+}
+
+template <size_t Dim, typename S>
+inline array<vector<Dim, float>, simd::num_elements<S>::value> unpack_lanes(vector<Dim, S> const& v)
+{
+    return simd::unpack(v);
+}
+
+template <typename S>
+inline array<basic_ray<float>, simd::num_elements<S>::value> unpack_lanes(basic_ray<S> const& r)
+{
+    return simd::unpack(r);
+}
+
+template <typename S>
+inline array<spectrum<float>, simd::num_elements<S>::value> unpack_lanes(spectrum<S> const& s)
+{
+    auto samples = simd::unpack(s.samples());
+
+    array<spectrum<float>, simd::num_elements<S>::value> result;
+
+    for (int i = 0; i < simd::num_elements<S>::value; ++i)
+    {
+        result[i] = spectrum<float>(samples[i]);
+    }
+
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Mask with the first n lanes set
+//
+
+template <typename S>
+inline simd::mask_type_t<S> valid_lanes(unsigned n)
+{
+    simd::aligned_array_t<S> lane;
+
+    for (int i = 0; i < simd::num_elements<S>::value; ++i)
+    {
+        lane[i] = static_cast<float>(i);
+    }
+
+    return S(lane) < S(static_cast<float>(n));
+}
+
+// Lane i is set <=> result[i] == true
+template <typename M>
+inline array<bool, simd::num_elements<M>::value> unpack_mask(M const& m)
+{
+    using S = simd::float_type_t<M>;
+
+    auto lanes = unpack_lanes(select(m, S(1.0f), S(0.0f)));
+
+    array<bool, simd::num_elements<M>::value> result;
+
+    for (int i = 0; i < simd::num_elements<M>::value; ++i)
+    {
+        result[i] = lanes[i] != 0.0f;
+    }
+
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Load a packet: func(lane) returns the scalar value for the lane, it is
+// called for lanes [0..n) and the last valid lane is replicated
+//
+
+template <typename S, typename Func>
+inline auto gather_lanes(unsigned n, Func func)
+    -> decltype(pack_lanes(array<decltype(func(0u)), simd::num_elements<S>::value>{}))
+{
+    array<decltype(func(0u)), simd::num_elements<S>::value> arr;
+
+    for (unsigned i = 0; i < simd::num_elements<S>::value; ++i)
+    {
+        arr[i] = func(i < n ? i : n - 1);
+    }
+
+    return pack_lanes(arr);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Store a packet: func(lane, value) is called for lanes [0..n)
+//
+
+template <typename T, typename Func>
+inline void scatter_lanes(unsigned n, T const& v, Func func)
+{
+    auto arr = unpack_lanes(v);
+
+    for (unsigned i = 0; i < n && i < arr.size(); ++i)
+    {
+        func(i, arr[i]);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Assemble a SIMD generator from per-path generators and back
+//
+// simd_generator_t<Generator, S> is the SIMD version of a scalar
+// generator template (e.g. random_generator<float> -> random_generator<S>)
+//
+
+template <typename Generator, typename S>
+struct simd_generator;
+
+template <template <typename, typename> class Generator, typename T, typename S>
+struct simd_generator<Generator<T, void>, S>
+{
+    using type = Generator<S, void>;
+};
+
+template <typename Generator, typename S>
+using simd_generator_t = typename simd_generator<Generator, S>::type;
+
+template <
+    typename S,
+    typename Func,
+    typename Generator = typename std::decay<decltype(std::declval<Func>()(0u))>::type
+    >
+inline simd_generator_t<Generator, S> gather_generators(unsigned n, Func func)
+{
+    simd_generator_t<Generator, S> result;
+
+    for (unsigned i = 0; i < simd::num_elements<S>::value; ++i)
+    {
+        result.get_generator(i) = func(i < n ? i : n - 1);
+    }
+
+    return result;
+}
+
+template <typename Generator, typename Func>
+inline void scatter_generators(unsigned n, Generator& gen, Func func)
+{
+    using S = typename Generator::value_type;
+
+    for (unsigned i = 0; i < n && i < simd::num_elements<S>::value; ++i)
+    {
+        func(i, gen.get_generator(i));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Material-coherent shading
+//
+// material_sort_key() returns a key that groups hits by material type
+// and material index, 0 is reserved for misses. Packets of hits with
+// equal keys can be shaded with with_simd_material(), which packs N
+// copies of the material into its SIMD type (e.g. plastic<float8>)
+// and calls func with it. Returns false if there is no such type.
+//
+
+template <typename M>
+inline uint64_t material_sort_key(M const& /* mat */, int mat_id)
+{
+    return static_cast<uint64_t>(static_cast<unsigned>(mat_id)) + 1;
+}
+
+template <typename ...Ts>
+inline uint64_t material_sort_key(generic_material<Ts...> const& mat, int mat_id)
+{
+    return (static_cast<uint64_t>(mat.which()) << 32) | static_cast<unsigned>(mat_id);
+}
+
+template <typename S, typename Func>
+struct simd_material_visitor
+{
+    using return_type = bool;
+
+    Func& func;
+
+    template <typename M>
+    bool operator()(M const& mat) const
+    {
+        return call(mat, has_simd_material<S, M>{});
+    }
+
+    template <typename M>
+    bool call(M const& mat, std::true_type) const
+    {
+        array<M, simd::num_elements<S>::value> mats;
+
+        for (size_t i = 0; i < mats.size(); ++i)
+        {
+            mats[i] = mat;
+        }
+
+        func(simd::pack(mats));
+        return true;
+    }
+
+    template <typename M>
+    bool call(M const& /* mat */, std::false_type) const
+    {
+        return false;
+    }
+};
+
+template <typename S, typename M, typename Func>
+inline bool with_simd_material(M const& mat, Func& func)
+{
+    return simd_material_visitor<S, Func>{ func }(mat);
+}
+
+template <typename S, typename ...Ts, typename Func>
+inline bool with_simd_material(generic_material<Ts...> const& mat, Func& func)
+{
+    return apply_visitor(simd_material_visitor<S, Func>{ func }, mat);
+}
+
+} // detail
+} // visionaray
+
+#endif // VSNRAY_DETAIL_WAVEFRONT_H
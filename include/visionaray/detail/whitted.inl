@@ -4,6 +4,7 @@
 #include <type_traits>
 
 #include "../math/simd/type_traits.h"
+#include "../math/limits.h"
 #include "../math/vector.h"
 #include "../array.h"
 #include "../generic_material.h"
@@ -221,15 +222,18 @@ struct kernel
 
     Params params;
 
+    template <typename R>
+    using result_type = result_record<typename R::scalar_type, visionaray::detail::aov_channels<Params>::value>;
+
     template <typename Intersector, typename R>
-    VSNRAY_FUNC result_record<typename R::scalar_type> operator()(Intersector& isect, R ray) const
+    VSNRAY_FUNC result_type<R> operator()(Intersector& isect, R ray) const
     {
 
         using S = typename R::scalar_type;
         using V = vector<3, S>;
         using C = spectrum<S>;
 
-        result_record<S> result;
+        result_type<R> result;
 
         auto hit_rec = closest_hit(ray, params.prims.begin, params.prims.end, isect);
 
@@ -254,7 +258,14 @@ struct kernel
         {
             hit_rec.isect_pos = ray.ori + ray.dir * hit_rec.t;
 
-            auto surf = get_surface(hit_rec, params);
+            auto surf = get_surface(hit_rec, params, ray);
+
+            // AOVs of the primary ray
+            if (depth == 1)
+            {
+                visionaray::detail::record_aovs(result, hit_rec, surf, ray, params);
+            }
+
             auto env = params.amb_light.intensity(ray.dir);
             auto bgcolor = params.background.intensity(ray.dir);
             auto ambient = surf.material.ambient() * C(from_rgb(env));
@@ -296,10 +307,15 @@ struct kernel
             if (any(bounce.kr > S(0.0)))
             {
                 auto dir = bounce.reflected_dir;
-                ray = R(
-                    hit_rec.isect_pos + dir * S(params.epsilon),
-                    dir
-                    );
+
+                // Mirror reflections keep the spread of the ray cone
+                propagate_cone(ray, hit_rec.t);
+
+                ray.ori = hit_rec.isect_pos + dir * S(params.epsilon);
+                ray.dir = dir;
+                ray.tmin = S(0.0);
+                ray.tmax = numeric_limits<S>::max();
+
                 hit_rec = closest_hit(ray, params.prims.begin, params.prims.end, isect);
             }
             throughput *= bounce.kr;
@@ -317,7 +333,7 @@ struct kernel
     }
 
     template <typename R>
-    VSNRAY_FUNC result_record<typename R::scalar_type> operator()(R ray) const
+    VSNRAY_FUNC result_type<R> operator()(R ray) const
     {
         default_intersector ignore;
         return (*this)(ignore, ray);
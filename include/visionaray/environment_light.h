@@ -9,11 +9,76 @@
 #include "detail/macros.h"
 #include "math/matrix.h"
 #include "math/vector.h"
+#include "aligned_vector.h"
+#include "light_sample.h"
 #include "spectrum.h"
 
 namespace visionaray
 {
 
+//-------------------------------------------------------------------------------------------------
+// Importance sampling data for lat-long environment maps
+//
+// Alias tables over the rows (marginal) and over the texels of each row
+// (conditional), texels are weighted by their luminance and sin(theta).
+// Does not own its data, use environment_map_distribution::ref().
+//
+
+struct environment_map_distribution_ref
+{
+    float const* marginal_prob     = nullptr;
+    int const*   marginal_alias    = nullptr;
+    float const* conditional_prob  = nullptr;
+    int const*   conditional_alias = nullptr;
+
+    // Per texel, w.r.t. texture coordinates
+    float const* pdf               = nullptr;
+
+    int          width             = 0;
+    int          height            = 0;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Built on the host from a texture with RGB(A) texels, must be rebuilt
+// when the texture changes
+//
+
+class environment_map_distribution
+{
+public:
+
+    environment_map_distribution() = default;
+
+    template <typename Texture>
+    explicit environment_map_distribution(Texture const& tex);
+
+    template <typename Texture>
+    void build(Texture const& tex);
+
+    environment_map_distribution_ref ref() const;
+
+private:
+
+    aligned_vector<float> marginal_prob_;
+    aligned_vector<int>   marginal_alias_;
+    aligned_vector<float> conditional_prob_;
+    aligned_vector<int>   conditional_alias_;
+    aligned_vector<float> pdf_;
+
+    int width_  = 0;
+    int height_ = 0;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Environment light
+//
+// Can be importance sampled when a distribution was set, otherwise
+// sample() returns samples with pdf 0.
+//
+
 template <typename T, typename Texture>
 class environment_light
 {
@@ -27,6 +92,21 @@ public:
     template <typename U>
     VSNRAY_FUNC vector<3, U> intensity(vector<3, U> const& dir) const;
 
+    // Sample a direction proportional to the radiance of the environment map
+    template <typename Generator, typename U = typename Generator::value_type>
+    VSNRAY_FUNC light_sample<U> sample(vector<3, U> const& reference_point, Generator& gen) const;
+
+    // Solid angle pdf of sample() picking dir
+    template <typename U>
+    VSNRAY_FUNC U pdf(vector<3, U> const& dir) const;
+
+    // Distribution for importance sampling, the data must be accessible
+    // where the light is used
+    VSNRAY_FUNC void set_distribution(environment_map_distribution_ref const& distribution);
+    VSNRAY_FUNC environment_map_distribution_ref const& distribution() const;
+
+    VSNRAY_FUNC bool importance_sampled() const;
+
     VSNRAY_FUNC Texture& texture();
     VSNRAY_FUNC Texture const& texture() const;
 
@@ -48,6 +128,8 @@ private:
 
     matrix<4, 4, T> light_to_world_transform_;
     matrix<4, 4, T> world_to_light_transform_;
+
+    environment_map_distribution_ref distribution_;
 };
 
 } // visionaray
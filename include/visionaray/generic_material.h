@@ -36,6 +36,7 @@ public:
     template <template <typename> class M>
     /* implicit */ generic_material(M<scalar_type> const& material);
 
+    VSNRAY_FUNC spectrum<scalar_type> albedo() const;
     VSNRAY_FUNC spectrum<scalar_type> ambient() const;
 
     template <typename SR>
@@ -60,6 +61,7 @@ private:
 
     // Variant visitors
 
+    struct albedo_visitor;
     struct ambient_visitor;
 
     template <typename SR>
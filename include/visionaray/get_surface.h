@@ -17,6 +17,7 @@
 #include "get_primitive.h"
 #include "get_shading_normal.h"
 #include "get_tex_coord.h"
+#include "ray_cone.h"
 #include "surface.h"
 
 namespace visionaray
@@ -49,20 +50,44 @@ public:
 };
 
 
+//-------------------------------------------------------------------------------------------------
+// Texture footprints
+//
+// Either no_footprint (textures are sampled at the finest level), or the
+// ray whose cone determines the level of detail (see ray_cone.h).
+//
+
+struct no_footprint {};
+
+template <size_t N>
+inline array<no_footprint, N> unpack_footprint(no_footprint /* */)
+{
+    return {};
+}
+
+template <size_t N, typename T>
+inline array<basic_ray<float>, N> unpack_footprint(basic_ray<T> const& ray)
+{
+    return simd::unpack(ray);
+}
+
+
 //-------------------------------------------------------------------------------------------------
 // Sample textures
 //
 
-template <typename HR, typename Params>
+template <typename HR, typename Params, typename Footprint>
 VSNRAY_FUNC
 inline typename Params::color_type get_tex_color(
         HR const&                      hr,
         Params const&                  params,
+        Footprint const&               footprint,
         std::integral_constant<int, 0> /* not a texture! */
         )
 {
     VSNRAY_UNUSED(hr);
     VSNRAY_UNUSED(params);
+    VSNRAY_UNUSED(footprint);
 
     using C = typename Params::color_type;
 
@@ -70,14 +95,17 @@ inline typename Params::color_type get_tex_color(
     return C(1.0);
 }
 
-template <typename HR, typename Params>
+template <typename HR, typename Params, typename Footprint>
 VSNRAY_FUNC
 inline typename Params::color_type get_tex_color(
         HR const&                      hr,
         Params const&                  params,
+        Footprint const&               footprint,
         std::integral_constant<int, 1> /* */
         )
 {
+    VSNRAY_UNUSED(footprint);
+
     using C = typename Params::color_type;
 
     auto coord = get_tex_coord(params.tex_coords, hr, get_primitive(params.prims.begin, hr));
@@ -92,6 +120,7 @@ VSNRAY_FUNC
 inline typename Params::color_type get_tex_color(
         HR const&                      hr,
         Params const&                  params,
+        no_footprint const&            /* */,
         std::integral_constant<int, 2> /* */
         )
 {
@@ -104,14 +133,73 @@ inline typename Params::color_type get_tex_color(
     return C(tex2D(tex, coord));
 }
 
+// Textures w/o tex2D(tex, coord, lod) (e.g. Ptex) ignore the footprint
+template <typename Tex, typename = void>
+struct supports_lod : std::false_type {};
+
+template <typename Tex>
+struct supports_lod<Tex, decltype(
+        void(tex2D(std::declval<Tex const&>(), vector<2, float>(), 0.0f)),
+        void(std::declval<Tex const&>().width())
+        )> : std::true_type {};
+
 template <typename HR, typename Params>
 VSNRAY_FUNC
+inline typename Params::color_type get_tex_color_lod(
+        HR const&                      hr,
+        Params const&                  params,
+        basic_ray<float> const&        ray,
+        std::false_type                /* */
+        )
+{
+    VSNRAY_UNUSED(ray);
+
+    return get_tex_color(hr, params, no_footprint{}, std::integral_constant<int, 2>{});
+}
+
+template <typename HR, typename Params>
+VSNRAY_FUNC
+inline typename Params::color_type get_tex_color_lod(
+        HR const&                      hr,
+        Params const&                  params,
+        basic_ray<float> const&        ray,
+        std::true_type                 /* */
+        )
+{
+    using C = typename Params::color_type;
+
+    auto const& prim = get_primitive(params.prims.begin, hr);
+    auto coord = get_tex_coord(params.tex_coords, hr, prim);
+
+    int mat_id = hr.inst_id < 0 ? hr.geom_id : hr.inst_id;
+    auto const& tex = params.textures[mat_id];
+    float lod = texture_lod(params.tex_coords, hr, prim, ray, tex.width(), tex.height());
+    return C(tex2D(tex, coord, lod));
+}
+
+template <typename HR, typename Params>
+VSNRAY_FUNC
+inline typename Params::color_type get_tex_color(
+        HR const&                      hr,
+        Params const&                  params,
+        basic_ray<float> const&        ray,
+        std::integral_constant<int, 2> /* */
+        )
+{
+    return get_tex_color_lod(hr, params, ray, supports_lod<typename Params::texture_type>{});
+}
+
+template <typename HR, typename Params, typename Footprint>
+VSNRAY_FUNC
 inline typename Params::color_type get_tex_color(
         HR const&                      hr,
         Params const&                  params,
+        Footprint const&               footprint,
         std::integral_constant<int, 3> /* */
         )
 {
+    VSNRAY_UNUSED(footprint);
+
     using C = typename Params::color_type;
 
     auto coord = get_tex_coord(params.tex_coords, hr, get_primitive(params.prims.begin, hr));
@@ -129,10 +217,11 @@ inline typename Params::color_type get_tex_color(
 template <
     typename HR,
     typename Params,
+    typename Footprint,
     typename = typename std::enable_if<!simd::is_simd_vector<typename HR::scalar_type>::value>::type
     >
 VSNRAY_FUNC
-inline auto get_surface_impl(HR const& hr, Params const& params)
+inline auto get_surface_impl(HR const& hr, Params const& params, Footprint const& footprint)
     -> surface<
             typename Params::normal_type,
             typename Params::color_type,
@@ -152,6 +241,7 @@ inline auto get_surface_impl(HR const& hr, Params const& params)
     auto tc    = params.tex_coords && params.textures ? get_tex_color(
                         hr,
                         params,
+                        footprint,
                         std::integral_constant<int, texture_dimensions<typename Params::texture_type>::value>{}
                         ) : C(1.0);
 
@@ -167,22 +257,41 @@ inline auto get_surface_impl(HR const& hr, Params const& params)
 template <
     typename HR,
     typename Params,
+    typename Footprint,
     typename = typename std::enable_if<simd::is_simd_vector<typename HR::scalar_type>::value>::type
     >
 VSNRAY_FUNC
-inline auto get_surface_impl(HR const& hr, Params const& params)
+inline auto get_surface_impl(HR const& hr, Params const& params, Footprint const& footprint)
 {
     using T = typename HR::scalar_type;
 
     auto hrs = unpack(hr);
+    auto footprints = unpack_footprint<simd::num_elements<T>::value>(footprint);
+
+    typename simd_decl_surface<Params, T>::array_type surfs = {};
 
-    typename simd_decl_surface<Params, T>::array_type surfs;
+    int first_hit = -1;
 
     for (int i = 0; i < simd::num_elements<T>::value; ++i)
     {
         if (hrs[i].hit)
         {
-            surfs[i] = get_surface_impl(hrs[i], params);
+            surfs[i] = get_surface_impl(hrs[i], params, footprints[i]);
+
+            if (first_hit < 0)
+            {
+                first_hit = i;
+            }
+        }
+    }
+
+    // Lanes without a hit replicate the first hit, so that they don't
+    // add material types that generic materials have to dispatch on
+    for (int i = 0; i < simd::num_elements<T>::value && first_hit >= 0; ++i)
+    {
+        if (!hrs[i].hit)
+        {
+            surfs[i] = surfs[first_hit];
         }
     }
 
@@ -196,7 +305,23 @@ template <typename HR, typename Params>
 VSNRAY_FUNC
 inline auto get_surface(HR const& hr, Params const& p)
 {
-    return detail::get_surface_impl(hr, p);
+    return detail::get_surface_impl(hr, p, detail::no_footprint{});
+}
+
+// Select the texture level of detail w/ the ray cone of the ray that
+// produced the hit record
+template <typename HR, typename Params, typename T>
+VSNRAY_FUNC
+inline auto get_surface(HR const& hr, Params const& p, basic_ray<T> const& ray)
+{
+    if (p.tex_coords && p.textures)
+    {
+        return detail::get_surface_impl(hr, p, ray);
+    }
+    else
+    {
+        return detail::get_surface_impl(hr, p, detail::no_footprint{});
+    }
 }
 
 } // visionaray
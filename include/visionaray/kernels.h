@@ -13,6 +13,8 @@
 #include "math/vector.h"
 #include "prim_traits.h"
 #include "ambient_light.h"
+#include "aov.h"
+#include "light_selector.h"
 #include "tags.h"
 
 namespace visionaray
@@ -33,7 +35,9 @@ template <
     typename Textures,
     typename Lights,
     typename BackgroundLight,
-    typename AmbientLight
+    typename AmbientLight,
+    typename LightSelector = uniform_light_selector,
+    typename AOVParams = aov_params<aov::None>
     >
 struct kernel_params
 {
@@ -46,6 +50,7 @@ struct kernel_params
     using color_type        = typename std::iterator_traits<Colors>::value_type;
     using texture_type      = typename std::iterator_traits<Textures>::value_type;
     using light_type        = typename std::iterator_traits<Lights>::value_type;
+    using aov_params_type   = AOVParams;
 
     struct
     {
@@ -71,6 +76,12 @@ struct kernel_params
 
     BackgroundLight background;
     AmbientLight amb_light;
+
+    // Picks lights for next event estimation, see light_selector.h
+    LightSelector light_selector;
+
+    // AOV channels recorded by the kernels, see aov.h
+    AOVParams aovs;
 };
 
 
@@ -127,7 +138,9 @@ auto make_kernel_params(
         num_bounces,
         epsilon,
         bl,
-        al
+        al,
+        {}, // light selector
+        {}  // aovs
         };
 }
 
@@ -184,7 +197,9 @@ auto make_kernel_params(
         num_bounces,
         epsilon,
         bl,
-        al
+        al,
+        {}, // light selector
+        {}  // aovs
         };
 }
 
@@ -247,7 +262,9 @@ auto make_kernel_params(
         num_bounces,
         epsilon,
         bl,
-        al
+        al,
+        {}, // light selector
+        {}  // aovs
         };
 }
 
@@ -314,7 +331,9 @@ auto make_kernel_params(
         num_bounces,
         epsilon,
         bl,
-        al
+        al,
+        {}, // light selector
+        {}  // aovs
         };
 }
 
@@ -386,7 +405,9 @@ auto make_kernel_params(
         num_bounces,
         epsilon,
         bl,
-        al
+        al,
+        {}, // light selector
+        {}  // aovs
         };
 }
 
@@ -453,8 +474,164 @@ auto make_kernel_params(
         amb_light
         };
 }
+
+
+//-------------------------------------------------------------------------------------------------
+// Copy of params that picks lights for next event estimation with
+// light_selector (e.g. light_bvh_ref) instead of uniformly
+//
+
+template <
+    typename NormalBinding,
+    typename ColorBinding,
+    typename Primitives,
+    typename Normals,
+    typename TexCoords,
+    typename Materials,
+    typename Colors,
+    typename Textures,
+    typename Lights,
+    typename BackgroundLight,
+    typename AmbientLight,
+    typename LightSelector,
+    typename AOVParams,
+    typename NewLightSelector
+    >
+auto with_light_selector(
+        kernel_params<
+            NormalBinding,
+            ColorBinding,
+            Primitives,
+            Normals,
+            TexCoords,
+            Materials,
+            Colors,
+            Textures,
+            Lights,
+            BackgroundLight,
+            AmbientLight,
+            LightSelector,
+            AOVParams
+            > const&                params,
+        NewLightSelector const&     light_selector
+        )
+    -> kernel_params<
+        NormalBinding,
+        ColorBinding,
+        Primitives,
+        Normals,
+        TexCoords,
+        Materials,
+        Colors,
+        Textures,
+        Lights,
+        BackgroundLight,
+        AmbientLight,
+        NewLightSelector,
+        AOVParams
+        >
+{
+    return {
+        { params.prims.begin, params.prims.end },
+        params.geometric_normals,
+        params.shading_normals,
+        params.tex_coords,
+        params.materials,
+        params.colors,
+        params.textures,
+        { params.lights.begin, params.lights.end },
+        params.num_bounces,
+        params.epsilon,
+        params.background,
+        params.amb_light,
+        light_selector,
+        params.aovs
+        };
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Copy of params that makes the kernels record AOVs (see aov.h). Channels
+// is a combination of aov::channel flags. The view-projection matrices of
+// the current and the previous frame are only used for motion vectors
+//
+
+template <
+    unsigned Channels,
+    typename NormalBinding,
+    typename ColorBinding,
+    typename Primitives,
+    typename Normals,
+    typename TexCoords,
+    typename Materials,
+    typename Colors,
+    typename Textures,
+    typename Lights,
+    typename BackgroundLight,
+    typename AmbientLight,
+    typename LightSelector,
+    typename AOVParams
+    >
+auto with_aovs(
+        kernel_params<
+            NormalBinding,
+            ColorBinding,
+            Primitives,
+            Normals,
+            TexCoords,
+            Materials,
+            Colors,
+            Textures,
+            Lights,
+            BackgroundLight,
+            AmbientLight,
+            LightSelector,
+            AOVParams
+            > const&                params,
+        mat4 const&                 view_proj = mat4::identity(),
+        mat4 const&                 prev_view_proj = mat4::identity()
+        )
+    -> kernel_params<
+        NormalBinding,
+        ColorBinding,
+        Primitives,
+        Normals,
+        TexCoords,
+        Materials,
+        Colors,
+        Textures,
+        Lights,
+        BackgroundLight,
+        AmbientLight,
+        LightSelector,
+        aov_params<Channels>
+        >
+{
+    aov_params<Channels> aovs;
+    aovs.view_proj = view_proj;
+    aovs.prev_view_proj = prev_view_proj;
+
+    return {
+        { params.prims.begin, params.prims.end },
+        params.geometric_normals,
+        params.shading_normals,
+        params.tex_coords,
+        params.materials,
+        params.colors,
+        params.textures,
+        { params.lights.begin, params.lights.end },
+        params.num_bounces,
+        params.epsilon,
+        params.background,
+        params.amb_light,
+        params.light_selector,
+        aovs
+        };
+}
+
 } // visionaray
 
+#include "detail/ambient_occlusion.inl"
 #include "detail/pathtracing.inl"
 #include "detail/simple.inl"
 #include "detail/whitted.inl"
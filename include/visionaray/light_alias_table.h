@@ -0,0 +1,140 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_LIGHT_ALIAS_TABLE_H
+#define VSNRAY_LIGHT_ALIAS_TABLE_H 1
+
+#include <cstddef>
+#include <type_traits>
+
+#include "detail/macros.h"
+#include "math/simd/type_traits.h"
+#include "math/vector.h"
+#include "aligned_vector.h"
+#include "light_bvh.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Light selector that picks lights proportional to their power
+//
+// Uses an alias table (Walker 1977, Vose 1991), sampling is O(1) and
+// independent of the reference point. The power of a light is estimated
+// with get_light_bounds(), lights that cannot be bounded (e.g.
+// directional lights) are assigned the mean power of the other emitting
+// lights.
+// Does not own its data, use light_alias_table::ref().
+//
+
+class light_alias_table_ref
+{
+public:
+
+    light_alias_table_ref() = default;
+
+    light_alias_table_ref(
+            float const* prob,
+            int const*   alias,
+            float const* pmf,
+            int const*   emitter_geom_ids,
+            int const*   emitter_prim_ids,
+            int const*   emitter_lights,
+            int          num_lights,
+            int          num_emitters
+            );
+
+    // Light selector interface, see light_selector.h
+    VSNRAY_FUNC int sample(int num_lights, vec3 const& pos, vec3 const& n, float u, float& pmf) const;
+    VSNRAY_FUNC float emitter_pmf(int num_lights, vec3 const& pos, vec3 const& n, int geom_id, int prim_id) const;
+
+    // SIMD, one table lookup per lane with gather
+    template <
+        typename T,
+        typename = typename std::enable_if<simd::is_simd_vector<T>::value>::type
+        >
+    simd::int_type_t<T> sample(
+            int                     num_lights,
+            vector<3, T> const&     pos,
+            vector<3, T> const&     n,
+            T const&                u,
+            T&                      pmf
+            ) const;
+
+    template <
+        typename T,
+        typename I,
+        typename = typename std::enable_if<simd::is_simd_vector<T>::value>::type
+        >
+    T emitter_pmf(
+            int                     num_lights,
+            vector<3, T> const&     pos,
+            vector<3, T> const&     n,
+            I const&                geom_id,
+            I const&                prim_id
+            ) const;
+
+    // Probability that sample() picks the light
+    VSNRAY_FUNC float pmf(int light_id) const;
+
+private:
+
+    float const* prob_             = nullptr;
+    int const*   alias_            = nullptr;
+    float const* pmf_              = nullptr;
+    int const*   emitter_geom_ids_ = nullptr;
+    int const*   emitter_prim_ids_ = nullptr;
+    int const*   emitter_lights_   = nullptr;
+    int          num_lights_       = 0;
+    int          num_emitters_     = 0;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Light alias table
+//
+// Built over a list of lights (e.g. generic_light) on the host, light
+// indices refer to that list. The table must be rebuilt when lights are
+// added, removed or changed.
+//
+
+class light_alias_table
+{
+public:
+
+    light_alias_table() = default;
+
+    template <typename Lights>
+    light_alias_table(Lights begin, Lights end);
+
+    template <typename Lights>
+    void build(Lights begin, Lights end);
+
+    light_alias_table_ref ref() const;
+
+    size_t num_lights() const;
+
+private:
+
+    // Per bin
+    aligned_vector<float> prob_;
+    aligned_vector<int>   alias_;
+
+    // Per light
+    aligned_vector<float> pmf_;
+
+    // Area lights, sorted by (geom_id, prim_id)
+    aligned_vector<int>   emitter_geom_ids_;
+    aligned_vector<int>   emitter_prim_ids_;
+    aligned_vector<int>   emitter_lights_;
+
+};
+
+} // visionaray
+
+#include "detail/light_alias_table.inl"
+
+#endif // VSNRAY_LIGHT_ALIAS_TABLE_H
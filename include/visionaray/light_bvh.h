@@ -0,0 +1,204 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_LIGHT_BVH_H
+#define VSNRAY_LIGHT_BVH_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "detail/macros.h"
+#include "math/aabb.h"
+#include "math/forward.h"
+#include "math/vector.h"
+#include "aligned_vector.h"
+#include "area_light.h"
+#include "generic_light.h"
+#include "point_light.h"
+#include "spot_light.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Spatial and directional bounds of the emission of one or more lights
+//
+// Emitting normals are bounded by a cone (axis, theta_o), light is
+// emitted up to theta_e away from those normals. phi approximates the
+// emitted power.
+//
+
+struct light_bounds
+{
+    aabb  bounds;
+    vec3  axis;
+    float cos_theta_o;
+    float cos_theta_e;
+    float phi;
+    bool  two_sided;
+};
+
+// Returns false for lights that cannot be bounded (e.g. directional lights)
+template <typename L>
+inline bool get_light_bounds(L const& light, light_bounds& lb);
+
+template <typename T>
+inline bool get_light_bounds(point_light<T> const& light, light_bounds& lb);
+
+template <typename T>
+inline bool get_light_bounds(spot_light<T> const& light, light_bounds& lb);
+
+template <typename T, typename Geometry>
+inline bool get_light_bounds(area_light<T, Geometry> const& light, light_bounds& lb);
+
+template <typename T, typename P>
+inline bool get_light_bounds(area_light<T, basic_triangle<3, T, P>> const& light, light_bounds& lb);
+
+template <typename ...Ts>
+inline bool get_light_bounds(generic_light<Ts...> const& light, light_bounds& lb);
+
+// Geometry ids of area lights, returns false for other lights
+template <typename L>
+inline bool get_light_geometry_id(L const& light, int& geom_id, int& prim_id);
+
+template <typename T, typename Geometry>
+inline bool get_light_geometry_id(area_light<T, Geometry> const& light, int& geom_id, int& prim_id);
+
+template <typename ...Ts>
+inline bool get_light_geometry_id(generic_light<Ts...> const& light, int& geom_id, int& prim_id);
+
+
+//-------------------------------------------------------------------------------------------------
+// Light BVH node
+//
+// The first child of an inner node is stored right after the node,
+// index is the second child. For leaves, index is the light index.
+//
+
+struct light_bvh_node
+{
+    light_bounds bounds;
+    int index;
+    int is_leaf;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Per light info
+//
+
+struct light_bvh_light
+{
+    enum kind_type { NotSampled, InTree, Infinite };
+
+    // Branches (0: first, 1: second child) from the root to the leaf, LSB first
+    uint64_t bit_trail;
+    int kind;
+};
+
+struct light_bvh_emitter
+{
+    uint64_t key; // (geom_id << 32) | prim_id
+    int light_id;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Light selector that traverses a light BVH
+//
+// At each inner node, a child is picked with a probability that is
+// proportional to an estimate of its contribution to the reference
+// point (Conty Estevez and Kulla, "Importance Sampling of Many Lights
+// With Adaptive Tree Splitting", 2018). Lights that cannot be bounded
+// are picked uniformly, the BVH is treated like one more of them.
+// Does not own its data, use light_bvh::ref().
+//
+
+class light_bvh_ref
+{
+public:
+
+    light_bvh_ref() = default;
+
+    light_bvh_ref(
+            light_bvh_node const*    nodes,
+            light_bvh_light const*   lights,
+            int const*               infinite_lights,
+            light_bvh_emitter const* emitters,
+            int                      num_nodes,
+            int                      num_lights,
+            int                      num_infinite_lights,
+            int                      num_emitters
+            );
+
+    // Light selector interface, see light_selector.h
+    VSNRAY_FUNC int sample(int num_lights, vec3 const& pos, vec3 const& n, float u, float& pmf) const;
+    VSNRAY_FUNC float emitter_pmf(int num_lights, vec3 const& pos, vec3 const& n, int geom_id, int prim_id) const;
+
+    // Probability that sample() picks the light
+    VSNRAY_FUNC float pmf(vec3 const& pos, vec3 const& n, int light_id) const;
+
+private:
+
+    light_bvh_node const*    nodes_               = nullptr;
+    light_bvh_light const*   lights_              = nullptr;
+    int const*               infinite_lights_     = nullptr;
+    light_bvh_emitter const* emitters_            = nullptr;
+    int                      num_nodes_           = 0;
+    int                      num_lights_          = 0;
+    int                      num_infinite_lights_ = 0;
+    int                      num_emitters_        = 0;
+
+    VSNRAY_FUNC float infinite_probability() const;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Light BVH
+//
+// Built over a list of lights (e.g. generic_light) on the host, light
+// indices refer to that list. The BVH must be rebuilt when lights are
+// added, removed or changed.
+//
+
+class light_bvh
+{
+public:
+
+    light_bvh() = default;
+
+    template <typename Lights>
+    light_bvh(Lights begin, Lights end);
+
+    template <typename Lights>
+    void build(Lights begin, Lights end);
+
+    light_bvh_ref ref() const;
+
+    aligned_vector<light_bvh_node> const& nodes() const;
+    size_t num_nodes() const;
+    size_t num_lights() const;
+
+private:
+
+    using build_light = std::pair<int, light_bounds>;
+
+    aligned_vector<light_bvh_node>    nodes_;
+    aligned_vector<light_bvh_light>   lights_;
+    aligned_vector<int>               infinite_lights_;
+    aligned_vector<light_bvh_emitter> emitters_;
+
+    light_bounds build_recursive(std::vector<build_light>& lights, int first, int last, uint64_t bit_trail, int depth);
+
+};
+
+} // visionaray
+
+#include "detail/light_bvh.inl"
+
+#endif // VSNRAY_LIGHT_BVH_H
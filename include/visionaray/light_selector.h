@@ -0,0 +1,72 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_LIGHT_SELECTOR_H
+#define VSNRAY_LIGHT_SELECTOR_H 1
+
+#include "detail/macros.h"
+#include "math/vector.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Light selectors
+//
+// A light selector decides which light of a list of lights is sampled
+// for next event estimation at a reference point with normal n (n may
+// be the null vector). Selectors implement:
+//
+//  int sample(int num_lights, vec3 pos, vec3 n, float u, float& pmf) const
+//      Pick a light with u in [0..1), pmf is the probability to pick
+//      it. Returns -1 (and pmf = 0) if no light can be picked.
+//
+//  float emitter_pmf(int num_lights, vec3 pos, vec3 n, int geom_id, int prim_id) const
+//      Probability that sample() picks the area light with the given
+//      geometry, 0 if there is no such light. Kernels use this for the
+//      MIS weight of emissive surfaces hit by BRDF sampling.
+//
+// Selectors may additionally overload both functions for SIMD types
+// (vector<3, T> pos and n, T u and pmf, int_type_t<T> ids), otherwise
+// they are called once per lane.
+//
+// See sample_random_light() and light_selection_pmf() in sampling.h.
+//
+
+
+//-------------------------------------------------------------------------------------------------
+// Pick each light with the same probability
+//
+// Assumes that all emissive surfaces are light sources.
+//
+
+struct uniform_light_selector
+{
+    VSNRAY_FUNC
+    int sample(int num_lights, vec3 const& /* pos */, vec3 const& /* n */, float u, float& pmf) const
+    {
+        if (num_lights <= 0)
+        {
+            pmf = 0.0f;
+            return -1;
+        }
+
+        int light_id = static_cast<int>(u * num_lights);
+        light_id = light_id < num_lights ? light_id : num_lights - 1;
+
+        pmf = 1.0f / num_lights;
+        return light_id;
+    }
+
+    VSNRAY_FUNC
+    float emitter_pmf(int num_lights, vec3 const& /* pos */, vec3 const& /* n */, int /* geom_id */, int /* prim_id */) const
+    {
+        return num_lights > 0 ? 1.0f / num_lights : 0.0f;
+    }
+};
+
+} // visionaray
+
+#endif // VSNRAY_LIGHT_SELECTOR_H
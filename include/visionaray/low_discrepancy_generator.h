@@ -0,0 +1,212 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_LOW_DISCREPANCY_GENERATOR_H
+#define VSNRAY_LOW_DISCREPANCY_GENERATOR_H 1
+
+#include <type_traits>
+
+#include "detail/macros.h"
+#include "math/simd/type_traits.h"
+#include "array.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Low-discrepancy generators
+//
+// Drop-in replacements for random_generator that are selected with the
+// pixel sampler types (e.g. pixel_sampler::sobol_type). A generator is
+// constructed for one sample of one pixel; sample counts the samples
+// taken for that pixel (e.g. the frame number when frames are blended).
+// next() returns the next dimension of that sample point, so kernels
+// should consume the dimensions in the same order for every sample.
+//
+// sobol_generator:
+//      Sobol (0,2)-sequence w/ Owen scrambling and shuffling (Burley
+//      2020). Dimensions are padded: each pair of dimensions is an
+//      independently scrambled and shuffled 2D Sobol sequence.
+//
+// halton_generator:
+//      Halton sequence w/ Owen scrambling, dimension d uses the d-th
+//      prime as base. Scrambles are seeded per pixel and dimension, the
+//      first 64 bases are reused w/ other scrambles for higher dimensions.
+//
+// blue_noise_generator:
+//      Extensible rank-1 lattice sequence (Cools, Kuo and Nuyens 2006),
+//      toroidally shifted per pixel by values from a blue-noise mask
+//      (Georgiev and Fajardo 2016). The error is distributed as
+//      blue noise over the image. The mask is generated on the host at
+//      first use, this generator is not available in CUDA code.
+//
+
+template <typename T, typename = void>
+class sobol_generator
+{
+public:
+
+    using value_type = T;
+
+public:
+
+    sobol_generator() = default;
+
+    VSNRAY_FUNC sobol_generator(int x, int y, int sample);
+
+    VSNRAY_FUNC T next();
+
+private:
+
+    unsigned seed_   = 0;
+    unsigned sample_ = 0;
+    unsigned dim_    = 0;
+
+};
+
+template <typename T, typename = void>
+class halton_generator
+{
+public:
+
+    using value_type = T;
+
+public:
+
+    halton_generator() = default;
+
+    VSNRAY_FUNC halton_generator(int x, int y, int sample);
+
+    VSNRAY_FUNC T next();
+
+private:
+
+    unsigned seed_   = 0;
+    unsigned sample_ = 0;
+    unsigned dim_    = 0;
+
+};
+
+template <typename T, typename = void>
+class blue_noise_generator
+{
+public:
+
+    using value_type = T;
+
+public:
+
+    blue_noise_generator() = default;
+
+    blue_noise_generator(int x, int y, int sample);
+
+    T next();
+
+private:
+
+    int      x_      = 0;
+    int      y_      = 0;
+    unsigned sample_ = 0;
+    unsigned dim_    = 0;
+
+};
+
+
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// SIMD generators, one scalar generator per lane
+//
+
+template <typename Generator, typename T>
+class lane_generator
+{
+public:
+
+    using value_type = T;
+    using generator_type = Generator;
+    using int_type = simd::int_type_t<T>;
+
+public:
+
+    lane_generator() = default;
+
+    lane_generator(int_type const& x, int_type const& y, int_type const& sample)
+    {
+        simd::aligned_array_t<int_type> xs;
+        simd::aligned_array_t<int_type> ys;
+        simd::aligned_array_t<int_type> samples;
+
+        store(xs, x);
+        store(ys, y);
+        store(samples, sample);
+
+        for (int i = 0; i < simd::num_elements<T>::value; ++i)
+        {
+            generators_[i] = generator_type(xs[i], ys[i], samples[i]);
+        }
+    }
+
+    T next()
+    {
+        simd::aligned_array_t<T> arr;
+
+        for (int i = 0; i < simd::num_elements<T>::value; ++i)
+        {
+            arr[i] = generators_[i].next();
+        }
+
+        return T(arr);
+    }
+
+    generator_type& get_generator(unsigned i)
+    {
+        return generators_[i];
+    }
+
+private:
+
+    array<generator_type, simd::num_elements<T>::value> generators_;
+
+};
+
+} // detail
+
+template <typename T>
+class sobol_generator<T, typename std::enable_if<simd::is_simd_vector<T>::value>::type>
+    : public detail::lane_generator<sobol_generator<float>, T>
+{
+public:
+
+    using detail::lane_generator<sobol_generator<float>, T>::lane_generator;
+
+};
+
+template <typename T>
+class halton_generator<T, typename std::enable_if<simd::is_simd_vector<T>::value>::type>
+    : public detail::lane_generator<halton_generator<float>, T>
+{
+public:
+
+    using detail::lane_generator<halton_generator<float>, T>::lane_generator;
+
+};
+
+template <typename T>
+class blue_noise_generator<T, typename std::enable_if<simd::is_simd_vector<T>::value>::type>
+    : public detail::lane_generator<blue_noise_generator<float>, T>
+{
+public:
+
+    using detail::lane_generator<blue_noise_generator<float>, T>::lane_generator;
+
+};
+
+} // visionaray
+
+#include "detail/low_discrepancy_generator.inl"
+
+#endif // VSNRAY_LOW_DISCREPANCY_GENERATOR_H
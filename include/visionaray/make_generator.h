@@ -9,6 +9,8 @@
 #include <utility>
 
 #include "detail/macros.h"
+#include "low_discrepancy_generator.h"
+#include "make_random_seed.h"
 #include "pixel_sampler_types.h"
 #include "random_generator.h"
 
@@ -17,32 +19,92 @@ namespace visionaray
 namespace detail
 {
 
+// Generator for pixel samplers that do not need random numbers
+template <typename T>
+struct void_generator
+{
+    void_generator() = default;
+
+    template <typename ...Args>
+    VSNRAY_FUNC void_generator(Args...) {}
+
+    VSNRAY_FUNC T next() { return {}; }
+};
+
 template <typename T, typename U>
 struct make_generator_impl
 {
-    struct void_t
+    using generator_type = void_generator<T>;
+
+    template <typename I>
+    VSNRAY_FUNC
+    static generator_type make(I const& /* x */, I const& /* y */, int /* width */, I const& /* sample */)
     {
-        void_t() = default;
+        return {};
+    }
+};
+
+template <typename T>
+struct make_generator_impl<T, pixel_sampler::jittered_type>
+{
+    using generator_type = random_generator<T>;
 
-        template <typename ...Args>
-        VSNRAY_FUNC void_t(Args...) {}
+    template <typename I>
+    VSNRAY_FUNC
+    static generator_type make(I const& x, I const& y, int width, I const& sample)
+    {
+        return generator_type(make_random_seed(y * I(width) + x, sample));
+    }
+};
 
-        VSNRAY_FUNC T next() { return {}; }
-    };
+template <typename T>
+struct make_generator_impl<T, pixel_sampler::sobol_type>
+{
+    using generator_type = sobol_generator<T>;
 
-    using generator_type = void_t;
+    template <typename I>
+    VSNRAY_FUNC
+    static generator_type make(I const& x, I const& y, int /* width */, I const& sample)
+    {
+        return generator_type(x, y, sample);
+    }
 };
 
 template <typename T>
-struct make_generator_impl<T, pixel_sampler::jittered_type>
+struct make_generator_impl<T, pixel_sampler::halton_type>
 {
-    using generator_type = random_generator<T>;
+    using generator_type = halton_generator<T>;
+
+    template <typename I>
+    VSNRAY_FUNC
+    static generator_type make(I const& x, I const& y, int /* width */, I const& sample)
+    {
+        return generator_type(x, y, sample);
+    }
 };
 
-template <typename T, typename U>
-struct make_generator_impl<T, pixel_sampler::basic_jittered_blend_type<U>>
+template <typename T>
+struct make_generator_impl<T, pixel_sampler::blue_noise_type>
+{
+    using generator_type = blue_noise_generator<T>;
+
+    template <typename I>
+    static generator_type make(I const& x, I const& y, int /* width */, I const& sample)
+    {
+        return generator_type(x, y, sample);
+    }
+};
+
+template <typename T, typename U, typename Base>
+struct make_generator_impl<T, pixel_sampler::basic_jittered_blend_type<U, Base>>
+    : make_generator_impl<T, Base>
+{
+};
+
+template <typename T, typename U, typename Base>
+struct make_generator_impl<T, pixel_sampler::basic_adaptive_blend_type<U, Base>>
+    : make_generator_impl<T, Base>
 {
-    using generator_type = random_generator<T>;
 };
 
 } // detail
@@ -62,6 +124,24 @@ auto make_generator(T /* */, PixelSampler /* */, Args&&... args)
             );
 }
 
+
+//-------------------------------------------------------------------------------------------------
+// Number generator for one sample of pixel (x, y)
+//
+// sample counts the samples taken for the pixel, e.g. the frame number
+// when frames are blended. Pseudo random generators are seeded with a
+// hash of the pixel index and sample, low-discrepancy generators use
+// sample as the index into their sequence.
+//
+
+template <typename T, typename PixelSampler, typename I>
+VSNRAY_FUNC
+auto make_pixel_generator(T /* */, PixelSampler /* */, I const& x, I const& y, int width, I const& sample)
+    -> typename detail::make_generator_impl<T, PixelSampler>::generator_type
+{
+    return detail::make_generator_impl<T, PixelSampler>::make(x, y, width, sample);
+}
+
 } // visionaray
 
 #endif // VSNRAY_MAKE_GENERATOR_H
@@ -22,6 +22,11 @@ namespace visionaray
 //
 // Built-in and user-defined materials (must) support the following interface:
 //
+//  - albedo():
+//      return type:                    spectrum, the reflectance of the material (e.g.
+//                                      for the albedo AOV of the built-in kernels; only
+//                                      required when that AOV is rendered)
+//
 //  - shade():
 //      const parameter shade_record:   shading info (normal, texture color, ...)
 //      return type:                    spectrum
@@ -91,6 +96,7 @@ public:
 
 public:
 
+    VSNRAY_FUNC spectrum<T> albedo() const;
     VSNRAY_FUNC spectrum<T> ambient() const;
 
     template <typename SR>
@@ -142,6 +148,7 @@ public:
 
 public:
 
+    VSNRAY_FUNC spectrum<T> albedo() const;
     VSNRAY_FUNC spectrum<T> ambient() const;
 
     template <typename SR>
@@ -198,6 +205,7 @@ public:
 public:
 
     // TODO: no support for  ambient (function returns 0.0)
+    VSNRAY_FUNC spectrum<T> albedo() const;
     VSNRAY_FUNC spectrum<T> ambient() const;
 
     template <typename SR>
@@ -254,6 +262,7 @@ public:
 public:
 
     // TODO: no support for  ambient (function returns 0.0)
+    VSNRAY_FUNC spectrum<T> albedo() const;
     VSNRAY_FUNC spectrum<T> ambient() const;
 
     template <typename SR>
@@ -310,6 +319,7 @@ public:
 public:
 
     // TODO: no support for  ambient (function returns 0.0)
+    VSNRAY_FUNC spectrum<T> albedo() const;
     VSNRAY_FUNC spectrum<T> ambient() const;
 
     template <typename SR>
@@ -373,6 +383,7 @@ public:
 
 public:
 
+    VSNRAY_FUNC spectrum<T> albedo() const;
     VSNRAY_FUNC spectrum<T> ambient() const;
 
     template <typename SR>
@@ -0,0 +1,152 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cstring>
+
+#if defined(__F16C__) && !defined(__CUDA_ARCH__)
+#include <immintrin.h>
+#endif
+
+namespace MATH_NAMESPACE
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Convert float to half and vice versa
+// Software versions for hardware w/o conversion instructions, cf.
+// https://gist.github.com/rygorous/2156668
+//
+
+MATH_FUNC
+inline uint16_t float_to_half_soft(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+
+    uint32_t sign = u & 0x80000000U;
+    u ^= sign;
+
+    uint32_t result = 0;
+
+    if (u >= ((127U + 16U) << 23)) // Inf or NaN (all exponent bits set)
+    {
+        result = u > (255U << 23) ? 0x7E00U : 0x7C00U;
+    }
+    else if (u < (113U << 23)) // Subnormal or zero
+    {
+        // Align the 10 mantissa bits at the bottom of a float, the addition
+        // rounds to nearest even
+        uint32_t magic_u = ((127U - 15U) + (23U - 10U) + 1U) << 23;
+        float magic;
+        memcpy(&magic, &magic_u, sizeof(magic));
+
+        float tmp;
+        memcpy(&tmp, &u, sizeof(tmp));
+        tmp += magic;
+        memcpy(&u, &tmp, sizeof(u));
+
+        result = u - magic_u;
+    }
+    else
+    {
+        uint32_t mant_odd = (u >> 13) & 1U;
+
+        // Update exponent, round to nearest even
+        u += ((15U - 127U) << 23) + 0xFFFU;
+        u += mant_odd;
+
+        result = u >> 13;
+    }
+
+    return static_cast<uint16_t>(result | (sign >> 16));
+}
+
+MATH_FUNC
+inline float half_to_float_soft(uint16_t h)
+{
+    uint32_t const shifted_exp = 0x7C00U << 13;
+
+    uint32_t u = (h & 0x7FFFU) << 13;
+    uint32_t exp = u & shifted_exp;
+    u += (127U - 15U) << 23;
+
+    float f;
+
+    if (exp == shifted_exp) // Inf or NaN
+    {
+        u += (128U - 16U) << 23;
+        memcpy(&f, &u, sizeof(f));
+    }
+    else if (exp == 0) // Subnormal or zero, renormalize
+    {
+        u += 1U << 23;
+        memcpy(&f, &u, sizeof(f));
+
+        uint32_t magic_u = 113U << 23;
+        float magic;
+        memcpy(&magic, &magic_u, sizeof(magic));
+        f -= magic;
+    }
+    else
+    {
+        memcpy(&f, &u, sizeof(f));
+    }
+
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000U) << 16;
+    memcpy(&u, &f, sizeof(u));
+    u |= sign;
+    memcpy(&f, &u, sizeof(f));
+
+    return f;
+}
+
+MATH_FUNC
+inline uint16_t float_to_half(float f)
+{
+#if defined(__F16C__) && !defined(__CUDA_ARCH__)
+    return static_cast<uint16_t>(_cvtss_sh(f, 0 /* round to nearest even */));
+#elif defined(__aarch64__) && !defined(__CUDA_ARCH__)
+    __fp16 h = static_cast<__fp16>(f);
+    uint16_t u;
+    memcpy(&u, &h, sizeof(u));
+    return u;
+#else
+    return float_to_half_soft(f);
+#endif
+}
+
+MATH_FUNC
+inline float half_to_float(uint16_t h)
+{
+#if defined(__F16C__) && !defined(__CUDA_ARCH__)
+    return _cvtsh_ss(h);
+#elif defined(__aarch64__) && !defined(__CUDA_ARCH__)
+    __fp16 f;
+    memcpy(&f, &h, sizeof(f));
+    return static_cast<float>(f);
+#else
+    return half_to_float_soft(h);
+#endif
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// half members
+//
+
+MATH_FUNC
+inline half::half(float f)
+    : value(detail::float_to_half(f))
+{
+}
+
+MATH_FUNC
+inline half::operator float() const
+{
+    return detail::half_to_float(value);
+}
+
+} // MATH_NAMESPACE
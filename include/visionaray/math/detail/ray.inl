@@ -67,6 +67,9 @@ inline auto pack(array<basic_ray<T>, N> const& rays)
     float_array tmin;
     float_array tmax;
 
+    float_array cone_width;
+    float_array cone_spread;
+
     for (size_t i = 0; i < N; ++i)
     {
         ori_x[i] = rays[i].ori.x;
@@ -79,14 +82,22 @@ inline auto pack(array<basic_ray<T>, N> const& rays)
 
         tmin[i] = rays[i].tmin;
         tmax[i] = rays[i].tmax;
+
+        cone_width[i] = rays[i].cone_width;
+        cone_spread[i] = rays[i].cone_spread;
     }
 
-    return basic_ray<U>(
+    basic_ray<U> result(
             vector<3, U>(ori_x, ori_y, ori_z),
             vector<3, U>(dir_x, dir_y, dir_z),
             tmin,
             tmax
             );
+
+    result.cone_width = U(cone_width);
+    result.cone_spread = U(cone_spread);
+
+    return result;
 }
 
 // pack four rays
@@ -147,6 +158,9 @@ inline auto unpack(basic_ray<FloatT> const& ray)
     float_array tmin;
     float_array tmax;
 
+    float_array cone_width;
+    float_array cone_spread;
+
     store(ori_x, ray.ori.x);
     store(ori_y, ray.ori.y);
     store(ori_z, ray.ori.z);
@@ -158,6 +172,9 @@ inline auto unpack(basic_ray<FloatT> const& ray)
     store(tmin, ray.tmin);
     store(tmax, ray.tmax);
 
+    store(cone_width, ray.cone_width);
+    store(cone_spread, ray.cone_spread);
+
     array<basic_ray<float>, num_elements<FloatT>::value> result;
 
     for (int i = 0; i < num_elements<FloatT>::value; ++i)
@@ -172,6 +189,9 @@ inline auto unpack(basic_ray<FloatT> const& ray)
 
         result[i].tmin = tmin[i];
         result[i].tmax = tmax[i];
+
+        result[i].cone_width = cone_width[i];
+        result[i].cone_spread = cone_spread[i];
     }
 
     return result;
@@ -25,6 +25,8 @@ namespace MATH_NAMESPACE
 template <size_t Dim>
 class cartesian_axis;
 
+class half;
+
 template <unsigned Bits>
 class snorm;
 
@@ -0,0 +1,46 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_MATH_HALF_H
+#define VSNRAY_MATH_HALF_H 1
+
+#include <cstdint>
+
+#include "config.h"
+
+namespace MATH_NAMESPACE
+{
+
+//-------------------------------------------------------------------------------------------------
+// half
+//
+// IEEE 754 binary16 storage type: 1 sign bit, 5 exponent bits, 10 mantissa
+// bits. Arithmetic is performed in float, floats are rounded to the nearest
+// half (ties to even). Conversions use F16C (x86) or __fp16 (AArch64) when
+// available, see simd/half.h for SIMD conversions
+//
+
+class half
+{
+public:
+
+    using value_type = uint16_t;
+
+public:
+
+    value_type value;
+
+    half() = default;
+
+    MATH_FUNC /* implicit */ half(float f);
+
+    MATH_FUNC operator float() const;
+};
+
+} // MATH_NAMESPACE
+
+#include "detail/half.inl"
+
+#endif // VSNRAY_MATH_HALF_H
@@ -15,6 +15,7 @@
 #include "coordinates.h"
 #include "cylinder.h"
 #include "fixed.h"
+#include "half.h"
 #include "intersect.h"
 #include "interval.h"
 #include "io.h"
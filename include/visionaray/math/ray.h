@@ -28,6 +28,12 @@ public:
     T tmin;
     T tmax;
 
+    // Ray cone for texture level of detail selection (see ray_cone.h):
+    // width of the cone at the origin and spread angle in radians. Rays
+    // w/o a cone have no footprint and sample the finest level
+    T cone_width  = T(0.0);
+    T cone_spread = T(0.0);
+
     basic_ray() = default;
 
     // Constructor with origin and direction, tmin is 0.0 and tmax is
@@ -35,6 +35,7 @@ public:
     MATH_FUNC basic_float(float x, float y, float z, float w);
     MATH_FUNC basic_float(float const v[4]);
     MATH_FUNC basic_float(float s);
+    MATH_FUNC basic_float(basic_int<int[4]> const& i);
 };
 
 
@@ -116,6 +117,7 @@ public:
             );
     MATH_FUNC basic_float(float const v[8]);
     MATH_FUNC basic_float(float s);
+    MATH_FUNC basic_float(basic_int<int[8]> const& i);
 };
 
 
@@ -211,6 +213,7 @@ public:
             );
     MATH_FUNC basic_float(float const v[16]);
     MATH_FUNC basic_float(float s);
+    MATH_FUNC basic_float(basic_int<int[16]> const& i);
 };
 
 
@@ -324,7 +324,7 @@ VSNRAY_FORCE_INLINE int8 max(int8 const& u, int8 const& v)
 #if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX2)
     return _mm256_max_epi32(u, v);
 #else
-    return select(mask8(u < v), u, v);
+    return select(mask8(u < v), v, u);
 #endif
 }
 
@@ -252,6 +252,11 @@ VSNRAY_FORCE_INLINE float16 abs(float16 const& u)
     return _mm512_castsi512_ps(a);
 }
 
+VSNRAY_FORCE_INLINE float16 round(float16 const& v)
+{
+    return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEAREST_INT);
+}
+
 VSNRAY_FORCE_INLINE float16 ceil(float16 const& v)
 {
     return _mm512_ceil_ps(v);
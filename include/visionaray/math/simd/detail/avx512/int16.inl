@@ -240,5 +240,20 @@ VSNRAY_FORCE_INLINE mask16 operator!=(int16 const& u, int16 const& v)
     return !(u == v);
 }
 
+
+//-------------------------------------------------------------------------------------------------
+// Math functions
+//
+
+VSNRAY_FORCE_INLINE int16 min(int16 const& u, int16 const& v)
+{
+    return _mm512_min_epi32(u, v);
+}
+
+VSNRAY_FORCE_INLINE int16 max(int16 const& u, int16 const& v)
+{
+    return _mm512_max_epi32(u, v);
+}
+
 } // simd
 } // MATH_NAMESPACE
@@ -45,6 +45,15 @@ VSNRAY_FORCE_INLINE float16::basic_float(float s)
 {
 }
 
+MATH_FUNC
+VSNRAY_FORCE_INLINE float16::basic_float(basic_int<int[16]> const& i)
+{
+    for (int n = 0; n < 16; ++n)
+    {
+        value[n] = static_cast<float>(i.value[n]);
+    }
+}
+
 
 //-------------------------------------------------------------------------------------------------
 // Bitwise cast
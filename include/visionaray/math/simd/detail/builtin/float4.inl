@@ -30,6 +30,15 @@ VSNRAY_FORCE_INLINE float4::basic_float(float s)
 {
 }
 
+MATH_FUNC
+VSNRAY_FORCE_INLINE float4::basic_float(basic_int<int[4]> const& i)
+{
+    for (int n = 0; n < 4; ++n)
+    {
+        value[n] = static_cast<float>(i.value[n]);
+    }
+}
+
 
 //-------------------------------------------------------------------------------------------------
 // Bitwise cast
@@ -39,6 +39,15 @@ VSNRAY_FORCE_INLINE float8::basic_float(float s)
 {
 }
 
+MATH_FUNC
+VSNRAY_FORCE_INLINE float8::basic_float(basic_int<int[8]> const& i)
+{
+    for (int n = 0; n < 8; ++n)
+    {
+        value[n] = static_cast<float>(i.value[n]);
+    }
+}
+
 
 //-------------------------------------------------------------------------------------------------
 // Bitwise cast
@@ -19,10 +19,13 @@
 #include "avx.h"
 #include "avx512.h"
 #include "builtin.h"
+#include "half.h"
 #include "neon.h"
 #include "sse.h"
+#include "type_traits.h"
 
 // Insert math headers after platform headers to inhibit ADL!
+#include "../half.h"
 #include "../norm.h"
 #include "../vector.h"
 
@@ -46,6 +49,7 @@ namespace simd
 //  - base address: float,               index type: int4
 //  - base address: float,               index type: int8
 //  - base address: float,               index type: int16
+//  - base address: half,                index type: int4|int8|int16
 //  - base address: Int,                 index type: int4
 //  - base address: Int,                 index type: int8
 //  - base address: Int,                 index type: int16
@@ -59,6 +63,7 @@ namespace simd
 //  - base address: vector<N, unorm<M>>, index type: int4
 //  - base address: vector<N, unorm<M>>, index type: int8
 //  - base address: vector<N, unorm<M>>, index type: int16
+//  - base address: vector<N, half>,     index type: int4|int8|int16
 //  - base address: vector<N, Int>>,     index type: int4
 //  - base address: vector<N, Int>>,     index type: int8
 //  - base address: vector<N, Int>>,     index type: int16
@@ -806,6 +811,49 @@ VSNRAY_FORCE_INLINE vector<Dim, float16> gather(vector<Dim, unorm<Bits>> const*
     return simd::pack(arr);
 }
 
+
+//-------------------------------------------------------------------------------------------------
+// Gather float{4|8|16} from half array
+// Gathers the 16-bit patterns, then converts w/ F16C or AVX-512F if available
+//
+
+template <
+    typename I,
+    typename = typename std::enable_if<is_simd_vector<I>::value>::type
+    >
+VSNRAY_FORCE_INLINE float_type_t<I> gather(half const* base_addr, I const& index)
+{
+    return half_to_float(gather(reinterpret_cast<uint16_t const*>(base_addr), index));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Gather vector<Dim, float{4|8|16}> from vector<Dim, half> array
+// Gathers and converts one channel at a time
+//
+
+template <
+    size_t Dim,
+    typename I,
+    typename = typename std::enable_if<is_simd_vector<I>::value>::type
+    >
+VSNRAY_FORCE_INLINE vector<Dim, float_type_t<I>> gather(vector<Dim, half> const* base_addr, I const& index)
+{
+    static_assert(sizeof(vector<Dim, half>) == Dim * sizeof(half), "Type mismatch");
+
+    auto channels = reinterpret_cast<uint16_t const*>(base_addr);
+    I channel_index = index * I(static_cast<int>(Dim));
+
+    vector<Dim, float_type_t<I>> result;
+
+    for (size_t d = 0; d < Dim; ++d)
+    {
+        result[d] = half_to_float(gather(channels + d, channel_index));
+    }
+
+    return result;
+}
+
 } // simd
 } // MATH_NAMESPACE
 
@@ -0,0 +1,173 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_MATH_SIMD_HALF_H
+#define VSNRAY_MATH_SIMD_HALF_H 1
+
+#include <type_traits>
+
+#include "../detail/math.h"
+#include "avx.h"
+#include "avx512.h"
+#include "builtin.h"
+#include "neon.h"
+#include "sse.h"
+#include "type_traits.h"
+
+namespace MATH_NAMESPACE
+{
+namespace simd
+{
+
+//-------------------------------------------------------------------------------------------------
+// Convert between floats and half precision bit patterns (stored in the
+// lower 16 bits of each int lane). Rounds to nearest even
+//
+// Uses F16C, AVX-512F or NEON instructions when applicable and resorts to
+// a software implementation (cf. math/detail/half.inl) otherwise
+//
+
+template <
+    typename I,
+    typename = typename std::enable_if<is_simd_vector<I>::value>::type
+    >
+VSNRAY_FORCE_INLINE float_type_t<I> half_to_float(I const& h)
+{
+    using F = float_type_t<I>;
+
+    I const shifted_exp(0x7C00 << 13);
+
+    I u = (h & I(0x7FFF)) << 13;
+    I exp = u & shifted_exp;
+    u = u + I((127 - 15) << 23);
+
+    // Inf or NaN
+    u = select(exp == shifted_exp, u + I((128 - 16) << 23), u);
+
+    // Subnormal or zero, renormalize
+    F f = select(
+            exp == I(0),
+            reinterpret_as_float(u + I(1 << 23)) - reinterpret_as_float(I(113 << 23)),
+            reinterpret_as_float(u)
+            );
+
+    return reinterpret_as_float(reinterpret_as_int(f) | ((h & I(0x8000)) << 16));
+}
+
+template <
+    typename F,
+    typename = typename std::enable_if<is_simd_vector<F>::value>::type
+    >
+VSNRAY_FORCE_INLINE int_type_t<F> float_to_half(F const& f)
+{
+    using I = int_type_t<F>;
+
+    I u = reinterpret_as_int(f);
+    I sign = (u >> 16) & I(0x8000);
+    u = u & I(0x7FFFFFFF);
+
+    // Inf or NaN
+    I inf_nan = select(u > I(255 << 23), I(0x7E00), I(0x7C00));
+
+    // Subnormal or zero, the addition rounds to nearest even
+    F magic = reinterpret_as_float(I(((127 - 15) + (23 - 10) + 1) << 23));
+    I subnormal = reinterpret_as_int(reinterpret_as_float(u) + magic) - reinterpret_as_int(magic);
+
+    // Normalized, update exponent and round to nearest even
+    I mant_odd = (u >> 13) & I(1);
+    I normal = ((u - I(112 << 23) + I(0xFFF) + mant_odd) >> 13) & I(0xFFFF);
+
+    I result = select(
+            u >= I((127 + 16) << 23),
+            inf_nan,
+            select(u < I(113 << 23), subnormal, normal)
+            );
+
+    return result | sign;
+}
+
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX) && defined(__F16C__)
+
+VSNRAY_FORCE_INLINE float4 half_to_float(int4 const& h)
+{
+    return _mm_cvtph_ps(_mm_packus_epi32(h, h));
+}
+
+VSNRAY_FORCE_INLINE int4 float_to_half(float4 const& f)
+{
+    return _mm_cvtepu16_epi32(_mm_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+}
+
+VSNRAY_FORCE_INLINE float8 half_to_float(int8 const& h)
+{
+    __m128i lo = _mm256_castsi256_si128(h);
+    __m128i hi = _mm256_extractf128_si256(h, 1);
+    return _mm256_cvtph_ps(_mm_packus_epi32(lo, hi));
+}
+
+VSNRAY_FORCE_INLINE int8 float_to_half(float8 const& f)
+{
+    __m128i h = _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT);
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX2)
+    return _mm256_cvtepu16_epi32(h);
+#else
+    return _mm256_insertf128_si256(
+            _mm256_castsi128_si256(_mm_cvtepu16_epi32(h)),
+            _mm_cvtepu16_epi32(_mm_unpackhi_epi64(h, h)),
+            1
+            );
+#endif
+}
+
+#endif
+
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX512F)
+
+VSNRAY_FORCE_INLINE float16 half_to_float(int16 const& h)
+{
+    return _mm512_cvtph_ps(_mm512_cvtepi32_epi16(h));
+}
+
+VSNRAY_FORCE_INLINE int16 float_to_half(float16 const& f)
+{
+    return _mm512_cvtepu16_epi32(_mm512_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+}
+
+#endif
+
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_NEON_FP) && defined(__aarch64__)
+
+VSNRAY_FORCE_INLINE float4 half_to_float(int4 const& h)
+{
+    return vcvt_f32_f16(vreinterpret_f16_u16(vmovn_u32(vreinterpretq_u32_s32(h))));
+}
+
+VSNRAY_FORCE_INLINE int4 float_to_half(float4 const& f)
+{
+    return vreinterpretq_s32_u32(vmovl_u16(vreinterpret_u16_f16(vcvt_f16_f32(f))));
+}
+
+VSNRAY_FORCE_INLINE float8 half_to_float(int8 const& h)
+{
+    return float8(
+            half_to_float(int4(h.value[0])).value,
+            half_to_float(int4(h.value[1])).value
+            );
+}
+
+VSNRAY_FORCE_INLINE int8 float_to_half(float8 const& f)
+{
+    return int8(
+            float_to_half(float4(f.value[0])).value,
+            float_to_half(float4(f.value[1])).value
+            );
+}
+
+#endif
+
+} // simd
+} // MATH_NAMESPACE
+
+#endif // VSNRAY_MATH_SIMD_HALF_H
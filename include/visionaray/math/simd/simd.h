@@ -11,6 +11,7 @@
 #include "builtin.h"
 #include "forward.h"
 #include "gather.h"
+#include "half.h"
 #include "neon.h"
 #include "sse.h"
 #include "trans.h"
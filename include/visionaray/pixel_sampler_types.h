@@ -56,9 +56,21 @@ struct uniform_type : base_type
 // Jittered pixel positions
 struct jittered_type : base_type {};
 
-// Jittered and successive blending
-template <typename T>
-struct basic_jittered_blend_type : jittered_type
+// Jittered pixel positions, pixel positions and kernel samples are
+// taken from low-discrepancy sequences instead of a pseudo RNG (see
+// low_discrepancy_generator.h)
+struct sobol_type : jittered_type {};
+struct halton_type : jittered_type {};
+struct blue_noise_type : jittered_type {};
+
+// Jittered and successive blending, Base selects the sample sequence.
+// Blending w/ sfactor = 1/n into a PF_RGBA16F accumulation buffer stops
+// converging once the samples differ from the mean by less than n / 4096
+// to n / 2048 (relative), i.e. after ~1000 frames for noise of 25%. Use
+// PF_RGBA32F accumulation buffers and a PF_RGBA16F color buffer to
+// accumulate more frames
+template <typename T, typename Base = jittered_type>
+struct basic_jittered_blend_type : Base
 {
     unsigned spp = 1;
 
@@ -66,7 +78,29 @@ struct basic_jittered_blend_type : jittered_type
     T dfactor;
 };
 
-using jittered_blend_type = basic_jittered_blend_type<float>;
+using jittered_blend_type   = basic_jittered_blend_type<float>;
+using sobol_blend_type      = basic_jittered_blend_type<float, sobol_type>;
+using halton_blend_type     = basic_jittered_blend_type<float, halton_type>;
+using blue_noise_blend_type = basic_jittered_blend_type<float, blue_noise_type>;
+
+// Jittered and successive blending w/ adaptive sample counts. Samples are
+// averaged w/ per-pixel counts in the accum buffer, the render target's
+// moments buffer tracks the relative error of each pixel's mean. CPU
+// schedulers skip tiles whose pixels all have min_samples samples and a
+// relative error below threshold. Clear the accum buffer to start over.
+template <typename T, typename Base = jittered_type>
+struct basic_adaptive_blend_type : Base
+{
+    unsigned spp = 1;
+
+    // Relative standard error of the mean luminance
+    T threshold = T(0.01);
+
+    // Samples per pixel before a pixel may be considered converged
+    unsigned min_samples = 16;
+};
+
+using adaptive_blend_type   = basic_adaptive_blend_type<float>;
 
 } // pixel_sampler
 } // visionaray
@@ -6,6 +6,7 @@
 #ifndef VSNRAY_PIXEL_TRAITS_H
 #define VSNRAY_PIXEL_TRAITS_H 1
 
+#include "math/half.h"
 #include "math/unorm.h"
 #include "math/vector.h"
 #include "pixel_format.h"
@@ -42,6 +43,30 @@ struct pixel_traits<PF_RGBA8>
     typedef vector<4, unorm< 8>> type;
 };
 
+template <>
+struct pixel_traits<PF_R16F>
+{
+    typedef half type;
+};
+
+template <>
+struct pixel_traits<PF_RG16F>
+{
+    typedef vector<2, half> type;
+};
+
+template <>
+struct pixel_traits<PF_RGB16F>
+{
+    typedef vector<3, half> type;
+};
+
+template <>
+struct pixel_traits<PF_RGBA16F>
+{
+    typedef vector<4, half> type;
+};
+
 template <>
 struct pixel_traits<PF_R32F>
 {
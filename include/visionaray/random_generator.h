@@ -8,21 +8,66 @@
 
 #include <type_traits>
 
-#if defined(__CUDACC__)
-#include <thrust/random.h>
-#else
-#include <random>
-#endif
-
 #include "detail/macros.h"
 #include "math/simd/type_traits.h"
 #include "array.h"
 
 namespace visionaray
 {
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Integer hash (lowbias32, Chris Wellons) used by random_generator
+//
+// The SIMD overload only uses 32-bit integer add, mul, xor and shifts.
+// Right shifts are masked because operator>> is arithmetic for some of
+// the simd int types.
+//
+
+VSNRAY_FUNC
+inline unsigned random_hash(unsigned x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+template <typename I>
+VSNRAY_FUNC
+inline I random_shift_right(I const& x, int count)
+{
+    return (x >> count) & I(static_cast<int>(0xFFFFFFFFu >> count));
+}
+
+template <typename I>
+VSNRAY_FUNC
+inline I random_hash(I x)
+{
+    x = x ^ random_shift_right(x, 16);
+    x = x * I(static_cast<int>(0x7FEB352Du));
+    x = x ^ random_shift_right(x, 15);
+    x = x * I(static_cast<int>(0x846CA68Bu));
+    x = x ^ random_shift_right(x, 16);
+    return x;
+}
+
+// Weyl sequence increment (golden ratio)
+enum { RandomIncrement = 0x9E3779B9u };
+
+} // detail
+
 
 //-------------------------------------------------------------------------------------------------
-// random_generator classes, uses a standard pseudo RNG to generate samples
+// random_generator classes, counter-based pseudo RNG
+//
+// The state is a 32-bit counter that is advanced by a Weyl sequence
+// increment, next() returns the hashed counter (cf. SplitMix). The seed
+// is hashed to obtain the initial counter, so consecutive seeds yield
+// decorrelated sequences. The sequence of a generator has period 2^32.
 //
 
 template <typename T, typename = void>
@@ -34,45 +79,53 @@ public:
 
 public:
 
-#if defined(__CUDACC__)
-    typedef thrust::default_random_engine rand_engine;
-    typedef thrust::uniform_real_distribution<T> uniform_dist;
-#else
-    typedef std::default_random_engine rand_engine;
-    typedef std::uniform_real_distribution<T> uniform_dist;
-#endif
-
     random_generator() = default;
 
     VSNRAY_FUNC random_generator(unsigned seed)
-        : rng_(rand_engine(seed))
-        , dist_(uniform_dist(0, 1))
+        : state_(detail::random_hash(seed))
     {
     }
 
     VSNRAY_FUNC T next()
     {
-        return dist_(rng_);
+        state_ += detail::RandomIncrement;
+
+        // 24 bits, uniform in [0..1)
+        return T(detail::random_hash(state_) >> 8) * T(1.0 / 16777216.0);
     }
 
 private:
 
-    rand_engine  rng_;
-    uniform_dist dist_;
+    unsigned state_ = 0;
 
 };
 
+
+//-------------------------------------------------------------------------------------------------
+// SIMD random_generator
+//
+// Lane i produces the same sequence as the scalar generator seeded with
+// seed[i]. The scalar generators of the lanes are stored contiguously and
+// aligned, next() loads their states as one int vector and advances all
+// lanes with integer SIMD ops.
+//
+
 template <typename T>
 class random_generator<T, typename std::enable_if<simd::is_simd_vector<T>::value>::type>
 {
 public:
 
     using value_type = T;
+    using int_type = simd::int_type_t<T>;
 
 public:
 
     typedef random_generator<float> generator_type;
 
+    static_assert(sizeof(generator_type) == sizeof(int), "Size mismatch");
+
+    random_generator() = default;
+
     VSNRAY_FUNC random_generator(array<unsigned, simd::num_elements<value_type>::value> const& seed)
     {
         for (int i = 0; i < simd::num_elements<value_type>::value; ++i)
@@ -83,17 +136,17 @@ public:
 
     VSNRAY_FUNC value_type next()
     {
-        simd::aligned_array_t<value_type> arr;
+        int* states = reinterpret_cast<int*>(generators_.data());
 
-        for (int i = 0; i < simd::num_elements<value_type>::value; ++i)
-        {
-            arr[i] = generators_[i].next();
-        }
+        int_type state(states);
+        state = state + int_type(static_cast<int>(detail::RandomIncrement));
+        store(states, state);
 
-        return value_type(arr);
+        // 24 bits, uniform in [0..1)
+        int_type bits = detail::random_shift_right(detail::random_hash(state), 8);
+        return convert_to_float(bits) * value_type(1.0f / 16777216.0f);
     }
 
-    // TODO: maybe don't have a random_generatorN at all?
     VSNRAY_FUNC generator_type& get_generator(unsigned i)
     {
         return generators_[i];
@@ -101,7 +154,7 @@ public:
 
 private:
 
-    array<generator_type, simd::num_elements<value_type>::value> generators_;
+    alignas(int_type) array<generator_type, simd::num_elements<value_type>::value> generators_;
 
 };
 
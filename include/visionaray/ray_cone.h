@@ -0,0 +1,123 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_RAY_CONE_H
+#define VSNRAY_RAY_CONE_H 1
+
+#include "detail/macros.h"
+#include "math/detail/math.h"
+#include "math/ray.h"
+#include "math/triangle.h"
+#include "math/vector.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Ray cones for texture level of detail selection
+//
+// From: Akenine-Moeller et al.: Texture Level of Detail Strategies for
+// Real-Time Ray Tracing (Ray Tracing Gems, 2019)
+//
+// A ray cone approximates the footprint of a pixel along a ray and is
+// stored w/ the ray (basic_ray::cone_width and cone_spread). Cameras
+// start the cone w/ the spread angle of one pixel, the width grows
+// linearly w/ the distance traveled. Kernels propagate the cone to the
+// hit point before a ray is continued from there. The mip level at a
+// hit is
+//
+//   lod = 0.5 * log2(texel area / surface area) + log2(width / |cos(theta)|)
+//
+// where the area ratio is a constant per triangle.
+//
+
+// Width of the cone at distance t along the ray
+template <typename T>
+VSNRAY_FUNC
+inline T cone_width(basic_ray<T> const& ray, T const& t)
+{
+    return ray.cone_width + ray.cone_spread * t;
+}
+
+// Propagate the cone to a hit at distance t, call this before the ray is
+// continued from the hit point. surface_spread widens (or, if negative,
+// narrows) the cone, e.g. to account for curvature or rough surfaces
+template <typename T>
+VSNRAY_FUNC
+inline void propagate_cone(basic_ray<T>& ray, T const& t, T const& surface_spread = T(0.0))
+{
+    ray.cone_width = cone_width(ray, t);
+    ray.cone_spread += surface_spread;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Texture level of detail for a ray hitting a primitive
+//
+// Returns lod 0 for rays w/o a cone and primitives w/o per-vertex texture
+// coordinates. Negative values denote magnification, texture fetches
+// clamp the lod to the available mip levels.
+//
+
+template <typename TexCoords, typename HR, typename Primitive>
+VSNRAY_FUNC
+inline float texture_lod(
+        TexCoords               tex_coords,
+        HR const&               hr,
+        Primitive const&        prim,
+        basic_ray<float> const& ray,
+        unsigned                tex_width,
+        unsigned                tex_height
+        )
+{
+    VSNRAY_UNUSED(tex_coords);
+    VSNRAY_UNUSED(hr);
+    VSNRAY_UNUSED(prim);
+    VSNRAY_UNUSED(ray);
+    VSNRAY_UNUSED(tex_width);
+    VSNRAY_UNUSED(tex_height);
+
+    return 0.0f;
+}
+
+// Triangles, w/ texture coordinates per vertex (see get_tex_coord())
+template <typename TexCoords, typename HR, typename T>
+VSNRAY_FUNC
+inline float texture_lod(
+        TexCoords                   tex_coords,
+        HR const&                   hr,
+        basic_triangle<3, T> const& tri,
+        basic_ray<float> const&     ray,
+        unsigned                    tex_width,
+        unsigned                    tex_height
+        )
+{
+    auto tc1 = tex_coords[hr.prim_id * 3];
+    auto tc2 = tex_coords[hr.prim_id * 3 + 1];
+    auto tc3 = tex_coords[hr.prim_id * 3 + 2];
+
+    auto t1 = tc2 - tc1;
+    auto t2 = tc3 - tc1;
+
+    // Twice the areas in texel space and in object space
+    float texel_area = abs(t1.x * t2.y - t1.y * t2.x) * tex_width * tex_height;
+
+    vector<3, float> n = cross(vector<3, float>(tri.e1), vector<3, float>(tri.e2));
+    float surface_area = length(n);
+
+    float width = abs(cone_width(ray, hr.t));
+    float cos_theta = surface_area > 0.0f ? abs(dot(ray.dir, n)) / surface_area : 0.0f;
+
+    if (width <= 0.0f || texel_area <= 0.0f || cos_theta <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    return 0.5f * log2(texel_area / surface_area) + log2(width / cos_theta);
+}
+
+} // visionaray
+
+#endif // VSNRAY_RAY_CONE_H
@@ -7,6 +7,7 @@
 #define VSNRAY_RENDER_TARGET_H 1
 
 #include "detail/macros.h"
+#include "aov.h"
 #include "pixel_traits.h"
 
 namespace visionaray
@@ -61,6 +62,10 @@ struct render_target_ref
     // Storage type used by the accumulation buffer
     using accum_type = typename pixel_traits<AccumFormat>::type;
 
+    // Per-pixel moments for adaptive sampling (mean luminance, mean squared
+    // luminance, number of samples, relative error of the mean)
+    using moments_type = vector<4, float>;
+
 
     VSNRAY_FUNC color_type* color()
     {
@@ -77,6 +82,16 @@ struct render_target_ref
         return accum_;
     }
 
+    VSNRAY_FUNC moments_type* moments()
+    {
+        return moments_;
+    }
+
+    VSNRAY_FUNC aov_ref const& aovs() const
+    {
+        return aovs_;
+    }
+
     VSNRAY_FUNC color_type const* color() const
     {
         return color_;
@@ -92,6 +107,11 @@ struct render_target_ref
         return accum_;
     }
 
+    VSNRAY_FUNC moments_type const* moments() const
+    {
+        return moments_;
+    }
+
     VSNRAY_FUNC int width() const
     {
         return width_;
@@ -110,6 +130,13 @@ struct render_target_ref
     int width_;
     int height_;
 
+    // Optional, nullptr until the render target allocated its moments
+    // buffer for an adaptive pixel sampler
+    moments_type* moments_;
+
+    // Optional, planes of disabled AOV channels are nullptr
+    aov_ref aovs_;
+
 };
 
 } // visionaray
@@ -8,21 +8,44 @@
 
 #include "math/simd/type_traits.h"
 #include "math/vector.h"
+#include "aov.h"
 
 namespace visionaray
 {
 
+namespace detail
+{
+
+template <typename T, unsigned AOVs>
+struct result_record_aovs
+{
+    aov_record<T> aov;
+};
+
+template <typename T>
+struct result_record_aovs<T, aov::None>
+{
+};
+
+} // detail
+
+
 //-------------------------------------------------------------------------------------------------
 // Result record that the builtin visionaray kernels return
 //
+// AOVs is a combination of aov::channel flags, records w/ AOVs have an
+// additional member aov (see aov.h)
+//
 
-template <typename T>
-struct result_record
+template <typename T, unsigned AOVs = aov::None>
+struct result_record : detail::result_record_aovs<T, AOVs>
 {
     using scalar_type = T;
     using mask_type   = simd::mask_type_t<T>;
     using color_type  = vector<4, T>;
 
+    enum { aov_channels = AOVs };
+
     mask_type   hit   = mask_type(false);
     color_type  color = color_type(0.0);
     scalar_type depth = scalar_type(0.0);
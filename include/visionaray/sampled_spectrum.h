@@ -0,0 +1,187 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_SAMPLED_SPECTRUM_H
+#define VSNRAY_SAMPLED_SPECTRUM_H 1
+
+#include <cstddef>
+
+#include "detail/macros.h"
+#include "math/vector.h"
+#include "spectrum.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Hero wavelength sampling
+//
+// From: Wilkie et al.: Hero Wavelength Spectral Sampling (2014)
+//
+// A path carries radiance at N wavelengths. The hero wavelength is
+// sampled uniformly in [lambda_min, lambda_max), the others are placed at
+// equidistant offsets and wrap around. All wavelengths have the same pdf,
+// values are converted to XYZ and RGB when the path terminates.
+//
+
+template <size_t N, typename T>
+struct sampled_wavelengths
+{
+    static constexpr float lambda_min = 380.0f;
+    static constexpr float lambda_max = 720.0f;
+
+    vector<N, T> lambda;
+
+    VSNRAY_FUNC static T pdf()
+    {
+        return T(1.0f / (lambda_max - lambda_min));
+    }
+};
+
+// Sample N wavelengths, u in [0..1)
+template <size_t N, typename T>
+VSNRAY_FUNC
+sampled_wavelengths<N, T> sample_wavelengths(T const& u);
+
+// Evaluate an SPD (e.g. blackbody, spd_d65, measured) at the wavelengths
+template <size_t N, typename T, typename SPD>
+VSNRAY_FUNC
+vector<N, T> sample_spd(SPD const& spd, sampled_wavelengths<N, T> const& wl);
+
+// Monte Carlo estimate of the XYZ tristimulus values, normalized so that
+// an equal energy spectrum w/ value 1 has Y = 1 (see spd_to_rgb())
+template <size_t N, typename T>
+VSNRAY_FUNC
+vector<3, T> to_xyz(vector<N, T> const& values, sampled_wavelengths<N, T> const& wl);
+
+template <size_t N, typename T>
+VSNRAY_FUNC
+vector<3, T> to_rgb(vector<N, T> const& values, sampled_wavelengths<N, T> const& wl);
+
+
+//-------------------------------------------------------------------------------------------------
+// RGB to spectrum conversion at sampled wavelengths
+//
+// Reflectances are upsampled w/ the basis spectra by Smits (see
+// detail/spd/smits.h). Illuminants are upsampled the same way and
+// multiplied w/ the D65 SPD, the white point of linear sRGB, so that
+// rgb(1,1,1) illuminants have Y = 1 and convert back to white.
+//
+
+template <size_t N, typename T>
+class rgb_upsampler
+{
+public:
+
+    // Evaluates the basis spectra at the wavelengths
+    VSNRAY_FUNC explicit rgb_upsampler(sampled_wavelengths<N, T> const& wl);
+
+    VSNRAY_FUNC vector<N, T> reflectance(vector<3, T> const& rgb) const;
+    VSNRAY_FUNC vector<N, T> illuminant(vector<3, T> const& rgb) const;
+
+private:
+
+    // White, cyan, magenta, yellow, red, green, blue
+    vector<N, T> basis_[7];
+
+    // Normalized D65
+    vector<N, T> d65_;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Color representations for light transport (see pathtracing::kernel)
+//
+// Materials, lights and textures store RGB spectra. path_state<S> is
+// created once per path and converts those to the color type that is
+// transported along the path, and the transported color to RGB.
+//
+
+// Transport RGB spectra (default)
+struct rgb_transport
+{
+    template <typename S>
+    class path_state
+    {
+    public:
+
+        using color_type = spectrum<S>;
+
+        template <typename Generator>
+        VSNRAY_FUNC explicit path_state(Generator& /* gen */) {}
+
+        VSNRAY_FUNC color_type reflectance(spectrum<S> const& s) const { return s; }
+        VSNRAY_FUNC color_type illuminant(spectrum<S> const& s) const { return s; }
+
+        // BRDF times incident light
+        template <typename Surface, typename V>
+        VSNRAY_FUNC color_type shade(Surface& surf, V const& view_dir, V const& light_dir, V const& intensity) const
+        {
+            return surf.shade(view_dir, light_dir, intensity);
+        }
+
+        VSNRAY_FUNC S max_value(color_type const& c) const { return max_element(c.samples()); }
+
+        VSNRAY_FUNC vector<3, S> to_rgb(color_type const& c) const { return visionaray::to_rgb(c); }
+    };
+};
+
+// Transport radiance at N hero wavelengths
+template <size_t N = 4>
+struct hero_transport
+{
+    template <typename S>
+    class path_state
+    {
+    public:
+
+        using color_type = vector<N, S>;
+
+        // Draws one random number for the hero wavelength
+        template <typename Generator>
+        VSNRAY_FUNC explicit path_state(Generator& gen)
+            : wl_(sample_wavelengths<N>(gen.next()))
+            , upsampler_(wl_)
+        {
+        }
+
+        VSNRAY_FUNC color_type reflectance(spectrum<S> const& s) const
+        {
+            return upsampler_.reflectance(visionaray::to_rgb(s));
+        }
+
+        VSNRAY_FUNC color_type illuminant(spectrum<S> const& s) const
+        {
+            return upsampler_.illuminant(visionaray::to_rgb(s));
+        }
+
+        // The BRDF is upsampled as a reflectance and the light as an
+        // illuminant, not their product
+        template <typename Surface, typename V>
+        VSNRAY_FUNC color_type shade(Surface& surf, V const& view_dir, V const& light_dir, V const& intensity) const
+        {
+            return reflectance(surf.shade(view_dir, light_dir, V(1.0)))
+                 * upsampler_.illuminant(intensity);
+        }
+
+        VSNRAY_FUNC S max_value(color_type const& c) const { return max_element(c); }
+
+        VSNRAY_FUNC vector<3, S> to_rgb(color_type const& c) const { return visionaray::to_rgb(c, wl_); }
+
+        VSNRAY_FUNC sampled_wavelengths<N, S> const& wavelengths() const { return wl_; }
+
+    private:
+
+        sampled_wavelengths<N, S> wl_;
+        rgb_upsampler<N, S> upsampler_;
+    };
+};
+
+} // visionaray
+
+#include "detail/sampled_spectrum.inl"
+
+#endif // VSNRAY_SAMPLED_SPECTRUM_H
@@ -8,6 +8,7 @@
 
 #include <iterator>
 #include <type_traits>
+#include <utility>
 
 #include "detail/macros.h"
 #include "math/detail/math.h"
@@ -34,7 +35,7 @@ template <
     typename F = simd::float_type_t<I>
     >
 VSNRAY_FUNC
-inline F radical_inverse(I const& n)
+inline F radical_inverse(I n)
 {
     F result(0.0);
     F inv_base(1.0f / Base);
@@ -170,6 +171,266 @@ struct has_sample : has_sample_impl<T, Generator>::type
 {
 };
 
+// Light selectors that pick lights for all SIMD lanes at once
+template <typename Selector, typename T>
+struct has_simd_sample_impl
+{
+    template <typename U>
+    static std::true_type test(decltype(std::declval<U const&>().sample(
+            0,
+            std::declval<vector<3, T> const&>(),
+            std::declval<vector<3, T> const&>(),
+            std::declval<T const&>(),
+            std::declval<T&>()
+            ))*);
+
+    template <typename U>
+    static std::false_type test(...);
+
+    using type = decltype( test<typename std::decay<Selector>::type>(nullptr) );
+};
+
+template <typename Selector, typename T>
+struct has_simd_sample : has_simd_sample_impl<Selector, T>::type
+{
+};
+
+template <typename Selector, typename T, typename I>
+struct has_simd_emitter_pmf_impl
+{
+    template <typename U>
+    static std::true_type test(decltype(std::declval<U const&>().emitter_pmf(
+            0,
+            std::declval<vector<3, T> const&>(),
+            std::declval<vector<3, T> const&>(),
+            std::declval<I const&>(),
+            std::declval<I const&>()
+            ))*);
+
+    template <typename U>
+    static std::false_type test(...);
+
+    using type = decltype( test<typename std::decay<Selector>::type>(nullptr) );
+};
+
+template <typename Selector, typename T, typename I>
+struct has_simd_emitter_pmf : has_simd_emitter_pmf_impl<Selector, T, I>::type
+{
+};
+
+template <typename T>
+VSNRAY_FUNC
+inline light_sample<T> zero_light_sample()
+{
+    light_sample<T> result;
+    result.dir = vector<3, T>(0.0);
+    result.pdf = T(0.0);
+    result.dist = T(0.0);
+    result.intensity = vector<3, T>(0.0);
+    result.normal = vector<3, T>(0.0);
+    result.area = T(0.0);
+    result.delta_light = T(0.0) != T(0.0);
+    return result;
+}
+
+// Sample the light light_id[i] for lane i, lanes with light_id < 0 get a zero sample
+//
+// Lanes that picked the same light are sampled together: the light
+// is evaluated once with SIMD code and blended into the result with
+// a lane mask. Lights that were picked by a single lane are sampled
+// lane by lane
+template <typename Lights, typename Generator, typename T = typename Generator::value_type>
+inline light_sample<T> sample_light_lanes(
+        Lights                  begin,
+        int const*              light_id,
+        vector<3, T> const&     reference_point,
+        Generator&              gen
+        )
+{
+    using float_array = simd::aligned_array_t<T>;
+
+    enum { N = simd::num_elements<T>::value };
+
+    light_sample<T> result = zero_light_sample<T>();
+
+    T delta_light(0.0);
+
+    auto rp = simd::unpack(reference_point);
+
+    array<vector<3, float>, N> dir = {};
+    float_array dist = {};
+    array<vector<3, float>, N> intensities = {};
+    array<vector<3, float>, N> normals = {};
+    float_array area = {};
+    float_array delta_lights = {};
+    float_array pdf = {};
+    float_array scalar_lanes = {};
+
+    bool done[N] = {};
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+        if (done[i] || light_id[i] < 0)
+        {
+            continue;
+        }
+
+        float_array lanes = {};
+        unsigned num_lanes = 0;
+
+        for (unsigned j = i; j < N; ++j)
+        {
+            if (light_id[j] == light_id[i])
+            {
+                lanes[j] = 1.0f;
+                done[j] = true;
+                ++num_lanes;
+            }
+        }
+
+        if (num_lanes > 1)
+        {
+            auto mask = T(lanes) != T(0.0);
+
+            auto ls = begin[light_id[i]].sample(reference_point, gen);
+
+            result.dir = select(mask, ls.dir, result.dir);
+            result.dist = select(mask, ls.dist, result.dist);
+            result.intensity = select(mask, ls.intensity, result.intensity);
+            result.normal = select(mask, ls.normal, result.normal);
+            result.area = select(mask, ls.area, result.area);
+            result.pdf = select(mask, ls.pdf, result.pdf);
+            delta_light = select(mask, select(ls.delta_light, T(1.0), T(0.0)), delta_light);
+        }
+        else
+        {
+            auto ls = begin[light_id[i]].sample(rp[i], gen.get_generator(i));
+
+            dir[i] = ls.dir;
+            dist[i] = ls.dist;
+            intensities[i] = ls.intensity;
+            normals[i] = ls.normal;
+            area[i] = ls.area;
+            delta_lights[i] = ls.delta_light ? 1.0f : 0.0f;
+            pdf[i] = ls.pdf;
+            scalar_lanes[i] = 1.0f;
+        }
+    }
+
+    auto mask = T(scalar_lanes) != T(0.0);
+
+    result.dir = select(mask, simd::pack(dir), result.dir);
+    result.dist = select(mask, T(dist), result.dist);
+    result.intensity = select(mask, simd::pack(intensities), result.intensity);
+    result.normal = select(mask, simd::pack(normals), result.normal);
+    result.area = select(mask, T(area), result.area);
+    result.pdf = select(mask, T(pdf), result.pdf);
+    delta_light = select(mask, T(delta_lights), delta_light);
+
+    // Masks are not necessarily int vectors (e.g. AVX-512 bit masks)
+    result.delta_light = delta_light != T(0.0);
+
+    return result;
+}
+
+// Pick lights for all lanes, returns the probabilities to pick them
+template <typename Selector, typename T, typename IntArray>
+inline T select_lights(
+        Selector const&         selector,
+        int                     num_lights,
+        vector<3, T> const&     reference_point,
+        vector<3, T> const&     normal,
+        T const&                u,
+        IntArray&               light_id,
+        std::true_type          /* simd selector */
+        )
+{
+    T pmf;
+    store(light_id, selector.sample(num_lights, reference_point, normal, u, pmf));
+    return pmf;
+}
+
+template <typename Selector, typename T, typename IntArray>
+inline T select_lights(
+        Selector const&         selector,
+        int                     num_lights,
+        vector<3, T> const&     reference_point,
+        vector<3, T> const&     normal,
+        T const&                u,
+        IntArray&               light_id,
+        std::false_type         /* simd selector */
+        )
+{
+    using float_array = simd::aligned_array_t<T>;
+
+    enum { N = simd::num_elements<T>::value };
+
+    float_array uf;
+    store(uf, u);
+
+    auto rp = simd::unpack(reference_point);
+    auto ns = simd::unpack(normal);
+
+    float_array pmf = {};
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+        light_id[i] = selector.sample(num_lights, rp[i], ns[i], uf[i], pmf[i]);
+    }
+
+    return T(pmf);
+}
+
+// Selection probability of the emitters hit in each lane
+template <typename Selector, typename T, typename I>
+inline T emitter_pmf_lanes(
+        Selector const&         selector,
+        int                     num_lights,
+        vector<3, T> const&     reference_point,
+        vector<3, T> const&     normal,
+        I const&                geom_id,
+        I const&                prim_id,
+        std::true_type          /* simd selector */
+        )
+{
+    return selector.emitter_pmf(num_lights, reference_point, normal, geom_id, prim_id);
+}
+
+template <typename Selector, typename T, typename I>
+inline T emitter_pmf_lanes(
+        Selector const&         selector,
+        int                     num_lights,
+        vector<3, T> const&     reference_point,
+        vector<3, T> const&     normal,
+        I const&                geom_id,
+        I const&                prim_id,
+        std::false_type         /* simd selector */
+        )
+{
+    using float_array = simd::aligned_array_t<T>;
+    using int_array = simd::aligned_array_t<I>;
+
+    enum { N = simd::num_elements<T>::value };
+
+    int_array geom_ids;
+    store(geom_ids, geom_id);
+
+    int_array prim_ids;
+    store(prim_ids, prim_id);
+
+    auto rp = simd::unpack(reference_point);
+    auto ns = simd::unpack(normal);
+
+    float_array result = {};
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+        result[i] = selector.emitter_pmf(num_lights, rp[i], ns[i], geom_ids[i], prim_ids[i]);
+    }
+
+    return T(result);
+}
+
 } // detail
 
 // empty default
@@ -225,6 +486,8 @@ light_sample<T> sample_random_light(Lights begin, Lights end, vector<3, T> const
 {
     using float_array = simd::aligned_array_t<T>;
 
+    enum { N = simd::num_elements<T>::value };
+
     auto num_lights = end - begin;
 
     auto u = gen.next();
@@ -232,40 +495,162 @@ light_sample<T> sample_random_light(Lights begin, Lights end, vector<3, T> const
     float_array uf;
     store(uf, u);
 
-    light_sample<T> result;
+    int light_id[N];
 
-    auto rp = simd::unpack(reference_point);
+    for (unsigned i = 0; i < N; ++i)
+    {
+        light_id[i] = static_cast<int>(uf[i] * num_lights);
+    }
 
-    array<vector<3, float>, simd::num_elements<T>::value> dir;
-    float* dist = reinterpret_cast<float*>(&result.dist);
-    array<vector<3, float>, simd::num_elements<T>::value> intensities;
-    array<vector<3, float>, simd::num_elements<T>::value> normals;
-    float* area = reinterpret_cast<float*>(&result.area);
-    int* delta_light = reinterpret_cast<int*>(&result.delta_light);
-    float* pdf = reinterpret_cast<float*>(&result.pdf);
+    return detail::sample_light_lanes(begin, light_id, reference_point, gen);
+}
 
-    for (unsigned i = 0; i < simd::num_elements<T>::value; ++i)
-    {
-        int light_id = static_cast<int>(uf[i] * num_lights);
 
-        auto ls = begin[light_id].sample(rp[i], gen.get_generator(i));
+//-------------------------------------------------------------------------------------------------
+// Sample a light picked by a light selector (see light_selector.h)
+//
+// normal is the normal at reference_point, or the null vector. The
+// probability to pick the light is folded into the PDF of the sample.
+// If no light can be picked, the sample is zero and has PDF 0. With
+// SIMD, selectors that have SIMD overloads pick the lights for all
+// lanes at once, others are called lane by lane.
+//
+
+// non-simd
+template <
+    typename Lights,
+    typename Selector,
+    typename Generator,
+    typename T = typename Generator::value_type,
+    typename = typename std::enable_if<!simd::is_simd_vector<T>::value>::type,
+    typename = typename std::enable_if<
+        detail::has_sample<typename std::iterator_traits<Lights>::value_type, Generator>::value>::type
+    >
+VSNRAY_FUNC
+light_sample<T> sample_random_light(
+        Lights                  begin,
+        Lights                  end,
+        Selector const&         selector,
+        vector<3, T> const&     reference_point,
+        vector<3, T> const&     normal,
+        Generator&              gen
+        )
+{
+    float pmf = 0.0f;
+    int light_id = selector.sample(static_cast<int>(end - begin), reference_point, normal, gen.next(), pmf);
 
-        dir[i] = ls.dir;
-        dist[i] = ls.dist;
-        intensities[i] = ls.intensity;
-        normals[i] = ls.normal;
-        area[i] = ls.area;
-        delta_light[i] = ls.delta_light ? 0xFFFFFFFF : 0x00000000;
-        pdf[i] = ls.pdf;
+    if (light_id < 0)
+    {
+        return detail::zero_light_sample<T>();
     }
 
-    result.dir = simd::pack(dir);
-    result.intensity = simd::pack(intensities);
-    result.normal = simd::pack(normals);
+    auto result = begin[light_id].sample(reference_point, gen);
+    result.pdf *= pmf;
+    return result;
+}
+
+// simd
+template <
+    typename Lights,
+    typename Selector,
+    typename Generator,
+    typename T = typename Generator::value_type,
+    typename = typename std::enable_if<simd::is_simd_vector<T>::value>::type,
+    typename = typename std::enable_if<
+        detail::has_sample<typename std::iterator_traits<Lights>::value_type, Generator>::value>::type,
+    typename = void
+    >
+light_sample<T> sample_random_light(
+        Lights                  begin,
+        Lights                  end,
+        Selector const&         selector,
+        vector<3, T> const&     reference_point,
+        vector<3, T> const&     normal,
+        Generator&              gen
+        )
+{
+    using int_array = simd::aligned_array_t<simd::int_type_t<T>>;
+
+    int_array light_id;
+    T pmf = detail::select_lights(
+            selector,
+            static_cast<int>(end - begin),
+            reference_point,
+            normal,
+            gen.next(),
+            light_id,
+            detail::has_simd_sample<Selector, T>{}
+            );
 
+    auto result = detail::sample_light_lanes(begin, light_id, reference_point, gen);
+    result.pdf *= pmf;
     return result;
 }
 
+
+//-------------------------------------------------------------------------------------------------
+// Probability that a light selector picks the light source that was
+// hit (hit_rec), seen from reference_point with normal
+//
+
+// non-simd
+template <
+    typename Lights,
+    typename Selector,
+    typename HR,
+    typename T,
+    typename = typename std::enable_if<!simd::is_simd_vector<T>::value>::type
+    >
+VSNRAY_FUNC
+T light_selection_pmf(
+        Lights                  begin,
+        Lights                  end,
+        Selector const&         selector,
+        vector<3, T> const&     reference_point,
+        vector<3, T> const&     normal,
+        HR const&               hit_rec
+        )
+{
+    return selector.emitter_pmf(
+            static_cast<int>(end - begin),
+            reference_point,
+            normal,
+            static_cast<int>(hit_rec.geom_id),
+            static_cast<int>(hit_rec.prim_id)
+            );
+}
+
+// simd
+template <
+    typename Lights,
+    typename Selector,
+    typename HR,
+    typename T,
+    typename = typename std::enable_if<simd::is_simd_vector<T>::value>::type,
+    typename = void
+    >
+T light_selection_pmf(
+        Lights                  begin,
+        Lights                  end,
+        Selector const&         selector,
+        vector<3, T> const&     reference_point,
+        vector<3, T> const&     normal,
+        HR const&               hit_rec
+        )
+{
+    using I = simd::int_type_t<T>;
+
+    return detail::emitter_pmf_lanes(
+            selector,
+            static_cast<int>(end - begin),
+            reference_point,
+            normal,
+            I(hit_rec.geom_id),
+            I(hit_rec.prim_id),
+            detail::has_simd_emitter_pmf<Selector, T, I>{}
+            );
+}
+
 } // visionaray
 
 #endif // VSNRAY_SAMPLING_H
@@ -8,6 +8,7 @@
 
 #include <cstddef>
 
+#include "math/half.h"
 #include "math/unorm.h"
 #include "math/vector.h"
 #include "pixel_format.h"
@@ -313,6 +314,33 @@ inline void swizzle_RGB32F_to_RGBA8(
     }
 }
 
+inline void swizzle_RGB32F_to_RGBA16F(
+        vector<4, half>*            dst,
+        vector<3, float> const*     src,
+        size_t                      len,
+        swizzle_hint                hint
+        )
+{
+    float a = hint == AlphaIsZero ? 0.0f : 1.0f;
+    for (size_t i = 0; i < len; ++i)
+    {
+        auto rgb = src[i];
+        dst[i] = vector<4, half>( rgb.x, rgb.y, rgb.z, a );
+    }
+}
+
+inline void swizzle_RGBA32F_to_RGBA16F(
+        vector<4, half>*            dst,
+        vector<4, float> const*     src,
+        size_t                      len
+        )
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        dst[i] = vector<4, half>(src[i]);
+    }
+}
+
 
 //-------------------------------------------------------------------------------------------------
 // Swizzle in-place
@@ -521,6 +549,39 @@ inline void swizzle_expand_types(
     }
 }
 
+// RGB32F -> RGBA16F
+
+inline void swizzle_expand_types(
+        vector<4, half>*            dst,
+        pixel_format                format_dst,
+        vector<3, float> const*     src,
+        pixel_format                format_src,
+        size_t                      len,
+        swizzle_hint                hint
+        )
+{
+    if (format_dst == PF_RGBA16F && format_src == PF_RGB32F)
+    {
+        detail::swizzle_RGB32F_to_RGBA16F( dst, src, len, hint );
+    }
+}
+
+// RGBA32F -> RGBA16F
+
+inline void swizzle_expand_types(
+        vector<4, half>*            dst,
+        pixel_format                format_dst,
+        vector<4, float> const*     src,
+        pixel_format                format_src,
+        size_t                      len
+        )
+{
+    if (format_dst == PF_RGBA16F && format_src == PF_RGBA32F)
+    {
+        detail::swizzle_RGBA32F_to_RGBA16F( dst, src, len );
+    }
+}
+
 // RGB32F -> RGBA8, 8-bit type is unorm<8>
 
 inline void swizzle_expand_types(
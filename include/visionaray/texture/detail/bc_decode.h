@@ -0,0 +1,620 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_BC_DECODE_H
+#define VSNRAY_TEXTURE_DETAIL_BC_DECODE_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "../../math/unorm.h"
+#include "../../math/vector.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Block compression formats. Textures are stored as 4x4 blocks of 8 (BC1)
+// or 16 bytes. BC5 has two channels and decodes to (r, g, 0, 1)
+//
+
+enum tex_block_format
+{
+    BC1 = 0,
+    BC3,
+    BC5,
+    BC7
+};
+
+namespace detail
+{
+
+using bc_texel = vector<4, unorm<8>>;
+
+inline size_t bc_block_bytes(tex_block_format format)
+{
+    return format == BC1 ? 8 : 16;
+}
+
+inline bc_texel make_bc_texel(unsigned r, unsigned g, unsigned b, unsigned a)
+{
+    bc_texel result;
+    result.x.value = static_cast<uint8_t>(r);
+    result.y.value = static_cast<uint8_t>(g);
+    result.z.value = static_cast<uint8_t>(b);
+    result.w.value = static_cast<uint8_t>(a);
+    return result;
+}
+
+inline uint32_t bc_load32(uint8_t const* ptr)
+{
+    return uint32_t(ptr[0]) | (uint32_t(ptr[1]) << 8) | (uint32_t(ptr[2]) << 16) | (uint32_t(ptr[3]) << 24);
+}
+
+inline uint64_t bc_load64(uint8_t const* ptr)
+{
+    return uint64_t(bc_load32(ptr)) | (uint64_t(bc_load32(ptr + 4)) << 32);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The decoders write texels [first..last) of the block (in row-major order) to
+// out[first..last). Fetches decode single texels, packets whole blocks
+//
+
+// BC1 color block, BC3 blocks always use four colors
+inline void decode_bc1(
+        uint8_t const*  block,
+        unsigned        first,
+        unsigned        last,
+        bc_texel*       out,
+        bool            four_colors = false
+        )
+{
+    unsigned c0 = block[0] | (block[1] << 8);
+    unsigned c1 = block[2] | (block[3] << 8);
+    uint32_t bits = bc_load32(block + 4);
+
+    unsigned colors[4][4];
+
+    for (int i = 0; i < 2; ++i)
+    {
+        unsigned c = i == 0 ? c0 : c1;
+        unsigned r = (c >> 11) & 0x1F;
+        unsigned g = (c >> 5) & 0x3F;
+        unsigned b = c & 0x1F;
+        colors[i][0] = (r << 3) | (r >> 2);
+        colors[i][1] = (g << 2) | (g >> 4);
+        colors[i][2] = (b << 3) | (b >> 2);
+        colors[i][3] = 255;
+    }
+
+    if (c0 > c1 || four_colors)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            colors[2][c] = (2 * colors[0][c] + colors[1][c] + 1) / 3;
+            colors[3][c] = (colors[0][c] + 2 * colors[1][c] + 1) / 3;
+        }
+        colors[2][3] = 255;
+        colors[3][3] = 255;
+    }
+    else
+    {
+        // Three colors and transparent black
+        for (int c = 0; c < 3; ++c)
+        {
+            colors[2][c] = (colors[0][c] + colors[1][c]) / 2;
+            colors[3][c] = 0;
+        }
+        colors[2][3] = 255;
+        colors[3][3] = 0;
+    }
+
+    for (unsigned i = first; i < last; ++i)
+    {
+        unsigned const* c = colors[(bits >> (2 * i)) & 0x3];
+        out[i] = make_bc_texel(c[0], c[1], c[2], c[3]);
+    }
+}
+
+// Single channel block of BC3 and BC5, writes every stride'th byte
+inline void decode_bc4(
+        uint8_t const*  block,
+        unsigned        first,
+        unsigned        last,
+        uint8_t*        out,
+        size_t          stride
+        )
+{
+    unsigned a0 = block[0];
+    unsigned a1 = block[1];
+    uint64_t bits = bc_load64(block) >> 16;
+
+    unsigned values[8];
+    values[0] = a0;
+    values[1] = a1;
+
+    if (a0 > a1)
+    {
+        for (unsigned i = 1; i < 7; ++i)
+        {
+            values[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+        }
+    }
+    else
+    {
+        for (unsigned i = 1; i < 5; ++i)
+        {
+            values[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+        }
+        values[6] = 0;
+        values[7] = 255;
+    }
+
+    for (unsigned i = first; i < last; ++i)
+    {
+        out[i * stride] = static_cast<uint8_t>(values[(bits >> (3 * i)) & 0x7]);
+    }
+}
+
+inline void decode_bc3(uint8_t const* block, unsigned first, unsigned last, bc_texel* out)
+{
+    decode_bc1(block + 8, first, last, out, true);
+    decode_bc4(block, first, last, &out[0].w.value, sizeof(bc_texel));
+}
+
+inline void decode_bc5(uint8_t const* block, unsigned first, unsigned last, bc_texel* out)
+{
+    for (unsigned i = first; i < last; ++i)
+    {
+        out[i] = make_bc_texel(0, 0, 0, 255);
+    }
+
+    decode_bc4(block, first, last, &out[0].x.value, sizeof(bc_texel));
+    decode_bc4(block + 8, first, last, &out[0].y.value, sizeof(bc_texel));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// BC7
+//
+
+struct bc7_mode_info
+{
+    unsigned subsets;
+    unsigned partition_bits;
+    unsigned rotation_bits;
+    unsigned index_selection_bits;
+    unsigned color_bits;
+    unsigned alpha_bits;
+    unsigned endpoint_pbits;
+    unsigned shared_pbits;
+    unsigned index_bits;
+    unsigned index2_bits;
+};
+
+inline bc7_mode_info const& bc7_mode(unsigned mode)
+{
+    static const bc7_mode_info modes[] = {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+        };
+
+    return modes[mode];
+}
+
+// Subset of each texel for the 64 two-subset partitions
+inline uint8_t const* bc7_partition2(unsigned partition)
+{
+    static const uint8_t table[64][16] = {
+        { 0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1 }, { 0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1 },
+        { 0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1 }, { 0,0,0,1,0,0,1,1,0,0,1,1,0,1,1,1 },
+        { 0,0,0,0,0,0,0,1,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,0,1,1,1,1,1,1,1 },
+        { 0,0,0,1,0,0,1,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,1,0,0,1,1,0,1,1,1 },
+        { 0,0,0,0,0,0,0,0,0,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,1,1,1,1,1,1,1,1,1 },
+        { 0,0,0,0,0,0,0,1,0,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,1,0,1,1,1 },
+        { 0,0,0,1,0,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1 },
+        { 0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1 }, { 0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1 },
+        { 0,0,0,0,1,0,0,0,1,1,1,0,1,1,1,1 }, { 0,1,1,1,0,0,0,1,0,0,0,0,0,0,0,0 },
+        { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,1,0 }, { 0,1,1,1,0,0,1,1,0,0,0,1,0,0,0,0 },
+        { 0,0,1,1,0,0,0,1,0,0,0,0,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,1,0,0,1,1,1,0 },
+        { 0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0 }, { 0,1,1,1,0,0,1,1,0,0,1,1,0,0,0,1 },
+        { 0,0,1,1,0,0,0,1,0,0,0,1,0,0,0,0 }, { 0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0 },
+        { 0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0 }, { 0,0,1,1,0,1,1,0,0,1,1,0,1,1,0,0 },
+        { 0,0,0,1,0,1,1,1,1,1,1,0,1,0,0,0 }, { 0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0 },
+        { 0,1,1,1,0,0,0,1,1,0,0,0,1,1,1,0 }, { 0,0,1,1,1,0,0,1,1,0,0,1,1,1,0,0 },
+        { 0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1 }, { 0,0,0,0,1,1,1,1,0,0,0,0,1,1,1,1 },
+        { 0,1,0,1,1,0,1,0,0,1,0,1,1,0,1,0 }, { 0,0,1,1,0,0,1,1,1,1,0,0,1,1,0,0 },
+        { 0,0,1,1,1,1,0,0,0,0,1,1,1,1,0,0 }, { 0,1,0,1,0,1,0,1,1,0,1,0,1,0,1,0 },
+        { 0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1 }, { 0,1,0,1,1,0,1,0,1,0,1,0,0,1,0,1 },
+        { 0,1,1,1,0,0,1,1,1,1,0,0,1,1,1,0 }, { 0,0,0,1,0,0,1,1,1,1,0,0,1,0,0,0 },
+        { 0,0,1,1,0,0,1,0,0,1,0,0,1,1,0,0 }, { 0,0,1,1,1,0,1,1,1,1,0,1,1,1,0,0 },
+        { 0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0 }, { 0,0,1,1,1,1,0,0,1,1,0,0,0,0,1,1 },
+        { 0,1,1,0,0,1,1,0,1,0,0,1,1,0,0,1 }, { 0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0 },
+        { 0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,0 }, { 0,0,1,0,0,1,1,1,0,0,1,0,0,0,0,0 },
+        { 0,0,0,0,0,0,1,0,0,1,1,1,0,0,1,0 }, { 0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,0 },
+        { 0,1,1,0,1,1,0,0,1,0,0,1,0,0,1,1 }, { 0,0,1,1,0,1,1,0,1,1,0,0,1,0,0,1 },
+        { 0,1,1,0,0,0,1,1,1,0,0,1,1,1,0,0 }, { 0,0,1,1,1,0,0,1,1,1,0,0,0,1,1,0 },
+        { 0,1,1,0,1,1,0,0,1,1,0,0,1,0,0,1 }, { 0,1,1,0,0,0,1,1,0,0,1,1,1,0,0,1 },
+        { 0,1,1,1,1,1,1,0,1,0,0,0,0,0,0,1 }, { 0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,1 },
+        { 0,0,0,0,1,1,1,1,0,0,1,1,0,0,1,1 }, { 0,0,1,1,0,0,1,1,1,1,1,1,0,0,0,0 },
+        { 0,0,1,0,0,0,1,0,1,1,1,0,1,1,1,0 }, { 0,1,0,0,0,1,0,0,0,1,1,1,0,1,1,1 }
+        };
+
+    return table[partition];
+}
+
+// Subset of each texel for the 64 three-subset partitions
+inline uint8_t const* bc7_partition3(unsigned partition)
+{
+    static const uint8_t table[64][16] = {
+        { 0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2 }, { 0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1 },
+        { 0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1 }, { 0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1 },
+        { 0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2 }, { 0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2 },
+        { 0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1 }, { 0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1 },
+        { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2 },
+        { 0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2 }, { 0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2 },
+        { 0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2 }, { 0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2 },
+        { 0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2 }, { 0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0 },
+        { 0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2 }, { 0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0 },
+        { 0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2 }, { 0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1 },
+        { 0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2 }, { 0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1 },
+        { 0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2 }, { 0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0 },
+        { 0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0 }, { 0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2 },
+        { 0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0 }, { 0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1 },
+        { 0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2 }, { 0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2 },
+        { 0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1 }, { 0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1 },
+        { 0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2 }, { 0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1 },
+        { 0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2 }, { 0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0 },
+        { 0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0 }, { 0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0 },
+        { 0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0 }, { 0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1 },
+        { 0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1 }, { 0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2 },
+        { 0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1 }, { 0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2 },
+        { 0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1 }, { 0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1 },
+        { 0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1 }, { 0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1 },
+        { 0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2 }, { 0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1 },
+        { 0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2 }, { 0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2 },
+        { 0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2 }, { 0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2 },
+        { 0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2 },
+        { 0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2 }, { 0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2 },
+        { 0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2 }, { 0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2 },
+        { 0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1 }, { 0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2 },
+        { 0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2 }, { 0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0 }
+        };
+
+    return table[partition];
+}
+
+// Anchor texel of each subset, its index is stored w/ one bit less
+inline unsigned bc7_anchor(unsigned subsets, unsigned partition, unsigned subset)
+{
+    static const uint8_t anchor2[64] = {
+        15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15,
+        15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+        15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,
+         6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+        };
+
+    static const uint8_t anchor3_1[64] = {
+         3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,
+         3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+         8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,
+         3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3
+        };
+
+    static const uint8_t anchor3_2[64] = {
+        15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8,
+        15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+        15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8,
+        15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8
+        };
+
+    if (subset == 0)
+    {
+        return 0;
+    }
+    else if (subsets == 2)
+    {
+        return anchor2[partition];
+    }
+    else
+    {
+        return subset == 1 ? anchor3_1[partition] : anchor3_2[partition];
+    }
+}
+
+inline unsigned bc7_interpolate(unsigned e0, unsigned e1, unsigned index, unsigned bits)
+{
+    static const unsigned weights2[] = { 0, 21, 43, 64 };
+    static const unsigned weights3[] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    static const unsigned weights4[] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    unsigned w = bits == 2 ? weights2[index] : bits == 3 ? weights3[index] : weights4[index];
+
+    return ((64 - w) * e0 + w * e1 + 32) >> 6;
+}
+
+// Little-endian bit stream over the 128 bits of a block
+class bc7_bit_reader
+{
+public:
+
+    explicit bc7_bit_reader(uint8_t const* block)
+        : lo_(bc_load64(block))
+        , hi_(bc_load64(block + 8))
+    {
+    }
+
+    unsigned read(unsigned n)
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        uint64_t bits = pos_ < 64 ? lo_ >> pos_ : hi_ >> (pos_ - 64);
+
+        if (pos_ < 64 && pos_ + n > 64)
+        {
+            bits |= hi_ << (64 - pos_);
+        }
+
+        pos_ += n;
+
+        return static_cast<unsigned>(bits & ((uint64_t(1) << n) - 1));
+    }
+
+    void skip(unsigned n)
+    {
+        pos_ += n;
+    }
+
+    void seek(unsigned pos)
+    {
+        pos_ = pos;
+    }
+
+    unsigned position() const
+    {
+        return pos_;
+    }
+
+private:
+
+    uint64_t lo_;
+    uint64_t hi_;
+    unsigned pos_ = 0;
+
+};
+
+inline void decode_bc7(uint8_t const* block, unsigned first, unsigned last, bc_texel* out)
+{
+    unsigned mode = 0;
+    while (mode < 8 && !(block[0] & (1 << mode)))
+    {
+        ++mode;
+    }
+
+    // Reserved mode, decodes to transparent black
+    if (mode == 8)
+    {
+        for (unsigned i = first; i < last; ++i)
+        {
+            out[i] = make_bc_texel(0, 0, 0, 0);
+        }
+        return;
+    }
+
+    bc7_mode_info const& info = bc7_mode(mode);
+
+    bc7_bit_reader reader(block);
+    reader.skip(mode + 1);
+
+    unsigned partition = reader.read(info.partition_bits);
+    unsigned rotation = reader.read(info.rotation_bits);
+    unsigned index_selection = reader.read(info.index_selection_bits);
+
+    unsigned const num_endpoints = info.subsets * 2;
+
+    unsigned endpoints[6][4];
+
+    for (unsigned c = 0; c < 3; ++c)
+    {
+        for (unsigned e = 0; e < num_endpoints; ++e)
+        {
+            endpoints[e][c] = reader.read(info.color_bits);
+        }
+    }
+
+    for (unsigned e = 0; e < num_endpoints; ++e)
+    {
+        endpoints[e][3] = reader.read(info.alpha_bits);
+    }
+
+    // P-bits are the lowest bit of all channels
+    unsigned pbits = 0;
+    if (info.endpoint_pbits)
+    {
+        pbits = 1;
+
+        for (unsigned e = 0; e < num_endpoints; ++e)
+        {
+            unsigned p = reader.read(1);
+
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                endpoints[e][c] = (endpoints[e][c] << 1) | p;
+            }
+        }
+    }
+    else if (info.shared_pbits)
+    {
+        pbits = 1;
+
+        for (unsigned s = 0; s < info.subsets; ++s)
+        {
+            unsigned p = reader.read(1);
+
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                endpoints[2 * s][c] = (endpoints[2 * s][c] << 1) | p;
+                endpoints[2 * s + 1][c] = (endpoints[2 * s + 1][c] << 1) | p;
+            }
+        }
+    }
+
+    // Expand to 8 bits by replicating the high bits
+    unsigned const color_prec = info.color_bits + pbits;
+    unsigned const alpha_prec = info.alpha_bits + pbits;
+
+    for (unsigned e = 0; e < num_endpoints; ++e)
+    {
+        for (unsigned c = 0; c < 3; ++c)
+        {
+            unsigned v = endpoints[e][c] << (8 - color_prec);
+            endpoints[e][c] = v | (v >> color_prec);
+        }
+
+        if (info.alpha_bits)
+        {
+            unsigned v = endpoints[e][3] << (8 - alpha_prec);
+            endpoints[e][3] = v | (v >> alpha_prec);
+        }
+        else
+        {
+            endpoints[e][3] = 255;
+        }
+    }
+
+    uint8_t const* subsets = info.subsets == 2 ? bc7_partition2(partition)
+                           : info.subsets == 3 ? bc7_partition3(partition)
+                           : nullptr;
+
+    auto subset = [&](unsigned i) -> unsigned
+    {
+        return subsets ? subsets[i] : 0;
+    };
+
+    // Anchor texels store their indices w/ one bit less, the index of texel
+    // i starts after the indices of texels [0..i). Only the indices of
+    // texels [first..last) are read
+    unsigned anchors[3] = { 0, 0, 0 };
+
+    for (unsigned s = 1; s < info.subsets; ++s)
+    {
+        anchors[s] = bc7_anchor(info.subsets, partition, s);
+    }
+
+    auto index_offset = [&](unsigned i, unsigned bits) -> unsigned
+    {
+        unsigned offset = i * bits;
+
+        for (unsigned s = 0; s < info.subsets; ++s)
+        {
+            offset -= anchors[s] < i ? 1 : 0;
+        }
+
+        return offset;
+    };
+
+    unsigned const indices_begin = reader.position();
+    unsigned const indices2_begin = indices_begin + 16 * info.index_bits - info.subsets;
+
+    for (unsigned i = first; i < last; ++i)
+    {
+        unsigned s = subset(i);
+        unsigned const* e0 = endpoints[2 * s];
+        unsigned const* e1 = endpoints[2 * s + 1];
+
+        bool anchor = i == anchors[s];
+
+        reader.seek(indices_begin + index_offset(i, info.index_bits));
+        unsigned index = reader.read(anchor ? info.index_bits - 1 : info.index_bits);
+
+        unsigned color_index = index;
+        unsigned color_bits = info.index_bits;
+        unsigned alpha_index = index;
+        unsigned alpha_bits = info.index_bits;
+
+        if (info.index2_bits)
+        {
+            // Separate indices for color and alpha, may be swapped. The
+            // second index set has one subset, its anchor is texel 0
+            reader.seek(indices2_begin + (i == 0 ? 0 : i * info.index2_bits - 1));
+            unsigned index2 = reader.read(i == 0 ? info.index2_bits - 1 : info.index2_bits);
+
+            if (index_selection)
+            {
+                color_index = index2;
+                color_bits = info.index2_bits;
+            }
+            else
+            {
+                alpha_index = index2;
+                alpha_bits = info.index2_bits;
+            }
+        }
+
+        unsigned rgba[4] = {
+            bc7_interpolate(e0[0], e1[0], color_index, color_bits),
+            bc7_interpolate(e0[1], e1[1], color_index, color_bits),
+            bc7_interpolate(e0[2], e1[2], color_index, color_bits),
+            bc7_interpolate(e0[3], e1[3], alpha_index, alpha_bits)
+            };
+
+        if (rotation > 0)
+        {
+            std::swap(rgba[3], rgba[rotation - 1]);
+        }
+
+        out[i] = make_bc_texel(rgba[0], rgba[1], rgba[2], rgba[3]);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Dispatch
+//
+
+inline void decode_block(
+        tex_block_format    format,
+        uint8_t const*      block,
+        unsigned            first,
+        unsigned            last,
+        bc_texel*           out
+        )
+{
+    switch (format)
+    {
+    case BC1:
+        decode_bc1(block, first, last, out);
+        break;
+
+    case BC3:
+        decode_bc3(block, first, last, out);
+        break;
+
+    case BC5:
+        decode_bc5(block, first, last, out);
+        break;
+
+    case BC7:
+        decode_bc7(block, first, last, out);
+        break;
+    }
+}
+
+} // detail
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_BC_DECODE_H
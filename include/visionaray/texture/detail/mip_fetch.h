@@ -0,0 +1,190 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_MIP_FETCH_H
+#define VSNRAY_TEXTURE_DETAIL_MIP_FETCH_H 1
+
+#include <type_traits>
+
+#include "../../math/simd/type_traits.h"
+#include "../../math/detail/math.h"
+#include "../../math/vector.h"
+#include "mipmapped_texture.h"
+#include "tex_fetch.h"
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Range of mip levels accessed by all lanes
+//
+
+VSNRAY_FUNC
+inline void mip_level_range(float first, float last, int& lo, int& hi)
+{
+    lo = static_cast<int>(first);
+    hi = static_cast<int>(last);
+}
+
+template <
+    typename F,
+    typename = typename std::enable_if<simd::is_simd_vector<F>::value>::type
+    >
+inline void mip_level_range(F const& first, F const& last, int& lo, int& hi)
+{
+    simd::aligned_array_t<F> f;
+    simd::aligned_array_t<F> l;
+    store(f, first);
+    store(l, last);
+
+    lo = static_cast<int>(f[0]);
+    hi = static_cast<int>(l[0]);
+
+    for (int i = 1; i < simd::num_elements<F>::value; ++i)
+    {
+        lo = min(lo, static_cast<int>(f[i]));
+        hi = max(hi, static_cast<int>(l[i]));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Sample at a level of detail
+//
+// MipmapNearest samples the closest level, MipmapLinear (and
+// MipmapAnisotropic w/o derivatives) interpolates between the two closest
+// levels. The lod is clamped to the available levels. SIMD lanes may access
+// different levels, each level is sampled once for the whole packet.
+//
+
+template <typename T, typename FloatT>
+VSNRAY_FUNC
+inline auto mip_fetch_lod(
+        mipmapped_texture_ref<T, 2> const&  tex,
+        vector<2, FloatT> const&            coord,
+        FloatT                              lod
+        )
+    -> decltype( tex_fetch_impl(tex.level(0), coord) )
+{
+    using R = decltype( tex_fetch_impl(tex.level(0), coord) );
+
+    FloatT max_level(static_cast<float>(tex.num_levels() - 1));
+
+    // Also maps NaN to 0
+    lod = select(lod > FloatT(0.0), lod, FloatT(0.0));
+    lod = min(lod, max_level);
+
+    if (tex.get_mipmap_filter_mode() == MipmapNearest)
+    {
+        lod = floor(lod + FloatT(0.5));
+    }
+
+    FloatT l0 = floor(lod);
+    FloatT l1 = min(l0 + FloatT(1.0), max_level);
+    FloatT frac = lod - l0;
+
+    int lo = 0;
+    int hi = 0;
+    mip_level_range(l0, l1, lo, hi);
+
+    R result(FloatT(0.0));
+
+    for (int l = lo; l <= hi; ++l)
+    {
+        FloatT fl(static_cast<float>(l));
+
+        FloatT w = select(l0 == fl, FloatT(1.0) - frac, FloatT(0.0))
+                 + select(l1 == fl, frac, FloatT(0.0));
+
+        if (any(w > FloatT(0.0)))
+        {
+            result += tex_fetch_impl(tex.level(l), coord) * w;
+        }
+    }
+
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Sample w/ texture coordinate derivatives
+//
+// ddx and ddy are the changes of the texture coordinates from one pixel to
+// the next. The isotropic filters select the lod from the larger axis of
+// the footprint. MipmapAnisotropic takes up to max_anisotropy trilinear
+// probes along the major axis at the lod of the minor axis (footprint
+// assembly), an approximation of EWA filtering.
+//
+
+template <typename T, typename FloatT>
+VSNRAY_FUNC
+inline auto mip_fetch_grad(
+        mipmapped_texture_ref<T, 2> const&  tex,
+        vector<2, FloatT> const&            coord,
+        vector<2, FloatT> const&            ddx,
+        vector<2, FloatT> const&            ddy
+        )
+    -> decltype( tex_fetch_impl(tex.level(0), coord) )
+{
+    using R = decltype( tex_fetch_impl(tex.level(0), coord) );
+
+    vector<2, FloatT> size(
+            FloatT(static_cast<float>(tex.width())),
+            FloatT(static_cast<float>(tex.height()))
+            );
+
+    // Footprint axes in texels
+    FloatT lx = length(ddx * size);
+    FloatT ly = length(ddy * size);
+
+    FloatT major = max(lx, ly);
+
+    if (tex.get_mipmap_filter_mode() != MipmapAnisotropic)
+    {
+        return mip_fetch_lod(tex, coord, log2(major));
+    }
+
+    FloatT minor = min(lx, ly);
+    FloatT max_aniso(static_cast<float>(max(tex.get_max_anisotropy(), 1U)));
+
+    // One probe w/o footprint, max_anisotropy probes for degenerate
+    // footprints w/o extent along the minor axis
+    FloatT n = select(
+            minor > FloatT(0.0),
+            min(ceil(major / minor), max_aniso),
+            select(major > FloatT(0.0), max_aniso, FloatT(1.0))
+            );
+    n = max(n, FloatT(1.0));
+
+    auto axis = select(lx >= ly, ddx, ddy);
+    FloatT lod = log2(major / n);
+
+    int num_probes = 1;
+    int ignore = 1;
+    mip_level_range(n, n, ignore, num_probes);
+
+    R result(FloatT(0.0));
+
+    for (int i = 0; i < num_probes; ++i)
+    {
+        FloatT fi(static_cast<float>(i));
+
+        // Probes are spaced evenly over the major axis, lanes w/
+        // fewer probes skip the remaining ones
+        FloatT offset = (fi + FloatT(0.5)) / n - FloatT(0.5);
+        FloatT w = select(fi < n, FloatT(1.0) / n, FloatT(0.0));
+
+        result += mip_fetch_lod(tex, coord + axis * offset, lod) * w;
+    }
+
+    return result;
+}
+
+} // detail
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_MIP_FETCH_H
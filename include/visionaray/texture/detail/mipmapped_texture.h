@@ -0,0 +1,477 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_MIPMAPPED_TEXTURE_H
+#define VSNRAY_TEXTURE_DETAIL_MIPMAPPED_TEXTURE_H 1
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "../../detail/macros.h"
+#include "../../detail/parallel_for.h"
+#include "../../detail/range.h"
+#include "../../detail/thread_pool.h"
+#include "../../math/simd/simd.h"
+#include "../../math/detail/math.h"
+#include "../../math/vector.h"
+#include "../../aligned_vector.h"
+#include "texture_common.h"
+
+namespace visionaray
+{
+
+template <typename T, unsigned Dim>
+class mipmapped_texture_ref;
+
+
+//-------------------------------------------------------------------------------------------------
+// Mipmapped texture
+//
+// Owns a pyramid of textures, level 0 is the base texture, each further
+// level is downsampled by a factor of two w/ a 2x2 box filter, down to
+// 1x1 texels. Address mode, filter mode, color space and coordinate
+// normalization apply to all levels. Sample the pyramid w/ the
+// tex2D(tex, coord, lod) and tex2D(tex, coord, ddx, ddy) overloads of a
+// mipmapped_texture_ref.
+//
+// Only 2D textures are supported, levels are CPU textures.
+//
+
+template <typename T, unsigned Dim>
+class mipmapped_texture
+{
+public:
+
+    static_assert(Dim == 2, "Only 2D textures can be mipmapped");
+
+    using value_type = T;
+    using level_type = texture<T, Dim>;
+    using ref_type = mipmapped_texture_ref<T, Dim>;
+    enum { dimensions = Dim };
+
+public:
+
+    mipmapped_texture() = default;
+
+    // Build the pyramid from the base texture on the calling thread,
+    // max_levels = 0 builds all levels
+    explicit mipmapped_texture(level_type base, unsigned max_levels = 0);
+
+    // Same, downsampling in parallel on pool
+    mipmapped_texture(level_type base, thread_pool& pool, unsigned max_levels = 0);
+
+    // Level references point to the pyramid of the copy
+    mipmapped_texture(mipmapped_texture const& rhs);
+    mipmapped_texture(mipmapped_texture&& rhs) = default;
+
+    mipmapped_texture& operator=(mipmapped_texture const& rhs);
+    mipmapped_texture& operator=(mipmapped_texture&& rhs) = default;
+
+    unsigned num_levels() const { return static_cast<unsigned>(levels_.size()); }
+
+    level_type const& level(unsigned l) const { assert(l < num_levels()); return levels_[l]; }
+
+    // Size of the base level
+    unsigned width() const { return levels_.empty() ? 0 : levels_[0].width(); }
+    unsigned height() const { return levels_.empty() ? 0 : levels_[0].height(); }
+
+    void set_address_mode(tex_address_mode mode);
+    void set_filter_mode(tex_filter_mode mode);
+    void set_color_space(tex_color_space cs);
+    void set_normalized_coords(bool nc);
+
+    void set_mipmap_filter_mode(tex_mipmap_filter_mode mode) { mipmap_filter_mode_ = mode; }
+    tex_mipmap_filter_mode get_mipmap_filter_mode() const { return mipmap_filter_mode_; }
+
+    // Max. number of probes along the major axis w/ MipmapAnisotropic
+    void set_max_anisotropy(unsigned max_anisotropy) { max_anisotropy_ = max_anisotropy; }
+    unsigned get_max_anisotropy() const { return max_anisotropy_; }
+
+    // Level references, stable as long as the texture lives
+    texture_ref<T, Dim> const* level_refs() const { return refs_.data(); }
+
+private:
+
+    void generate(level_type base, thread_pool* pool, unsigned max_levels);
+    void update_refs();
+
+    aligned_vector<level_type> levels_;
+    aligned_vector<texture_ref<T, Dim>> refs_;
+
+    tex_mipmap_filter_mode mipmap_filter_mode_ = MipmapLinear;
+    unsigned max_anisotropy_ = 8;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// View to a mipmapped texture, use as kernel parameter
+//
+
+template <typename T, unsigned Dim>
+class mipmapped_texture_ref
+{
+public:
+
+    using value_type = T;
+    using level_type = texture_ref<T, Dim>;
+    enum { dimensions = Dim };
+
+public:
+
+    mipmapped_texture_ref() = default;
+
+    explicit mipmapped_texture_ref(mipmapped_texture<T, Dim> const& tex)
+        : levels_(tex.level_refs())
+        , num_levels_(tex.num_levels())
+        , mipmap_filter_mode_(tex.get_mipmap_filter_mode())
+        , max_anisotropy_(tex.get_max_anisotropy())
+    {
+    }
+
+    VSNRAY_FUNC unsigned num_levels() const { return num_levels_; }
+
+    VSNRAY_FUNC level_type const& level(unsigned l) const { return levels_[l]; }
+
+    VSNRAY_FUNC unsigned width() const { return levels_[0].width(); }
+    VSNRAY_FUNC unsigned height() const { return levels_[0].height(); }
+
+    VSNRAY_FUNC tex_filter_mode get_filter_mode() const { return levels_[0].get_filter_mode(); }
+    VSNRAY_FUNC tex_color_space get_color_space() const { return levels_[0].get_color_space(); }
+    VSNRAY_FUNC bool get_normalized_coords() const { return levels_[0].get_normalized_coords(); }
+
+    VSNRAY_FUNC tex_mipmap_filter_mode get_mipmap_filter_mode() const { return mipmap_filter_mode_; }
+    VSNRAY_FUNC unsigned get_max_anisotropy() const { return max_anisotropy_; }
+
+    VSNRAY_FUNC operator bool() const { return num_levels_ > 0; }
+
+private:
+
+    level_type const* levels_ = nullptr;
+    unsigned num_levels_ = 0;
+
+    tex_mipmap_filter_mode mipmap_filter_mode_ = MipmapLinear;
+    unsigned max_anisotropy_ = 8;
+
+};
+
+
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Texels as arrays of float channels for downsampling
+//
+
+template <typename T>
+inline T mip_channel_from_float(float f, std::true_type /* integral */)
+{
+    return static_cast<T>(f + 0.5f);
+}
+
+template <typename T>
+inline T mip_channel_from_float(float f, std::false_type /* integral */)
+{
+    return T(f);
+}
+
+template <typename T>
+struct mip_texel
+{
+    enum { channels = 1 };
+
+    static void to_float(T const& t, float* f)
+    {
+        f[0] = static_cast<float>(t);
+    }
+
+    static T from_float(float const* f)
+    {
+        return mip_channel_from_float<T>(f[0], std::is_integral<T>{});
+    }
+};
+
+template <size_t N, typename T>
+struct mip_texel<vector<N, T>>
+{
+    enum { channels = N };
+
+    static void to_float(vector<N, T> const& t, float* f)
+    {
+        for (size_t c = 0; c < N; ++c)
+        {
+            f[c] = static_cast<float>(t[c]);
+        }
+    }
+
+    static vector<N, T> from_float(float const* f)
+    {
+        vector<N, T> result;
+
+        for (size_t c = 0; c < N; ++c)
+        {
+            result[c] = mip_channel_from_float<T>(f[c], std::is_integral<T>{});
+        }
+
+        return result;
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Downsample one level w/ a 2x2 box filter
+//
+// Source rows are converted to floats, the two rows of a destination row
+// are summed up w/ SIMD, then horizontal pairs of texels are averaged.
+// Odd source sizes drop the last row or column. sRGB textures are
+// averaged in linear space.
+//
+
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX512F)
+using mipmap_float = simd::float16;
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX)
+using mipmap_float = simd::float8;
+#else
+using mipmap_float = simd::float4;
+#endif
+
+// Rows per tile for parallel_for
+static const unsigned MipmapTileRows = 16;
+
+template <typename T>
+inline void downsample(
+        texture<T, 2> const&    src,
+        texture<T, 2>&          dst,
+        thread_pool*            pool
+        )
+{
+    using texel = mip_texel<T>;
+    using F = mipmap_float;
+
+    unsigned const C = texel::channels;
+    unsigned const N = simd::num_elements<F>::value;
+
+    unsigned sw = src.width();
+    unsigned sh = src.height();
+    unsigned dw = dst.width();
+    unsigned dh = dst.height();
+
+    bool srgb = src.get_color_space() == sRGB;
+    unsigned srgb_channels = min(C, 3U);
+
+    // Rows are padded to multiples of the SIMD width, so that loads are aligned
+    size_t row_len = round_up(static_cast<size_t>(sw * C), static_cast<size_t>(N));
+
+    T const* src_data = src.data();
+    aligned_vector<T> dst_data(dw * static_cast<size_t>(dh));
+
+    auto load_row = [&](unsigned y, float* row)
+    {
+        for (unsigned x = 0; x < sw; ++x)
+        {
+            texel::to_float(src_data[y * static_cast<size_t>(sw) + x], row + x * C);
+
+            for (unsigned c = 0; c < srgb_channels && srgb; ++c)
+            {
+                row[x * C + c] = std::pow(row[x * C + c], 2.2f);
+            }
+        }
+    };
+
+    auto downsample_rows = [&](range1d<unsigned> const& r)
+    {
+        aligned_vector<float, 64> rows(row_len * 2, 0.0f);
+        float* row0 = rows.data();
+        float* row1 = rows.data() + row_len;
+
+        for (unsigned y = r.begin(); y != r.end(); ++y)
+        {
+            load_row(2 * y, row0);
+            load_row(min(2 * y + 1, sh - 1), row1);
+
+            for (size_t i = 0; i < row_len; i += N)
+            {
+                store(row0 + i, F(row0 + i) + F(row1 + i));
+            }
+
+            for (unsigned x = 0; x < dw; ++x)
+            {
+                float const* t0 = row0 + 2 * x * C;
+                float const* t1 = row0 + min(2 * x + 1, sw - 1) * C;
+
+                float avg[C];
+
+                for (unsigned c = 0; c < C; ++c)
+                {
+                    avg[c] = (t0[c] + t1[c]) * 0.25f;
+                }
+
+                for (unsigned c = 0; c < srgb_channels && srgb; ++c)
+                {
+                    avg[c] = std::pow(avg[c], 1.0f / 2.2f);
+                }
+
+                dst_data[y * static_cast<size_t>(dw) + x] = texel::from_float(avg);
+            }
+        }
+    };
+
+    // Downsample tiles of rows in parallel if a pool is available
+    if (pool == nullptr)
+    {
+        downsample_rows(range1d<unsigned>(0, dh));
+    }
+    else
+    {
+        parallel_for(*pool, tiled_range1d<unsigned>(0, dh, MipmapTileRows), downsample_rows);
+    }
+
+    dst.reset(dst_data.data());
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// mipmapped_texture members
+//
+
+template <typename T, unsigned Dim>
+inline mipmapped_texture<T, Dim>::mipmapped_texture(level_type base, unsigned max_levels)
+{
+    generate(std::move(base), nullptr, max_levels);
+}
+
+template <typename T, unsigned Dim>
+inline mipmapped_texture<T, Dim>::mipmapped_texture(level_type base, thread_pool& pool, unsigned max_levels)
+{
+    generate(std::move(base), &pool, max_levels);
+}
+
+template <typename T, unsigned Dim>
+inline mipmapped_texture<T, Dim>::mipmapped_texture(mipmapped_texture const& rhs)
+    : levels_(rhs.levels_)
+    , mipmap_filter_mode_(rhs.mipmap_filter_mode_)
+    , max_anisotropy_(rhs.max_anisotropy_)
+{
+    update_refs();
+}
+
+template <typename T, unsigned Dim>
+inline mipmapped_texture<T, Dim>& mipmapped_texture<T, Dim>::operator=(mipmapped_texture const& rhs)
+{
+    if (&rhs != this)
+    {
+        levels_ = rhs.levels_;
+        mipmap_filter_mode_ = rhs.mipmap_filter_mode_;
+        max_anisotropy_ = rhs.max_anisotropy_;
+        update_refs();
+    }
+
+    return *this;
+}
+
+template <typename T, unsigned Dim>
+inline void mipmapped_texture<T, Dim>::set_address_mode(tex_address_mode mode)
+{
+    for (auto& l : levels_)
+    {
+        l.set_address_mode(mode);
+    }
+
+    update_refs();
+}
+
+template <typename T, unsigned Dim>
+inline void mipmapped_texture<T, Dim>::set_filter_mode(tex_filter_mode mode)
+{
+    for (auto& l : levels_)
+    {
+        l.set_filter_mode(mode);
+    }
+
+    update_refs();
+}
+
+template <typename T, unsigned Dim>
+inline void mipmapped_texture<T, Dim>::set_color_space(tex_color_space cs)
+{
+    for (auto& l : levels_)
+    {
+        l.set_color_space(cs);
+    }
+
+    update_refs();
+}
+
+template <typename T, unsigned Dim>
+inline void mipmapped_texture<T, Dim>::set_normalized_coords(bool nc)
+{
+    for (auto& l : levels_)
+    {
+        l.set_normalized_coords(nc);
+    }
+
+    update_refs();
+}
+
+template <typename T, unsigned Dim>
+inline void mipmapped_texture<T, Dim>::generate(level_type base, thread_pool* pool, unsigned max_levels)
+{
+    unsigned w = base.width();
+    unsigned h = base.height();
+
+    unsigned num_levels = 1;
+
+    while ((w >> num_levels) > 0 || (h >> num_levels) > 0)
+    {
+        ++num_levels;
+    }
+
+    if (max_levels > 0)
+    {
+        num_levels = min(num_levels, max_levels);
+    }
+
+    levels_.clear();
+    levels_.reserve(num_levels);
+    levels_.emplace_back(std::move(base));
+
+    for (unsigned l = 1; l < num_levels; ++l)
+    {
+        level_type const& prev = levels_[l - 1];
+
+        level_type next(max(prev.width() / 2, 1U), max(prev.height() / 2, 1U));
+        next.set_address_mode(prev.get_address_mode());
+        next.set_filter_mode(prev.get_filter_mode());
+        next.set_color_space(prev.get_color_space());
+        next.set_normalized_coords(prev.get_normalized_coords());
+
+        detail::downsample(prev, next, pool);
+
+        levels_.emplace_back(std::move(next));
+    }
+
+    update_refs();
+}
+
+template <typename T, unsigned Dim>
+inline void mipmapped_texture<T, Dim>::update_refs()
+{
+    refs_.clear();
+    refs_.reserve(levels_.size());
+
+    for (auto const& l : levels_)
+    {
+        refs_.emplace_back(l);
+    }
+}
+
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_MIPMAPPED_TEXTURE_H
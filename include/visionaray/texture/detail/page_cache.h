@@ -0,0 +1,303 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_PAGE_CACHE_H
+#define VSNRAY_TEXTURE_DETAIL_PAGE_CACHE_H 1
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "../../detail/parallel_for.h"
+#include "../../detail/range.h"
+#include "../../detail/thread_pool.h"
+#include "../../aligned_vector.h"
+#include "page_counters.h"
+
+namespace visionaray
+{
+
+class page_cache;
+
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Pages of one paged texture, independent of the texel type
+//
+// Fetches read the page table concurrently, pages are only published or
+// evicted by the page cache. A page that is not resident is requested
+// once, it is loaded by the next page_cache::update().
+//
+
+class paged_image
+{
+public:
+
+    paged_image(page_cache& cache, unsigned num_pages, size_t page_bytes);
+    virtual ~paged_image();
+
+    paged_image(paged_image const&) = delete;
+    paged_image& operator=(paged_image const&) = delete;
+
+    // Fill dst w/ page_bytes() bytes, called from the page cache's threads.
+    // Returns false if the page could not be loaded
+    virtual bool load_page(unsigned page, void* dst) const = 0;
+
+    page_cache& cache() const { return cache_; }
+
+    unsigned num_pages() const { return num_pages_; }
+    size_t page_bytes() const { return page_bytes_; }
+
+    // Pointer to the page data, or nullptr if the page is not resident
+    void const* page(unsigned page) const
+    {
+        assert(page < num_pages_);
+        return pages_[page].load(std::memory_order_acquire);
+    }
+
+    // Mark page as used in the current frame
+    void touch(unsigned page, unsigned frame) const
+    {
+        // Only write if necessary, the cache line is shared by all threads
+        if (frames_[page].load(std::memory_order_relaxed) != frame)
+        {
+            frames_[page].store(frame, std::memory_order_relaxed);
+        }
+    }
+
+    // Request a page that is not resident
+    void request(unsigned page) const;
+
+protected:
+
+    // Load and pin a page immediately, pinned pages are never evicted
+    void pin(unsigned page);
+
+private:
+
+    friend class visionaray::page_cache;
+
+    page_cache& cache_;
+    unsigned num_pages_;
+    size_t page_bytes_;
+
+    std::unique_ptr<std::atomic<void const*>[]> pages_;
+    std::unique_ptr<std::atomic<unsigned>[]> frames_;
+    std::unique_ptr<std::atomic<bool>[]> requested_;
+
+};
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// Fixed-size LRU cache for the pages of paged textures
+//
+// The cache is shared by all paged textures that were created w/ it and by
+// all threads that fetch from these textures. Texture fetches never block
+// and never load pages: misses are recorded, and the texture falls back to
+// a lower resolution level. update() then loads the requested pages and, if
+// the cache is full, evicts the pages that were not used for the longest
+// time. update() must not run concurrently to texture fetches, call it
+// e.g. between two frames.
+//
+// The size limit applies to all pages except the pinned ones (the lowest
+// resolution level of each texture is always resident).
+//
+// Hits and misses are counted per thread and added to the cache's counters
+// by flush_page_counters() (see page_counters.h).
+//
+
+class page_cache
+{
+public:
+
+    // Default size: 1 GB
+    explicit page_cache(size_t max_bytes = size_t(1) << 30)
+        : max_bytes_(max_bytes)
+    {
+        reset_counters();
+    }
+
+   ~page_cache()
+    {
+        // Textures must be destroyed before their cache
+        assert(resident_.empty() && pinned_.empty());
+
+        discard_local_counters();
+    }
+
+    page_cache(page_cache const&) = delete;
+    page_cache& operator=(page_cache const&) = delete;
+
+    void set_max_bytes(size_t max_bytes)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        max_bytes_ = max_bytes;
+    }
+
+    size_t get_max_bytes() const
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return max_bytes_;
+    }
+
+    // Bytes of all resident pages, including the pinned ones
+    size_t resident_bytes() const
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return resident_bytes_ + pinned_bytes_;
+    }
+
+    size_t num_resident_pages() const
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return resident_.size();
+    }
+
+    // Number of update() calls, pages are timestamped w/ the frame they were last used in
+    unsigned frame() const
+    {
+        return frame_.load(std::memory_order_relaxed);
+    }
+
+    // Texel fetches that found their page resident
+    uint64_t hits() const
+    {
+        flush_page_counters();
+
+        uint64_t result = 0;
+
+        for (auto const& s : counters_)
+        {
+            result += s.hits.load(std::memory_order_relaxed);
+        }
+
+        return result;
+    }
+
+    // Texel fetches that fell back to a lower resolution
+    uint64_t misses() const
+    {
+        flush_page_counters();
+
+        uint64_t result = 0;
+
+        for (auto const& s : counters_)
+        {
+            result += s.misses.load(std::memory_order_relaxed);
+        }
+
+        return result;
+    }
+
+    void reset_counters()
+    {
+        discard_local_counters();
+
+        for (auto& s : counters_)
+        {
+            s.hits.store(0, std::memory_order_relaxed);
+            s.misses.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Count on the calling thread, w/o atomic operations
+    void count(unsigned hits, unsigned misses)
+    {
+        auto& local = detail::this_thread_page_counters();
+
+        if (local.shards != counters_)
+        {
+            flush_page_counters();
+            local.shards = counters_;
+        }
+
+        local.hits += hits;
+        local.misses += misses;
+    }
+
+    // Load the requested pages in parallel on pool
+    void update(thread_pool& pool)
+    {
+        load_requested(&pool);
+    }
+
+    // Same, loads on the calling thread
+    void update()
+    {
+        load_requested(nullptr);
+    }
+
+private:
+
+    friend class detail::paged_image;
+
+    struct resident_page
+    {
+        detail::paged_image* image;
+        unsigned page;
+        aligned_vector<uint8_t, 64> data;
+    };
+
+    void request(detail::paged_image const* image, unsigned page)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        requests_.emplace_back(const_cast<detail::paged_image*>(image), page);
+    }
+
+    void discard_local_counters()
+    {
+        auto& local = detail::this_thread_page_counters();
+
+        if (local.shards == counters_)
+        {
+            local = detail::page_counters_local();
+        }
+    }
+
+    void load_requested(thread_pool* pool);
+    void pin(detail::paged_image* image, unsigned page);
+    void release(detail::paged_image* image);
+
+    mutable std::mutex mutex_;
+
+    size_t max_bytes_;
+    size_t resident_bytes_ = 0;
+    size_t pinned_bytes_ = 0;
+
+    std::vector<resident_page> resident_;
+    std::vector<resident_page> pinned_;
+    std::vector<std::pair<detail::paged_image*, unsigned>> requests_;
+
+    std::atomic<unsigned> frame_{1};
+
+    detail::page_counter_shard counters_[detail::PageCounterShards];
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Page cache shared by the whole application, used by paged textures by default
+//
+
+inline page_cache& default_page_cache()
+{
+    static page_cache cache;
+    return cache;
+}
+
+} // visionaray
+
+#include "page_cache.inl"
+
+#endif // VSNRAY_TEXTURE_DETAIL_PAGE_CACHE_H
@@ -0,0 +1,201 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// paged_image members
+//
+
+inline paged_image::paged_image(page_cache& cache, unsigned num_pages, size_t page_bytes)
+    : cache_(cache)
+    , num_pages_(num_pages)
+    , page_bytes_(page_bytes)
+    , pages_(new std::atomic<void const*>[num_pages])
+    , frames_(new std::atomic<unsigned>[num_pages])
+    , requested_(new std::atomic<bool>[num_pages])
+{
+    for (unsigned i = 0; i < num_pages_; ++i)
+    {
+        pages_[i].store(nullptr, std::memory_order_relaxed);
+        frames_[i].store(0, std::memory_order_relaxed);
+        requested_[i].store(false, std::memory_order_relaxed);
+    }
+}
+
+inline paged_image::~paged_image()
+{
+    cache_.release(this);
+}
+
+inline void paged_image::request(unsigned page) const
+{
+    assert(page < num_pages_);
+
+    // Only the first thread that misses the page adds a request
+    if (!requested_[page].load(std::memory_order_relaxed)
+     && !requested_[page].exchange(true, std::memory_order_relaxed))
+    {
+        cache_.request(this, page);
+    }
+}
+
+inline void paged_image::pin(unsigned page)
+{
+    cache_.pin(this, page);
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// page_cache members
+//
+
+inline void page_cache::load_requested(thread_pool* pool)
+{
+    std::lock_guard<std::mutex> l(mutex_);
+
+    unsigned frame = frame_.load(std::memory_order_relaxed);
+
+    std::vector<std::pair<detail::paged_image*, unsigned>> requests;
+    std::swap(requests, requests_);
+
+    auto last_used = [](resident_page const& p)
+    {
+        return p.image->frames_[p.page].load(std::memory_order_relaxed);
+    };
+
+    // Most recently used pages first, evict from the back
+    std::sort(
+            resident_.begin(),
+            resident_.end(),
+            [&](resident_page const& a, resident_page const& b)
+            {
+                return last_used(a) > last_used(b);
+            }
+            );
+
+    std::vector<resident_page> loads;
+
+    for (auto const& r : requests)
+    {
+        detail::paged_image* image = r.first;
+        unsigned page = r.second;
+        size_t bytes = image->page_bytes();
+
+        // Pages used in this frame are not evicted
+        while (resident_bytes_ + bytes > max_bytes_ && !resident_.empty() && last_used(resident_.back()) != frame)
+        {
+            auto& victim = resident_.back();
+            victim.image->pages_[victim.page].store(nullptr, std::memory_order_relaxed);
+            resident_bytes_ -= victim.data.size();
+            resident_.pop_back();
+        }
+
+        if (resident_bytes_ + bytes > max_bytes_)
+        {
+            // Cache is full, the page is requested again by the next miss
+            image->requested_[page].store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        resident_bytes_ += bytes;
+        loads.push_back({ image, page, aligned_vector<uint8_t, 64>(bytes) });
+    }
+
+    // Load from disk in parallel
+    std::unique_ptr<bool[]> loaded(new bool[loads.size()]);
+
+    auto load = [&](range1d<unsigned> const& r)
+    {
+        for (unsigned i = r.begin(); i != r.end(); ++i)
+        {
+            loaded[i] = loads[i].image->load_page(loads[i].page, loads[i].data.data());
+        }
+    };
+
+    unsigned num_loads = static_cast<unsigned>(loads.size());
+
+    if (pool == nullptr || pool->num_threads <= 1 || num_loads <= 1)
+    {
+        load(range1d<unsigned>(0, num_loads));
+    }
+    else
+    {
+        parallel_for(*pool, tiled_range1d<unsigned>(0, num_loads, 1), load);
+    }
+
+    // Publish
+    for (unsigned i = 0; i < num_loads; ++i)
+    {
+        auto& p = loads[i];
+
+        p.image->requested_[p.page].store(false, std::memory_order_relaxed);
+
+        if (!loaded[i])
+        {
+            // Not published, the page is requested again by the next miss
+            resident_bytes_ -= p.data.size();
+            continue;
+        }
+
+        p.image->frames_[p.page].store(frame, std::memory_order_relaxed);
+        p.image->pages_[p.page].store(p.data.data(), std::memory_order_release);
+        resident_.push_back(std::move(p));
+    }
+
+    frame_.store(frame + 1, std::memory_order_relaxed);
+}
+
+inline void page_cache::pin(detail::paged_image* image, unsigned page)
+{
+    // There is no lower resolution to fall back to, a pinned page that
+    // cannot be loaded stays resident w/ zero texels
+    resident_page p{ image, page, aligned_vector<uint8_t, 64>(image->page_bytes()) };
+
+    if (!image->load_page(page, p.data.data()))
+    {
+        std::fill(p.data.begin(), p.data.end(), uint8_t(0));
+    }
+
+    image->pages_[page].store(p.data.data(), std::memory_order_release);
+
+    std::lock_guard<std::mutex> l(mutex_);
+    pinned_bytes_ += p.data.size();
+    pinned_.push_back(std::move(p));
+}
+
+inline void page_cache::release(detail::paged_image* image)
+{
+    std::lock_guard<std::mutex> l(mutex_);
+
+    auto owned = [image](resident_page const& p) { return p.image == image; };
+
+    for (auto const& p : resident_)
+    {
+        resident_bytes_ -= owned(p) ? p.data.size() : 0;
+    }
+
+    for (auto const& p : pinned_)
+    {
+        pinned_bytes_ -= owned(p) ? p.data.size() : 0;
+    }
+
+    resident_.erase(std::remove_if(resident_.begin(), resident_.end(), owned), resident_.end());
+    pinned_.erase(std::remove_if(pinned_.begin(), pinned_.end(), owned), pinned_.end());
+
+    requests_.erase(
+            std::remove_if(
+                requests_.begin(),
+                requests_.end(),
+                [image](std::pair<detail::paged_image*, unsigned> const& r) { return r.first == image; }
+                ),
+            requests_.end()
+            );
+}
+
+} // visionaray
@@ -0,0 +1,85 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_PAGE_COUNTERS_H
+#define VSNRAY_TEXTURE_DETAIL_PAGE_COUNTERS_H 1
+
+#include <atomic>
+#include <cstdint>
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Hit and miss counters of a page cache, threads count in different shards
+//
+
+static const unsigned PageCounterShards = 16;
+
+struct alignas(64) page_counter_shard
+{
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+};
+
+inline unsigned page_counter_shard_index()
+{
+    static std::atomic<unsigned> next(0);
+    thread_local unsigned index = next++ % PageCounterShards;
+    return index;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Texel fetches of the calling thread that were not yet added to the shards
+// of their page cache. Fetches only increment these, the shards are updated
+// once per tile
+//
+
+struct page_counters_local
+{
+    page_counter_shard* shards = nullptr;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+inline page_counters_local& this_thread_page_counters()
+{
+    thread_local page_counters_local counters;
+    return counters;
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// Add the calling thread's hits and misses to the counters of their page
+// cache. The CPU schedulers call this at the end of each tile. Other
+// threads that fetch from paged textures call it before the counters are
+// read on another thread, and before the page cache is destroyed
+//
+
+inline void flush_page_counters()
+{
+    auto& local = detail::this_thread_page_counters();
+
+    if (local.hits == 0 && local.misses == 0)
+    {
+        return;
+    }
+
+    auto& s = local.shards[detail::page_counter_shard_index()];
+    s.hits.fetch_add(local.hits, std::memory_order_relaxed);
+    s.misses.fetch_add(local.misses, std::memory_order_relaxed);
+
+    local.hits = 0;
+    local.misses = 0;
+}
+
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_PAGE_COUNTERS_H
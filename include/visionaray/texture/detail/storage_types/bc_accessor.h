@@ -0,0 +1,87 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_BC_ACCESSOR_H
+#define VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_BC_ACCESSOR_H 1
+
+#include <cstdint>
+
+#include "../../../math/detail/math.h"
+#include "../../../math/unorm.h"
+#include "../../../math/vector.h"
+#include "../../../array.h"
+#include "bc_storage.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// View to (user-managed) block compressed data w/ the layout of bc_storage
+//
+
+template <unsigned Dim>
+class bc_accessor
+{
+public:
+
+    static_assert(Dim == 2, "bc_accessor only supports 2D textures");
+
+    using value_type = vector<4, unorm<8>>;
+
+public:
+
+    bc_accessor() = default;
+
+    explicit bc_accessor(uint8_t const* data, array<unsigned, 2> size, tex_block_format format)
+    {
+        reset(data, size, format);
+    }
+
+    array<unsigned, 2> size() const
+    {
+        return size_;
+    }
+
+    tex_block_format get_block_format() const
+    {
+        return format_;
+    }
+
+    template <typename U, typename I>
+    U value(U /* */, I const& x, I const& y) const
+    {
+        return detail::bc_value(U{}, data_, format_, num_blocks_x_, x, y);
+    }
+
+    void reset(uint8_t const* data, array<unsigned, 2> size, tex_block_format format)
+    {
+        data_ = data;
+        size_ = size;
+        num_blocks_x_ = div_up(size[0], 4U);
+        format_ = format;
+    }
+
+    uint8_t const* data() const
+    {
+        return data_;
+    }
+
+    operator bool() const
+    {
+        return data_ != nullptr;
+    }
+
+protected:
+
+    uint8_t const* data_ = nullptr;
+    array<unsigned, 2> size_ = {{ 0, 0 }};
+    unsigned num_blocks_x_ = 0;
+    tex_block_format format_ = BC1;
+
+};
+
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_BC_ACCESSOR_H
@@ -0,0 +1,219 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_BC_STORAGE_H
+#define VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_BC_STORAGE_H 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../../../math/simd/type_traits.h"
+#include "../../../math/detail/math.h"
+#include "../../../math/unorm.h"
+#include "../../../math/vector.h"
+#include "../../../aligned_vector.h"
+#include "../../../array.h"
+#include "../bc_decode.h"
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Fetch texels from 4x4 blocks
+//
+
+template <
+    typename U,
+    typename I,
+    typename = typename std::enable_if<!simd::is_simd_vector<I>::value>::type
+    >
+inline U bc_value(
+        U                   /* */,
+        uint8_t const*      blocks,
+        tex_block_format    format,
+        unsigned            num_blocks_x,
+        I const&            x,
+        I const&            y
+        )
+{
+    size_t block_id = size_t(y >> 2) * num_blocks_x + size_t(x >> 2);
+    unsigned i = unsigned((y & 3) * 4 + (x & 3));
+
+    bc_texel texels[16];
+    decode_block(format, blocks + block_id * bc_block_bytes(format), i, i + 1, texels);
+
+    return U(texels[i]);
+}
+
+// Lanes that access the same block share one decode of the whole block
+template <
+    typename U,
+    typename I,
+    typename = typename std::enable_if<simd::is_simd_vector<I>::value>::type,
+    typename = void
+    >
+inline U bc_value(
+        U                   /* */,
+        uint8_t const*      blocks,
+        tex_block_format    format,
+        unsigned            num_blocks_x,
+        I const&            x,
+        I const&            y
+        )
+{
+    using V = vector<4, float>;
+
+    static const int N = simd::num_elements<I>::value;
+
+    simd::aligned_array_t<I> xs;
+    simd::aligned_array_t<I> ys;
+    store(xs, x);
+    store(ys, y);
+
+    size_t block_ids[N];
+    unsigned texel_ids[N];
+
+    for (int l = 0; l < N; ++l)
+    {
+        block_ids[l] = size_t(ys[l] >> 2) * num_blocks_x + size_t(xs[l] >> 2);
+        texel_ids[l] = unsigned((ys[l] & 3) * 4 + (xs[l] & 3));
+    }
+
+    array<V, N> result;
+    bool done[N] = {};
+
+    for (int l = 0; l < N; ++l)
+    {
+        if (done[l])
+        {
+            continue;
+        }
+
+        uint8_t const* block = blocks + block_ids[l] * bc_block_bytes(format);
+
+        bool shared = false;
+        for (int m = l + 1; m < N; ++m)
+        {
+            shared |= block_ids[m] == block_ids[l];
+        }
+
+        bc_texel texels[16];
+
+        if (shared)
+        {
+            decode_block(format, block, 0, 16, texels);
+
+            for (int m = l; m < N; ++m)
+            {
+                if (block_ids[m] == block_ids[l])
+                {
+                    result[m] = V(texels[texel_ids[m]]);
+                    done[m] = true;
+                }
+            }
+        }
+        else
+        {
+            decode_block(format, block, texel_ids[l], texel_ids[l] + 1, texels);
+            result[l] = V(texels[texel_ids[l]]);
+        }
+    }
+
+    return U(simd::pack(result));
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// 2D storage type for block compressed (BCn) data. The 4x4 blocks are kept
+// in memory and decoded when texels are fetched. The texel type is
+// vector<4, unorm<8>> regardless of the format
+//
+
+template <unsigned Dim>
+class bc_storage
+{
+public:
+
+    static_assert(Dim == 2, "bc_storage only supports 2D textures");
+
+    using value_type = vector<4, unorm<8>>;
+
+public:
+
+    bc_storage() = default;
+
+    explicit bc_storage(array<unsigned, 2> size, tex_block_format format = BC1)
+    {
+        realloc(size[0], size[1], format);
+    }
+
+    explicit bc_storage(unsigned w, unsigned h, tex_block_format format = BC1)
+    {
+        realloc(w, h, format);
+    }
+
+    array<unsigned, 2> size() const
+    {
+        return size_;
+    }
+
+    tex_block_format get_block_format() const
+    {
+        return format_;
+    }
+
+    template <typename U, typename I>
+    U value(U /* */, I const& x, I const& y) const
+    {
+        return detail::bc_value(U{}, data_.data(), format_, num_blocks_[0], x, y);
+    }
+
+    void realloc(unsigned w, unsigned h, tex_block_format format)
+    {
+        size_[0] = w;
+        size_[1] = h;
+
+        num_blocks_[0] = div_up(w, 4U);
+        num_blocks_[1] = div_up(h, 4U);
+
+        format_ = format;
+
+        data_.resize(num_blocks_[0] * size_t(num_blocks_[1]) * detail::bc_block_bytes(format_));
+    }
+
+    // Blocks are expected row by row, as stored in DDS files
+    void reset(uint8_t const* blocks)
+    {
+        std::copy(blocks, blocks + data_.size(), data_.begin());
+    }
+
+    uint8_t const* data() const
+    {
+        return data_.data();
+    }
+
+    operator bool() const
+    {
+        return !data_.empty();
+    }
+
+protected:
+
+    aligned_vector<uint8_t> data_;
+    array<unsigned, 2> size_ = {{ 0, 0 }};
+    array<unsigned, 2> num_blocks_ = {{ 0, 0 }};
+    tex_block_format format_ = BC1;
+
+};
+
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_BC_STORAGE_H
@@ -0,0 +1,74 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_PAGED_ACCESSOR_H
+#define VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_PAGED_ACCESSOR_H 1
+
+#include "../../../array.h"
+#include "paged_storage.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// View to the pages of a paged_storage, the storage must outlive the view
+//
+
+template <typename T, unsigned Dim>
+class paged_accessor
+{
+public:
+
+    static_assert(Dim == 2, "paged_accessor only supports 2D textures");
+
+    using value_type = T;
+
+public:
+
+    paged_accessor() = default;
+
+    explicit paged_accessor(detail::paged_data<T> const* data, array<unsigned, 2> size)
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    array<unsigned, 2> size() const
+    {
+        return size_;
+    }
+
+    template <typename U, typename I>
+    U value(U /* */, I const& x, I const& y) const
+    {
+        return detail::paged_value(U{}, *data_, x, y);
+    }
+
+    void reset(detail::paged_data<T> const* data, array<unsigned, 2> size)
+    {
+        data_ = data;
+        size_ = size;
+    }
+
+    detail::paged_data<T> const* data() const
+    {
+        return data_;
+    }
+
+    operator bool() const
+    {
+        return data_ != nullptr;
+    }
+
+protected:
+
+    detail::paged_data<T> const* data_ = nullptr;
+    array<unsigned, 2> size_ = {{ 0, 0 }};
+
+};
+
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_PAGED_ACCESSOR_H
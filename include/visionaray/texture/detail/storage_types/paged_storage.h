@@ -0,0 +1,314 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_PAGED_STORAGE_H
+#define VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_PAGED_STORAGE_H 1
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../../math/detail/math.h"
+#include "../../../math/simd/gather.h"
+#include "../../../math/simd/type_traits.h"
+#include "../../../array.h"
+#include "../page_cache.h"
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Paged layout
+//
+// Each mip level is split into pages of 64x64 texels, texels inside a page
+// are stored row by row. Levels are downsampled by a factor of two (w/
+// floor), down to the first level that fits in a single page. Pages are
+// numbered level by level, row by row.
+//
+
+static const int PageLog2 = 6;
+static const unsigned PageSize = 1 << PageLog2;
+
+struct paged_level
+{
+    unsigned width;
+    unsigned height;
+    unsigned num_pages_x;
+    unsigned first_page;
+};
+
+inline std::vector<paged_level> make_paged_levels(unsigned w, unsigned h, unsigned& num_pages)
+{
+    std::vector<paged_level> levels;
+    num_pages = 0;
+
+    for (;;)
+    {
+        paged_level l;
+        l.width = w;
+        l.height = h;
+        l.num_pages_x = div_up(w, PageSize);
+        l.first_page = num_pages;
+        levels.push_back(l);
+
+        num_pages += l.num_pages_x * div_up(h, PageSize);
+
+        if (w <= PageSize && h <= PageSize)
+        {
+            break;
+        }
+
+        w = max(w / 2, 1U);
+        h = max(h / 2, 1U);
+    }
+
+    return levels;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Pages of a paged texture w/ texel type T
+//
+
+template <typename T>
+class paged_data : public paged_image
+{
+public:
+
+    // Fills the page (page_x, page_y) of a level, PageSize texels per row.
+    // Texels outside the level may be left untouched. Returns false if the
+    // page could not be loaded. Called concurrently from the page cache's
+    // threads
+    using source_type = std::function<bool(unsigned level, unsigned page_x, unsigned page_y, T* dst)>;
+
+public:
+
+    paged_data(unsigned w, unsigned h, source_type source, page_cache& cache)
+        : paged_image(cache, count_pages(w, h), PageSize * PageSize * sizeof(T))
+        , source_(std::move(source))
+    {
+        unsigned num_pages = 0;
+        levels_ = make_paged_levels(w, h, num_pages);
+
+        // The lowest resolution is the fallback for all other levels
+        pin(levels_.back().first_page);
+    }
+
+    bool load_page(unsigned page, void* dst) const
+    {
+        unsigned l = static_cast<unsigned>(levels_.size()) - 1;
+
+        while (levels_[l].first_page > page)
+        {
+            --l;
+        }
+
+        unsigned p = page - levels_[l].first_page;
+
+        return source_(l, p % levels_[l].num_pages_x, p / levels_[l].num_pages_x, static_cast<T*>(dst));
+    }
+
+    unsigned num_levels() const
+    {
+        return static_cast<unsigned>(levels_.size());
+    }
+
+    paged_level const& level(unsigned l) const
+    {
+        return levels_[l];
+    }
+
+    // Texel (x,y) of level 0, or of the highest resolution level whose
+    // page is resident. Requests the page of level 0 if it is missing, and
+    // the page of the next level above the fallback, so that the fallback
+    // refines step by step while level 0 is not resident yet
+    T texel(unsigned x, unsigned y, unsigned frame, bool& hit) const
+    {
+        unsigned missing = 0;
+
+        for (unsigned l = 0; l < levels_.size(); ++l)
+        {
+            paged_level const& level = levels_[l];
+
+            unsigned lx = min(x >> l, level.width - 1);
+            unsigned ly = min(y >> l, level.height - 1);
+
+            unsigned id = level.first_page + (ly >> PageLog2) * level.num_pages_x + (lx >> PageLog2);
+
+            if (T const* p = static_cast<T const*>(page(id)))
+            {
+                touch(id, frame);
+                hit = l == 0;
+
+                if (l > 1)
+                {
+                    request(missing);
+                }
+
+                return p[(ly & (PageSize - 1)) * PageSize + (lx & (PageSize - 1))];
+            }
+
+            if (l == 0)
+            {
+                request(id);
+            }
+
+            missing = id;
+        }
+
+        // The lowest resolution level is pinned
+        assert(0);
+        hit = false;
+        return T();
+    }
+
+private:
+
+    static unsigned count_pages(unsigned w, unsigned h)
+    {
+        unsigned num_pages = 0;
+        make_paged_levels(w, h, num_pages);
+        return num_pages;
+    }
+
+    std::vector<paged_level> levels_;
+    source_type source_;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Fetch texels through the page cache
+//
+
+template <
+    typename U,
+    typename T,
+    typename I,
+    typename = typename std::enable_if<!simd::is_simd_vector<I>::value>::type
+    >
+inline U paged_value(U /* */, paged_data<T> const& data, I const& x, I const& y)
+{
+    bool hit = false;
+    T t = data.texel(static_cast<unsigned>(x), static_cast<unsigned>(y), data.cache().frame(), hit);
+
+    data.cache().count(hit ? 1 : 0, hit ? 0 : 1);
+
+    return U(t);
+}
+
+template <
+    typename U,
+    typename T,
+    typename I,
+    typename = typename std::enable_if<simd::is_simd_vector<I>::value>::type,
+    typename = void
+    >
+inline U paged_value(U /* */, paged_data<T> const& data, I const& x, I const& y)
+{
+    static const int N = simd::num_elements<I>::value;
+
+    simd::aligned_array_t<I> xs;
+    simd::aligned_array_t<I> ys;
+    store(xs, x);
+    store(ys, y);
+
+    unsigned frame = data.cache().frame();
+    unsigned hits = 0;
+
+    T texels[N];
+    simd::aligned_array_t<I> lanes;
+
+    for (int i = 0; i < N; ++i)
+    {
+        bool hit = false;
+        texels[i] = data.texel(static_cast<unsigned>(xs[i]), static_cast<unsigned>(ys[i]), frame, hit);
+        hits += hit ? 1 : 0;
+        lanes[i] = i;
+    }
+
+    data.cache().count(hits, N - hits);
+
+    // Convert to SIMD w/ the gather overloads of the other storage types
+    return U(gather(texels, I(lanes)));
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// 2D storage type for out-of-core textures. The mip levels are split into
+// pages that are loaded on demand into a page cache (see page_cache.h).
+// Texels of pages that are not resident yet are taken from lower
+// resolution levels. The pages are shared by all copies of the storage
+//
+
+template <typename T, unsigned Dim>
+class paged_storage
+{
+public:
+
+    static_assert(Dim == 2, "paged_storage only supports 2D textures");
+
+    using value_type = T;
+    using source_type = typename detail::paged_data<T>::source_type;
+
+public:
+
+    paged_storage() = default;
+
+    paged_storage(
+            unsigned        w,
+            unsigned        h,
+            source_type     source,
+            page_cache&     cache = default_page_cache()
+            )
+        : data_(std::make_shared<detail::paged_data<T>>(w, h, std::move(source), cache))
+        , size_{{ w, h }}
+    {
+    }
+
+    array<unsigned, 2> size() const
+    {
+        return size_;
+    }
+
+    unsigned num_levels() const
+    {
+        return data_ ? data_->num_levels() : 0;
+    }
+
+    template <typename U, typename I>
+    U value(U /* */, I const& x, I const& y) const
+    {
+        return detail::paged_value(U{}, *data_, x, y);
+    }
+
+    detail::paged_data<T> const* data() const
+    {
+        return data_.get();
+    }
+
+    operator bool() const
+    {
+        return data_ != nullptr;
+    }
+
+protected:
+
+    std::shared_ptr<detail::paged_data<T>> data_;
+    array<unsigned, 2> size_ = {{ 0, 0 }};
+
+};
+
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_PAGED_STORAGE_H
@@ -0,0 +1,104 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_TILED_ACCESSOR_H
+#define VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_TILED_ACCESSOR_H 1
+
+#include <cstddef>
+#include <type_traits>
+
+#include "../../../math/detail/math.h"
+#include "../../../math/simd/gather.h"
+#include "../../../math/simd/type_traits.h"
+#include "../../../array.h"
+#include "tiled_storage.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// View to (user-managed) memory w/ the layout of tiled_storage
+//
+
+template <typename T, unsigned Dim>
+class tiled_accessor
+{
+public:
+
+    static_assert(Dim == 2, "tiled_accessor only supports 2D textures");
+
+    using value_type = T;
+
+public:
+
+    tiled_accessor() = default;
+
+    explicit tiled_accessor(array<unsigned, 2> size)
+        : data_(nullptr)
+        , size_(size)
+        , num_tiles_x_(div_up(size[0], detail::TileSize))
+    {
+    }
+
+    explicit tiled_accessor(T const* data, array<unsigned, 2> size)
+        : data_(data)
+        , size_(size)
+        , num_tiles_x_(div_up(size[0], detail::TileSize))
+    {
+    }
+
+    array<unsigned, 2> size() const
+    {
+        return size_;
+    }
+
+    template <typename U, typename I>
+    U value(U /* */, I const& x, I const& y) const
+    {
+        return access(U{}, detail::tiled_index(x, y, num_tiles_x_));
+    }
+
+    void reset(T const* data)
+    {
+        data_ = data;
+    }
+
+    value_type const* data() const
+    {
+        return data_;
+    }
+
+    operator bool() const
+    {
+        return data_ != nullptr;
+    }
+
+protected:
+
+    template <typename U>
+    U access(U /* */, size_t index) const
+    {
+        return U(data_[index]);
+    }
+
+    template <
+        typename U,
+        typename I,
+        typename = typename std::enable_if<simd::is_simd_vector<I>::value>::type
+        >
+    U access(U /* */, I const& index) const
+    {
+        return U(gather(data_, index));
+    }
+
+    T const* data_ = nullptr;
+    array<unsigned, 2> size_ = {{ 0, 0 }};
+    unsigned num_tiles_x_ = 0;
+
+};
+
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_TILED_ACCESSOR_H
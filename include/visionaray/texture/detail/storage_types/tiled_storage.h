@@ -0,0 +1,255 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_TILED_STORAGE_H
+#define VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_TILED_STORAGE_H 1
+
+#include <cstddef>
+#include <type_traits>
+
+#include "../../../detail/parallel_for.h"
+#include "../../../detail/range.h"
+#include "../../../detail/thread_pool.h"
+#include "../../../math/detail/math.h"
+#include "../../../math/simd/gather.h"
+#include "../../../math/simd/type_traits.h"
+#include "../../../aligned_vector.h"
+#include "../../../array.h"
+#include "../../../pixel_format.h"
+#include "../../../swizzle.h"
+
+namespace visionaray
+{
+namespace detail
+{
+
+//-------------------------------------------------------------------------------------------------
+// Tiled 2D layout
+//
+// The image is split into 8x8 tiles that are stored one after another,
+// texels inside a tile are stored in Morton order. The 2x2 texels of a
+// bilinear lookup thus usually share a cache line, regardless of the
+// orientation of the texture coordinates. Only shifts and masks are used,
+// so that SIMD indices are computed w/o integer division.
+//
+
+static const int TileLog2 = 3;
+static const unsigned TileSize = 1 << TileLog2;
+
+// Textures w/ less texels are converted w/o the thread pool
+static const size_t TileSerialThreshold = 1 << 16;
+
+// Spreads the lower three bits of x to the even bits
+template <typename I>
+VSNRAY_FUNC
+inline I morton_spread3(I x)
+{
+    x = (x | (x << 2)) & I(0x33);
+    x = (x | (x << 1)) & I(0x55);
+    return x;
+}
+
+template <typename I>
+VSNRAY_FUNC
+inline I tiled_index(I const& x, I const& y, unsigned num_tiles_x)
+{
+    I tx = x >> TileLog2;
+    I ty = y >> TileLog2;
+
+    I ix = x & I(static_cast<int>(TileSize - 1));
+    I iy = y & I(static_cast<int>(TileSize - 1));
+
+    I tile_id = ty * I(static_cast<int>(num_tiles_x)) + tx;
+
+    return (tile_id << (2 * TileLog2)) | morton_spread3(ix) | (morton_spread3(iy) << 1);
+}
+
+inline size_t tiled_index(unsigned x, unsigned y, unsigned num_tiles_x)
+{
+    size_t tile_id = size_t(y >> TileLog2) * num_tiles_x + (x >> TileLog2);
+
+    unsigned ix = x & (TileSize - 1);
+    unsigned iy = y & (TileSize - 1);
+
+    return (tile_id << (2 * TileLog2)) | morton_spread3(ix) | (morton_spread3(iy) << 1);
+}
+
+} // detail
+
+
+//-------------------------------------------------------------------------------------------------
+// 2D storage type w/ tiled layout (see above). Data is aligned to allow for
+// SIMD access. reset() expects row-major data, reset(data, pool) converts
+// it in parallel. data() returns the tiled layout
+//
+
+template <typename T, unsigned Dim, size_t A = 16>
+class tiled_storage
+{
+public:
+
+    static_assert(Dim == 2, "tiled_storage only supports 2D textures");
+
+    using value_type = T;
+
+public:
+
+    tiled_storage() = default;
+
+    explicit tiled_storage(array<unsigned, 2> size)
+    {
+        realloc(size[0], size[1]);
+    }
+
+    explicit tiled_storage(unsigned w, unsigned h)
+    {
+        realloc(w, h);
+    }
+
+    array<unsigned, 2> size() const
+    {
+        return size_;
+    }
+
+    template <typename U, typename I>
+    U value(U /* */, I const& x, I const& y) const
+    {
+        return access(U{}, detail::tiled_index(x, y, num_tiles_[0]));
+    }
+
+    void realloc(unsigned w, unsigned h)
+    {
+        size_[0] = w;
+        size_[1] = h;
+
+        num_tiles_[0] = div_up(w, detail::TileSize);
+        num_tiles_[1] = div_up(h, detail::TileSize);
+
+        data_.resize(size_t(num_tiles_[0]) * num_tiles_[1] * detail::TileSize * detail::TileSize);
+    }
+
+    void reset(T const* data, thread_pool& pool)
+    {
+        // Convert rows of tiles in parallel, small textures w/o the pool
+        if (pool.num_threads <= 1 || linear_size() < detail::TileSerialThreshold)
+        {
+            reset(data);
+        }
+        else
+        {
+            parallel_for(
+                    pool,
+                    tiled_range1d<unsigned>(0, num_tiles_[1], 1),
+                    [&](range1d<unsigned> const& r) { convert_tile_rows(data, r); }
+                    );
+        }
+    }
+
+    void reset(T const* data)
+    {
+        convert_tile_rows(data, range1d<unsigned>(0, num_tiles_[1]));
+    }
+
+    void reset(
+            T const* data,
+            pixel_format format,
+            pixel_format internal_format
+            )
+    {
+        if (format != internal_format)
+        {
+            // Swizzle in-place
+            aligned_vector<T> tmp(data, data + linear_size());
+            swizzle(tmp.data(), internal_format, format, tmp.size());
+            reset(tmp.data());
+        }
+        else
+        {
+            // Simple copy
+            reset(data);
+        }
+    }
+
+    template <typename U>
+    void reset(
+            U const* data,
+            pixel_format format,
+            pixel_format internal_format
+            )
+    {
+        // Copy to temporary array, then swizzle
+        aligned_vector<T> dst(linear_size());
+        swizzle(dst.data(), internal_format, data, format, dst.size());
+        reset(dst.data());
+    }
+
+    template <typename U>
+    void reset(
+            U const* data,
+            pixel_format format,
+            pixel_format internal_format,
+            swizzle_hint hint
+            )
+    {
+        // Copy with temporary array, hint about how to handle alpha
+        aligned_vector<T> dst(linear_size());
+        swizzle(dst.data(), internal_format, data, format, dst.size(), hint);
+        reset(dst.data());
+    }
+
+    value_type const* data() const
+    {
+        return data_.data();
+    }
+
+    operator bool() const
+    {
+        return !data_.empty();
+    }
+
+protected:
+
+    size_t linear_size() const
+    {
+        return size_[0] * size_t(size_[1]);
+    }
+
+    // Converts the rows of tiles in R from row-major DATA
+    void convert_tile_rows(T const* data, range1d<unsigned> const& r)
+    {
+        for (unsigned y = r.begin() * detail::TileSize; y < min(r.end() * detail::TileSize, size_[1]); ++y)
+        {
+            for (unsigned x = 0; x < size_[0]; ++x)
+            {
+                data_[detail::tiled_index(x, y, num_tiles_[0])] = data[size_t(y) * size_[0] + x];
+            }
+        }
+    }
+
+    template <typename U>
+    U access(U /* */, size_t index) const
+    {
+        return U(data_[index]);
+    }
+
+    template <
+        typename U,
+        typename I,
+        typename = typename std::enable_if<simd::is_simd_vector<I>::value>::type
+        >
+    U access(U /* */, I const& index) const
+    {
+        return U(gather(data_.data(), index));
+    }
+
+    aligned_vector<T, A> data_;
+    array<unsigned, 2> size_ = {{ 0, 0 }};
+    array<unsigned, 2> num_tiles_ = {{ 0, 0 }};
+
+};
+
+} // visionaray
+
+#endif // VSNRAY_TEXTURE_DETAIL_STORAGE_TYPES_TILED_STORAGE_H
@@ -127,6 +127,61 @@ inline vector<Dim1, FloatT> texND_impl_expand_types(
     return result;
 }
 
+// Overload for half textures, non-simd coordinates
+template <
+    typename Tex,
+    size_t Dims,
+    typename FloatT,
+    typename = typename std::enable_if<std::is_floating_point<FloatT>::value>::type,
+    typename = typename std::enable_if<!simd::is_simd_vector<FloatT>::value>::type
+    >
+VSNRAY_FUNC
+inline FloatT texND_impl_expand_types(
+        half                        /* */,
+        Tex const&                  tex,
+        vector<Dims, FloatT> const& coord
+        )
+{
+    // convert texels to float upon access and filter
+    // w/o rounding the result to half precision
+    using return_type   = FloatT;
+    using internal_type = FloatT;
+
+    return choose_filter(
+            return_type{},
+            internal_type{},
+            tex,
+            coord
+            );
+}
+
+// Overload for vectors of halfs, non-simd coordinates
+template <
+    size_t Dim1,
+    typename Tex,
+    size_t Dim2,
+    typename FloatT,
+    typename = typename std::enable_if<std::is_floating_point<FloatT>::value>::type,
+    typename = typename std::enable_if<!simd::is_simd_vector<FloatT>::value>::type
+    >
+VSNRAY_FUNC
+inline vector<Dim1, FloatT> texND_impl_expand_types(
+        vector<Dim1, half>          /* */,
+        Tex const&                  tex,
+        vector<Dim2, FloatT> const& coord
+        )
+{
+    using return_type   = vector<Dim1, FloatT>;
+    using internal_type = vector<Dim1, FloatT>;
+
+    return choose_filter(
+            return_type{},
+            internal_type{},
+            tex,
+            coord
+            );
+}
+
 // normalized floating point texture, simd coordinates
 template <
     unsigned Bits,
@@ -16,7 +16,13 @@
 #include "../../math/vector.h"
 
 #include "storage_types/aligned_storage.h"
+#include "storage_types/bc_accessor.h"
+#include "storage_types/bc_storage.h"
+#include "storage_types/paged_accessor.h"
+#include "storage_types/paged_storage.h"
 #include "storage_types/pointer_storage.h"
+#include "storage_types/tiled_accessor.h"
+#include "storage_types/tiled_storage.h"
 
 namespace visionaray
 {
@@ -43,6 +49,14 @@ enum tex_filter_mode
     CardinalSpline
 };
 
+// Filtering between mip levels (see mipmapped_texture)
+enum tex_mipmap_filter_mode
+{
+    MipmapNearest = 0,
+    MipmapLinear,
+    MipmapAnisotropic
+};
+
 enum tex_color_space
 {
     RGB = 0,
@@ -417,7 +431,94 @@ struct texture : texture_base<Dim, aligned_storage<T, Dim, 16>>
     using ref_type = texture_ref<T, Dim>;
 };
 
-// Specialization, uses tiling (TODO..)
+//-------------------------------------------------------------------------------------------------
+// 2D texture w/ tiled storage, fetches are more cache-friendly than w/ row-major
+// textures. Use tiled_texture_ref<T, Dim> as a view to the data
+//
+
+template <typename T, unsigned Dim>
+struct tiled_texture_ref : texture_base<Dim, tiled_accessor<T, Dim>>
+{
+    using value_type = T;
+    using base_type = texture_base<Dim, tiled_accessor<T, Dim>>;
+    enum { dimensions = Dim };
+    using base_type::base_type;
+};
+
+template <typename T, unsigned Dim>
+struct tiled_texture : texture_base<Dim, tiled_storage<T, Dim, 16>>
+{
+    using value_type = T;
+    using base_type = texture_base<Dim, tiled_storage<T, Dim, 16>>;
+    enum { dimensions = Dim };
+    using base_type::base_type;
+    using ref_type = tiled_texture_ref<T, Dim>;
+};
+
+
+
+//-------------------------------------------------------------------------------------------------
+// Block compressed (BCn) 2D texture, decoded when texels are fetched.
+// Use bc_texture_ref<Dim> as a view to the data
+//
+
+template <unsigned Dim>
+struct bc_texture_ref;
+
+template <unsigned Dim>
+struct bc_texture : texture_base<Dim, bc_storage<Dim>>
+{
+    using value_type = vector<4, unorm<8>>;
+    using base_type = texture_base<Dim, bc_storage<Dim>>;
+    enum { dimensions = Dim };
+    using base_type::base_type;
+    using ref_type = bc_texture_ref<Dim>;
+};
+
+template <unsigned Dim>
+struct bc_texture_ref : texture_base<Dim, bc_accessor<Dim>>
+{
+    using value_type = vector<4, unorm<8>>;
+    using base_type = texture_base<Dim, bc_accessor<Dim>>;
+    enum { dimensions = Dim };
+    using base_type::base_type;
+
+    bc_texture_ref() = default;
+
+    explicit bc_texture_ref(bc_texture<Dim> const& tex)
+    {
+        this->reset(tex.data(), tex.size(), tex.get_block_format());
+        this->set_address_mode(tex.get_address_mode());
+        this->set_filter_mode(tex.get_filter_mode());
+        this->set_color_space(tex.get_color_space());
+        this->set_normalized_coords(tex.get_normalized_coords());
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Out-of-core 2D texture, pages are loaded on demand into a page cache.
+// Use paged_texture_ref<T, Dim> as a view to the data
+//
+
+template <typename T, unsigned Dim>
+struct paged_texture_ref : texture_base<Dim, paged_accessor<T, Dim>>
+{
+    using value_type = T;
+    using base_type = texture_base<Dim, paged_accessor<T, Dim>>;
+    enum { dimensions = Dim };
+    using base_type::base_type;
+};
+
+template <typename T, unsigned Dim>
+struct paged_texture : texture_base<Dim, paged_storage<T, Dim>>
+{
+    using value_type = T;
+    using base_type = texture_base<Dim, paged_storage<T, Dim>>;
+    enum { dimensions = Dim };
+    using base_type::base_type;
+    using ref_type = paged_texture_ref<T, Dim>;
+};
 
 
 // Specialization, uses bricking
@@ -18,6 +18,8 @@
 #include "detail/hip_texture.h"
 #endif
 
+#include "detail/mip_fetch.h"
+#include "detail/mipmapped_texture.h"
 #include "detail/tex_fetch.h"
 #include "detail/texture_common.h"
 
@@ -50,6 +52,81 @@ inline auto tex2D(Tex const& tex, vector<2, FloatT> const& coord)
 }
 
 
+// Sample at a level of detail (e.g. from texture_lod()), textures
+// w/o mip levels are sampled at their only level
+template <typename Tex, typename FloatT>
+VSNRAY_FUNC
+inline auto tex2D(Tex const& tex, vector<2, FloatT> const& coord, FloatT const& lod)
+    -> decltype( tex2D(tex, coord) )
+{
+    VSNRAY_UNUSED(lod);
+
+    return tex2D(tex, coord);
+}
+
+
+// Sample w/ texture coordinate derivatives, textures w/o mip levels are
+// sampled at their only level
+template <typename Tex, typename FloatT>
+VSNRAY_FUNC
+inline auto tex2D(
+        Tex const&                  tex,
+        vector<2, FloatT> const&    coord,
+        vector<2, FloatT> const&    ddx,
+        vector<2, FloatT> const&    ddy
+        )
+    -> decltype( tex2D(tex, coord) )
+{
+    VSNRAY_UNUSED(ddx);
+    VSNRAY_UNUSED(ddy);
+
+    return tex2D(tex, coord);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Mipmapped textures
+//
+
+// Base level
+template <typename T, typename FloatT>
+VSNRAY_FUNC
+inline auto tex2D(mipmapped_texture_ref<T, 2> const& tex, vector<2, FloatT> const& coord)
+    -> decltype( detail::tex_fetch_impl(tex.level(0), coord) )
+{
+    assert(tex.get_normalized_coords() && "Unnormalized coordinates on CPU not implemented yet");
+
+    return detail::tex_fetch_impl( tex.level(0), coord );
+}
+
+// Level of detail, e.g. from texture_lod()
+template <typename T, typename FloatT>
+VSNRAY_FUNC
+inline auto tex2D(mipmapped_texture_ref<T, 2> const& tex, vector<2, FloatT> const& coord, FloatT const& lod)
+    -> decltype( detail::mip_fetch_lod(tex, coord, lod) )
+{
+    assert(tex.get_normalized_coords() && "Unnormalized coordinates on CPU not implemented yet");
+
+    return detail::mip_fetch_lod( tex, coord, lod );
+}
+
+// Texture coordinate derivatives
+template <typename T, typename FloatT>
+VSNRAY_FUNC
+inline auto tex2D(
+        mipmapped_texture_ref<T, 2> const&  tex,
+        vector<2, FloatT> const&            coord,
+        vector<2, FloatT> const&            ddx,
+        vector<2, FloatT> const&            ddy
+        )
+    -> decltype( detail::mip_fetch_grad(tex, coord, ddx, ddy) )
+{
+    assert(tex.get_normalized_coords() && "Unnormalized coordinates on CPU not implemented yet");
+
+    return detail::mip_fetch_grad( tex, coord, ddx, ddy );
+}
+
+
 template <typename Tex, typename FloatT>
 VSNRAY_FUNC
 inline auto tex3D(Tex const& tex, vector<3, FloatT> const& coord)
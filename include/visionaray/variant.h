@@ -160,6 +160,12 @@ public:
             : nullptr;
     }
 
+    // One-based index of the type that is currently stored
+    VSNRAY_FUNC unsigned which() const
+    {
+        return type_index_;
+    }
+
 private:
 
     unsigned                        type_index_;
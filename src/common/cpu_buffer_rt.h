@@ -11,6 +11,7 @@
 #include <visionaray/math/forward.h>
 #include <visionaray/math/vector.h>
 #include <visionaray/aligned_vector.h>
+#include <visionaray/aov.h>
 #include <visionaray/pixel_traits.h>
 #include <visionaray/render_target.h>
 
@@ -31,6 +32,7 @@ public:
     using color_type    = typename pixel_traits<ColorFormat>::type;
     using depth_type    = typename pixel_traits<DepthFormat>::type;
     using accum_type    = typename pixel_traits<AccumFormat>::type;
+    using moments_type  = vec4;
 
     using ref_type      = render_target_ref<ColorFormat, DepthFormat, AccumFormat>;
 
@@ -42,13 +44,23 @@ public:
     color_type* color();
     depth_type* depth();
     accum_type* accum();
+    moments_type* moments();
 
     color_type const* color() const;
     depth_type const* depth() const;
     accum_type const* accum() const;
+    moments_type const* moments() const;
+
+    // AOV buffers, enable channels w/ aovs().set_channels() before resize()
+    aov_buffers& aovs();
+    aov_buffers const& aovs() const;
 
     ref_type ref();
 
+    // Allocate the moments buffer for adaptive sampling, called by the
+    // schedulers. moments() returns nullptr before
+    void require_moments();
+
     void clear_color_buffer(vec4 const& color = vec4(0.0f));
     void clear_depth_buffer(float depth = 1.0f);
     void clear_accum_buffer(vec4 const& color = vec4(0.0f));
@@ -64,6 +76,8 @@ protected:
     aligned_vector<color_type>            color_buffer;
     aligned_vector<depth_type>            depth_buffer;
     aligned_vector<accum_type>            accum_buffer;
+    aligned_vector<moments_type>          moments_buffer;
+    aov_buffers                           aov_buffer;
 
 };
 
@@ -40,6 +40,12 @@ typename cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_type* cpu_b
     return accum_buffer.data();
 }
 
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+typename cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments_type* cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments()
+{
+    return moments_buffer.empty() ? nullptr : moments_buffer.data();
+}
+
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 typename cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::color_type const* cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::color() const
 {
@@ -58,10 +64,37 @@ typename cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_type const*
     return accum_buffer.data();
 }
 
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+typename cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments_type const* cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments() const
+{
+    return moments_buffer.empty() ? nullptr : moments_buffer.data();
+}
+
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+aov_buffers& cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::aovs()
+{
+    return aov_buffer;
+}
+
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+aov_buffers const& cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::aovs() const
+{
+    return aov_buffer;
+}
+
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 typename cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::ref_type cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::ref()
 {
-    return { color(), depth(), accum(), width(), height() };
+    return { color(), depth(), accum(), width(), height(), moments(), aov_buffer.ref() };
+}
+
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+void cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::require_moments()
+{
+    if (moments_buffer.empty())
+    {
+        moments_buffer.resize(width() * height(), moments_type(0.0f));
+    }
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
@@ -97,8 +130,8 @@ void cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::clear_depth_buffer(fl
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 void cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::clear_accum_buffer(vec4 const& c)
 {
-    // Convert from RGBA32F to internal color format
-    color_type cc;
+    // Convert from RGBA32F to internal accum format
+    accum_type cc;
     convert(
         pixel_format_constant<AccumFormat>{},
         pixel_format_constant<PF_RGBA32F>{},
@@ -107,6 +140,9 @@ void cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::clear_accum_buffer(ve
         );
 
     std::fill(accum_buffer.begin(), accum_buffer.end(), cc);
+
+    // Accumulation starts over, so does adaptive sampling
+    std::fill(moments_buffer.begin(), moments_buffer.end(), moments_type(0.0f));
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
@@ -139,6 +175,13 @@ void cpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::resize(int w, int h)
         accum_buffer.resize(w * h);
     }
 
+    if (!moments_buffer.empty())
+    {
+        moments_buffer.resize(w * h, moments_type(0.0f));
+    }
+
+    aov_buffer.resize(w, h);
+
     if (!compositor)
     {
         compositor.reset(new gl::depth_compositor);
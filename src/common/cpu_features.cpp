@@ -0,0 +1,121 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cstdint>
+
+#include <visionaray/math/simd/intrinsics.h>
+
+#if VSNRAY_BASE_ARCH == VSNRAY_BASE_ARCH_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#include "cpu_features.h"
+
+namespace visionaray
+{
+
+#if VSNRAY_BASE_ARCH == VSNRAY_BASE_ARCH_X86
+
+//-------------------------------------------------------------------------------------------------
+// cpuid and xgetbv wrappers
+//
+
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i)
+    {
+        regs[i] = static_cast<uint32_t>(r[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t xgetbv(uint32_t index)
+{
+#if defined(_MSC_VER)
+    return _xgetbv(index);
+#else
+    uint32_t eax = 0;
+    uint32_t edx = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+static cpu_features query_cpu_features()
+{
+    cpu_features result;
+
+    uint32_t regs[4] = { 0, 0, 0, 0 };
+
+    cpuid(0, 0, regs);
+    uint32_t max_leaf = regs[0];
+
+    if (max_leaf < 1)
+    {
+        return result;
+    }
+
+    cpuid(1, 0, regs);
+    uint32_t ecx1 = regs[2];
+    uint32_t edx1 = regs[3];
+
+    result.sse2   = (edx1 & (1u << 26)) != 0;
+    result.sse4_1 = (ecx1 & (1u << 19)) != 0;
+    result.sse4_2 = (ecx1 & (1u << 20)) != 0;
+
+    // OS must support xsave and have enabled SSE and AVX state
+    bool osxsave = (ecx1 & (1u << 27)) != 0;
+    uint64_t xcr0 = osxsave ? xgetbv(0) : 0;
+
+    bool os_avx    = (xcr0 & 0x06) == 0x06;
+    bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+    result.avx  = os_avx && (ecx1 & (1u << 28)) != 0;
+    result.fma  = result.avx && (ecx1 & (1u << 12)) != 0;
+    result.f16c = result.avx && (ecx1 & (1u << 29)) != 0;
+
+    if (max_leaf >= 7)
+    {
+        cpuid(7, 0, regs);
+        uint32_t ebx7 = regs[1];
+
+        result.avx2     = result.avx && (ebx7 & (1u <<  5)) != 0;
+        result.avx512f  = os_avx512  && (ebx7 & (1u << 16)) != 0;
+        result.avx512dq = result.avx512f && (ebx7 & (1u << 17)) != 0;
+        result.avx512bw = result.avx512f && (ebx7 & (1u << 30)) != 0;
+        result.avx512vl = result.avx512f && (ebx7 & (1u << 31)) != 0;
+    }
+
+    return result;
+}
+
+#else
+
+static cpu_features query_cpu_features()
+{
+    return cpu_features();
+}
+
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+// Public interface
+//
+
+cpu_features const& get_cpu_features()
+{
+    static const cpu_features features = query_cpu_features();
+    return features;
+}
+
+} // visionaray
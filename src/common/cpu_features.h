@@ -0,0 +1,39 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_COMMON_CPU_FEATURES_H
+#define VSNRAY_COMMON_CPU_FEATURES_H 1
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Instruction set extensions supported by the host CPU *and* the OS
+//
+// AVX and AVX-512 are only reported if the OS saves the extended
+// register state on context switches (checked with xgetbv).
+//
+
+struct cpu_features
+{
+    bool sse2     = false;
+    bool sse4_1   = false;
+    bool sse4_2   = false;
+    bool avx      = false;
+    bool avx2     = false;
+    bool fma      = false;
+    bool f16c     = false;
+    bool avx512f  = false;
+    bool avx512dq = false;
+    bool avx512bw = false;
+    bool avx512vl = false;
+};
+
+// Query once and cache, safe to call from multiple threads
+cpu_features const& get_cpu_features();
+
+} // visionaray
+
+#endif // VSNRAY_COMMON_CPU_FEATURES_H
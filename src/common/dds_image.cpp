@@ -12,13 +12,13 @@
 /* No warranty is expressed or implied. Use at your own risk, */
 /* or not at all. */
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <ostream>
 #include <vector>
 
-#include <visionaray/math/io.h>
-#include <visionaray/math/vector.h>
+#include <visionaray/texture/detail/bc_decode.h>
 
 #include "dds_image.h"
 
@@ -67,6 +67,18 @@
 #define D3DFMT_DXT3                MAKE_FOURCC('D','X','T','3')
 #define D3DFMT_DXT4                MAKE_FOURCC('D','X','T','4')
 #define D3DFMT_DXT5                MAKE_FOURCC('D','X','T','5')
+#define D3DFMT_ATI2                MAKE_FOURCC('A','T','I','2')
+#define D3DFMT_BC5U                MAKE_FOURCC('B','C','5','U')
+#define D3DFMT_DX10                MAKE_FOURCC('D','X','1','0')
+
+// dds_header_dxt10.dxgi_format
+#define DXGI_FORMAT_BC1_UNORM      71
+#define DXGI_FORMAT_BC1_UNORM_SRGB 72
+#define DXGI_FORMAT_BC3_UNORM      77
+#define DXGI_FORMAT_BC3_UNORM_SRGB 78
+#define DXGI_FORMAT_BC5_UNORM      83
+#define DXGI_FORMAT_BC7_UNORM      98
+#define DXGI_FORMAT_BC7_UNORM_SRGB 99
 
 
 struct dds_header
@@ -108,6 +120,16 @@ struct dds_header
     unsigned reserved2;
 };
 
+// Follows dds_header if pixel_format.four_cc is DX10
+struct dds_header_dxt10
+{
+    unsigned dxgi_format;
+    unsigned resource_dimension;
+    unsigned misc_flag;
+    unsigned array_size;
+    unsigned misc_flags2;
+};
+
 struct dds_load_info
 {
     bool compressed;
@@ -122,6 +144,8 @@ enum dds_pixel_format
     DDS_PF_DXT1,
     DDS_PF_DXT3,
     DDS_PF_DXT5,
+    DDS_PF_BC5,
+    DDS_PF_BC7,
     DDS_PF_BGRA8,
     DDS_PF_BGR8,
     DDS_PF_BGR5A1,
@@ -147,6 +171,11 @@ static dds_pixel_format get_pixel_format(dds_header::pixel_format_t pf)
         return DDS_PF_DXT5;
     }
 
+    if ((pf.flags & DDPF_FOURCC) && (pf.four_cc == D3DFMT_ATI2 || pf.four_cc == D3DFMT_BC5U))
+    {
+        return DDS_PF_BC5;
+    }
+
     if ((pf.flags & DDPF_RGB) && (pf.flags & DDPF_ALPHAPIXELS) &&
         (pf.rgb_bit_count == 32) && (pf.r_bit_mask == 0xFF0000) &&
         (pf.g_bit_mask == 0xFF00) && (pf.b_bit_mask == 0xFF) &&
@@ -179,99 +208,45 @@ static dds_pixel_format get_pixel_format(dds_header::pixel_format_t pf)
 }
 
 
-static void decode_tile_rgb_5_6_5(uint8_t* dst, uint8_t const* src)
+static dds_pixel_format get_pixel_format(dds_header_dxt10 const& header)
 {
-    using visionaray::vec3;
-
-    uint16_t c0 = *reinterpret_cast<uint16_t const*>(src);
-    uint16_t c1 = *reinterpret_cast<uint16_t const*>(src + 2);
-
-    vec3 color[4];
-
-    color[0] = vec3(
-        ((c0 & 0xF800) >> 11) / 32.0f,
-        ((c0 & 0x7E0) >> 5)   / 64.0f,
-        (c0 & 0x1F)           / 32.0f
-        );
-
-    color[1] = vec3(
-        ((c1 & 0xF800) >> 11) / 32.0f,
-        ((c1 & 0x7E0) >> 5)   / 64.0f,
-        (c1 & 0x1F)           / 32.0f
-        );
-
-    color[2] = c0 > c1
-        ? (2.0f * color[0] + color[1]) / 3.0f
-        : (color[0] + color[1]) / 2.0f;
-
-    color[3] = c0 > c1
-        ? (color[0] + 2.0f * color[1]) / 3.0f
-        : vec3(0.0f);
-
-    uint32_t bitmask = *reinterpret_cast<uint32_t const*>(src + 4);
-    for (int i = 0; i < 16; ++i)
+    switch (header.dxgi_format)
     {
-        int index = bitmask & 0x3;
-
-        dst[i * 3]     = color[index].x * 255;
-        dst[i * 3 + 1] = color[index].y * 255;
-        dst[i * 3 + 2] = color[index].z * 255;
-
-        bitmask >>= 2;
-    }
-}
-
-
-static void decode_tile_alpha_dxt5(uint8_t* dst, uint8_t const* src)
-{
-    uint8_t a0 = src[0];
-    uint8_t a1 = src[1];
-
-    float alpha[8];
-
-    alpha[0] = src[0] / 255.0f;
-    alpha[1] = src[1] / 255.0f;
-
-    alpha[2] = a0 > a1
-        ? (6.0f * alpha[0] + 1.0f * alpha[1]) / 7.0f
-        : (4.0f * alpha[0] + 1.0f * alpha[1]) / 5.0f;
-
-    alpha[3] = a0 > a1
-        ? (5.0f * alpha[0] + 2.0f * alpha[1]) / 7.0f
-        : (3.0f * alpha[0] + 2.0f * alpha[1]) / 5.0f;
-
-    alpha[4] = a0 > a1
-        ? (4.0f * alpha[0] + 3.0f * alpha[1]) / 7.0f
-        : (2.0f * alpha[0] + 3.0f * alpha[1]) / 5.0f;
-
-    alpha[5] = a0 > a1
-        ? (3.0f * alpha[0] + 4.0f * alpha[1]) / 7.0f
-        : (1.0f * alpha[0] + 4.0f * alpha[1]) / 5.0f;
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+        return DDS_PF_DXT1;
 
-    alpha[6] = a0 > a1
-        ? (2.0f * alpha[0] + 5.0f * alpha[1]) / 7.0f
-        : 0.0f;
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+        return DDS_PF_DXT5;
 
-    alpha[7] = a0 > a1
-        ? (1.0f * alpha[0] + 6.0f * alpha[1]) / 7.0f
-        : 1.0f;
+    case DXGI_FORMAT_BC5_UNORM:
+        return DDS_PF_BC5;
 
-    uint64_t bitmask = *reinterpret_cast<uint64_t const*>(src + 2);
-    for (int i = 0; i < 16; ++i)
-    {
-        int index = bitmask & 0x7;
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return DDS_PF_BC7;
 
-        dst[i] = alpha[index] * 255;
-
-        bitmask >>= 3;
+    default:
+        return DDS_PF_UNKNOWN;
     }
 }
 
-namespace visionaray
-{
 
-bool dds_image::load(std::string const& filename)
+//-------------------------------------------------------------------------------------------------
+// Read the header and the blocks of the base level of a block compressed file
+//
+
+static bool read_blocks(
+        std::string const&                  filename,
+        unsigned&                           width,
+        unsigned&                           height,
+        visionaray::tex_block_format&       block_format,
+        visionaray::aligned_vector<uint8_t>& blocks
+        )
 {
+    using namespace visionaray;
+
     std::ifstream file(filename, std::ios::in | std::ios::binary);
 
 
@@ -291,65 +266,156 @@ bool dds_image::load(std::string const& filename)
         return false;
     }
 
-    width_ = static_cast<int>(header.width);
-    height_ = static_cast<int>(header.height);
-
     auto format = get_pixel_format(header.pixel_format);
-    if (format == DDS_PF_UNKNOWN)
+
+    if ((header.pixel_format.flags & DDPF_FOURCC) && header.pixel_format.four_cc == D3DFMT_DX10)
+    {
+        dds_header_dxt10 header10;
+        memset(&header10, 0, sizeof(header10));
+        file.read(reinterpret_cast<char*>(&header10), sizeof(header10));
+
+        format = get_pixel_format(header10);
+    }
+
+    switch (format)
     {
+    case DDS_PF_DXT1:
+        block_format = BC1;
+        break;
+
+    case DDS_PF_DXT5:
+        block_format = BC3;
+        break;
+
+    case DDS_PF_BC5:
+        block_format = BC5;
+        break;
+
+    case DDS_PF_BC7:
+        block_format = BC7;
+        break;
+
+    default:
         std::cerr << "DDS: unknown pixel format\n";
         return false;
     }
 
-    if (format == DDS_PF_DXT1)
+    width = header.width;
+    height = header.height;
+
+    size_t num_blocks = size_t((width + 3) / 4) * ((height + 3) / 4);
+    blocks.resize(num_blocks * detail::bc_block_bytes(block_format));
+
+    file.read(reinterpret_cast<char*>(blocks.data()), blocks.size());
+
+    if (!file)
     {
-        std::vector<uint8_t> bytes(header.pitch_or_linear_size);
-        file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+        std::cerr << "DDS: file error\n";
+        return false;
+    }
 
-        format_ = PF_RGB8;
+    return true;
+}
 
-        auto pitch = header.width * 3;
-        data_.resize(pitch * header.height);
+namespace visionaray
+{
 
-        for (size_t i = 0; i < bytes.size(); i += 8)
-        {
-            decode_tile_rgb_5_6_5(data_.data() + i * 2 * 3, bytes.data() + i);
-        }
+bool dds_image::load(std::string const& filename)
+{
+    unsigned width = 0;
+    unsigned height = 0;
+    aligned_vector<uint8_t> blocks;
 
-        return true;
+    if (!read_blocks(filename, width, height, block_format_, blocks))
+    {
+        return false;
     }
 
-    if (format == DDS_PF_DXT5)
+    width_ = static_cast<int>(width);
+    height_ = static_cast<int>(height);
+
+    size_t num_channels = 0;
+
+    switch (block_format_)
     {
-        std::vector<uint8_t> bytes(header.pitch_or_linear_size);
-        file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+    case BC1:
+        format_ = PF_RGB8;
+        num_channels = 3;
+        break;
+
+    case BC5:
+        format_ = PF_RG8;
+        num_channels = 2;
+        break;
 
+    default:
         format_ = PF_RGBA8;
+        num_channels = 4;
+        break;
+    }
 
-        auto pitch = header.width * 4;
-        data_.resize(pitch * header.height);
+    data_.resize(width * size_t(height) * num_channels);
 
-        for (size_t i = 0; i < bytes.size(); i += 16)
-        {
-            uint8_t rgb[48];
-            uint8_t alpha[16];
-            decode_tile_alpha_dxt5(alpha, bytes.data() + i);
-            decode_tile_rgb_5_6_5(rgb, bytes.data() + i + 8);
+    // Decompress, blocks are stored row by row
+    unsigned num_blocks_x = (width + 3) / 4;
+    unsigned num_blocks_y = (height + 3) / 4;
+    size_t block_bytes = detail::bc_block_bytes(block_format_);
 
-            for (int j = 0; j < 16; ++j)
+    for (unsigned by = 0; by < num_blocks_y; ++by)
+    {
+        for (unsigned bx = 0; bx < num_blocks_x; ++bx)
+        {
+            detail::bc_texel texels[16];
+            detail::decode_block(
+                    block_format_,
+                    blocks.data() + (by * size_t(num_blocks_x) + bx) * block_bytes,
+                    0,
+                    16,
+                    texels
+                    );
+
+            for (unsigned i = 0; i < 16; ++i)
             {
-                size_t index = (i + j) * 4;
-                data_[index]     = rgb[j * 3];
-                data_[index + 1] = rgb[j * 3 + 1];
-                data_[index + 2] = rgb[j * 3 + 2];
-                data_[index + 3] = alpha[j];
+                unsigned x = bx * 4 + i % 4;
+                unsigned y = by * 4 + i / 4;
+
+                if (x >= width || y >= height)
+                {
+                    continue;
+                }
+
+                uint8_t* dst = data_.data() + (y * size_t(width) + x) * num_channels;
+
+                for (size_t c = 0; c < num_channels; ++c)
+                {
+                    dst[c] = texels[i][c].value;
+                }
             }
         }
+    }
 
-        return true;
+    return true;
+}
+
+bool dds_image::load_compressed(std::string const& filename)
+{
+    unsigned width = 0;
+    unsigned height = 0;
+
+    if (!read_blocks(filename, width, height, block_format_, data_))
+    {
+        return false;
     }
 
-    return false;
+    width_ = static_cast<int>(width);
+    height_ = static_cast<int>(height);
+
+    return true;
+}
+
+tex_block_format dds_image::block_format() const
+{
+    return block_format_;
 }
 
 } // visionaray
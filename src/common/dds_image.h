@@ -8,6 +8,8 @@
 
 #include <string>
 
+#include <visionaray/texture/detail/bc_decode.h>
+
 #include "image_base.h"
 
 namespace visionaray
@@ -17,8 +19,18 @@ class dds_image : public image_base
 {
 public:
 
+    // Load and decompress BC1, BC3, BC5 or BC7 data (base level)
     bool load(std::string const& filename);
 
+    // Load w/o decompression, data() returns the blocks (e.g. for bc_texture)
+    bool load_compressed(std::string const& filename);
+
+    tex_block_format block_format() const;
+
+private:
+
+    tex_block_format block_format_ = BC1;
+
 };
 
 } // visionaray
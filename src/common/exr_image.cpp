@@ -74,6 +74,11 @@ static void store_rgba32f(
 }
 #endif // VSNRAY_COMMON_HAVE_OPENEXR
 
+exr_image::exr_image(int width, int height, pixel_format format, uint8_t const* data)
+    : image_base(width, height, format, data)
+{
+}
+
 bool exr_image::load(std::string const& filename)
 {
 #if VSNRAY_COMMON_HAVE_OPENEXR
@@ -125,4 +130,65 @@ bool exr_image::load(std::string const& filename)
 #endif
 }
 
+bool exr_image::save(std::string const& filename, file_base::save_options const& options)
+{
+    VSNRAY_UNUSED(options);
+
+#if VSNRAY_COMMON_HAVE_OPENEXR
+    if (format_ != PF_RGB32F && format_ != PF_RGBA32F)
+    {
+        std::cerr << "Unsupported image format\n";
+        return false;
+    }
+
+    try
+    {
+        Imf::Array2D<Imf::Rgba> pixels(height_, width_);
+
+        for (int y = 0; y < height_; ++y)
+        {
+            for (int x = 0; x < width_; ++x)
+            {
+                vec4 rgba(1.0f);
+
+                if (format_ == PF_RGB32F)
+                {
+                    rgba.xyz() = reinterpret_cast<vec3 const*>(data_.data())[y * width_ + x];
+                }
+                else
+                {
+                    rgba = reinterpret_cast<vec4 const*>(data_.data())[y * width_ + x];
+                }
+
+                pixels[y][x] = Imf::Rgba(rgba.x, rgba.y, rgba.z, rgba.w);
+            }
+        }
+
+        Imf::RgbaOutputFile file(
+                filename.c_str(),
+                width_,
+                height_,
+                format_ == PF_RGB32F ? Imf::WRITE_RGB : Imf::WRITE_RGBA
+                );
+
+        file.setFrameBuffer(&pixels[0][0], 1, width_);
+        file.writePixels(height_);
+
+        return true;
+    }
+    catch(Iex::BaseExc& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+
+        return false;
+    }
+
+    return false;
+#else
+    VSNRAY_UNUSED(filename);
+
+    return false;
+#endif
+}
+
 } // visionaray
@@ -17,7 +17,16 @@ class exr_image : public image_base
 {
 public:
 
+    // Default constructor.
+    exr_image() = default;
+
+    // Construct image from width, height, format, and data (data is copied).
+    exr_image(int width, int height, pixel_format format, uint8_t const* data);
+
     bool load(std::string const& filename);
+
+    // Save exr image (PF_RGB32F or PF_RGBA32F, stored as half). No options.
+    bool save(std::string const& filename, save_options const& options);
 };
 
 } // visionaray
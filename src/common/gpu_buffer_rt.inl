@@ -28,6 +28,12 @@ typename gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_type* gpu_b
     return accum_buffer_;
 }
 
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+typename gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments_type* gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments()
+{
+    return moments_buffer_.empty() ? nullptr : moments_buffer_.data();
+}
+
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 typename gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::color_type const* gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::color() const
 {
@@ -46,10 +52,27 @@ typename gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_type const*
     return accum_buffer_;
 }
 
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+typename gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments_type const* gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments() const
+{
+    return moments_buffer_.empty() ? nullptr : moments_buffer_.data();
+}
+
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 typename gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::ref_type gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::ref()
 {
-    return { color(), depth(), accum(), width(), height() };
+    return { color(), depth(), accum(), width(), height(), moments() };
+}
+
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+void gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::require_moments()
+{
+    if (moments_buffer_.size() != static_cast<size_t>(width() * height()))
+    {
+        moments_type m(0.0f);
+        moments_buffer_.resize(width() * height());
+        cuda::fill(moments_buffer_.data(), moments_buffer_.size() * sizeof(moments_type), &m, sizeof(moments_type));
+    }
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
@@ -95,6 +118,13 @@ void gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::clear_accum_buffer(ve
         );
 
     cuda::fill(accum(), width() * height() * sizeof(color_type), &cc, sizeof(accum_type));
+
+    // Accumulation starts over, so does adaptive sampling
+    if (!moments_buffer_.empty())
+    {
+        moments_type m(0.0f);
+        cuda::fill(moments_buffer_.data(), moments_buffer_.size() * sizeof(moments_type), &m, sizeof(moments_type));
+    }
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
@@ -131,6 +161,12 @@ void gpu_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::resize(int w, int h)
         cudaFree(accum_buffer_);
         cudaMalloc((void**)&accum_buffer_, w * h * sizeof(accum_type));
     }
+
+    // Reallocated if adaptive sampling used it before
+    if (!moments_buffer_.empty())
+    {
+        require_moments();
+    }
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
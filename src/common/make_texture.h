@@ -11,6 +11,7 @@
 #include <ostream>
 #include <type_traits>
 
+#include <visionaray/math/half.h>
 #include <visionaray/math/unorm.h>
 #include <visionaray/math/vector.h>
 #include <visionaray/texture/texture.h>
@@ -124,6 +125,36 @@ inline void make_texture(Texture& tex, image const& img)
     }
 }
 
+
+//-------------------------------------------------------------------------------------------------
+// Overload with 4x half!
+//
+template <
+    typename Texture,
+    typename = typename std::enable_if<std::is_same<typename Texture::value_type, vector<4, half>>::value>::type,
+    typename = void,
+    typename = void
+    >
+inline void make_texture(Texture& tex, image const& img)
+{
+    if (img.format() == PF_RGB32F)
+    {
+        // Down-convert to half and add alpha=1.0
+        auto data_ptr = reinterpret_cast<vector<3, float> const*>(img.data());
+        tex.reset(data_ptr, PF_RGB32F, PF_RGBA16F, AlphaIsOne);
+    }
+    else if (img.format() == PF_RGBA32F)
+    {
+        // Down-convert to half
+        auto data_ptr = reinterpret_cast<vector<4, float> const*>(img.data());
+        tex.reset(data_ptr, PF_RGBA32F, PF_RGBA16F);
+    }
+    else
+    {
+        std::cerr << "Warning: unsupported pixel format\n";
+    }
+}
+
 } // visionaray
 
 #endif // VSNRAY_COMMON_MAKE_TEXTURE_H
@@ -0,0 +1,300 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "page_file.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// File layout: header, then all pages in the order of detail::make_paged_levels()
+//
+
+static char const PageFileMagic[4] = { 'V', 'P', 'T', 'X' };
+
+struct page_file_header
+{
+    char     magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t texel_bytes;
+    uint32_t page_size;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Read bytes at offset w/o a shared file position, safe to call concurrently
+//
+
+#ifdef _WIN32
+
+static void* open_file(std::string const& filename)
+{
+    HANDLE file = CreateFileA(
+            filename.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr
+            );
+
+    return file != INVALID_HANDLE_VALUE ? file : nullptr;
+}
+
+static void close_file(void* file)
+{
+    CloseHandle(file);
+}
+
+static bool read_at(void* file, uint64_t offset, void* dst, size_t bytes)
+{
+    char* ptr = static_cast<char*>(dst);
+
+    while (bytes > 0)
+    {
+        OVERLAPPED ov = {};
+        ov.Offset = static_cast<DWORD>(offset);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        DWORD num_read = 0;
+        DWORD count = static_cast<DWORD>(std::min(bytes, size_t(1) << 30));
+
+        if (!ReadFile(file, ptr, count, &num_read, &ov) || num_read == 0)
+        {
+            return false;
+        }
+
+        ptr += num_read;
+        offset += num_read;
+        bytes -= num_read;
+    }
+
+    return true;
+}
+
+#else
+
+static int open_file(std::string const& filename)
+{
+    return ::open(filename.c_str(), O_RDONLY);
+}
+
+static void close_file(int file)
+{
+    ::close(file);
+}
+
+static bool read_at(int file, uint64_t offset, void* dst, size_t bytes)
+{
+    char* ptr = static_cast<char*>(dst);
+
+    while (bytes > 0)
+    {
+        ssize_t num_read = ::pread(file, ptr, bytes, static_cast<off_t>(offset));
+
+        if (num_read < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (num_read <= 0)
+        {
+            return false;
+        }
+
+        ptr += num_read;
+        offset += static_cast<uint64_t>(num_read);
+        bytes -= static_cast<size_t>(num_read);
+    }
+
+    return true;
+}
+
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+// page_file
+//
+
+page_file::page_file(std::string const& filename)
+{
+    open(filename);
+}
+
+page_file::~page_file()
+{
+    close();
+}
+
+bool page_file::open(std::string const& filename)
+{
+    close();
+
+    file_ = open_file(filename);
+
+    if (!good())
+    {
+        std::cerr << "Cannot open page file: " << filename << '\n';
+        return false;
+    }
+
+    page_file_header header;
+
+    if (!read_at(file_, 0, &header, sizeof(header))
+     || std::memcmp(header.magic, PageFileMagic, sizeof(PageFileMagic)) != 0
+     || header.version != 1
+     || header.page_size != detail::PageSize)
+    {
+        std::cerr << "Invalid page file: " << filename << '\n';
+        close();
+        return false;
+    }
+
+    width_ = header.width;
+    height_ = header.height;
+    texel_bytes_ = header.texel_bytes;
+
+    unsigned num_pages = 0;
+    levels_ = detail::make_paged_levels(width_, height_, num_pages);
+
+    return true;
+}
+
+void page_file::close()
+{
+    if (good())
+    {
+        close_file(file_);
+    }
+
+#ifdef _WIN32
+    file_ = nullptr;
+#else
+    file_ = -1;
+#endif
+    width_ = 0;
+    height_ = 0;
+    texel_bytes_ = 0;
+    levels_.clear();
+}
+
+bool page_file::good() const
+{
+#ifdef _WIN32
+    return file_ != nullptr;
+#else
+    return file_ >= 0;
+#endif
+}
+
+bool page_file::read_page(unsigned level, unsigned page_x, unsigned page_y, void* dst) const
+{
+    assert(level < levels_.size());
+
+    size_t page_bytes = detail::PageSize * detail::PageSize * texel_bytes_;
+    size_t page = levels_[level].first_page + page_y * levels_[level].num_pages_x + page_x;
+
+    return read_at(file_, sizeof(page_file_header) + uint64_t(page) * page_bytes, dst, page_bytes);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Write page files
+//
+
+bool write_page_file(
+        std::string const&              filename,
+        unsigned                        width,
+        unsigned                        height,
+        size_t                          texel_bytes,
+        std::vector<void const*> const& levels
+        )
+{
+    unsigned num_pages = 0;
+    auto paged_levels = detail::make_paged_levels(width, height, num_pages);
+
+    if (levels.size() != paged_levels.size())
+    {
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+
+    if (!file.good())
+    {
+        std::cerr << "Cannot open page file for writing: " << filename << '\n';
+        return false;
+    }
+
+    page_file_header header;
+    std::memcpy(header.magic, PageFileMagic, sizeof(PageFileMagic));
+    header.version = 1;
+    header.width = width;
+    header.height = height;
+    header.texel_bytes = static_cast<uint32_t>(texel_bytes);
+    header.page_size = detail::PageSize;
+
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    size_t row_bytes = detail::PageSize * texel_bytes;
+    std::vector<char> page(detail::PageSize * row_bytes);
+
+    for (size_t l = 0; l < paged_levels.size(); ++l)
+    {
+        auto const& level = paged_levels[l];
+        char const* data = static_cast<char const*>(levels[l]);
+
+        unsigned num_pages_y = div_up(level.height, detail::PageSize);
+
+        for (unsigned py = 0; py < num_pages_y; ++py)
+        {
+            for (unsigned px = 0; px < level.num_pages_x; ++px)
+            {
+                // Texels outside the level are zero
+                std::fill(page.begin(), page.end(), 0);
+
+                unsigned x0 = px * detail::PageSize;
+                unsigned y0 = py * detail::PageSize;
+                unsigned w = min(detail::PageSize, level.width - x0);
+                unsigned h = min(detail::PageSize, level.height - y0);
+
+                for (unsigned y = 0; y < h; ++y)
+                {
+                    std::memcpy(
+                            page.data() + y * row_bytes,
+                            data + ((y0 + y) * size_t(level.width) + x0) * texel_bytes,
+                            w * texel_bytes
+                            );
+                }
+
+                file.write(page.data(), static_cast<std::streamsize>(page.size()));
+            }
+        }
+    }
+
+    return file.good();
+}
+
+} // visionaray
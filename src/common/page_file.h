@@ -0,0 +1,114 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_COMMON_PAGE_FILE_H
+#define VSNRAY_COMMON_PAGE_FILE_H 1
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <visionaray/texture/texture.h>
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// File w/ the pages of a paged_texture
+//
+// Stores all mip levels of a 2D texture, split into pages w/ the layout of
+// paged_texture. Pages are stored one after another, a page is read w/ a
+// single positional read, so threads load pages concurrently. Create page
+// files from textures w/ write_page_file().
+//
+
+class page_file
+{
+public:
+
+    page_file() = default;
+    explicit page_file(std::string const& filename);
+   ~page_file();
+
+    page_file(page_file const&) = delete;
+    page_file& operator=(page_file const&) = delete;
+
+    bool open(std::string const& filename);
+    void close();
+
+    bool good() const;
+
+    unsigned width() const { return width_; }
+    unsigned height() const { return height_; }
+    size_t texel_bytes() const { return texel_bytes_; }
+
+    // Read a page w/ PageSize x PageSize texels, thread-safe
+    bool read_page(unsigned level, unsigned page_x, unsigned page_y, void* dst) const;
+
+    // Page source for paged_texture<T, 2>, the file must outlive the texture
+    template <typename T>
+    typename paged_texture<T, 2>::source_type source() const
+    {
+        assert(sizeof(T) == texel_bytes_);
+
+        return [this](unsigned level, unsigned page_x, unsigned page_y, T* dst)
+        {
+            return read_page(level, page_x, page_y, dst);
+        };
+    }
+
+private:
+
+#ifdef _WIN32
+    void* file_ = nullptr; // HANDLE
+#else
+    int file_ = -1;
+#endif
+
+    unsigned width_ = 0;
+    unsigned height_ = 0;
+    size_t texel_bytes_ = 0;
+
+    std::vector<detail::paged_level> levels_;
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Write page files
+//
+
+// levels: row-major texels of the mip levels w/ the sizes of detail::make_paged_levels()
+bool write_page_file(
+        std::string const&              filename,
+        unsigned                        width,
+        unsigned                        height,
+        size_t                          texel_bytes,
+        std::vector<void const*> const& levels
+        );
+
+// Downsample tex w/ mipmapped_texture and write all levels
+template <typename T>
+bool write_page_file(std::string const& filename, texture<T, 2> const& tex)
+{
+    unsigned num_pages = 0;
+    auto paged_levels = detail::make_paged_levels(tex.width(), tex.height(), num_pages);
+
+    mipmapped_texture<T, 2> mipmaps(tex, static_cast<unsigned>(paged_levels.size()));
+
+    std::vector<void const*> levels;
+
+    for (unsigned l = 0; l < mipmaps.num_levels(); ++l)
+    {
+        levels.push_back(mipmaps.level(l).data());
+    }
+
+    return write_page_file(filename, tex.width(), tex.height(), sizeof(T), levels);
+}
+
+} // visionaray
+
+#endif // VSNRAY_COMMON_PAGE_FILE_H
@@ -10,6 +10,7 @@
 
 #include <GL/glew.h>
 
+#include <visionaray/cuda/device_vector.h>
 #include <visionaray/math/forward.h>
 #include <visionaray/math/vector.h>
 #include <visionaray/detail/macros.h>
@@ -36,6 +37,7 @@ public:
     using color_type    = typename pixel_traits<ColorFormat>::type;
     using depth_type    = typename pixel_traits<DepthFormat>::type;
     using accum_type    = typename pixel_traits<AccumFormat>::type;
+    using moments_type  = vec4;
 
     using ref_type      = render_target_ref<ColorFormat, DepthFormat, AccumFormat>;
 
@@ -47,13 +49,19 @@ public:
     color_type* color();
     depth_type* depth();
     accum_type* accum();
+    moments_type* moments();
 
     color_type const* color() const;
     depth_type const* depth() const;
     accum_type const* accum() const;
+    moments_type const* moments() const;
 
     ref_type ref();
 
+    // Allocate the moments buffer for adaptive sampling, called by the
+    // schedulers. moments() returns nullptr before
+    void require_moments();
+
     void clear_color_buffer(vec4 const& color = vec4(0.0f));
     void clear_depth_buffer(float depth = 1.0f);
     void clear_accum_buffer(vec4 const& color = vec4(0.0f));
@@ -74,6 +82,8 @@ private:
     gl::buffer                            depth_buffer;
     gl::buffer                            accum_buffer;
 
+    cuda::device_vector<moments_type>     moments_buffer;
+
 };
 
 } // visionaray
@@ -39,6 +39,12 @@ typename pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_ty
     return static_cast<accum_type*>(accum_resource.dev_ptr());
 }
 
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+typename pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments_type* pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments()
+{
+    return moments_buffer.empty() ? nullptr : moments_buffer.data();
+}
+
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 typename pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::color_type const* pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::color() const
 {
@@ -57,10 +63,27 @@ typename pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::accum_ty
     return static_cast<accum_type const*>(accum_resource.dev_ptr());
 }
 
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+typename pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments_type const* pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::moments() const
+{
+    return moments_buffer.empty() ? nullptr : moments_buffer.data();
+}
+
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
 typename pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::ref_type pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::ref()
 {
-    return { color(), depth(), accum(), width(), height() };
+    return { color(), depth(), accum(), width(), height(), moments() };
+}
+
+template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
+void pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::require_moments()
+{
+    if (moments_buffer.size() != static_cast<size_t>(width() * height()))
+    {
+        moments_type m(0.0f);
+        moments_buffer.resize(width() * height());
+        cuda::fill(moments_buffer.data(), moments_buffer.size() * sizeof(moments_type), &m, sizeof(moments_type));
+    }
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
@@ -172,6 +195,12 @@ void pixel_unpack_buffer_rt<ColorFormat, DepthFormat, AccumFormat>::resize(int w
         // register buffer object with CUDA
         depth_resource.register_buffer(depth_buffer.get(), cudaGraphicsRegisterFlagsWriteDiscard);
     }
+
+    // Reallocated if adaptive sampling used it before
+    if (!moments_buffer.empty())
+    {
+        require_moments();
+    }
 }
 
 template <pixel_format ColorFormat, pixel_format DepthFormat, pixel_format AccumFormat>
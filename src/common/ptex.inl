@@ -3,10 +3,19 @@
 
 #include <cmath>
 #include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 
 #include <visionaray/math/simd/type_traits.h>
+#include <visionaray/math/detail/math.h>
 #include <visionaray/math/forward.h>
+#include <visionaray/math/unorm.h>
 #include <visionaray/math/triangle.h>
 #include <visionaray/math/vector.h>
 #include <visionaray/texture/texture_traits.h>
@@ -22,38 +31,208 @@ namespace visionaray
 
 namespace ptex
 {
+namespace detail
+{
 
-// tex2D
-inline vector<4, unorm<8>> tex2D(texture const& tex, coordinate<float> const& coord)
+//-------------------------------------------------------------------------------------------------
+// Per-thread texture handles
+//
+// Opening a texture through the PtexCache locks the cache, and creating a
+// filter allocates. Each thread therefore keeps the handles and filters of
+// the textures it has accessed, keyed by cache and filename. Handles keep
+// their cache alive. Once a cache is referenced by handles only, all its
+// textures were destroyed, and threads release their handles of the cache
+// the next time they open a texture.
+//
+
+using cache_ptr = std::shared_ptr<PtexPtr<PtexCache>>;
+
+struct thread_handle
+{
+    // Released last
+    cache_ptr cache;
+
+    PtexPtr<PtexTexture> tex;
+    PtexPtr<Ptex::PtexFilter> filter;
+    int num_channels = 0;
+};
+
+struct thread_handle_key
 {
-    Ptex::String error = "";
-    PtexPtr<PtexTexture> ptex_tex(tex.cache->get()->get(tex.filename.c_str(), error));
+    PtexPtr<PtexCache> const* cache;
+    std::string filename;
 
-    if (ptex_tex == nullptr)
+    bool operator==(thread_handle_key const& rhs) const
     {
-        return vector<4, unorm<8>>(1.0f, 1.0f, 1.0f, 1.0f);
+        return cache == rhs.cache && filename == rhs.filename;
+    }
+};
+
+struct thread_handle_key_hash
+{
+    size_t operator()(thread_handle_key const& key) const
+    {
+        return std::hash<void const*>()(key.cache) ^ std::hash<std::string>()(key.filename);
+    }
+};
+
+// Number of handles of all threads per cache
+class handle_counts
+{
+public:
+
+    void add(PtexPtr<PtexCache> const* cache, long n)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+
+        long& count = counts_[cache];
+        count += n;
+
+        if (count == 0)
+        {
+            counts_.erase(cache);
+        }
+    }
+
+    // True if no texture references the cache anymore
+    bool unused(cache_ptr const& cache)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+
+        auto it = counts_.find(cache.get());
+        return it != counts_.end() && cache.use_count() <= it->second;
+    }
+
+private:
+
+    std::mutex mutex_;
+    std::unordered_map<PtexPtr<PtexCache> const*, long> counts_;
+
+};
+
+inline handle_counts& global_handle_counts()
+{
+    static handle_counts counts;
+    return counts;
+}
+
+class thread_handles
+{
+public:
+
+    thread_handles() = default;
+
+   ~thread_handles()
+    {
+        for (auto const& h : handles_)
+        {
+            global_handle_counts().add(h.first.cache, -1);
+        }
+    }
+
+    thread_handles(thread_handles const&) = delete;
+    thread_handles& operator=(thread_handles const&) = delete;
+
+    thread_handle const& get(texture const& tex)
+    {
+        // Consecutive lookups mostly access the same texture
+        if (last_ != nullptr && last_tex_ == &tex && last_->cache == tex.cache && *last_filename_ == tex.filename)
+        {
+            return *last_;
+        }
+
+        thread_handle_key key{ tex.cache.get(), tex.filename };
+        auto it = handles_.find(key);
+
+        if (it == handles_.end())
+        {
+            release_unused();
+
+            // PtexPtr is not copyable, construct in place
+            it = handles_.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>()).first;
+            open(it->second, tex);
+            global_handle_counts().add(key.cache, 1);
+        }
+
+        last_tex_ = &tex;
+        last_ = &it->second;
+        last_filename_ = &it->first.filename;
+
+        return it->second;
+    }
+
+private:
+
+    static void open(thread_handle& h, texture const& tex)
+    {
+        h.cache = tex.cache;
+
+        Ptex::String error = "";
+        h.tex.reset(tex.cache->get()->get(tex.filename.c_str(), error));
+
+        if (h.tex != nullptr)
+        {
+            Ptex::PtexFilter::Options opts(Ptex::PtexFilter::FilterType::f_bspline);
+            h.filter.reset(Ptex::PtexFilter::getFilter(h.tex.get(), opts));
+            h.num_channels = h.tex->numChannels();
+        }
+    }
+
+    void release_unused()
+    {
+        for (auto it = handles_.begin(); it != handles_.end(); )
+        {
+            if (global_handle_counts().unused(it->second.cache))
+            {
+                global_handle_counts().add(it->first.cache, -1);
+                it = handles_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        last_ = nullptr;
     }
 
-    Ptex::PtexFilter::Options opts(Ptex::PtexFilter::FilterType::f_bspline);
-    PtexPtr<Ptex::PtexFilter> filter(Ptex::PtexFilter::getFilter(ptex_tex.get(), opts));
+    std::unordered_map<thread_handle_key, thread_handle, thread_handle_key_hash> handles_;
+
+    texture const* last_tex_ = nullptr;
+    thread_handle const* last_ = nullptr;
+    std::string const* last_filename_ = nullptr;
 
-    auto face_data = ptex_tex->getData(coord.face_id);
-    auto res = face_data->res();
+};
 
-    vec3 rgb;
-    filter->eval(
+inline thread_handle const& get_thread_handle(texture const& tex)
+{
+    thread_local thread_handles handles;
+    return handles.get(tex);
+}
+
+// Filter with a width of one texel
+inline vector<4, unorm<8>> eval(thread_handle const& h, int face_id, float u, float v, Ptex::Res res)
+{
+    vec3 rgb(0.0f);
+    h.filter->eval(
             rgb.data(),
             0,
-            ptex_tex->numChannels(),
-            coord.face_id,
-            coord.u,
-            coord.v,
+            min(h.num_channels, 3),
+            face_id,
+            u,
+            v,
             1.0f / res.u(),
             0.0f,
             0.0f,
             1.0f / res.v()
             );
 
+    // Gray scale textures
+    if (h.num_channels == 1)
+    {
+        rgb = vec3(rgb.x);
+    }
+
     // TODO: Ptex is agnostic of linear vs. non-linear color spaces
     // The following conversion from non-linear to Visionaray's internal
     // linear color space is specific to Disney's Moana Island Scene
@@ -65,6 +244,68 @@ inline vector<4, unorm<8>> tex2D(texture const& tex, coordinate<float> const& co
             );
 }
 
+} // detail
+
+
+// tex2D
+inline vector<4, unorm<8>> tex2D(texture const& tex, coordinate<float> const& coord)
+{
+    auto const& h = detail::get_thread_handle(tex);
+
+    if (h.tex == nullptr)
+    {
+        return vector<4, unorm<8>>(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+
+    return detail::eval(h, coord.face_id, coord.u, coord.v, h.tex->getFaceInfo(coord.face_id).res);
+}
+
+// tex2D, SIMD: one handle lookup per packet, lanes on the same face share
+// the face info
+template <
+    typename T,
+    typename = typename std::enable_if<simd::is_simd_vector<T>::value>::type
+    >
+inline vector<4, T> tex2D(texture const& tex, coordinate<T> const& coord)
+{
+    using I = typename coordinate<T>::I;
+
+    static const int N = simd::num_elements<T>::value;
+
+    simd::aligned_array_t<I> face_ids;
+    simd::aligned_array_t<T> us;
+    simd::aligned_array_t<T> vs;
+    store(face_ids, coord.face_id);
+    store(us, coord.u);
+    store(vs, coord.v);
+
+    auto const& h = detail::get_thread_handle(tex);
+
+    array<vector<4, float>, N> texels;
+
+    int face_id = -1;
+    Ptex::Res res;
+
+    for (int i = 0; i < N; ++i)
+    {
+        if (h.tex == nullptr)
+        {
+            texels[i] = vector<4, float>(1.0f);
+            continue;
+        }
+
+        if (face_ids[i] != face_id)
+        {
+            face_id = face_ids[i];
+            res = h.tex->getFaceInfo(face_id).res;
+        }
+
+        texels[i] = vector<4, float>(detail::eval(h, face_id, us[i], vs[i], res));
+    }
+
+    return simd::pack(texels);
+}
+
 } // ptex
 
 
@@ -0,0 +1,257 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <string>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include <visionaray/detail/color_conversion.h>
+#include <visionaray/math/vector.h>
+#include <visionaray/aligned_vector.h>
+
+#include "image.h"
+#include "sched_profiler_io.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+static double to_us(double seconds)
+{
+    return seconds * 1000000.0;
+}
+
+// Wall time per pixel in microseconds
+static float time_per_pixel(tile_timing const& t)
+{
+    int num_pixels = (t.x1 - t.x0) * (t.y1 - t.y0);
+
+    return num_pixels > 0
+        ? static_cast<float>(to_us(t.end - t.begin) / num_pixels)
+        : 0.0f;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// CSV
+//
+
+bool save_tile_timings_csv(sched_profiler const& prof, std::string const& filename)
+{
+    std::ofstream file(filename);
+
+    if (!file.good())
+    {
+        std::cerr << "Cannot open file: " << filename << '\n';
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+
+    file << "frame,x0,y0,x1,y1,thread,samples,begin_us,end_us,duration_us\n";
+
+    for (auto const& t : prof.tiles())
+    {
+        file << t.frame_id << ','
+             << t.x0 << ',' << t.y0 << ','
+             << t.x1 << ',' << t.y1 << ','
+             << t.thread_index << ','
+             << t.num_samples << ','
+             << to_us(t.begin) << ','
+             << to_us(t.end) << ','
+             << to_us(t.end - t.begin) << '\n';
+    }
+
+    if (!file)
+    {
+        std::cerr << "Error writing to file\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Chrome trace event format
+// see: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+//
+
+bool save_tile_timings_chrome_trace(sched_profiler const& prof, std::string const& filename)
+{
+    std::ofstream file(filename);
+
+    if (!file.good())
+    {
+        std::cerr << "Cannot open file: " << filename << '\n';
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+
+    file << "{\"traceEvents\":[\n";
+
+    bool first = true;
+
+    auto separator = [&]()
+    {
+        if (!first)
+        {
+            file << ",\n";
+        }
+        first = false;
+    };
+
+    // Frames go on a separate track (tid -1)
+    for (auto const& f : prof.frames())
+    {
+        separator();
+        file << "{\"name\":\"frame " << f.frame_id << "\",\"cat\":\"frame\",\"ph\":\"X\""
+             << ",\"pid\":0,\"tid\":-1"
+             << ",\"ts\":" << to_us(f.begin)
+             << ",\"dur\":" << to_us(f.end - f.begin)
+             << ",\"args\":{\"width\":" << f.width << ",\"height\":" << f.height << "}}";
+    }
+
+    for (auto const& t : prof.tiles())
+    {
+        separator();
+        file << "{\"name\":\"tile\",\"cat\":\"tile\",\"ph\":\"X\""
+             << ",\"pid\":0,\"tid\":" << t.thread_index
+             << ",\"ts\":" << to_us(t.begin)
+             << ",\"dur\":" << to_us(t.end - t.begin)
+             << ",\"args\":{\"frame\":" << t.frame_id
+             << ",\"x0\":" << t.x0 << ",\"y0\":" << t.y0
+             << ",\"x1\":" << t.x1 << ",\"y1\":" << t.y1
+             << ",\"samples\":" << t.num_samples << "}}";
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    if (!file)
+    {
+        std::cerr << "Error writing to file\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Heat map
+//
+
+bool make_tile_heat_map(
+        sched_profiler const&   prof,
+        unsigned                frame_id,
+        aligned_vector<float>&  times,
+        int&                    width,
+        int&                    height
+        )
+{
+    auto fit = std::find_if(
+            prof.frames().begin(),
+            prof.frames().end(),
+            [frame_id](frame_timing const& f) { return f.frame_id == frame_id; }
+            );
+
+    if (fit == prof.frames().end())
+    {
+        std::cerr << "No timings recorded for frame " << frame_id << '\n';
+        return false;
+    }
+
+    width = fit->width;
+    height = fit->height;
+
+    times.assign(width * static_cast<size_t>(height), 0.0f);
+
+    for (auto const& t : prof.tiles())
+    {
+        if (t.frame_id != frame_id)
+        {
+            continue;
+        }
+
+        float tpp = time_per_pixel(t);
+
+        for (int y = std::max(t.y0, 0); y < std::min(t.y1, height); ++y)
+        {
+            for (int x = std::max(t.x0, 0); x < std::min(t.x1, width); ++x)
+            {
+                times[y * width + x] = tpp;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool save_tile_heat_map(sched_profiler const& prof, std::string const& filename, unsigned frame_id)
+{
+    aligned_vector<float> times;
+    int width = 0;
+    int height = 0;
+
+    if (!make_tile_heat_map(prof, frame_id, times, width, height))
+    {
+        return false;
+    }
+
+    std::string ext = boost::filesystem::path(filename).extension().string();
+    boost::algorithm::to_lower(ext);
+
+    if (ext == ".exr")
+    {
+        aligned_vector<vec3> rgb(times.size());
+
+        for (size_t i = 0; i < times.size(); ++i)
+        {
+            rgb[i] = vec3(times[i]);
+        }
+
+        image img(width, height, PF_RGB32F, reinterpret_cast<uint8_t const*>(rgb.data()));
+        return img.save(filename, {});
+    }
+    else
+    {
+        float max_time = times.empty() ? 0.0f : *std::max_element(times.begin(), times.end());
+
+        aligned_vector<vector<3, uint8_t>> rgb(times.size());
+
+        for (size_t i = 0; i < times.size(); ++i)
+        {
+            float t = max_time > 0.0f ? times[i] / max_time : 0.0f;
+            vec3 c = temperature_to_rgb(t) * 255.0f;
+            rgb[i] = vector<3, uint8_t>(c);
+        }
+
+        image img(width, height, PF_RGB8, reinterpret_cast<uint8_t const*>(rgb.data()));
+        return img.save(filename, { { "binary", true } });
+    }
+}
+
+bool save_tile_heat_map(sched_profiler const& prof, std::string const& filename)
+{
+    if (prof.frames().empty())
+    {
+        std::cerr << "No timings recorded\n";
+        return false;
+    }
+
+    return save_tile_heat_map(prof, filename, prof.frames().back().frame_id);
+}
+
+} // visionaray
@@ -0,0 +1,48 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_COMMON_SCHED_PROFILER_IO_H
+#define VSNRAY_COMMON_SCHED_PROFILER_IO_H 1
+
+#include <string>
+
+#include <visionaray/detail/sched_profiler.h>
+#include <visionaray/aligned_vector.h>
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Export per-tile timings recorded by a CPU scheduler
+//
+
+// CSV file, one line per tile:
+// frame,x0,y0,x1,y1,thread,samples,begin_us,end_us,duration_us
+bool save_tile_timings_csv(sched_profiler const& prof, std::string const& filename);
+
+// JSON timeline for chrome://tracing or Perfetto, one track per worker thread
+bool save_tile_timings_chrome_trace(sched_profiler const& prof, std::string const& filename);
+
+// Wall time per pixel in microseconds (tile time / tile pixels) for one
+// frame, row-major. Returns false if no timings were recorded for the frame.
+bool make_tile_heat_map(
+        sched_profiler const&   prof,
+        unsigned                frame_id,
+        aligned_vector<float>&  times,
+        int&                    width,
+        int&                    height
+        );
+
+// Heat map of the wall time per pixel (tile time / tile pixels) for one frame.
+// EXR files store the raw time in microseconds, other formats (PNM, PNG)
+// store a temperature colored image normalized to the slowest tile.
+bool save_tile_heat_map(sched_profiler const& prof, std::string const& filename, unsigned frame_id);
+
+// Heat map of the most recent frame
+bool save_tile_heat_map(sched_profiler const& prof, std::string const& filename);
+
+} // visionaray
+
+#endif // VSNRAY_COMMON_SCHED_PROFILER_IO_H
@@ -16,6 +16,7 @@
 #include <visionaray/variant.h>
 
 #include "bvh_costs.h"
+#include "host_sched.h"
 
 namespace visionaray
 {
@@ -31,7 +32,24 @@ namespace visionaray
 
 
 
-enum algorithm { Simple, Whitted, Pathtracing, Costs };
+enum algorithm { Simple, Whitted, Pathtracing, Costs, AmbientOcclusion };
+
+// Algorithms that blend frames until convergence
+inline bool is_progressive(algorithm algo)
+{
+    return algo == Pathtracing || algo == AmbientOcclusion;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Settings of the ambient occlusion kernel, passed w/ each render call
+//
+
+struct ao_settings
+{
+    unsigned samples = 8;
+    float radius = 1.0f;
+};
 
 
 //-------------------------------------------------------------------------------------------------
@@ -45,6 +63,7 @@ inline void call_kernel(
         KParams const&                                   kparams,
         unsigned&                                        frame_num,
         unsigned                                         spp,
+        ao_settings const&                               ao,
         variant<pinhole_camera, thin_lens_camera> const& cam,
         RT&                                              rt
         )
@@ -57,6 +76,7 @@ inline void call_kernel(
                 kparams,
                 frame_num,
                 spp,
+                ao,
                 *cam.as<thin_lens_camera>(),
                 rt
                 );
@@ -69,6 +89,7 @@ inline void call_kernel(
                 kparams,
                 frame_num,
                 spp,
+                ao,
                 *cam.as<pinhole_camera>(),
                 rt
                 );
@@ -82,12 +103,13 @@ inline void call_kernel(
 
 template <typename Sched, typename KParams, typename ...Args>
 void call_kernel(
-        algorithm       algo,
-        Sched&          sched,
-        KParams const&  kparams,
-        unsigned&       frame_num,
-        unsigned        spp,
-        Args&&...       args
+        algorithm           algo,
+        Sched&              sched,
+        KParams const&      kparams,
+        unsigned&           frame_num,
+        unsigned            spp,
+        ao_settings const&  ao,
+        Args&&...           args
         )
 {
     switch (algo)
@@ -126,6 +148,22 @@ void call_kernel(
             );
         break;
     }
+    case AmbientOcclusion:
+    {
+        float alpha = 1.0f / ++frame_num;
+        pixel_sampler::sobol_blend_type sps;
+        sps.spp = spp;
+        sps.sfactor = alpha;
+        sps.dfactor = 1.0f - alpha;
+        ambient_occlusion::kernel<KParams> kernel{kparams};
+        kernel.samples = ao.samples;
+        kernel.radius = ao.radius;
+        sched.frame(
+            kernel,
+            make_sched_params(sps, std::forward<Args>(args)...)
+            );
+        break;
+    }
     case Costs:
     {
         sched.frame(
@@ -137,6 +175,28 @@ void call_kernel(
     }
 }
 
+
+//-------------------------------------------------------------------------------------------------
+// Host scheduler with runtime SIMD width, dispatch to the active packet type
+//
+
+template <typename KParams, typename ...Args>
+void call_kernel(
+        algorithm           algo,
+        multi_width_sched&  sched,
+        KParams const&      kparams,
+        unsigned&           frame_num,
+        unsigned            spp,
+        ao_settings const&  ao,
+        Args&&...           args
+        )
+{
+    sched.visit([&](auto& s)
+    {
+        call_kernel(algo, s, kparams, frame_num, spp, ao, args...);
+    });
+}
+
 } // visionaray
 
 #endif // VSNRAY_VIEWER_CALL_KERNEL_H
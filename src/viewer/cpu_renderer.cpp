@@ -0,0 +1,150 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <iostream>
+#include <ostream>
+#include <string>
+
+#if VSNRAY_VIEWER_HAVE_ISA_DISPATCH
+#include <dlfcn.h>
+#endif
+
+#include <common/cpu_features.h>
+
+#include "cpu_renderer.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+#if VSNRAY_VIEWER_HAVE_ISA_DISPATCH
+
+using abi_version_func = int (*)();
+using create_func = cpu_renderer* (*)(unsigned);
+
+// Load module and resolve the factory function, modules stay loaded
+// until the program exits, so there is no need to keep the handle
+static create_func load_module(cpu_isa isa)
+{
+    // Modules are found via the viewer's runpath ($ORIGIN/...)
+    std::string filename = std::string("vsnray-viewer-cpu-")
+                         + cpu_isa_name(isa)
+                         + VSNRAY_VIEWER_MODULE_SUFFIX;
+
+    void* handle = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+    if (handle == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto abi_version = reinterpret_cast<abi_version_func>(
+            dlsym(handle, "vsnray_viewer_cpu_renderer_abi_version")
+            );
+
+    if (abi_version == nullptr || abi_version() != cpu_renderer::ABIVersion)
+    {
+        std::cerr << "Warning: ignoring incompatible module " << filename << '\n';
+        return nullptr;
+    }
+
+    return reinterpret_cast<create_func>(dlsym(handle, "vsnray_viewer_create_cpu_renderer"));
+}
+
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+// Public interface
+//
+
+char const* cpu_isa_name(cpu_isa isa)
+{
+    switch (isa)
+    {
+    case IsaAuto:
+        return "auto";
+
+    case IsaBaseline:
+        return "baseline";
+
+    case IsaSSE4_2:
+        return "sse4_2";
+
+    case IsaAVX2:
+        return "avx2";
+
+    case IsaAVX512:
+        return "avx512";
+    }
+
+    return "unknown";
+}
+
+bool cpu_isa_supported(cpu_isa isa)
+{
+    cpu_features const& cpu = get_cpu_features();
+
+    switch (isa)
+    {
+    case IsaAuto:
+    case IsaBaseline:
+        return true;
+
+    case IsaSSE4_2:
+        return cpu.sse4_2;
+
+    case IsaAVX2:
+        return cpu.avx2 && cpu.fma && cpu.f16c;
+
+    case IsaAVX512:
+        return cpu.avx512f && cpu.avx512dq && cpu.avx512bw && cpu.avx512vl
+            && cpu.avx2 && cpu.fma && cpu.f16c;
+    }
+
+    return false;
+}
+
+std::unique_ptr<cpu_renderer> make_cpu_renderer(cpu_isa isa, unsigned num_threads)
+{
+    if (isa == IsaAuto)
+    {
+        for (cpu_isa i : { IsaAVX512, IsaAVX2, IsaSSE4_2 })
+        {
+            auto result = make_cpu_renderer(i, num_threads);
+
+            if (result != nullptr)
+            {
+                return result;
+            }
+        }
+
+        return make_cpu_renderer(IsaBaseline, num_threads);
+    }
+
+    if (isa == IsaBaseline)
+    {
+        return std::unique_ptr<cpu_renderer>(create_baseline_cpu_renderer(num_threads));
+    }
+
+    if (!cpu_isa_supported(isa))
+    {
+        return nullptr;
+    }
+
+#if VSNRAY_VIEWER_HAVE_ISA_DISPATCH
+    create_func create = load_module(isa);
+
+    if (create != nullptr)
+    {
+        return std::unique_ptr<cpu_renderer>(create(num_threads));
+    }
+#endif
+
+    return nullptr;
+}
+
+} // visionaray
@@ -0,0 +1,174 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_VIEWER_CPU_RENDERER_H
+#define VSNRAY_VIEWER_CPU_RENDERER_H 1
+
+#include <memory>
+
+#include "render.h"
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Instruction sets the CPU render calls can be compiled for
+//
+// IsaBaseline is linked into the viewer and uses the viewer's compile
+// flags. The other ISAs are built as loadable modules (see
+// VSNRAY_ENABLE_VIEWER_ISA_DISPATCH) and are only loaded if the host
+// CPU supports them.
+//
+
+enum cpu_isa
+{
+    IsaAuto,
+    IsaBaseline,
+    IsaSSE4_2,
+    IsaAVX2,
+    IsaAVX512
+};
+
+// Short name, also used for the module file name (e.g. "avx2")
+char const* cpu_isa_name(cpu_isa isa);
+
+// Does the host CPU (and OS) support the instruction set?
+bool cpu_isa_supported(cpu_isa isa);
+
+
+//-------------------------------------------------------------------------------------------------
+// Interface to the CPU render calls compiled for one instruction set
+//
+// Owns the host scheduler. Objects are created with make_cpu_renderer(),
+// never derive from this class outside of cpu_renderer_impl.cpp.
+//
+
+class cpu_renderer
+{
+public:
+
+    // Bump when the interface changes, modules with a different version are rejected
+    enum { ABIVersion = 2 };
+
+    virtual ~cpu_renderer() = default;
+
+    // Name of the SIMD instruction set the render calls were compiled for
+    virtual char const* isa_name() const = 0;
+
+    virtual void set_simd_width(simd_width width) = 0;
+    virtual simd_width get_simd_width() const = 0;
+
+    // Packets of this width map to native vector registers
+    virtual bool simd_width_native(simd_width width) const = 0;
+
+    virtual void render_plastic(
+            index_bvh<basic_triangle<3, float>> const& bvh,
+            aligned_vector<vec3> const&                geometric_normals,
+            aligned_vector<vec3> const&                shading_normals,
+            aligned_vector<vec2> const&                tex_coords,
+            aligned_vector<plastic_t> const&           materials,
+            aligned_vector<texture_t> const&           textures,
+            aligned_vector<point_light<float>> const&  lights,
+            unsigned                                   bounces,
+            float                                      epsilon,
+            vec4                                       bgcolor,
+            vec4                                       ambient,
+            host_device_rt&                            rt,
+            camera_t const&                            cam,
+            unsigned&                                  frame_num,
+            algorithm                                  algo,
+            unsigned                                   ssaa_samples,
+            ao_settings const&                         ao
+            ) = 0;
+
+    virtual void render_generic_material(
+            index_bvh<basic_triangle<3, float>> const&                         bvh,
+            aligned_vector<vec3> const&                                        geometric_normals,
+            aligned_vector<vec3> const&                                        shading_normals,
+            aligned_vector<vec2> const&                                        tex_coords,
+            aligned_vector<generic_material_t> const&                          materials,
+            aligned_vector<texture_t> const&                                   textures,
+            aligned_vector<area_light<float, basic_triangle<3, float>>> const& lights,
+            unsigned                                                           bounces,
+            float                                                              epsilon,
+            vec4                                                               bgcolor,
+            vec4                                                               ambient,
+            host_device_rt&                                                    rt,
+            camera_t const&                                                    cam,
+            unsigned&                                                          frame_num,
+            algorithm                                                          algo,
+            unsigned                                                           ssaa_samples,
+            ao_settings const&                                                 ao
+            ) = 0;
+
+    virtual void render_instances(
+            index_bvh<index_bvh<basic_triangle<3, float>>::bvh_inst>& bvh,
+            aligned_vector<vec3> const&                               geometric_normals,
+            aligned_vector<vec3> const&                               shading_normals,
+            aligned_vector<vec2> const&                               tex_coords,
+            aligned_vector<generic_material_t> const&                 materials,
+            aligned_vector<vec3> const&                               colors,
+            aligned_vector<texture_t> const&                          textures,
+            aligned_vector<generic_light_t> const&                    lights,
+            unsigned                                                  bounces,
+            float                                                     epsilon,
+            vec4                                                      bgcolor,
+            vec4                                                      ambient,
+            host_device_rt&                                           rt,
+            camera_t const&                                           cam,
+            unsigned&                                                 frame_num,
+            algorithm                                                 algo,
+            unsigned                                                  ssaa_samples,
+            ao_settings const&                                        ao,
+            host_environment_light const&                             env_light
+            ) = 0;
+
+#if VSNRAY_COMMON_HAVE_PTEX
+    virtual void render_instances_ptex(
+            index_bvh<index_bvh<basic_triangle<3, float>>::bvh_inst>& bvh,
+            aligned_vector<vec3> const&                               geometric_normals,
+            aligned_vector<vec3> const&                               shading_normals,
+            aligned_vector<ptex::face_id_t> const&                    face_ids,
+            aligned_vector<generic_material_t> const&                 materials,
+            aligned_vector<vec3> const&                               colors,
+            aligned_vector<ptex::texture> const&                      textures,
+            aligned_vector<generic_light_t> const&                    lights,
+            unsigned                                                  bounces,
+            float                                                     epsilon,
+            vec4                                                      bgcolor,
+            vec4                                                      ambient,
+            host_device_rt&                                           rt,
+            camera_t const&                                           cam,
+            unsigned&                                                 frame_num,
+            algorithm                                                 algo,
+            unsigned                                                  ssaa_samples,
+            ao_settings const&                                        ao,
+            host_environment_light const&                             env_light
+            ) = 0;
+#endif
+
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Create CPU renderer for the given instruction set
+//
+// IsaAuto picks the widest ISA that is supported by the CPU and for
+// which a module is available, falling back to IsaBaseline. Returns
+// nullptr if the ISA is not supported or the module cannot be loaded.
+//
+
+std::unique_ptr<cpu_renderer> make_cpu_renderer(cpu_isa isa, unsigned num_threads);
+
+
+//-------------------------------------------------------------------------------------------------
+// Baseline renderer linked into the viewer (cpu_renderer_impl.cpp)
+//
+
+cpu_renderer* create_baseline_cpu_renderer(unsigned num_threads);
+
+} // visionaray
+
+#endif // VSNRAY_VIEWER_CPU_RENDERER_H
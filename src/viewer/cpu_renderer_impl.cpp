@@ -0,0 +1,290 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <visionaray/math/simd/intrinsics.h>
+
+#include "cpu_renderer.h"
+
+//-------------------------------------------------------------------------------------------------
+// This file is compiled into the viewer (baseline ISA) and, with
+// VSNRAY_VIEWER_CPU_RENDERER_MODULE defined, once per ISA into a module
+// that is built with hidden visibility, so that none of the inline
+// functions and template instances compiled with wider instruction sets
+// can leak into the viewer.
+//
+
+namespace visionaray
+{
+
+//-------------------------------------------------------------------------------------------------
+// Name of the SIMD ISA this translation unit was compiled for
+//
+
+static char const* compiled_isa_name()
+{
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX512F)
+    return "avx512";
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX2)
+    return "avx2";
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX)
+    return "avx";
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_SSE4_2)
+    return "sse4_2";
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_SSE4_1)
+    return "sse4_1";
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_SSE2)
+    return "sse2";
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_NEON_FP)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Forward to the render calls, using a scheduler compiled for this ISA
+//
+
+class cpu_renderer_impl : public cpu_renderer
+{
+public:
+
+    explicit cpu_renderer_impl(unsigned num_threads)
+        : sched_(num_threads)
+    {
+    }
+
+    char const* isa_name() const
+    {
+        return compiled_isa_name();
+    }
+
+    void set_simd_width(simd_width width)
+    {
+        sched_.set_width(width);
+    }
+
+    simd_width get_simd_width() const
+    {
+        return sched_.width();
+    }
+
+    bool simd_width_native(simd_width width) const
+    {
+        return visionaray::simd_width_native(width);
+    }
+
+    void render_plastic(
+            index_bvh<basic_triangle<3, float>> const& bvh,
+            aligned_vector<vec3> const&                geometric_normals,
+            aligned_vector<vec3> const&                shading_normals,
+            aligned_vector<vec2> const&                tex_coords,
+            aligned_vector<plastic_t> const&           materials,
+            aligned_vector<texture_t> const&           textures,
+            aligned_vector<point_light<float>> const&  lights,
+            unsigned                                   bounces,
+            float                                      epsilon,
+            vec4                                       bgcolor,
+            vec4                                       ambient,
+            host_device_rt&                            rt,
+            camera_t const&                            cam,
+            unsigned&                                  frame_num,
+            algorithm                                  algo,
+            unsigned                                   ssaa_samples,
+            ao_settings const&                         ao
+            )
+    {
+        render_plastic_cpp(
+                bvh,
+                geometric_normals,
+                shading_normals,
+                tex_coords,
+                materials,
+                textures,
+                lights,
+                bounces,
+                epsilon,
+                bgcolor,
+                ambient,
+                rt,
+                sched_,
+                cam,
+                frame_num,
+                algo,
+                ssaa_samples,
+                ao
+                );
+    }
+
+    void render_generic_material(
+            index_bvh<basic_triangle<3, float>> const&                         bvh,
+            aligned_vector<vec3> const&                                        geometric_normals,
+            aligned_vector<vec3> const&                                        shading_normals,
+            aligned_vector<vec2> const&                                        tex_coords,
+            aligned_vector<generic_material_t> const&                          materials,
+            aligned_vector<texture_t> const&                                   textures,
+            aligned_vector<area_light<float, basic_triangle<3, float>>> const& lights,
+            unsigned                                                           bounces,
+            float                                                              epsilon,
+            vec4                                                               bgcolor,
+            vec4                                                               ambient,
+            host_device_rt&                                                    rt,
+            camera_t const&                                                    cam,
+            unsigned&                                                          frame_num,
+            algorithm                                                          algo,
+            unsigned                                                           ssaa_samples,
+            ao_settings const&                                                 ao
+            )
+    {
+        render_generic_material_cpp(
+                bvh,
+                geometric_normals,
+                shading_normals,
+                tex_coords,
+                materials,
+                textures,
+                lights,
+                bounces,
+                epsilon,
+                bgcolor,
+                ambient,
+                rt,
+                sched_,
+                cam,
+                frame_num,
+                algo,
+                ssaa_samples,
+                ao
+                );
+    }
+
+    void render_instances(
+            index_bvh<index_bvh<basic_triangle<3, float>>::bvh_inst>& bvh,
+            aligned_vector<vec3> const&                               geometric_normals,
+            aligned_vector<vec3> const&                               shading_normals,
+            aligned_vector<vec2> const&                               tex_coords,
+            aligned_vector<generic_material_t> const&                 materials,
+            aligned_vector<vec3> const&                               colors,
+            aligned_vector<texture_t> const&                          textures,
+            aligned_vector<generic_light_t> const&                    lights,
+            unsigned                                                  bounces,
+            float                                                     epsilon,
+            vec4                                                      bgcolor,
+            vec4                                                      ambient,
+            host_device_rt&                                           rt,
+            camera_t const&                                           cam,
+            unsigned&                                                 frame_num,
+            algorithm                                                 algo,
+            unsigned                                                  ssaa_samples,
+            ao_settings const&                                        ao,
+            host_environment_light const&                             env_light
+            )
+    {
+        render_instances_cpp(
+                bvh,
+                geometric_normals,
+                shading_normals,
+                tex_coords,
+                materials,
+                colors,
+                textures,
+                lights,
+                bounces,
+                epsilon,
+                bgcolor,
+                ambient,
+                rt,
+                sched_,
+                cam,
+                frame_num,
+                algo,
+                ssaa_samples,
+                ao,
+                env_light
+                );
+    }
+
+#if VSNRAY_COMMON_HAVE_PTEX
+    void render_instances_ptex(
+            index_bvh<index_bvh<basic_triangle<3, float>>::bvh_inst>& bvh,
+            aligned_vector<vec3> const&                               geometric_normals,
+            aligned_vector<vec3> const&                               shading_normals,
+            aligned_vector<ptex::face_id_t> const&                    face_ids,
+            aligned_vector<generic_material_t> const&                 materials,
+            aligned_vector<vec3> const&                               colors,
+            aligned_vector<ptex::texture> const&                      textures,
+            aligned_vector<generic_light_t> const&                    lights,
+            unsigned                                                  bounces,
+            float                                                     epsilon,
+            vec4                                                      bgcolor,
+            vec4                                                      ambient,
+            host_device_rt&                                           rt,
+            camera_t const&                                           cam,
+            unsigned&                                                 frame_num,
+            algorithm                                                 algo,
+            unsigned                                                  ssaa_samples,
+            ao_settings const&                                        ao,
+            host_environment_light const&                             env_light
+            )
+    {
+        render_instances_ptex_cpp(
+                bvh,
+                geometric_normals,
+                shading_normals,
+                face_ids,
+                materials,
+                colors,
+                textures,
+                lights,
+                bounces,
+                epsilon,
+                bgcolor,
+                ambient,
+                rt,
+                sched_,
+                cam,
+                frame_num,
+                algo,
+                ssaa_samples,
+                ao,
+                env_light
+                );
+    }
+#endif
+
+private:
+
+    multi_width_sched sched_;
+
+};
+
+#ifndef VSNRAY_VIEWER_CPU_RENDERER_MODULE
+cpu_renderer* create_baseline_cpu_renderer(unsigned num_threads)
+{
+    return new cpu_renderer_impl(num_threads);
+}
+#endif
+
+} // visionaray
+
+
+#ifdef VSNRAY_VIEWER_CPU_RENDERER_MODULE
+
+//-------------------------------------------------------------------------------------------------
+// Module entry points, looked up by make_cpu_renderer() with dlsym()
+//
+
+extern "C" __attribute__((visibility("default")))
+int vsnray_viewer_cpu_renderer_abi_version()
+{
+    return visionaray::cpu_renderer::ABIVersion;
+}
+
+extern "C" __attribute__((visibility("default")))
+visionaray::cpu_renderer* vsnray_viewer_create_cpu_renderer(unsigned num_threads)
+{
+    return new visionaray::cpu_renderer_impl(num_threads);
+}
+
+#endif // VSNRAY_VIEWER_CPU_RENDERER_MODULE
@@ -0,0 +1,218 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_VIEWER_HOST_SCHED_H
+#define VSNRAY_VIEWER_HOST_SCHED_H 1
+
+#include <cassert>
+#include <memory>
+
+#include <common/cpu_features.h>
+
+#include <visionaray/math/simd/simd.h>
+#include <visionaray/math/ray.h>
+#include <visionaray/scheduler.h>
+
+#if defined(__INTEL_COMPILER) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <visionaray/detail/tbb_sched.h>
+#endif
+
+namespace visionaray
+{
+
+#if defined(__INTEL_COMPILER) || defined(__MINGW32__) || defined(__MINGW64__)
+template <typename R>
+using host_sched_t = tbb_sched<R>;
+#else
+template <typename R>
+using host_sched_t = tiled_sched<R>;
+#endif
+
+
+//-------------------------------------------------------------------------------------------------
+// SIMD width (number of rays per packet) used for CPU rendering
+//
+
+enum simd_width
+{
+    SimdWidthAuto = 0,
+    SimdWidth4    = 4,
+    SimdWidth8    = 8,
+    SimdWidth16   = 16
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Returns true if packets of the given width map to native vector
+// registers in this build *and* the host CPU supports the instructions
+//
+
+inline bool simd_width_native(simd_width width)
+{
+    cpu_features const& cpu = get_cpu_features();
+
+    bool native8 = false;
+    bool native16 = false;
+
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX)
+    native8 = cpu.avx;
+#elif VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_NEON_FP)
+    native8 = true; // float8 is backed by two NEON registers
+#endif
+
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX512F)
+    native16 = cpu.avx512f;
+#endif
+
+    (void)cpu;
+
+    switch (width)
+    {
+    case SimdWidth4:
+        return true;
+
+    case SimdWidth8:
+        return native8;
+
+    case SimdWidth16:
+        return native16;
+
+    default:
+        return false;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Widest native SIMD width
+//
+
+inline simd_width max_native_simd_width()
+{
+    if (simd_width_native(SimdWidth16))
+    {
+        return SimdWidth16;
+    }
+    else if (simd_width_native(SimdWidth8))
+    {
+        return SimdWidth8;
+    }
+    else
+    {
+        return SimdWidth4;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Host scheduler with runtime-selectable SIMD width
+//
+// Holds one host_sched_t per packet type, the scheduler (and thus the
+// thread pool) for the active width is created lazily, the others are
+// destroyed when the width changes. Packet and tile dimensions follow
+// from the packet type (see packet_size<>).
+//
+// Use visit() to call a function with the active scheduler:
+//
+//   sched.visit([&](auto& s) { s.frame(kernel, sparams); });
+//
+
+class multi_width_sched
+{
+public:
+
+    using sched4_type  = host_sched_t<basic_ray<simd::float4>>;
+    using sched8_type  = host_sched_t<basic_ray<simd::float8>>;
+    using sched16_type = host_sched_t<basic_ray<simd::float16>>;
+
+public:
+
+    explicit multi_width_sched(unsigned num_threads, simd_width width = SimdWidthAuto)
+        : num_threads_(num_threads)
+    {
+        set_width(width);
+    }
+
+    // Select the SIMD width, SimdWidthAuto picks max_native_simd_width()
+    void set_width(simd_width width)
+    {
+        if (width == SimdWidthAuto)
+        {
+            width = max_native_simd_width();
+        }
+
+        if (width == width_)
+        {
+            return;
+        }
+
+        width_ = width;
+
+        // Only keep one thread pool around
+        sched4_.reset();
+        sched8_.reset();
+        sched16_.reset();
+    }
+
+    simd_width width() const
+    {
+        return width_;
+    }
+
+    void reset(unsigned num_threads)
+    {
+        num_threads_ = num_threads;
+
+        if (sched4_)  sched4_->reset(num_threads);
+        if (sched8_)  sched8_->reset(num_threads);
+        if (sched16_) sched16_->reset(num_threads);
+    }
+
+    template <typename Func>
+    void visit(Func func)
+    {
+        switch (width_)
+        {
+        case SimdWidth16:
+            func(get(sched16_));
+            break;
+
+        case SimdWidth8:
+            func(get(sched8_));
+            break;
+
+        case SimdWidth4:
+        default:
+            func(get(sched4_));
+            break;
+        }
+    }
+
+private:
+
+    template <typename Sched>
+    Sched& get(std::unique_ptr<Sched>& sched)
+    {
+        if (sched == nullptr)
+        {
+            sched.reset(new Sched(num_threads_));
+        }
+
+        return *sched;
+    }
+
+    unsigned num_threads_;
+
+    simd_width width_ = SimdWidthAuto;
+
+    std::unique_ptr<sched4_type>  sched4_;
+    std::unique_ptr<sched8_type>  sched8_;
+    std::unique_ptr<sched16_type> sched16_;
+
+};
+
+} // visionaray
+
+#endif // VSNRAY_VIEWER_HOST_SCHED_H
@@ -32,16 +32,13 @@
 #include <visionaray/thin_lens_camera.h>
 #include <visionaray/variant.h>
 
-#if defined(__INTEL_COMPILER) || defined(__MINGW32__) || defined(__MINGW64__)
-#include <visionaray/detail/tbb_sched.h>
-#endif
-
 #if VSNRAY_COMMON_HAVE_PTEX
 #include <common/ptex.h>
 #endif
 
 #include "call_kernel.h" // algorithm
 #include "host_device_rt.h"
+#include "host_sched.h"
 
 namespace visionaray
 {
@@ -54,12 +51,8 @@ namespace visionaray
 // Helper types
 //
 
-//using scalar_type_cpu           = float;
-using scalar_type_cpu           = simd::float4;
-//using scalar_type_cpu           = simd::float8;
-//using scalar_type_cpu           = simd::float16;
+// CPU packet type (float4, float8 or float16) is selected at runtime, see host_sched.h
 using scalar_type_gpu           = float;
-using ray_type_cpu              = basic_ray<scalar_type_cpu>;
 using ray_type_gpu              = basic_ray<scalar_type_gpu>;
 
 using camera_t = thin_lens_camera;
@@ -85,15 +78,6 @@ using cuda_texture_t = cuda_texture_ref<vector<4, unorm<8>>, 2>;
 using device_environment_light = environment_light<float, cuda_texture_ref<vec4, 2>>;
 #endif
 
-#if defined(__INTEL_COMPILER) || defined(__MINGW32__) || defined(__MINGW64__)
-template <typename R>
-using host_sched_t = tbb_sched<R>;
-#else
-template <typename R>
-using host_sched_t = tiled_sched<R>;
-#endif
-
-
 //-------------------------------------------------------------------------------------------------
 // Render from lists, only material is plastic
 //
@@ -111,11 +95,12 @@ void render_plastic_cpp(
         vec4                                       bgcolor,
         vec4                                       ambient,
         host_device_rt&                            rt,
-        host_sched_t<ray_type_cpu>&                sched,
+        multi_width_sched&                         sched,
         camera_t const&                            cam,
         unsigned&                                  frame_num,
         algorithm                                  algo,
-        unsigned                                   ssaa_samples
+        unsigned                                   ssaa_samples,
+        ao_settings const&                         ao
         );
 
 #ifdef __CUDACC__
@@ -136,7 +121,8 @@ void render_plastic_cu(
         camera_t const&                                   cam,
         unsigned&                                         frame_num,
         algorithm                                         algo,
-        unsigned                                          ssaa_samples
+        unsigned                                          ssaa_samples,
+        ao_settings const&                                ao
         );
 #endif
 
@@ -158,11 +144,12 @@ void render_generic_material_cpp(
         vec4                                                               bgcolor,
         vec4                                                               ambient,
         host_device_rt&                                                    rt,
-        host_sched_t<ray_type_cpu>&                                        sched,
+        multi_width_sched&                                                 sched,
         camera_t const&                                                    cam,
         unsigned&                                                          frame_num,
         algorithm                                                          algo,
-        unsigned                                                           ssaa_samples
+        unsigned                                                           ssaa_samples,
+        ao_settings const&                                                 ao
         );
 
 #ifdef __CUDACC__
@@ -183,7 +170,8 @@ void render_generic_material_cu(
         camera_t const&                                                    cam,
         unsigned&                                                          frame_num,
         algorithm                                                          algo,
-        unsigned                                                           ssaa_samples
+        unsigned                                                           ssaa_samples,
+        ao_settings const&                                                 ao
         );
 #endif
 
@@ -206,11 +194,12 @@ void render_instances_cpp(
         vec4                                                      bgcolor,
         vec4                                                      ambient,
         host_device_rt&                                           rt,
-        host_sched_t<ray_type_cpu>&                               sched,
+        multi_width_sched&                                        sched,
         camera_t const&                                           cam,
         unsigned&                                                 frame_num,
         algorithm                                                 algo,
         unsigned                                                  ssaa_samples,
+        ao_settings const&                                        ao,
         host_environment_light const&                             env_light
         );
 
@@ -234,6 +223,7 @@ void render_instances_cu(
         unsigned&                                                           frame_num,
         algorithm                                                           algo,
         unsigned                                                            ssaa_samples,
+        ao_settings const&                                                  ao,
         device_environment_light const&                                     env_light
         );
 #endif
@@ -254,11 +244,12 @@ void render_instances_ptex_cpp(
         vec4                                                      bgcolor,
         vec4                                                      ambient,
         host_device_rt&                                           rt,
-        host_sched_t<ray_type_cpu>&                               sched,
+        multi_width_sched&                                        sched,
         camera_t const&                                           cam,
         unsigned&                                                 frame_num,
         algorithm                                                 algo,
         unsigned                                                  ssaa_samples,
+        ao_settings const&                                        ao,
         host_environment_light const&                             env_light
         );
 #endif
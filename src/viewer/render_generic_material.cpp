@@ -1,6 +1,8 @@
 // This file is distributed under the MIT license.
 // See the LICENSE file for details.
 
+#include <visionaray/light_bvh.h>
+
 #include "render.h"
 
 namespace visionaray
@@ -19,11 +21,12 @@ void render_generic_material_cpp(
         vec4                                                               bgcolor,
         vec4                                                               ambient,
         host_device_rt&                                                    rt,
-        host_sched_t<ray_type_cpu>&                                        sched,
+        multi_width_sched&                                                 sched,
         camera_t const&                                                    cam,
         unsigned&                                                          frame_num,
         algorithm                                                          algo,
-        unsigned                                                           ssaa_samples
+        unsigned                                                           ssaa_samples,
+        ao_settings const&                                                 ao
         )
 {
     using bvh_ref = index_bvh<basic_triangle<3, float>>::bvh_ref;
@@ -32,6 +35,14 @@ void render_generic_material_cpp(
 
     primitives.push_back(bvh.ref());
 
+    // Importance sample lights with a light BVH, only used by the path tracer
+    light_bvh lbvh;
+
+    if (algo == Pathtracing)
+    {
+        lbvh.build(lights.begin(), lights.end());
+    }
+
     auto kparams = make_kernel_params(
             normals_per_vertex_binding{},
             primitives.data(),
@@ -49,7 +60,16 @@ void render_generic_material_cpp(
             ambient
             );
 
-    call_kernel( algo, sched, kparams, frame_num, ssaa_samples, cam, rt );
+    call_kernel(
+            algo,
+            sched,
+            with_light_selector(kparams, lbvh.ref()),
+            frame_num,
+            ssaa_samples,
+            ao,
+            cam,
+            rt
+            );
 }
 
 } // visionaray
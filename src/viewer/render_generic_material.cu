@@ -25,7 +25,8 @@ void render_generic_material_cu(
         camera_t const&                                                    cam,
         unsigned&                                                          frame_num,
         algorithm                                                          algo,
-        unsigned                                                           ssaa_samples
+        unsigned                                                           ssaa_samples,
+        ao_settings const&                                                 ao
         )
 {
     // For some reason, this function causes nvcc on OSX to run into an inf loop..
@@ -55,7 +56,7 @@ void render_generic_material_cu(
             ambient
             );
 
-    call_kernel( algo, sched, kparams, frame_num, ssaa_samples, cam, rt );
+    call_kernel( algo, sched, kparams, frame_num, ssaa_samples, ao, cam, rt );
 #endif
 }
 
@@ -27,6 +27,7 @@ void render_instances_cu(
         unsigned&                                                           frame_num,
         algorithm                                                           algo,
         unsigned                                                            ssaa_samples,
+        ao_settings const&                                                  ao,
         device_environment_light const&                                     env_light
         )
 {
@@ -59,7 +60,7 @@ void render_instances_cu(
                 epsilon
                 );
 
-        call_kernel( algo, sched, kparams, frame_num, ssaa_samples, cam, rt );
+        call_kernel( algo, sched, kparams, frame_num, ssaa_samples, ao, cam, rt );
     }
     else
     {
@@ -82,7 +83,7 @@ void render_instances_cu(
                 ambient
                 );
 
-        call_kernel( algo, sched, kparams, frame_num, ssaa_samples, cam, rt );
+        call_kernel( algo, sched, kparams, frame_num, ssaa_samples, ao, cam, rt );
     }
 }
 
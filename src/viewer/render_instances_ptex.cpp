@@ -7,6 +7,8 @@
 
 #include <common/ptex.h>
 
+#include <visionaray/light_bvh.h>
+
 #include "render.h"
 
 namespace visionaray
@@ -26,11 +28,12 @@ void render_instances_ptex_cpp(
         vec4                                                      bgcolor,
         vec4                                                      ambient,
         host_device_rt&                                           rt,
-        host_sched_t<ray_type_cpu>&                               sched,
+        multi_width_sched&                                        sched,
         camera_t const&                                           cam,
         unsigned&                                                 frame_num,
         algorithm                                                 algo,
         unsigned                                                  ssaa_samples,
+        ao_settings const&                                        ao,
         host_environment_light const&                             env_light
         )
 {
@@ -40,6 +43,14 @@ void render_instances_ptex_cpp(
 
     primitives.push_back(bvh.ref());
 
+    // Importance sample lights with a light BVH, only used by the path tracer
+    light_bvh lbvh;
+
+    if (algo == Pathtracing)
+    {
+        lbvh.build(lights.begin(), lights.end());
+    }
+
     if (env_light.texture())
     {
         auto kparams = make_kernel_params(
@@ -61,7 +72,16 @@ void render_instances_ptex_cpp(
                 epsilon
                 );
 
-        call_kernel( algo, sched, kparams, frame_num, ssaa_samples, cam, rt );
+        call_kernel(
+                algo,
+                sched,
+                with_light_selector(kparams, lbvh.ref()),
+                frame_num,
+                ssaa_samples,
+                ao,
+                cam,
+                rt
+                );
     }
     else
     {
@@ -84,7 +104,16 @@ void render_instances_ptex_cpp(
                 ambient
                 );
 
-        call_kernel( algo, sched, kparams, frame_num, ssaa_samples, cam, rt );
+        call_kernel(
+                algo,
+                sched,
+                with_light_selector(kparams, lbvh.ref()),
+                frame_num,
+                ssaa_samples,
+                ao,
+                cam,
+                rt
+                );
     }
 }
 
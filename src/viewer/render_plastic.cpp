@@ -21,11 +21,12 @@ void render_plastic_cpp(
         vec4                                       bgcolor,
         vec4                                       ambient,
         host_device_rt&                            rt,
-        host_sched_t<ray_type_cpu>&                sched,
+        multi_width_sched&                         sched,
         camera_t const&                            cam,
         unsigned&                                  frame_num,
         algorithm                                  algo,
-        unsigned                                   ssaa_samples
+        unsigned                                   ssaa_samples,
+        ao_settings const&                         ao
         )
 {
     using bvh_ref = index_bvh<basic_triangle<3, float>>::bvh_ref;
@@ -51,7 +52,7 @@ void render_plastic_cpp(
             ambient
             );
 
-    call_kernel( algo, sched, kparams, frame_num, ssaa_samples, cam, rt );
+    call_kernel( algo, sched, kparams, frame_num, ssaa_samples, ao, cam, rt );
 }
 
 } // visionaray
@@ -25,7 +25,8 @@ void render_plastic_cu(
         camera_t const&                                   cam,
         unsigned&                                         frame_num,
         algorithm                                         algo,
-        unsigned                                          ssaa_samples
+        unsigned                                          ssaa_samples,
+        ao_settings const&                                ao
         )
 {
     using bvh_ref = cuda_index_bvh<basic_triangle<3, float>>::bvh_ref;
@@ -53,7 +54,7 @@ void render_plastic_cu(
             ambient
             );
 
-    call_kernel( algo, sched, kparams, frame_num, ssaa_samples, cam, rt );
+    call_kernel( algo, sched, kparams, frame_num, ssaa_samples, ao, cam, rt );
 }
 
 } // visionaray
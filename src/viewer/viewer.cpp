@@ -10,6 +10,7 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <exception>
 #include <fstream>
 #include <future>
@@ -17,6 +18,7 @@
 #include <iostream>
 #include <istream>
 #include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -78,6 +80,7 @@
 #endif
 
 #include "call_kernel.h"
+#include "cpu_renderer.h"
 #include "host_device_rt.h"
 #include "render.h"
 
@@ -240,7 +243,6 @@ struct renderer : viewer_type
 
     renderer()
         : viewer_type(800, 800, "Visionaray Viewer")
-        , host_sched(std::thread::hardware_concurrency())
         , rt(
             host_device_rt::CPU,
             true /* double buffering */,
@@ -299,7 +301,8 @@ struct renderer : viewer_type
                 { "simple",             Simple,         "Simple ray casting kernel" },
                 { "whitted",            Whitted,        "Whitted style ray tracing kernel" },
                 { "pathtracing",        Pathtracing,    "Pathtracing global illumination kernel" },
-                { "costs",              Costs,          "BVH cost kernel" }
+                { "costs",              Costs,          "BVH cost kernel" },
+                { "ao",                 AmbientOcclusion, "Ambient occlusion kernel" }
             },
             "algorithm",
             cl::Desc("Rendering algorithm"),
@@ -318,6 +321,39 @@ struct renderer : viewer_type
             cl::init(this->build_strategy)
             ) );
 
+        add_cmdline_option( cl::makeOption<simd_width&>({
+                { "auto",               SimdWidthAuto,  "Widest packets supported by the CPU" },
+                { "4",                  SimdWidth4,     "4-wide packets (SSE/NEON)" },
+                { "8",                  SimdWidth8,     "8-wide packets (AVX)" },
+                { "16",                 SimdWidth16,    "16-wide packets (AVX-512)" }
+            },
+            "simd",
+            cl::Desc("SIMD width for CPU rendering"),
+            cl::ArgRequired,
+            cl::init(this->simd)
+            ) );
+
+        add_cmdline_option( cl::makeOption<cpu_isa&>({
+                { "auto",               IsaAuto,        "Widest instruction set supported by the CPU" },
+                { "baseline",           IsaBaseline,    "Instruction set the viewer was compiled for" },
+                { "sse4_2",             IsaSSE4_2,      "SSE 4.2" },
+                { "avx2",               IsaAVX2,        "AVX2 + FMA" },
+                { "avx512",             IsaAVX512,      "AVX-512 (F, DQ, BW, VL)" }
+            },
+            "isa",
+            cl::Desc("Instruction set for CPU rendering"),
+            cl::ArgRequired,
+            cl::init(this->isa)
+            ) );
+
+        add_cmdline_option( cl::makeOption<bool&>(
+            cl::Parser<>(),
+            "isacheck",
+            cl::Desc("Compare and benchmark all available instruction sets on the first frame"),
+            cl::ArgDisallowed,
+            cl::init(this->isa_check)
+            ) );
+
         // The following two options both manipulate spp
         add_cmdline_option( cl::makeOption<unsigned&>({
                 { "1",      1,      "1x supersampling" },
@@ -371,6 +407,22 @@ struct renderer : viewer_type
             cl::init(this->bounces)
             ) );
 
+        add_cmdline_option( cl::makeOption<unsigned&>(
+            cl::Parser<>(),
+            "aosamples",
+            cl::Desc("Number of occlusion rays per pixel sample for ambient occlusion"),
+            cl::ArgRequired,
+            cl::init(this->ao_samples)
+            ) );
+
+        add_cmdline_option( cl::makeOption<float&>(
+            cl::Parser<>(),
+            "aoradius",
+            cl::Desc("Ambient occlusion radius (default: 1/10 of the scene diagonal)"),
+            cl::ArgRequired,
+            cl::init(this->ao_radius)
+            ) );
+
         add_cmdline_option( cl::makeOption<unsigned&>(
             cl::Parser<>(),
             "frames",
@@ -450,6 +502,60 @@ struct renderer : viewer_type
                     {
                         this->algo = Costs;
                     }
+                    else if (algo == "ao")
+                    {
+                        this->algo = AmbientOcclusion;
+                    }
+                }
+
+                // SIMD width
+                std::string simd = "";
+                err = ini.get_string("simd", simd);
+                if (err == inifile::Ok)
+                {
+                    if (simd == "auto")
+                    {
+                        this->simd = SimdWidthAuto;
+                    }
+                    else if (simd == "4")
+                    {
+                        this->simd = SimdWidth4;
+                    }
+                    else if (simd == "8")
+                    {
+                        this->simd = SimdWidth8;
+                    }
+                    else if (simd == "16")
+                    {
+                        this->simd = SimdWidth16;
+                    }
+                }
+
+                // Instruction set
+                std::string isa = "";
+                err = ini.get_string("isa", isa);
+                if (err == inifile::Ok)
+                {
+                    if (isa == "auto")
+                    {
+                        this->isa = IsaAuto;
+                    }
+                    else if (isa == "baseline")
+                    {
+                        this->isa = IsaBaseline;
+                    }
+                    else if (isa == "sse4_2")
+                    {
+                        this->isa = IsaSSE4_2;
+                    }
+                    else if (isa == "avx2")
+                    {
+                        this->isa = IsaAVX2;
+                    }
+                    else if (isa == "avx512")
+                    {
+                        this->isa = IsaAVX512;
+                    }
                 }
 
                 // ambient
@@ -484,6 +590,21 @@ struct renderer : viewer_type
                     this->bounces = bounces;
                 }
 
+                // ambient occlusion
+                uint32_t ao_samples = this->ao_samples;
+                err = ini.get_uint32("aosamples", ao_samples);
+                if (err == inifile::Ok)
+                {
+                    this->ao_samples = ao_samples;
+                }
+
+                float ao_radius = this->ao_radius;
+                err = ini.get_float("aoradius", ao_radius);
+                if (err == inifile::Ok)
+                {
+                    this->ao_radius = ao_radius;
+                }
+
                 // bvh
                 std::string bvh = "";
                 err = ini.get_string("bvh", bvh);
@@ -626,8 +747,13 @@ struct renderer : viewer_type
     int                                         h               = 800;
     unsigned                                    frame_num       = 0;
     unsigned                                    bounces         = 0;
+    unsigned                                    ao_samples      = 8;
+    float                                       ao_radius       = 0.0f;
     unsigned                                    spp             = 1;
     algorithm                                   algo            = Simple;
+    simd_width                                  simd            = SimdWidthAuto;
+    cpu_isa                                     isa             = IsaAuto;
+    bool                                        isa_check       = false;
     bvh_build_strategy                          build_strategy  = Binned;
     bool                                        use_headlight   = true;
     bool                                        use_groundplane = false;
@@ -670,7 +796,7 @@ struct renderer : viewer_type
     thrust::device_vector<device_tex_ref_type>  device_textures;
 #endif
 
-    host_sched_t<ray_type_cpu>                  host_sched;
+    std::unique_ptr<cpu_renderer>               host_renderer;
     host_device_rt                              rt;
 #if VSNRAY_COMMON_HAVE_CUDA
     cuda_sched<ray_type_gpu>                    device_sched;
@@ -680,6 +806,7 @@ struct renderer : viewer_type
     std::string                                 env_map_filename;
     visionaray::texture<vec4, 2>                env_map;
     host_environment_light                      env_light;
+    environment_map_distribution                env_map_distribution;
 #if VSNRAY_COMMON_HAVE_CUDA
     visionaray::cuda_texture<vec4, 2>           device_env_map;
     device_environment_light                    device_env_light;
@@ -731,6 +858,7 @@ private:
     void screenshot();
     void render_hud();
     void render_impl();
+    void run_isa_check();
 
 };
 
@@ -1658,6 +1786,13 @@ void renderer::build_scene()
 #endif
     }
 
+    // Importance sample the environment map
+    if (env_map)
+    {
+        env_map_distribution.build(env_map);
+        env_light.set_distribution(env_map_distribution.ref());
+    }
+
 //  std::cout << t.elapsed() << std::endl;
 }
 
@@ -1728,7 +1863,7 @@ void renderer::clear_frame()
 
     frame_num = 0;
 
-    if (algo == Pathtracing)
+    if (is_progressive(algo))
     {
         rt.clear();
     }
@@ -1907,11 +2042,12 @@ void renderer::render_hud()
     ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
     ImGui::Begin("Settings", &show_hud);
 
-    std::array<char const*, 4> algo_names = {{
+    std::array<char const*, 5> algo_names = {{
             "Simple",
             "Whitted",
             "Path Tracing",
-            "Costs"
+            "Costs",
+            "Ambient Occlusion"
             }};
 
     std::array<char const*, 4> ssaa_modes = {{
@@ -1952,7 +2088,7 @@ void renderer::render_hud()
             ImGui::SameLine();
             ImGui::Spacing();
             ImGui::SameLine();
-            if (algo == Pathtracing)
+            if (is_progressive(algo))
             {
                 ImGui::Text("Frames: %7u", std::max(1U, frame_num));
             }
@@ -1962,6 +2098,15 @@ void renderer::render_hud()
             }
 
             ImGui::Text("Device: %s", rt.mode() == host_device_rt::GPU ? "GPU" : "CPU");
+            if (rt.mode() == host_device_rt::CPU)
+            {
+                ImGui::SameLine();
+                ImGui::Text(
+                        "(%s, %d-wide)",
+                        host_renderer->isa_name(),
+                        static_cast<int>(host_renderer->get_simd_width())
+                        );
+            }
             ImGui::EndTabItem();
         }
 
@@ -2029,7 +2174,7 @@ void renderer::render_hud()
                         if (ssaa_modes[i] == ssaa_modes[0])
                         {
                             spp = 1;
-                            if (algo != Pathtracing)
+                            if (!is_progressive(algo))
                             {
                                 counter.reset();
                                 clear_frame();
@@ -2038,7 +2183,7 @@ void renderer::render_hud()
                         else if (ssaa_modes[i] == ssaa_modes[1])
                         {
                             spp = 2;
-                            if (algo != Pathtracing)
+                            if (!is_progressive(algo))
                             {
                                 counter.reset();
                                 clear_frame();
@@ -2047,7 +2192,7 @@ void renderer::render_hud()
                         else if (ssaa_modes[i] == ssaa_modes[2])
                         {
                             spp = 4;
-                            if (algo != Pathtracing)
+                            if (!is_progressive(algo))
                             {
                                 counter.reset();
                                 clear_frame();
@@ -2057,7 +2202,7 @@ void renderer::render_hud()
                         {
 
                             spp = 8;
-                            if (algo != Pathtracing)
+                            if (!is_progressive(algo))
                             {
                                 counter.reset();
                                 clear_frame();
@@ -2123,6 +2268,17 @@ void renderer::render_hud()
                             counter.reset();
                             clear_frame();
                         }
+                        else if (i == 4)
+                        {
+                            if (render_future.valid())
+                            {
+                                render_future.wait();
+                            }
+                            rt.set_double_buffering(false);
+                            algo = AmbientOcclusion;
+                            counter.reset();
+                            clear_frame();
+                        }
                     }
 
                     if (selected)
@@ -2133,6 +2289,25 @@ void renderer::render_hud()
 
                 ImGui::EndCombo();
             }
+
+            if (algo == AmbientOcclusion)
+            {
+                int ao_samples = this->ao_samples;
+                ImGui::PushItemWidth(80);
+                if (ImGui::InputInt("AO samples", &ao_samples) && ao_samples > 0)
+                {
+                    this->ao_samples = static_cast<unsigned>(ao_samples);
+                    counter.reset();
+                    clear_frame();
+                }
+                ImGui::SameLine();
+                if (ImGui::InputFloat("AO radius (0: auto)", &ao_radius))
+                {
+                    counter.reset();
+                    clear_frame();
+                }
+                ImGui::PopItemWidth();
+            }
             ImGui::EndTabItem();
         }
 
@@ -2338,6 +2513,10 @@ void renderer::render_impl()
                             : vec4(0.0)
                             ;
 
+    ao_settings ao;
+    ao.samples = ao_samples;
+    ao.radius  = ao_radius > 0.0f ? ao_radius : length(diagonal) * 0.1f;
+
     camera_t camx = cam;
     if (!use_dof || algo != Pathtracing)
     {
@@ -2365,7 +2544,7 @@ void renderer::render_impl()
             }
             if (tex_format == renderer::UV)
             {
-                render_instances_cpp(
+                host_renderer->render_instances(
                         host_top_level_bvh,
                         mod.geometric_normals,
                         mod.shading_normals,
@@ -2379,18 +2558,18 @@ void renderer::render_impl()
                         vec4(background_color(), 1.0f),
                         amb,
                         rt,
-                        host_sched,
                         camx,
                         frame_num,
                         algo,
                         spp,
+                        ao,
                         env_light
                         );
             }
 #if VSNRAY_COMMON_HAVE_PTEX
             else if (tex_format == renderer::Ptex)
             {
-                render_instances_ptex_cpp(
+                host_renderer->render_instances_ptex(
                         host_top_level_bvh,
                         mod.geometric_normals,
                         mod.shading_normals,
@@ -2404,11 +2583,11 @@ void renderer::render_impl()
                         vec4(background_color(), 1.0f),
                         amb,
                         rt,
-                        host_sched,
                         camx,
                         frame_num,
                         algo,
                         spp,
+                        ao,
                         env_light
                         );
             }
@@ -2416,7 +2595,7 @@ void renderer::render_impl()
         }
         else if (area_lights.size() > 0 && algo == Pathtracing)
         {
-            render_generic_material_cpp(
+            host_renderer->render_generic_material(
                     host_bvhs[0],
                     mod.geometric_normals,
                     mod.shading_normals,
@@ -2429,16 +2608,16 @@ void renderer::render_impl()
                     vec4(background_color(), 1.0f),
                     amb,
                     rt,
-                    host_sched,
                     camx,
                     frame_num,
                     algo,
-                    spp
+                    spp,
+                    ao
                     );
         }
         else
         {
-            render_plastic_cpp(
+            host_renderer->render_plastic(
                     host_bvhs[0],
                     mod.geometric_normals,
                     mod.shading_normals,
@@ -2451,11 +2630,11 @@ void renderer::render_impl()
                     vec4(background_color(), 1.0f),
                     amb,
                     rt,
-                    host_sched,
                     camx,
                     frame_num,
                     algo,
-                    spp
+                    spp,
+                    ao
                     );
         }
     }
@@ -2502,6 +2681,7 @@ void renderer::render_impl()
                         frame_num,
                         algo,
                         spp,
+                        ao,
                         device_env_light
                         );
             }
@@ -2525,7 +2705,8 @@ void renderer::render_impl()
                     camx,
                     frame_num,
                     algo,
-                    spp
+                    spp,
+                    ao
                     );
         }
         else
@@ -2547,7 +2728,8 @@ void renderer::render_impl()
                     camx,
                     frame_num,
                     algo,
-                    spp
+                    spp,
+                    ao
                     );
         }
     }
@@ -2586,6 +2768,146 @@ void renderer::render_impl()
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+// Self-check: render with every available instruction set, compare the
+// images against the baseline and measure the frame time
+//
+// Correctness is checked with the (deterministic) ray casting kernel,
+// timings are taken with the algorithm chosen by the user. With -isa=auto
+// the fastest instruction set that passes the check is used afterwards.
+//
+
+void renderer::run_isa_check()
+{
+    if (render_future.valid())
+    {
+        render_future.wait();
+    }
+
+    if (rt.mode() != host_device_rt::CPU)
+    {
+        return;
+    }
+
+    static const int NumFrames = 10;
+
+    // Max. per-channel difference to the baseline image (8-bit)
+    static const int Tolerance = 2;
+
+    using color_type = host_device_rt::color_type;
+
+    size_t num_pixels = static_cast<size_t>(rt.width()) * rt.height();
+
+    algorithm prev_algo = algo;
+    bool prev_paused = paused;
+    paused = false;
+
+    std::unique_ptr<cpu_renderer> prev_renderer = std::move(host_renderer);
+
+    std::vector<color_type> reference;
+    cpu_isa fastest = IsaBaseline;
+    double fastest_time = std::numeric_limits<double>::max();
+
+    std::cout << "ISA self-check (" << rt.width() << "x" << rt.height() << ", "
+              << NumFrames << " frames)\n";
+    std::cout << std::left
+              << std::setw(10) << "ISA"
+              << std::setw(10) << "compiled"
+              << std::setw(8)  << "width"
+              << std::setw(10) << "max diff"
+              << std::setw(12) << "mean diff"
+              << std::setw(12) << "ms/frame"
+              << "result\n";
+
+    for (cpu_isa i : { IsaBaseline, IsaSSE4_2, IsaAVX2, IsaAVX512 })
+    {
+        host_renderer = make_cpu_renderer(i, std::thread::hardware_concurrency());
+
+        if (host_renderer == nullptr)
+        {
+            std::cout << std::setw(10) << cpu_isa_name(i)
+                      << (cpu_isa_supported(i) ? "module not found" : "not supported by CPU") << '\n';
+            continue;
+        }
+
+        host_renderer->set_simd_width(simd);
+
+        // Correctness
+        algo = Simple;
+        frame_num = 0;
+        rt.clear();
+        render_impl();
+
+        color_type const* color = rt.color();
+        std::vector<color_type> image(color, color + num_pixels);
+
+        if (reference.empty())
+        {
+            reference = image;
+        }
+
+        int max_diff = 0;
+        double sum_diff = 0.0;
+
+        for (size_t p = 0; p < num_pixels; ++p)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                int a = static_cast<int>(static_cast<float>(image[p][c]) * 255.0f + 0.5f);
+                int b = static_cast<int>(static_cast<float>(reference[p][c]) * 255.0f + 0.5f);
+                int d = std::abs(a - b);
+                max_diff = std::max(max_diff, d);
+                sum_diff += d;
+            }
+        }
+
+        double mean_diff = num_pixels > 0 ? sum_diff / (num_pixels * 4) : 0.0;
+        bool passed = max_diff <= Tolerance;
+
+        // Performance
+        algo = prev_algo;
+        frame_num = 0;
+        rt.clear();
+
+        timer t;
+        for (int f = 0; f < NumFrames; ++f)
+        {
+            render_impl();
+        }
+        double ms = t.elapsed() * 1000.0 / NumFrames;
+
+        std::cout << std::setw(10) << cpu_isa_name(i)
+                  << std::setw(10) << host_renderer->isa_name()
+                  << std::setw(8)  << static_cast<int>(host_renderer->get_simd_width())
+                  << std::setw(10) << max_diff
+                  << std::setw(12) << std::fixed << std::setprecision(4) << mean_diff
+                  << std::setw(12) << std::setprecision(2) << ms
+                  << (passed ? "ok" : "MISMATCH") << '\n';
+
+        if (passed && ms < fastest_time)
+        {
+            fastest = i;
+            fastest_time = ms;
+        }
+    }
+
+    algo = prev_algo;
+    paused = prev_paused;
+
+    if (isa == IsaAuto)
+    {
+        std::cout << "Using fastest instruction set: " << cpu_isa_name(fastest) << '\n';
+        host_renderer = make_cpu_renderer(fastest, std::thread::hardware_concurrency());
+        host_renderer->set_simd_width(simd);
+    }
+    else
+    {
+        host_renderer = std::move(prev_renderer);
+    }
+
+    clear_frame();
+}
+
 void renderer::on_close()
 {
     outlines.destroy();
@@ -2593,6 +2915,12 @@ void renderer::on_close()
 
 void renderer::on_display()
 {
+    if (isa_check)
+    {
+        isa_check = false;
+        run_isa_check();
+    }
+
     if (render_async)
     {
         if (!render_future.valid() || render_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
@@ -2698,6 +3026,18 @@ void renderer::on_key_press(key_event const& event)
         clear_frame();
         break;
 
+    case '5':
+        std::cout << "Switching algorithm: ambient occlusion\n";
+        if (render_future.valid())
+        {
+            render_future.wait();
+        }
+        rt.set_double_buffering(false);
+        algo = AmbientOcclusion;
+        counter.reset();
+        clear_frame();
+        break;
+
     case 'b':
         show_bvh = !show_bvh;
 
@@ -2782,7 +3122,7 @@ void renderer::on_key_press(key_event const& event)
             spp = 1;
         }
 
-        if (algo != Pathtracing)
+        if (!is_progressive(algo))
         {
             counter.reset();
             clear_frame();
@@ -2869,7 +3209,7 @@ void renderer::on_space_mouse_move(visionaray::space_mouse_event const& event)
 
 void renderer::on_resize(int w, int h)
 {
-    if (render_future.valid() && algo != Pathtracing)
+    if (render_future.valid() && !is_progressive(algo))
     {
         render_future.wait();
     }
@@ -2915,9 +3255,29 @@ int main(int argc, char** argv)
 		return EXIT_FAILURE;
 	}
 
-    if (rend.algo == Pathtracing)
+    rend.host_renderer = make_cpu_renderer(rend.isa, std::thread::hardware_concurrency());
+
+    if (rend.host_renderer == nullptr)
     {
-        // Double buffering does not work in case of pathtracing
+        std::cerr << "Warning: instruction set " << cpu_isa_name(rend.isa)
+                  << " not available, falling back to baseline\n";
+        rend.host_renderer = make_cpu_renderer(IsaBaseline, std::thread::hardware_concurrency());
+    }
+
+    rend.host_renderer->set_simd_width(rend.simd);
+
+    if (rend.simd != SimdWidthAuto && !rend.host_renderer->simd_width_native(rend.simd))
+    {
+        std::cerr << "Warning: " << rend.simd << "-wide packets are not natively supported, "
+                  << "falling back to (slow) scalar emulation\n";
+    }
+
+    std::cout << "CPU rendering: " << rend.host_renderer->isa_name() << ", "
+              << rend.host_renderer->get_simd_width() << "-wide packets\n";
+
+    if (is_progressive(rend.algo))
+    {
+        // Double buffering does not work in case of progressive algorithms
         // because destination and source buffers need to be the same
         rend.rt.set_double_buffering(false);
     }
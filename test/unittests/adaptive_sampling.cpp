@@ -0,0 +1,165 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <visionaray/math/math.h>
+#include <visionaray/pinhole_camera.h>
+#include <visionaray/scheduler.h>
+#include <visionaray/simple_buffer_rt.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// Constant color in the left half of the image, uniform noise in [0..1)
+// in the right half
+struct noise_kernel
+{
+    template <typename R, typename Generator>
+    VSNRAY_FUNC
+    result_record<typename R::scalar_type> operator()(R ray, Generator& gen) const
+    {
+        using S = typename R::scalar_type;
+
+        result_record<S> result;
+        S noise = gen.next();
+        S value = select(ray.dir.x < S(0.0), S(0.5), noise);
+        result.color = vector<4, S>(value, value, value, S(1.0));
+        result.hit = ray.dir.x == ray.dir.x;
+        return result;
+    }
+};
+
+// The same kernel, invoked on whole tiles of single rays
+struct wavefront_noise_kernel
+{
+    using is_wavefront = void;
+
+    template <typename R, typename Generator>
+    void trace(
+            R                       /* */,
+            basic_ray<float> const* rays,
+            Generator*              gens,
+            result_record<float>*   results,
+            unsigned                count
+            ) const
+    {
+        for (unsigned i = 0; i < count; ++i)
+        {
+            results[i] = noise_kernel{}(rays[i], gens[i]);
+        }
+    }
+};
+
+using render_target_type = simple_buffer_rt<PF_RGBA32F, PF_UNSPECIFIED, PF_RGBA32F>;
+
+template <typename Kernel>
+static void render(Kernel kernel, render_target_type& rt, pixel_sampler::adaptive_blend_type ps, int frames)
+{
+    tiled_sched<basic_ray<simd::float4>> sched(2);
+
+    pinhole_camera cam;
+    cam.set_viewport(0, 0, rt.width(), rt.height());
+    cam.perspective(45.0f * constants::degrees_to_radians<float>(), 1.0f, 0.1f, 100.0f);
+    cam.look_at(vec3(0.0f, 0.0f, 3.5f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+    for (int i = 0; i < frames; ++i)
+    {
+        auto sparams = make_sched_params(ps, cam, rt);
+        sched.frame(kernel, sparams);
+    }
+}
+
+template <typename Kernel>
+static void test_adaptive(Kernel kernel)
+{
+    int const width = 64;
+    int const height = 32;
+    int const frames = 400;
+
+    render_target_type rt;
+    rt.resize(width, height);
+    rt.clear_accum_buffer();
+
+    // Allocated by the first frame w/ an adaptive sampler
+    EXPECT_EQ(rt.moments(), nullptr);
+
+    pixel_sampler::adaptive_blend_type ps;
+    ps.spp = 1;
+    ps.threshold = 0.1f;
+    ps.min_samples = 8;
+
+    render(kernel, rt, ps, frames);
+
+    ASSERT_NE(rt.moments(), nullptr);
+
+    auto const* moments = rt.moments();
+    auto const* accum = rt.accum();
+
+    float max_noisy_frames = 0.0f;
+    double noisy_mean = 0.0;
+    int num_noisy = 0;
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            auto const& m = moments[y * width + x];
+            auto const& c = accum[y * width + x];
+
+            if (x < width / 2)
+            {
+                // Constant pixels converge after the minimum sample count
+                EXPECT_FLOAT_EQ(m.z, 8.0f);
+                EXPECT_FLOAT_EQ(m.w, 0.0f);
+                EXPECT_FLOAT_EQ(c.x, 0.5f);
+            }
+            else if (x >= width / 2 + 4)
+            {
+                // Relative error ~0.58 / sqrt(n): at least ~30 samples to converge
+                EXPECT_GT(m.z, 20.0f);
+                EXPECT_LE(m.w, 0.1f);
+
+                // Accum buffer holds the average of the pixel's samples
+                EXPECT_NEAR(c.x, m.x, 1e-4f);
+
+                max_noisy_frames = max(max_noisy_frames, m.z);
+                noisy_mean += c.x;
+                ++num_noisy;
+            }
+        }
+    }
+
+    // Noisy tiles stop sampling before the last frame
+    EXPECT_LT(max_noisy_frames, static_cast<float>(frames));
+    EXPECT_NEAR(noisy_mean / num_noisy, 0.5, 0.02);
+
+    // Clearing the accum buffer starts over
+    rt.clear_accum_buffer();
+    render(kernel, rt, ps, 1);
+
+    for (int i = 0; i < width * height; ++i)
+    {
+        EXPECT_FLOAT_EQ(rt.moments()[i].z, 1.0f);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Converged tiles are skipped, noisy tiles receive samples until their
+// relative error drops below the threshold
+//
+
+TEST(AdaptiveSampling, Packets)
+{
+    test_adaptive(noise_kernel{});
+}
+
+TEST(AdaptiveSampling, Wavefront)
+{
+    test_adaptive(wavefront_noise_kernel{});
+}
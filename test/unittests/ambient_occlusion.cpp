@@ -0,0 +1,183 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <visionaray/math/math.h>
+#include <visionaray/aligned_vector.h>
+#include <visionaray/kernels.h>
+#include <visionaray/material.h>
+#include <visionaray/pinhole_camera.h>
+#include <visionaray/scheduler.h>
+#include <visionaray/simple_buffer_rt.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Test scene: camera between a floor at y = 0 and a ceiling at y = height,
+// looking down at the floor
+//
+
+using triangle_type = basic_triangle<3, float>;
+using render_target_type = simple_buffer_rt<PF_RGBA32F, PF_UNSPECIFIED, PF_RGBA32F>;
+
+struct test_scene
+{
+    aligned_vector<triangle_type> triangles;
+    aligned_vector<matte<float>> materials;
+
+    pinhole_camera cam;
+
+    int width = 8;
+    int height = 8;
+
+    explicit test_scene(float ceiling_height)
+    {
+        add_quad(0.0f, 0);
+        add_quad(ceiling_height, 2);
+
+        materials.push_back(matte<float>());
+
+        cam.set_viewport(0, 0, width, height);
+        cam.perspective(30.0f * constants::degrees_to_radians<float>(), 1.0f, 0.01f, 100.0f);
+        cam.look_at(vec3(0.0f, ceiling_height * 0.5f, 0.0f), vec3(0.0f), vec3(0.0f, 0.0f, 1.0f));
+    }
+
+    void add_quad(float y, unsigned prim_id)
+    {
+        float s = 1000.0f;
+
+        vec3 v1(-s, y, -s);
+        vec3 v2( s, y, -s);
+        vec3 v3( s, y,  s);
+        vec3 v4(-s, y,  s);
+
+        triangle_type t1(v1, v2 - v1, v3 - v1);
+        t1.prim_id = prim_id;
+        t1.geom_id = 0;
+        triangles.push_back(t1);
+
+        triangle_type t2(v1, v3 - v1, v4 - v1);
+        t2.prim_id = prim_id + 1;
+        t2.geom_id = 0;
+        triangles.push_back(t2);
+    }
+
+    // Mean visibility over all pixels after num_frames blended frames
+    template <typename R>
+    float render(unsigned samples, float radius, int num_frames)
+    {
+        auto kparams = make_kernel_params(
+                triangles.data(),
+                triangles.data() + triangles.size(),
+                materials.data(),
+                1,
+                1e-4f
+                );
+
+        ambient_occlusion::kernel<decltype(kparams)> kernel;
+        kernel.params = kparams;
+        kernel.samples = samples;
+        kernel.radius = radius;
+
+        tiled_sched<R> sched(2);
+
+        render_target_type rt;
+        rt.resize(width, height);
+        rt.clear_color_buffer();
+
+        for (int frame = 0; frame < num_frames; ++frame)
+        {
+            pixel_sampler::sobol_blend_type blend;
+            blend.spp = 1;
+            blend.sfactor = 1.0f / (frame + 1);
+            blend.dfactor = 1.0f - blend.sfactor;
+
+            auto sparams = make_sched_params(blend, cam, rt);
+            sched.frame(kernel, sparams);
+        }
+
+        float mean = 0.0f;
+
+        for (int i = 0; i < width * height; ++i)
+        {
+            vec4 c = rt.color()[i];
+            EXPECT_FLOAT_EQ(c.x, c.y);
+            EXPECT_FLOAT_EQ(c.x, c.z);
+            EXPECT_FLOAT_EQ(c.w, 1.0f);
+            mean += c.x;
+        }
+
+        return mean / (width * height);
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// A cosine-weighted ray from the floor hits the ceiling at distance
+// h / cos(theta), it is occluded if cos(theta) > h / radius. The visible
+// fraction of the hemisphere is (h / radius)^2
+//
+
+TEST(AmbientOcclusion, Ceiling)
+{
+    test_scene scene(1.0f);
+
+    // Ceiling out of reach
+    EXPECT_FLOAT_EQ(scene.render<basic_ray<float>>(8, 0.5f, 1), 1.0f);
+    EXPECT_FLOAT_EQ(scene.render<basic_ray<simd::float4>>(8, 0.5f, 1), 1.0f);
+
+    // Radius 2: 1/4 of the rays are not occluded, w/ single rays (batched
+    // into SIMD packets) and packets, also w/ sample counts that are no
+    // multiple of the SIMD width
+    EXPECT_NEAR(scene.render<basic_ray<float>>(16, 2.0f, 16), 0.25f, 0.02f);
+    EXPECT_NEAR(scene.render<basic_ray<float>>(13, 2.0f, 16), 0.25f, 0.02f);
+    EXPECT_NEAR(scene.render<basic_ray<simd::float4>>(16, 2.0f, 16), 0.25f, 0.02f);
+    EXPECT_NEAR(scene.render<basic_ray<simd::float8>>(5, 2.0f, 16), 0.25f, 0.02f);
+
+    // Radius 4: 1/16 of the rays
+    EXPECT_NEAR(scene.render<basic_ray<float>>(16, 4.0f, 16), 0.0625f, 0.01f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Background color for misses
+//
+
+TEST(AmbientOcclusion, Background)
+{
+    aligned_vector<basic_sphere<float>> spheres(1, basic_sphere<float>(vec3(0.0f), 1.0f));
+    aligned_vector<matte<float>> materials(1);
+
+    auto kparams = make_kernel_params(
+            spheres.data(),
+            spheres.data() + spheres.size(),
+            materials.data(),
+            1,
+            1e-4f,
+            vec4(0.2f, 0.4f, 0.6f, 1.0f)
+            );
+
+    ambient_occlusion::kernel<decltype(kparams)> kernel;
+    kernel.params = kparams;
+
+    pinhole_camera cam;
+    cam.set_viewport(0, 0, 4, 4);
+    cam.perspective(45.0f * constants::degrees_to_radians<float>(), 1.0f, 0.1f, 100.0f);
+    cam.look_at(vec3(0.0f, 0.0f, 5.0f), vec3(0.0f, 10.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f));
+
+    render_target_type rt;
+    rt.resize(4, 4);
+
+    tiled_sched<basic_ray<simd::float4>> sched(1);
+    auto sparams = make_sched_params(pixel_sampler::uniform_type{}, cam, rt);
+    sched.frame(kernel, sparams);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        EXPECT_FLOAT_EQ(rt.color()[i].x, 0.2f);
+        EXPECT_FLOAT_EQ(rt.color()[i].y, 0.4f);
+        EXPECT_FLOAT_EQ(rt.color()[i].z, 0.6f);
+    }
+}
@@ -0,0 +1,332 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <set>
+#include <vector>
+
+#include <visionaray/math/math.h>
+#include <visionaray/aligned_vector.h>
+#include <visionaray/aov.h>
+#include <visionaray/generic_material.h>
+#include <visionaray/kernels.h>
+#include <visionaray/material.h>
+#include <visionaray/pinhole_camera.h>
+#include <visionaray/point_light.h>
+#include <visionaray/scheduler.h>
+#include <visionaray/simple_buffer_rt.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Test scene: two spheres in front of the camera
+//
+
+using sphere_type = basic_sphere<float>;
+using material_type = generic_material<matte<float>, plastic<float>>;
+using render_target_type = simple_buffer_rt<PF_RGBA32F, PF_UNSPECIFIED, PF_RGBA32F>;
+
+struct test_scene
+{
+    aligned_vector<sphere_type> spheres;
+    aligned_vector<material_type> materials;
+    aligned_vector<point_light<float>> lights;
+
+    pinhole_camera cam;
+
+    int width = 32;
+    int height = 32;
+
+    test_scene()
+    {
+        sphere_type s0(vec3(-1.0f, 0.0f, 0.0f), 0.8f);
+        s0.prim_id = 0;
+        s0.geom_id = 0;
+
+        sphere_type s1(vec3(1.0f, 0.0f, 0.0f), 0.8f);
+        s1.prim_id = 1;
+        s1.geom_id = 1;
+
+        spheres.push_back(s0);
+        spheres.push_back(s1);
+
+        matte<float> m;
+        m.ca() = from_rgb(vec3(0.0f));
+        m.ka() = 0.0f;
+        m.cd() = from_rgb(vec3(0.8f, 0.2f, 0.1f));
+        m.kd() = 0.5f;
+
+        plastic<float> p;
+        p.ca() = from_rgb(vec3(0.0f));
+        p.ka() = 0.0f;
+        p.cd() = from_rgb(vec3(0.1f, 0.6f, 0.3f));
+        p.kd() = 1.0f;
+        p.cs() = from_rgb(vec3(1.0f));
+        p.ks() = 0.5f;
+        p.specular_exp() = 16.0f;
+
+        materials.push_back(m);
+        materials.push_back(p);
+
+        point_light<float> light;
+        light.set_cl(vec3(1.0f));
+        light.set_kl(1.0f);
+        light.set_position(vec3(0.0f, 5.0f, 5.0f));
+        lights.push_back(light);
+
+        cam.set_viewport(0, 0, width, height);
+        cam.perspective(45.0f * constants::degrees_to_radians<float>(), 1.0f, 0.1f, 100.0f);
+        cam.look_at(vec3(0.0f, 0.0f, 5.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    mat4 view_proj() const
+    {
+        return cam.get_proj_matrix() * cam.get_view_matrix();
+    }
+
+    template <unsigned Channels>
+    auto kernel_params(mat4 const& prev_view_proj)
+    {
+        auto params = make_kernel_params(
+                spheres.data(),
+                spheres.data() + spheres.size(),
+                materials.data(),
+                lights.data(),
+                lights.data() + lights.size(),
+                2,
+                1e-3f
+                );
+
+        return with_aovs<Channels>(params, view_proj(), prev_view_proj);
+    }
+};
+
+template <typename Kernel, typename R, typename PxSamplerT>
+static void render(Kernel kernel, R /* */, PxSamplerT ps, test_scene& scene, render_target_type& rt)
+{
+    tiled_sched<R> sched(2);
+
+    auto sparams = make_sched_params(ps, scene.cam, rt);
+    sched.frame(kernel, sparams);
+}
+
+// Checks AOV buffers against the scene, returns the number of hits
+static int check_aovs(test_scene const& scene, render_target_type const& rt, vec2 expected_motion)
+{
+    auto const& aovs = rt.aovs();
+
+    std::set<int> ids;
+    int hits = 0;
+
+    for (int i = 0; i < scene.width * scene.height; ++i)
+    {
+        int prim_id = aovs.prim_id()[i];
+        vec3 albedo = aovs.albedo()[i];
+        vec3 normal = aovs.normal()[i];
+        float depth = aovs.depth()[i];
+        vec2 motion = aovs.motion()[i];
+
+        if (prim_id < 0)
+        {
+            EXPECT_EQ(aovs.inst_id()[i], -1);
+            EXPECT_FLOAT_EQ(length(albedo), 0.0f);
+            EXPECT_FLOAT_EQ(length(normal), 0.0f);
+            EXPECT_FLOAT_EQ(length(motion), 0.0f);
+            EXPECT_EQ(depth, numeric_limits<float>::max());
+            continue;
+        }
+
+        ++hits;
+        ids.insert(prim_id);
+
+        // Geometry ID w/o instancing
+        EXPECT_EQ(aovs.inst_id()[i], prim_id);
+
+        vec3 expected_albedo = to_rgb(scene.materials[prim_id].albedo());
+        EXPECT_NEAR(albedo.x, expected_albedo.x, 1e-5f);
+        EXPECT_NEAR(albedo.y, expected_albedo.y, 1e-5f);
+        EXPECT_NEAR(albedo.z, expected_albedo.z, 1e-5f);
+
+        // Hit point on the sphere, normals face the camera
+        EXPECT_NEAR(length(normal), 1.0f, 1e-4f);
+        EXPECT_GT(normal.z, 0.0f);
+        EXPECT_GT(depth, 4.0f - 0.8f);
+        EXPECT_LT(depth, 5.5f);
+
+        EXPECT_NEAR(motion.x, expected_motion.x, 1e-4f);
+        EXPECT_NEAR(motion.y, expected_motion.y, 1e-4f);
+    }
+
+    EXPECT_EQ(ids.size(), 2u);
+
+    return hits;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Albedo of the built-in materials
+//
+
+TEST(AOV, MaterialAlbedo)
+{
+    matte<float> m;
+    m.cd() = from_rgb(vec3(0.5f, 0.25f, 1.0f));
+    m.kd() = 0.5f;
+    EXPECT_FLOAT_EQ(to_rgb(m.albedo()).x, 0.25f);
+    EXPECT_FLOAT_EQ(to_rgb(m.albedo()).z, 0.5f);
+
+    mirror<float> mi;
+    mi.cr() = from_rgb(vec3(1.0f));
+    mi.kr() = 0.9f;
+    EXPECT_FLOAT_EQ(to_rgb(mi.albedo()).y, 0.9f);
+
+    // Normal incidence reflectance of a dielectric w/ ior 1.5
+    metal<float> me;
+    me.ior() = from_rgb(vec3(1.5f));
+    me.absorption() = from_rgb(vec3(0.0f));
+    EXPECT_NEAR(to_rgb(me.albedo()).x, 0.04f, 1e-6f);
+
+    // generic_material forwards to the active type, also for SIMD
+    material_type gm(m);
+    EXPECT_FLOAT_EQ(to_rgb(gm.albedo()).x, 0.25f);
+
+    plastic<float> p;
+    p.cd() = from_rgb(vec3(0.9f));
+    p.kd() = 1.0f;
+
+    array<material_type, 4> mats = {{ material_type(m), material_type(p), material_type(m), material_type(p) }};
+    auto packed = simd::pack(mats);
+    auto alb = to_rgb(packed.albedo());
+
+    simd::aligned_array_t<simd::float4> x;
+    store(x, alb.x);
+    EXPECT_FLOAT_EQ(x[0], 0.25f);
+    EXPECT_FLOAT_EQ(x[1], 0.9f);
+    EXPECT_FLOAT_EQ(x[2], 0.25f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Kernels record AOVs of the first hit, schedulers store them to the render target
+//
+
+TEST(AOV, Kernels)
+{
+    test_scene scene;
+
+    unsigned const channels = aov::All;
+
+    render_target_type rt;
+    rt.aovs().set_channels(channels);
+    rt.resize(scene.width, scene.height);
+    rt.clear_accum_buffer();
+
+    // Camera did not move
+    auto kparams = scene.kernel_params<channels>(scene.view_proj());
+
+    simple::kernel<decltype(kparams)> simple_kernel;
+    simple_kernel.params = kparams;
+
+    render(simple_kernel, basic_ray<float>{}, pixel_sampler::uniform_type{}, scene, rt);
+    int hits = check_aovs(scene, rt, vec2(0.0f));
+    EXPECT_GT(hits, 0);
+
+    // Same primary rays w/ packets
+    auto prim_ids = std::vector<int>(rt.aovs().prim_id(), rt.aovs().prim_id() + scene.width * scene.height);
+
+    rt.aovs().clear();
+    render(simple_kernel, basic_ray<simd::float4>{}, pixel_sampler::uniform_type{}, scene, rt);
+    EXPECT_EQ(check_aovs(scene, rt, vec2(0.0f)), hits);
+
+    for (int i = 0; i < scene.width * scene.height; ++i)
+    {
+        EXPECT_EQ(rt.aovs().prim_id()[i], prim_ids[i]);
+    }
+
+    whitted::kernel<decltype(kparams)> whitted_kernel;
+    whitted_kernel.params = kparams;
+
+    rt.aovs().clear();
+    render(whitted_kernel, basic_ray<simd::float8>{}, pixel_sampler::uniform_type{}, scene, rt);
+    EXPECT_EQ(check_aovs(scene, rt, vec2(0.0f)), hits);
+
+    // Camera moved: the previous frame's image was shifted to the left by a
+    // tenth of the viewport (0.2 NDC units)
+    mat4 shift = mat4::identity();
+    shift(0, 3) = -0.2f;
+
+    auto kparams_moved = scene.kernel_params<channels>(shift * scene.view_proj());
+
+    pathtracing::kernel<decltype(kparams_moved)> pt_kernel;
+    pt_kernel.params = kparams_moved;
+
+    pixel_sampler::jittered_blend_type blend;
+    blend.spp = 2;
+    blend.sfactor = 1.0f;
+    blend.dfactor = 0.0f;
+
+    rt.aovs().clear();
+    render(pt_kernel, basic_ray<simd::float4>{}, blend, scene, rt);
+    EXPECT_GT(check_aovs(scene, rt, vec2(0.1f, 0.0f)), 0);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Only enabled channels are allocated, compact storage for albedo and normals
+//
+
+TEST(AOV, Buffers)
+{
+    test_scene scene;
+
+    render_target_type rt;
+    rt.aovs().set_channels(aov::Albedo | aov::PrimID);
+    rt.resize(scene.width, scene.height);
+
+    auto ref = rt.ref().aovs();
+    EXPECT_NE(ref.albedo, nullptr);
+    EXPECT_NE(ref.prim_id, nullptr);
+    EXPECT_EQ(ref.albedo16, nullptr);
+    EXPECT_EQ(ref.normal, nullptr);
+    EXPECT_EQ(ref.depth, nullptr);
+    EXPECT_EQ(ref.motion, nullptr);
+
+    // Render target w/o AOVs
+    render_target_type rt_none;
+    rt_none.resize(scene.width, scene.height);
+    EXPECT_EQ(rt_none.ref().aovs().prim_id, nullptr);
+
+    // Full and compact storage record the same values
+    auto kparams = scene.kernel_params<aov::Albedo | aov::Normal>(scene.view_proj());
+
+    simple::kernel<decltype(kparams)> kernel;
+    kernel.params = kparams;
+
+    render_target_type full;
+    full.aovs().set_channels(aov::Albedo | aov::Normal);
+    full.resize(scene.width, scene.height);
+
+    render_target_type compact;
+    compact.aovs().set_channels(aov::Albedo | aov::Normal, true);
+    compact.resize(scene.width, scene.height);
+
+    EXPECT_EQ(compact.ref().aovs().albedo, nullptr);
+    EXPECT_EQ(compact.ref().aovs().normal, nullptr);
+
+    render(kernel, basic_ray<simd::float4>{}, pixel_sampler::uniform_type{}, scene, full);
+    render(kernel, basic_ray<simd::float4>{}, pixel_sampler::uniform_type{}, scene, compact);
+
+    for (int i = 0; i < scene.width * scene.height; ++i)
+    {
+        vec3 albedo(compact.aovs().albedo16()[i]);
+        vec3 normal(compact.aovs().normal16()[i]);
+
+        EXPECT_NEAR(albedo.x, full.aovs().albedo()[i].x, 1e-4f);
+        EXPECT_NEAR(albedo.y, full.aovs().albedo()[i].y, 1e-4f);
+        EXPECT_NEAR(normal.x, full.aovs().normal()[i].x, 1e-4f);
+        EXPECT_NEAR(normal.z, full.aovs().normal()[i].z, 1e-4f);
+    }
+}
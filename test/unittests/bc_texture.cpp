@@ -0,0 +1,559 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <visionaray/math/math.h>
+#include <visionaray/texture/texture.h>
+#include <visionaray/aligned_vector.h>
+
+#include <gtest/gtest.h>
+
+#include "texture_helpers.h"
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+using texel = vector<4, unorm<8>>;
+
+// Write bits LSB first, as in the BC7 spec
+struct bit_writer
+{
+    uint8_t block[16] = {};
+    unsigned pos = 0;
+
+    void write(unsigned value, unsigned n)
+    {
+        for (unsigned i = 0; i < n; ++i, ++pos)
+        {
+            block[pos / 8] |= ((value >> i) & 1) << (pos % 8);
+        }
+    }
+};
+
+static unsigned interpolate(unsigned e0, unsigned e1, unsigned w)
+{
+    return ((64 - w) * e0 + w * e1 + 32) >> 6;
+}
+
+static void expect_texel(texel t, unsigned r, unsigned g, unsigned b, unsigned a)
+{
+    EXPECT_EQ(t.x.value, r);
+    EXPECT_EQ(t.y.value, g);
+    EXPECT_EQ(t.z.value, b);
+    EXPECT_EQ(t.w.value, a);
+}
+
+// Texels decoded one by one match the texels of the whole block
+static void expect_single_texels(tex_block_format format, uint8_t const* block)
+{
+    texel texels[16];
+    detail::decode_block(format, block, 0, 16, texels);
+
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        texel t[16];
+        detail::decode_block(format, block, i, i + 1, t);
+        expect_texel(t[i], texels[i].x.value, texels[i].y.value, texels[i].z.value, texels[i].w.value);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Anchor texels belong to their subsets
+//
+
+TEST(BCTexture, PartitionTables)
+{
+    for (unsigned p = 0; p < 64; ++p)
+    {
+        uint8_t const* p2 = detail::bc7_partition2(p);
+        uint8_t const* p3 = detail::bc7_partition3(p);
+
+        EXPECT_EQ(p2[0], 0);
+        EXPECT_EQ(p3[0], 0);
+        EXPECT_EQ(p2[detail::bc7_anchor(2, p, 1)], 1);
+        EXPECT_EQ(p3[detail::bc7_anchor(3, p, 1)], 1);
+        EXPECT_EQ(p3[detail::bc7_anchor(3, p, 2)], 2);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// BC1, BC3 and BC5 blocks
+//
+
+TEST(BCTexture, DecodeBC1BC3BC5)
+{
+    texel texels[16];
+
+    // Red and blue, four colors
+    uint8_t bc1[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+    detail::decode_block(BC1, bc1, 0, 16, texels);
+
+    expect_texel(texels[0], 255, 0, 0, 255);
+    expect_texel(texels[1], 0, 0, 255, 255);
+    expect_texel(texels[2], 170, 0, 85, 255);
+    expect_texel(texels[3], 85, 0, 170, 255);
+
+    // Swapped endpoints: three colors and transparent black
+    uint8_t bc1a[8] = { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4 };
+    detail::decode_block(BC1, bc1a, 0, 16, texels);
+
+    expect_texel(texels[0], 0, 0, 255, 255);
+    expect_texel(texels[1], 255, 0, 0, 255);
+    expect_texel(texels[2], 127, 0, 127, 255);
+    expect_texel(texels[3], 0, 0, 0, 0);
+
+    // Single texels
+    detail::decode_block(BC1, bc1, 2, 3, texels);
+    expect_texel(texels[2], 170, 0, 85, 255);
+
+    // BC3: eight alpha values, color block always w/ four colors
+    uint8_t bc3[16] = { 255, 0, 0210, 0, 0, 0, 0, 0, 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4 };
+    detail::decode_block(BC3, bc3, 0, 16, texels);
+
+    expect_texel(texels[0], 0, 0, 255, 255);
+    expect_texel(texels[1], 255, 0, 0, 0);
+    expect_texel(texels[2], 85, 0, 170, (6 * 255 + 3) / 7);
+    expect_texel(texels[3], 170, 0, 85, 255);
+
+    // BC5: two channels, six values + 0 and 255 w/ a0 <= a1
+    uint8_t bc5[16] = { 0, 100, 0372, 0, 0, 0, 0, 0, 200, 100, 1, 0, 0, 0, 0, 0 };
+    detail::decode_block(BC5, bc5, 0, 16, texels);
+
+    expect_texel(texels[0], 20, 100, 0, 255);
+    expect_texel(texels[1], 255, 200, 0, 255);
+    expect_texel(texels[2], 40, 200, 0, 255);
+    expect_texel(texels[3], 0, 200, 0, 255);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// BC7 blocks
+//
+
+TEST(BCTexture, DecodeBC7)
+{
+    texel texels[16];
+
+    // Mode 6: one subset, 7-bit RGBA endpoints w/ p-bits, 4-bit indices
+    {
+        bit_writer w;
+        w.write(1 << 6, 7);
+
+        unsigned e0[] = { 10, 20, 30, 127 };
+        unsigned e1[] = { 100, 80, 60, 0 };
+
+        for (int c = 0; c < 4; ++c)
+        {
+            w.write(e0[c], 7);
+            w.write(e1[c], 7);
+        }
+
+        w.write(1, 1);
+        w.write(0, 1);
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            w.write(i, i == 0 ? 3 : 4);
+        }
+
+        ASSERT_EQ(w.pos, 128U);
+
+        detail::decode_block(BC7, w.block, 0, 16, texels);
+
+        static const unsigned weights[] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            expect_texel(
+                    texels[i],
+                    interpolate(21, 200, weights[i]),
+                    interpolate(41, 160, weights[i]),
+                    interpolate(61, 120, weights[i]),
+                    interpolate(255, 0, weights[i])
+                    );
+        }
+    }
+
+    // Mode 1: two subsets, 6-bit RGB endpoints w/ shared p-bits, 3-bit indices
+    for (unsigned partition : { 0U, 13U, 17U, 63U })
+    {
+        bit_writer w;
+        w.write(1 << 1, 2);
+        w.write(partition, 6);
+
+        // Subset 0 from black to white, subset 1 from white to black
+        unsigned endpoints[] = { 0, 63, 63, 0 };
+
+        for (int c = 0; c < 3; ++c)
+        {
+            for (unsigned e : endpoints)
+            {
+                w.write(e, 6);
+            }
+        }
+
+        w.write(0, 1);
+        w.write(1, 1);
+
+        uint8_t const* subsets = detail::bc7_partition2(partition);
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            bool anchor = i == detail::bc7_anchor(2, partition, subsets[i]);
+            w.write(anchor ? i % 4 : i % 8, anchor ? 2 : 3);
+        }
+
+        ASSERT_EQ(w.pos, 128U);
+
+        detail::decode_block(BC7, w.block, 0, 16, texels);
+
+        static const unsigned weights[] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            bool anchor = i == detail::bc7_anchor(2, partition, subsets[i]);
+            unsigned index = anchor ? i % 4 : i % 8;
+
+            // Shared p-bits, subset 0: 0 and 253, subset 1: 255 and 2
+            unsigned v = subsets[i] == 0
+                    ? interpolate(0, 253, weights[index])
+                    : interpolate(255, 2, weights[index]);
+
+            expect_texel(texels[i], v, v, v, 255);
+        }
+    }
+
+    // Mode 0: three subsets, 4-bit RGB endpoints w/ p-bits, 3-bit indices
+    for (unsigned partition : { 0U, 5U, 15U })
+    {
+        bit_writer w;
+        w.write(1, 1);
+        w.write(partition, 4);
+
+        // Subset 0 from black to white, subset 1 from white to black,
+        // subset 2 from dark to light gray
+        unsigned endpoints[] = { 0, 15, 15, 0, 5, 10 };
+        unsigned pbits[] = { 0, 1, 1, 0, 1, 0 };
+
+        for (int c = 0; c < 3; ++c)
+        {
+            for (unsigned e : endpoints)
+            {
+                w.write(e, 4);
+            }
+        }
+
+        for (unsigned p : pbits)
+        {
+            w.write(p, 1);
+        }
+
+        uint8_t const* subsets = detail::bc7_partition3(partition);
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            bool anchor = i == detail::bc7_anchor(3, partition, subsets[i]);
+            w.write(anchor ? i % 4 : i % 8, anchor ? 2 : 3);
+        }
+
+        ASSERT_EQ(w.pos, 128U);
+
+        detail::decode_block(BC7, w.block, 0, 16, texels);
+
+        static const unsigned weights[] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+
+        // 5-bit endpoints w/ p-bits: 0, 31, 31, 0, 11, 20
+        static const unsigned e0[] = { 0, 255, 90 };
+        static const unsigned e1[] = { 255, 0, 165 };
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            bool anchor = i == detail::bc7_anchor(3, partition, subsets[i]);
+            unsigned index = anchor ? i % 4 : i % 8;
+            unsigned v = interpolate(e0[subsets[i]], e1[subsets[i]], weights[index]);
+
+            expect_texel(texels[i], v, v, v, 255);
+        }
+
+        expect_single_texels(BC7, w.block);
+    }
+
+    // Mode 2: three subsets, 5-bit RGB endpoints, 2-bit indices
+    for (unsigned partition : { 0U, 13U, 63U })
+    {
+        bit_writer w;
+        w.write(1 << 2, 3);
+        w.write(partition, 6);
+
+        unsigned endpoints[] = { 0, 31, 31, 0, 10, 20 };
+
+        for (int c = 0; c < 3; ++c)
+        {
+            for (unsigned e : endpoints)
+            {
+                w.write(e, 5);
+            }
+        }
+
+        uint8_t const* subsets = detail::bc7_partition3(partition);
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            bool anchor = i == detail::bc7_anchor(3, partition, subsets[i]);
+            w.write(anchor ? i % 2 : i % 4, anchor ? 1 : 2);
+        }
+
+        ASSERT_EQ(w.pos, 128U);
+
+        detail::decode_block(BC7, w.block, 0, 16, texels);
+
+        static const unsigned weights[] = { 0, 21, 43, 64 };
+
+        static const unsigned e0[] = { 0, 255, 82 };
+        static const unsigned e1[] = { 255, 0, 165 };
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            bool anchor = i == detail::bc7_anchor(3, partition, subsets[i]);
+            unsigned index = anchor ? i % 2 : i % 4;
+            unsigned v = interpolate(e0[subsets[i]], e1[subsets[i]], weights[index]);
+
+            expect_texel(texels[i], v, v, v, 255);
+        }
+
+        expect_single_texels(BC7, w.block);
+    }
+
+    // Mode 4: one subset, 5-bit RGB and 6-bit alpha endpoints, 2-bit and
+    // 3-bit indices, index selection and rotation
+    for (unsigned rotation = 0; rotation < 4; ++rotation)
+    {
+        for (unsigned index_selection = 0; index_selection < 2; ++index_selection)
+        {
+            bit_writer w;
+            w.write(1 << 4, 5);
+            w.write(rotation, 2);
+            w.write(index_selection, 1);
+
+            unsigned e0[] = { 31, 0, 10 };
+            unsigned e1[] = { 0, 31, 20 };
+
+            for (int c = 0; c < 3; ++c)
+            {
+                w.write(e0[c], 5);
+                w.write(e1[c], 5);
+            }
+
+            w.write(0, 6);
+            w.write(63, 6);
+
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                w.write(i % 4, i == 0 ? 1 : 2);
+            }
+
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                w.write((i * 3) % 8, i == 0 ? 2 : 3);
+            }
+
+            ASSERT_EQ(w.pos, 128U);
+
+            detail::decode_block(BC7, w.block, 0, 16, texels);
+
+            static const unsigned weights2[] = { 0, 21, 43, 64 };
+            static const unsigned weights3[] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                // Index selection 1 swaps the index sets of color and alpha
+                unsigned w2 = weights2[i % 4];
+                unsigned w3 = weights3[(i * 3) % 8];
+                unsigned color_weight = index_selection ? w3 : w2;
+                unsigned alpha_weight = index_selection ? w2 : w3;
+
+                unsigned rgba[] = {
+                    interpolate(255, 0, color_weight),
+                    interpolate(0, 255, color_weight),
+                    interpolate(82, 165, color_weight),
+                    interpolate(0, 255, alpha_weight)
+                    };
+
+                // Rotation swaps alpha w/ red, green or blue
+                if (rotation > 0)
+                {
+                    std::swap(rgba[3], rgba[rotation - 1]);
+                }
+
+                expect_texel(texels[i], rgba[0], rgba[1], rgba[2], rgba[3]);
+            }
+
+            expect_single_texels(BC7, w.block);
+        }
+    }
+
+    // Mode 5: one subset, 7-bit RGB and 8-bit alpha endpoints, separate
+    // 2-bit color and alpha indices, rotation
+    for (unsigned rotation = 0; rotation < 4; ++rotation)
+    {
+        bit_writer w;
+        w.write(1 << 5, 6);
+        w.write(rotation, 2);
+
+        unsigned e0[] = { 127, 0, 64 };
+        unsigned e1[] = { 0, 127, 100 };
+
+        for (int c = 0; c < 3; ++c)
+        {
+            w.write(e0[c], 7);
+            w.write(e1[c], 7);
+        }
+
+        w.write(10, 8);
+        w.write(250, 8);
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            w.write(i % 4, i == 0 ? 1 : 2);
+        }
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            w.write((i / 4) % 4, i == 0 ? 1 : 2);
+        }
+
+        ASSERT_EQ(w.pos, 128U);
+
+        detail::decode_block(BC7, w.block, 0, 16, texels);
+
+        static const unsigned weights[] = { 0, 21, 43, 64 };
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            unsigned color_weight = weights[i % 4];
+            unsigned alpha_weight = weights[(i / 4) % 4];
+
+            // 7-bit endpoints: 255, 0, 129 and 0, 255, 201
+            unsigned rgba[] = {
+                interpolate(255, 0, color_weight),
+                interpolate(0, 255, color_weight),
+                interpolate(129, 201, color_weight),
+                interpolate(10, 250, alpha_weight)
+                };
+
+            if (rotation > 0)
+            {
+                std::swap(rgba[3], rgba[rotation - 1]);
+            }
+
+            expect_texel(texels[i], rgba[0], rgba[1], rgba[2], rgba[3]);
+        }
+
+        expect_single_texels(BC7, w.block);
+    }
+
+    // Reserved mode
+    uint8_t reserved[16] = {};
+    detail::decode_block(BC7, reserved, 0, 16, texels);
+    expect_texel(texels[5], 0, 0, 0, 0);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Fetches return the same values as w/ decompressed textures
+//
+
+TEST(BCTexture, Fetch)
+{
+    unsigned w = 13;
+    unsigned h = 10;
+
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<int> bytes(0, 255);
+    std::uniform_real_distribution<float> coords(-0.5f, 1.5f);
+
+    for (auto format : { BC1, BC3, BC5, BC7 })
+    {
+        unsigned bw = (w + 3) / 4;
+        unsigned bh = (h + 3) / 4;
+        size_t block_bytes = detail::bc_block_bytes(format);
+
+        std::vector<uint8_t> blocks(bw * bh * block_bytes);
+
+        for (auto& b : blocks)
+        {
+            b = static_cast<uint8_t>(bytes(rng));
+        }
+
+        // Decompress for reference
+        aligned_vector<texel> data(w * h);
+
+        for (unsigned by = 0; by < bh; ++by)
+        {
+            for (unsigned bx = 0; bx < bw; ++bx)
+            {
+                texel texels[16];
+                detail::decode_block(format, blocks.data() + (by * bw + bx) * block_bytes, 0, 16, texels);
+
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    unsigned x = bx * 4 + i % 4;
+                    unsigned y = by * 4 + i / 4;
+
+                    if (x < w && y < h)
+                    {
+                        data[y * w + x] = texels[i];
+                    }
+                }
+            }
+        }
+
+        bc_texture<2> tex(w, h, format);
+        tex.reset(blocks.data());
+        EXPECT_EQ(tex.width(), w);
+        EXPECT_EQ(tex.height(), h);
+        EXPECT_EQ(tex.get_block_format(), format);
+
+        texture<texel, 2> ref(w, h);
+        ref.reset(data.data());
+
+        for (auto fm : { Nearest, Linear })
+        {
+            tex.set_address_mode(Wrap);
+            tex.set_filter_mode(fm);
+            ref.set_address_mode(Wrap);
+            ref.set_filter_mode(fm);
+
+            bc_texture<2>::ref_type tex_ref(tex);
+            texture<texel, 2>::ref_type ref_ref(ref);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                vec2 coord(coords(rng), coords(rng));
+                EXPECT_TRUE(equal(tex2D(tex, coord), tex2D(ref, coord)));
+                EXPECT_TRUE(equal(tex2D(tex_ref, coord), tex2D(ref_ref, coord)));
+
+                // Packets, some lanes in the same block
+                using F = simd::float4;
+                vector<2, F> coord4(
+                        F(coord.x, coord.x + 0.01f, coords(rng), coords(rng)),
+                        F(coord.y, coord.y, coords(rng), coords(rng))
+                        );
+
+                EXPECT_TRUE(equal(tex2D(tex, coord4), tex2D(ref_ref, coord4)));
+                EXPECT_TRUE(equal(tex2D(tex_ref, coord4), tex2D(ref_ref, coord4)));
+            }
+        }
+    }
+}
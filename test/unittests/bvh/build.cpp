@@ -120,3 +120,34 @@ TEST(BVH, BuildArrayRefBvh)
     EXPECT_TRUE(triangle_bvh.primitives().size() == triangles.size());
     EXPECT_TRUE(sphere_bvh.primitives().size()   == spheres.size());
 }
+
+// lbvh w/ and w/o thread pool ----------------------------
+
+TEST(BVH, BuildLbvhParallel)
+{
+    aligned_vector<sphere_t, 32> spheres;
+
+    // Shuffled 32x32x20 grid, distinct morton codes
+    for (int i = 0; i < 20480; ++i)
+    {
+        int j = (i * 7919) % 20480;
+        spheres.emplace_back(vec3(j % 32, (j / 32) % 32, j / 1024), 0.25f);
+    }
+
+    thread_pool pool(4);
+
+    lbvh_builder builder;
+
+    auto serial_bvh   = builder.build(bvh<sphere_t>{}, spheres.data(), spheres.size());
+    auto parallel_bvh = builder.build(bvh<sphere_t>{}, spheres.data(), spheres.size(), pool);
+
+    // Radix sort and stable sort produce the same order
+    ASSERT_EQ(serial_bvh.nodes().size(), parallel_bvh.nodes().size());
+    ASSERT_EQ(serial_bvh.primitives().size(), spheres.size());
+    ASSERT_EQ(parallel_bvh.primitives().size(), spheres.size());
+
+    for (size_t i = 0; i < spheres.size(); ++i)
+    {
+        EXPECT_TRUE(serial_bvh.primitives()[i].center == parallel_bvh.primitives()[i].center);
+    }
+}
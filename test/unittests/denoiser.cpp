@@ -0,0 +1,297 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <visionaray/math/math.h>
+#include <visionaray/aov.h>
+#include <visionaray/denoiser.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+struct test_image
+{
+    int width;
+    int height;
+
+    std::vector<vec4> color;
+    aov_buffers aovs;
+
+    test_image(int w, int h, unsigned channels = aov::Albedo | aov::Normal | aov::Depth)
+        : width(w)
+        , height(h)
+        , color(w * h, vec4(0.0f, 0.0f, 0.0f, 1.0f))
+    {
+        aovs.set_channels(channels);
+        aovs.resize(w, h);
+
+        // Fronto-parallel plane
+        for (int i = 0; i < w * h; ++i)
+        {
+            set(i, vec3(1.0f), vec3(0.0f, 0.0f, 1.0f), 5.0f);
+        }
+    }
+
+    void set(int i, vec3 albedo, vec3 normal, float depth)
+    {
+        auto ref = aovs.ref();
+
+        if (ref.albedo) ref.albedo[i] = albedo;
+        if (ref.normal) ref.normal[i] = normal;
+        if (ref.depth)  ref.depth[i] = depth;
+    }
+
+    // Mean and standard deviation of the red channel in columns [x0..x1)
+    void stats(std::vector<vec4> const& img, int x0, int x1, float& mean, float& stddev) const
+    {
+        double sum = 0.0;
+        double sum2 = 0.0;
+        int n = 0;
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = x0; x < x1; ++x)
+            {
+                float v = img[y * width + x].x;
+                sum += v;
+                sum2 += v * v;
+                ++n;
+            }
+        }
+
+        mean = static_cast<float>(sum / n);
+        stddev = static_cast<float>(std::sqrt(std::max(sum2 / n - (sum / n) * (sum / n), 0.0)));
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Noise is removed from flat regions, the mean is preserved
+//
+
+TEST(Denoiser, Smooth)
+{
+    test_image img(64, 48);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    for (auto& c : img.color)
+    {
+        float v = dist(rng);
+        c = vec4(v, v, v, 1.0f);
+    }
+
+    thread_pool pool(2);
+    atrous_denoiser denoiser(pool);
+    denoiser.params().sigma_color = 4.0f;
+
+    std::vector<vec4> output(img.color.size());
+    denoiser.apply(img.color.data(), img.aovs, img.width, img.height, output.data());
+
+    float mean_in, stddev_in;
+    img.stats(img.color, 0, img.width, mean_in, stddev_in);
+
+    float mean_out, stddev_out;
+    img.stats(output, 0, img.width, mean_out, stddev_out);
+
+    EXPECT_NEAR(mean_out, mean_in, 0.02f);
+    EXPECT_LT(stddev_out, stddev_in * 0.2f);
+
+    // Alpha is passed through
+    for (auto const& c : output)
+    {
+        EXPECT_FLOAT_EQ(c.w, 1.0f);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Constant images stay constant, also w/ widths that are no multiple of
+// the SIMD width (padding must not leak into the image)
+//
+
+TEST(Denoiser, Constant)
+{
+    test_image img(61, 37);
+
+    for (auto& c : img.color)
+    {
+        c = vec4(0.25f, 0.5f, 0.75f, 1.0f);
+    }
+
+    thread_pool pool(2);
+    atrous_denoiser denoiser(pool);
+
+    // Output aliases input
+    denoiser.apply(img.color.data(), img.aovs, img.width, img.height, img.color.data());
+
+    for (auto const& c : img.color)
+    {
+        EXPECT_NEAR(c.x, 0.25f, 1e-5f);
+        EXPECT_NEAR(c.y, 0.5f, 1e-5f);
+        EXPECT_NEAR(c.z, 0.75f, 1e-5f);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Geometric edges and texture detail are preserved
+//
+
+TEST(Denoiser, Edges)
+{
+    int const w = 64;
+    int const h = 32;
+
+    test_image img(w, h);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-0.1f, 0.1f);
+
+    // Normal edge between the left and the right half, noisy illumination
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int i = y * w + x;
+            bool left = x < w / 2;
+
+            img.set(i, vec3(1.0f), left ? vec3(0.0f, 0.0f, 1.0f) : vec3(1.0f, 0.0f, 0.0f), 5.0f);
+
+            float v = (left ? 0.2f : 0.8f) + dist(rng);
+            img.color[i] = vec4(v, v, v, 1.0f);
+        }
+    }
+
+    thread_pool pool(2);
+    atrous_denoiser denoiser(pool);
+
+    std::vector<vec4> output(img.color.size());
+    denoiser.apply(img.color.data(), img.aovs, w, h, output.data());
+
+    float mean, stddev;
+
+    img.stats(output, w / 2 - 1, w / 2, mean, stddev);
+    EXPECT_NEAR(mean, 0.2f, 0.02f);
+
+    img.stats(output, w / 2, w / 2 + 1, mean, stddev);
+    EXPECT_NEAR(mean, 0.8f, 0.02f);
+
+    // Checkerboard albedo, constant illumination: demodulation keeps the texture
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int i = y * w + x;
+            vec3 albedo((x + y) % 2 ? 0.9f : 0.1f);
+
+            img.set(i, albedo, vec3(0.0f, 0.0f, 1.0f), 5.0f);
+            img.color[i] = vec4(albedo * 0.5f, 1.0f);
+        }
+    }
+
+    denoiser.apply(img.color.data(), img.aovs, w, h, output.data());
+
+    for (int i = 0; i < w * h; ++i)
+    {
+        EXPECT_NEAR(output[i].x, img.color[i].x, 1e-5f);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Temporal reprojection follows the motion vectors and rejects history
+// that falls outside of the image
+//
+
+TEST(Denoiser, Temporal)
+{
+    int const w = 48;
+    int const h = 16;
+    int const shift = 4;
+
+    test_image img(w, h, aov::Albedo | aov::Normal | aov::Depth | aov::Motion);
+
+    thread_pool pool(2);
+    atrous_denoiser denoiser(pool);
+    denoiser.params().iterations = 0;
+    denoiser.params().temporal = true;
+    denoiser.params().temporal_alpha = 0.0f;
+
+    // Frame 1: horizontal ramp
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            float v = x / float(w);
+            img.color[y * w + x] = vec4(v, v, v, 1.0f);
+        }
+    }
+
+    std::vector<vec4> output(img.color.size());
+    denoiser.apply(img.color.data(), img.aovs, w, h, output.data());
+
+    // Frame 2: the image moved to the right, current samples are black,
+    // alpha = 0 shows only the history
+    auto ref = img.aovs.ref();
+
+    for (int i = 0; i < w * h; ++i)
+    {
+        img.color[i] = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        ref.motion[i] = vec2(shift / float(w), 0.0f);
+    }
+
+    denoiser.apply(img.color.data(), img.aovs, w, h, output.data());
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            float expected = x < shift ? 0.0f : (x - shift) / float(w);
+            EXPECT_NEAR(output[y * w + x].x, expected, 1e-5f);
+        }
+    }
+
+    // Static camera: running average over frames of independent noise
+    denoiser.reset_history();
+    denoiser.params().temporal_alpha = 0.2f;
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    for (int i = 0; i < w * h; ++i)
+    {
+        ref.motion[i] = vec2(0.0f);
+    }
+
+    for (int frame = 0; frame < 32; ++frame)
+    {
+        for (auto& c : img.color)
+        {
+            float v = dist(rng);
+            c = vec4(v, v, v, 1.0f);
+        }
+
+        denoiser.apply(img.color.data(), img.aovs, w, h, output.data());
+    }
+
+    float mean_in, stddev_in;
+    img.stats(img.color, 0, w, mean_in, stddev_in);
+
+    float mean_out, stddev_out;
+    img.stats(output, 0, w, mean_out, stddev_out);
+
+    // Variance of the exponential moving average: alpha / (2 - alpha)
+    EXPECT_NEAR(mean_out, 0.5f, 0.03f);
+    EXPECT_LT(stddev_out, stddev_in * 0.5f);
+}
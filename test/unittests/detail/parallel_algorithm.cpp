@@ -1,11 +1,12 @@
 // This file is distributed under the MIT license.
 // See the LICENSE file for details.
 
-#include <visionaray/config.h>
-
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
+#include <numeric>
 #include <vector>
 
 #include <visionaray/detail/parallel_algorithm.h>
@@ -14,22 +15,21 @@
 
 using namespace visionaray;
 
-
-#if VSNRAY_HAVE_TBB
-
 //-------------------------------------------------------------------------------------------------
 // Test counting_sort()
 //
 
 TEST(ParallelAlgorithm, CountingSort)
 {
+    thread_pool pool(4);
+
     // Array of ints
     {
         std::vector<int> a{3, 1, 4, 3, 2, 1, 8, 7, 7, 7};
         std::vector<int> b(a.size());
         std::vector<int> counts(9);
 
-        paralgo::counting_sort(a.begin(), a.end(), b.begin(), counts);
+        paralgo::counting_sort(pool, a.begin(), a.end(), b.begin(), counts);
         EXPECT_TRUE(std::is_sorted(b.begin(), b.end()));
 
         std::sort(a.begin(), a.end());
@@ -50,7 +50,7 @@ TEST(ParallelAlgorithm, CountingSort)
             a[i] = rand() % K;
         }
 
-        paralgo::counting_sort(a.begin(), a.end(), b.begin(), counts);
+        paralgo::counting_sort(pool, a.begin(), a.end(), b.begin(), counts);
         EXPECT_TRUE(std::is_sorted(b.begin(), b.end()));
 
         std::sort(a.begin(), a.end());
@@ -92,6 +92,7 @@ TEST(ParallelAlgorithm, CountingSort)
         }
 
         paralgo::counting_sort(
+                pool,
                 a.begin(),
                 a.end(),
                 b.begin(),
@@ -113,4 +114,212 @@ TEST(ParallelAlgorithm, CountingSort)
     }
 }
 
-#endif // VSNRAY_HAVE_TBB
+
+//-------------------------------------------------------------------------------------------------
+// Test radix_sort()
+//
+
+TEST(ParallelAlgorithm, RadixSort)
+{
+    thread_pool pool(4);
+
+    // 32-bit keys
+    {
+        static const size_t N = 1000000;
+
+        std::vector<uint32_t> a(N);
+        for (size_t i = 0; i < N; ++i)
+        {
+            a[i] = static_cast<uint32_t>(rand()) * 2654435761U;
+        }
+
+        std::vector<uint32_t> b(a);
+
+        paralgo::radix_sort(pool, a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        EXPECT_TRUE(a == b);
+    }
+
+    // 64-bit keys with payload, sort must be stable
+    {
+        static const size_t N = 100000;
+
+        std::vector<uint64_t> keys(N);
+        std::vector<int> values(N);
+        for (size_t i = 0; i < N; ++i)
+        {
+            keys[i] = static_cast<uint64_t>(rand() % 1000) << 40;
+            values[i] = static_cast<int>(i);
+        }
+
+        std::vector<std::pair<uint64_t, int>> ref(N);
+        for (size_t i = 0; i < N; ++i)
+        {
+            ref[i] = { keys[i], values[i] };
+        }
+
+        paralgo::radix_sort(pool, keys.begin(), keys.end(), values.begin());
+        std::stable_sort(
+                ref.begin(),
+                ref.end(),
+                [](std::pair<uint64_t, int> const& x, std::pair<uint64_t, int> const& y)
+                {
+                    return x.first < y.first;
+                });
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            EXPECT_EQ(keys[i], ref[i].first);
+            EXPECT_EQ(values[i], ref[i].second);
+        }
+    }
+
+    // User defined struct, sorted by key function
+    {
+        struct my_struct
+        {
+            int id;
+            unsigned code;
+        };
+
+        static const size_t N = 100000;
+
+        std::vector<my_struct> a(N);
+        for (size_t i = 0; i < N; ++i)
+        {
+            a[i] = { static_cast<int>(i), static_cast<unsigned>(rand()) & 0x3FFFFFFF };
+        }
+
+        paralgo::radix_sort_by(pool, a.begin(), a.end(), [](my_struct const& s) { return s.code; }, 30);
+
+        for (size_t i = 1; i < N; ++i)
+        {
+            EXPECT_TRUE(a[i - 1].code < a[i].code || (a[i - 1].code == a[i].code && a[i - 1].id < a[i].id));
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Test reduce() and inclusive_scan()/exclusive_scan()
+//
+
+TEST(ParallelAlgorithm, ReduceScan)
+{
+    thread_pool pool(4);
+
+    for (size_t N : { size_t(0), size_t(1), size_t(100), size_t(1000000) })
+    {
+        std::vector<int> a(N);
+        for (size_t i = 0; i < N; ++i)
+        {
+            a[i] = rand() % 16;
+        }
+
+        // reduce
+        EXPECT_EQ(
+                paralgo::reduce(pool, a.begin(), a.end(), 7),
+                std::accumulate(a.begin(), a.end(), 7)
+                );
+
+        EXPECT_EQ(
+                paralgo::reduce(pool, a.begin(), a.end(), 0, [](int x, int y) { return std::max(x, y); }),
+                N > 0 ? *std::max_element(a.begin(), a.end()) : 0
+                );
+
+        // inclusive_scan
+        std::vector<int> inc(N);
+        std::vector<int> inc_ref(N);
+        paralgo::inclusive_scan(pool, a.begin(), a.end(), inc.begin());
+        std::partial_sum(a.begin(), a.end(), inc_ref.begin());
+        EXPECT_TRUE(inc == inc_ref);
+
+        // exclusive_scan
+        std::vector<int> exc(N);
+        paralgo::exclusive_scan(pool, a.begin(), a.end(), exc.begin(), 3);
+        for (size_t i = 0; i < N; ++i)
+        {
+            EXPECT_EQ(exc[i], 3 + inc_ref[i] - a[i]);
+        }
+
+        // In-place
+        paralgo::inclusive_scan(pool, a.begin(), a.end(), a.begin());
+        EXPECT_TRUE(a == inc_ref);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Test that floating point reduce() and inclusive_scan() results do not
+// depend on the number of threads
+//
+
+TEST(ParallelAlgorithm, Deterministic)
+{
+    static const size_t N = 1000000;
+
+    std::vector<float> a(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        a[i] = static_cast<float>(rand()) / RAND_MAX * 1000.0f;
+    }
+
+    float ref_sum = 0.0f;
+    std::vector<float> ref_scan(N);
+
+    for (unsigned num_threads : { 1U, 3U, 8U })
+    {
+        thread_pool pool(num_threads);
+
+        float sum = paralgo::reduce(pool, a.begin(), a.end(), 0.0f);
+
+        std::vector<float> scan(N);
+        paralgo::inclusive_scan(pool, a.begin(), a.end(), scan.begin());
+
+        if (num_threads == 1)
+        {
+            ref_sum = sum;
+            ref_scan = scan;
+        }
+        else
+        {
+            EXPECT_EQ(sum, ref_sum);
+            EXPECT_TRUE(scan == ref_scan);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Test partition() and copy_if()
+//
+
+TEST(ParallelAlgorithm, PartitionCopyIf)
+{
+    thread_pool pool(4);
+
+    static const size_t N = 1000000;
+
+    std::vector<int> a(N);
+    std::iota(a.begin(), a.end(), 0);
+
+    auto is_odd = [](int i) { return (i & 1) == 1; };
+
+    // copy_if
+    std::vector<int> b(N);
+    auto end = paralgo::copy_if(pool, a.begin(), a.end(), b.begin(), is_odd);
+    EXPECT_EQ(static_cast<size_t>(end - b.begin()), N / 2);
+
+    for (size_t i = 0; i < N / 2; ++i)
+    {
+        EXPECT_EQ(b[i], static_cast<int>(i * 2 + 1));
+    }
+
+    // partition
+    auto mid = paralgo::partition(pool, a.begin(), a.end(), is_odd);
+    EXPECT_EQ(static_cast<size_t>(mid - a.begin()), N / 2);
+    EXPECT_TRUE(std::is_partitioned(a.begin(), a.end(), is_odd));
+
+    // Stable
+    EXPECT_TRUE(std::is_sorted(a.begin(), mid));
+    EXPECT_TRUE(std::is_sorted(mid, a.end()));
+}
@@ -0,0 +1,318 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <visionaray/math/math.h>
+#include <visionaray/pinhole_camera.h>
+#include <visionaray/scheduler.h>
+#include <visionaray/simple_buffer_rt.h>
+
+#include <common/sched_profiler_io.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// Constant color in the left half of the image, uniform noise in [0..1)
+// in the right half. Adaptive sampling stops sampling the left half.
+struct half_noise_kernel
+{
+    template <typename R, typename Generator>
+    VSNRAY_FUNC
+    result_record<typename R::scalar_type> operator()(R ray, Generator& gen) const
+    {
+        using S = typename R::scalar_type;
+
+        result_record<S> result;
+        S noise = gen.next();
+        S value = select(ray.dir.x < S(0.0), S(0.5), noise);
+        result.color = vector<4, S>(value, value, value, S(1.0));
+        result.hit = ray.dir.x == ray.dir.x;
+        return result;
+    }
+};
+
+// The same kernel, invoked on whole tiles of single rays
+struct wavefront_half_noise_kernel
+{
+    using is_wavefront = void;
+
+    template <typename R, typename Generator>
+    void trace(
+            R                       /* */,
+            basic_ray<float> const* rays,
+            Generator*              gens,
+            result_record<float>*   results,
+            unsigned                count
+            ) const
+    {
+        for (unsigned i = 0; i < count; ++i)
+        {
+            results[i] = half_noise_kernel{}(rays[i], gens[i]);
+        }
+    }
+};
+
+using render_target_type = simple_buffer_rt<PF_RGBA32F, PF_UNSPECIFIED, PF_RGBA32F>;
+
+static uint64_t tile_area(tile_timing const& t)
+{
+    return static_cast<uint64_t>(t.x1 - t.x0) * (t.y1 - t.y0);
+}
+
+static std::vector<tile_timing> tiles_of_frame(sched_profiler const& prof, unsigned frame_id)
+{
+    std::vector<tile_timing> result;
+
+    for (auto const& t : prof.tiles())
+    {
+        if (t.frame_id == frame_id)
+        {
+            result.push_back(t);
+        }
+    }
+
+    return result;
+}
+
+static std::string read_file(char const* filename)
+{
+    std::ifstream file(filename);
+    std::stringstream str;
+    str << file.rdbuf();
+    return str.str();
+}
+
+static size_t count_occurrences(std::string const& str, std::string const& pattern)
+{
+    size_t count = 0;
+
+    for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1))
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+template <typename Kernel>
+static void test_profiler(Kernel kernel)
+{
+    // Width is no multiple of the tile or packet width
+    int const width = 62;
+    int const height = 32;
+    int const num_frames = 12;
+    unsigned const num_threads = 2;
+
+    render_target_type rt;
+    rt.resize(width, height);
+    rt.clear_accum_buffer();
+
+    pixel_sampler::adaptive_blend_type ps;
+    ps.spp = 2;
+    ps.threshold = 0.1f;
+    ps.min_samples = 8;
+
+    pinhole_camera cam;
+    cam.set_viewport(0, 0, width, height);
+    cam.perspective(45.0f * constants::degrees_to_radians<float>(), 1.0f, 0.1f, 100.0f);
+    cam.look_at(vec3(0.0f, 0.0f, 3.5f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+    sched_profiler prof;
+
+    tiled_sched<basic_ray<simd::float8>> sched(num_threads);
+    sched.set_profiler(&prof);
+
+    for (int i = 0; i < num_frames; ++i)
+    {
+        auto sparams = make_sched_params(ps, cam, rt);
+        sched.frame(kernel, sparams);
+    }
+
+    ASSERT_EQ(prof.frames().size(), static_cast<size_t>(num_frames));
+
+    unsigned first_frame = prof.frames().front().frame_id;
+    unsigned last_frame = prof.frames().back().frame_id;
+
+
+    // Records --------------------------------------------
+
+    for (auto const& f : prof.frames())
+    {
+        EXPECT_EQ(f.width, width);
+        EXPECT_EQ(f.height, height);
+        EXPECT_LE(f.begin, f.end);
+
+        auto tiles = tiles_of_frame(prof, f.frame_id);
+        ASSERT_EQ(tiles.size(), size_t(4 * 2));
+
+        uint64_t area = 0;
+
+        for (auto const& t : tiles)
+        {
+            EXPECT_LT(t.thread_index, num_threads);
+            EXPECT_LE(f.begin, t.begin);
+            EXPECT_LE(t.begin, t.end);
+            EXPECT_LE(t.end, f.end);
+
+            area += tile_area(t);
+        }
+
+        EXPECT_EQ(area, static_cast<uint64_t>(width * height));
+    }
+
+    // All tiles are sampled in the first frame
+    for (auto const& t : tiles_of_frame(prof, first_frame))
+    {
+        EXPECT_EQ(t.num_samples, tile_area(t) * ps.spp);
+    }
+
+    // Adaptive sampling skips the converged tiles in the left half
+    for (auto const& t : tiles_of_frame(prof, last_frame))
+    {
+        if (t.x1 <= width / 2)
+        {
+            EXPECT_EQ(t.num_samples, uint64_t(0));
+        }
+        else
+        {
+            EXPECT_EQ(t.num_samples, tile_area(t) * ps.spp);
+        }
+    }
+
+
+    // CSV ------------------------------------------------
+
+    char const* csv_filename = "sched_profiler_test.csv";
+    ASSERT_TRUE(save_tile_timings_csv(prof, csv_filename));
+
+    std::ifstream csv(csv_filename);
+    std::string line;
+
+    std::getline(csv, line);
+    EXPECT_EQ(line, "frame,x0,y0,x1,y1,thread,samples,begin_us,end_us,duration_us");
+
+    for (auto const& t : prof.tiles())
+    {
+        ASSERT_TRUE(static_cast<bool>(std::getline(csv, line)));
+
+        unsigned frame_id = 0;
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = 0;
+        int y1 = 0;
+        unsigned thread_index = 0;
+        unsigned long long num_samples = 0;
+        double begin = 0.0;
+        double end = 0.0;
+        double duration = 0.0;
+
+        int n = std::sscanf(
+                line.c_str(),
+                "%u,%d,%d,%d,%d,%u,%llu,%lf,%lf,%lf",
+                &frame_id,
+                &x0,
+                &y0,
+                &x1,
+                &y1,
+                &thread_index,
+                &num_samples,
+                &begin,
+                &end,
+                &duration
+                );
+
+        ASSERT_EQ(n, 10);
+        EXPECT_EQ(frame_id, t.frame_id);
+        EXPECT_EQ(x0, t.x0);
+        EXPECT_EQ(y0, t.y0);
+        EXPECT_EQ(x1, t.x1);
+        EXPECT_EQ(y1, t.y1);
+        EXPECT_EQ(thread_index, t.thread_index);
+        EXPECT_EQ(num_samples, t.num_samples);
+        EXPECT_NEAR(begin, t.begin * 1000000.0, 0.001);
+        EXPECT_NEAR(end, t.end * 1000000.0, 0.001);
+    }
+
+    EXPECT_FALSE(static_cast<bool>(std::getline(csv, line)));
+
+    csv.close();
+    std::remove(csv_filename);
+
+
+    // Chrome trace ---------------------------------------
+
+    char const* trace_filename = "sched_profiler_test.json";
+    ASSERT_TRUE(save_tile_timings_chrome_trace(prof, trace_filename));
+
+    std::string trace = read_file(trace_filename);
+    std::remove(trace_filename);
+
+    EXPECT_EQ(trace.find("{\"traceEvents\":["), size_t(0));
+    EXPECT_NE(trace.find("],\"displayTimeUnit\":\"ms\"}"), std::string::npos);
+    EXPECT_EQ(count_occurrences(trace, "\"cat\":\"frame\""), prof.frames().size());
+    EXPECT_EQ(count_occurrences(trace, "\"cat\":\"tile\""), prof.tiles().size());
+
+    size_t num_skipped = 0;
+
+    for (auto const& t : prof.tiles())
+    {
+        num_skipped += t.num_samples == 0 ? 1 : 0;
+    }
+
+    EXPECT_GT(num_skipped, size_t(0));
+    EXPECT_EQ(count_occurrences(trace, "\"samples\":0}"), num_skipped);
+
+
+    // Heat map -------------------------------------------
+
+    aligned_vector<float> times;
+    int heat_map_width = 0;
+    int heat_map_height = 0;
+
+    ASSERT_TRUE(make_tile_heat_map(prof, last_frame, times, heat_map_width, heat_map_height));
+    ASSERT_EQ(heat_map_width, width);
+    ASSERT_EQ(heat_map_height, height);
+
+    for (auto const& t : tiles_of_frame(prof, last_frame))
+    {
+        float expected = static_cast<float>((t.end - t.begin) * 1000000.0 / tile_area(t));
+
+        for (int y = t.y0; y < t.y1; ++y)
+        {
+            for (int x = t.x0; x < t.x1; ++x)
+            {
+                EXPECT_FLOAT_EQ(times[y * width + x], expected);
+            }
+        }
+    }
+
+    EXPECT_FALSE(make_tile_heat_map(prof, last_frame + 1, times, heat_map_width, heat_map_height));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Test tiled_sched w/ a profiler attached
+//
+
+TEST(SchedProfiler, Packets)
+{
+    test_profiler(half_noise_kernel{});
+}
+
+TEST(SchedProfiler, Wavefront)
+{
+    test_profiler(wavefront_half_noise_kernel{});
+}
@@ -0,0 +1,117 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <visionaray/detail/parallel_for.h>
+#include <visionaray/detail/scratch_arena.h>
+#include <visionaray/detail/thread_pool.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Test scratch_arena allocation and reset
+//
+
+TEST(ScratchArena, Allocate)
+{
+    scratch_arena arena(1024);
+
+    void* first = arena.allocate(16);
+
+    // Alignment is respected
+    for (size_t align = 1; align <= 256; align *= 2)
+    {
+        void* ptr = arena.allocate(3, align);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % align, uintptr_t(0));
+    }
+
+    // Typed allocations
+    float* f = arena.allocate<float>(100);
+    for (int i = 0; i < 100; ++i)
+    {
+        f[i] = static_cast<float>(i);
+    }
+    EXPECT_FLOAT_EQ(f[99], 99.0f);
+
+    // Oversized allocations get their own block
+    char* big = arena.allocate<char>(4096);
+    EXPECT_TRUE(big != nullptr);
+    EXPECT_GE(arena.capacity(), size_t(4096));
+
+    // After reset, blocks are reused and no memory is reserved
+    size_t cap = arena.capacity();
+    arena.reset();
+    EXPECT_EQ(arena.allocate(16), first);
+    EXPECT_EQ(arena.capacity(), cap);
+
+    arena.release();
+    EXPECT_EQ(arena.capacity(), size_t(0));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Test scratch_allocator with STL containers
+//
+
+TEST(ScratchArena, Allocator)
+{
+    scratch_arena arena;
+
+    std::vector<int, scratch_allocator<int>> v{scratch_allocator<int>(arena)};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        v.push_back(i);
+    }
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(v[i], i);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Test that thread_pool workers are bound to distinct arenas
+//
+
+TEST(ScratchArena, ThreadPool)
+{
+    static const unsigned NumThreads = 4;
+    static const int N = 1024;
+
+    thread_pool pool(NumThreads);
+
+    std::vector<scratch_arena*> arenas(N);
+
+    parallel_for(
+        pool,
+        range1d<int>(0, N),
+        [&](int i)
+        {
+            arenas[i] = &this_thread_scratch_arena();
+        });
+
+    for (int i = 0; i < N; ++i)
+    {
+        bool found = false;
+        for (unsigned t = 0; t < NumThreads; ++t)
+        {
+            found |= arenas[i] == &pool.get_scratch_arena(t);
+        }
+        EXPECT_TRUE(found);
+    }
+
+    // The main thread uses its own fallback arena
+    scratch_arena* main_arena = &this_thread_scratch_arena();
+    for (unsigned t = 0; t < NumThreads; ++t)
+    {
+        EXPECT_NE(main_arena, &pool.get_scratch_arena(t));
+    }
+}
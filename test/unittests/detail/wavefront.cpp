@@ -0,0 +1,348 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include <visionaray/math/math.h>
+#include <visionaray/aligned_vector.h>
+#include <visionaray/area_light.h>
+#include <visionaray/bvh.h>
+#include <visionaray/generic_material.h>
+#include <visionaray/get_normal.h>
+#include <visionaray/kernels.h>
+#include <visionaray/material.h>
+#include <visionaray/pinhole_camera.h>
+#include <visionaray/scheduler.h>
+#include <visionaray/simple_buffer_rt.h>
+#include <visionaray/detail/wavefront.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Test scene: closed box with an area light at the ceiling and a few
+// plastic fins standing on the floor
+//
+
+using triangle_type = basic_triangle<3, float>;
+using material_type = generic_material<matte<float>, emissive<float>, plastic<float>>;
+
+struct test_scene
+{
+    aligned_vector<triangle_type> triangles;
+    aligned_vector<vec3> normals;
+    aligned_vector<material_type> materials;
+    aligned_vector<area_light<float, triangle_type>> lights;
+
+    index_bvh<triangle_type> bvh;
+    aligned_vector<index_bvh<triangle_type>::bvh_ref> refs;
+
+    pinhole_camera cam;
+
+    void add_quad(vec3 a, vec3 b, vec3 c, vec3 d, unsigned geom_id)
+    {
+        triangle_type t1(a, b - a, c - a);
+        t1.prim_id = static_cast<unsigned>(triangles.size());
+        t1.geom_id = geom_id;
+        triangles.push_back(t1);
+
+        triangle_type t2(a, c - a, d - a);
+        t2.prim_id = static_cast<unsigned>(triangles.size());
+        t2.geom_id = geom_id;
+        triangles.push_back(t2);
+    }
+
+    explicit test_scene(int width, int height)
+    {
+        add_quad(vec3(-1.0f, -1.0f, -1.0f), vec3( 1.0f, -1.0f, -1.0f), vec3( 1.0f, -1.0f,  1.0f), vec3(-1.0f, -1.0f,  1.0f), 0);
+        add_quad(vec3(-1.0f,  1.0f, -1.0f), vec3(-1.0f,  1.0f,  1.0f), vec3( 1.0f,  1.0f,  1.0f), vec3( 1.0f,  1.0f, -1.0f), 0);
+        add_quad(vec3(-1.0f, -1.0f, -1.0f), vec3(-1.0f,  1.0f, -1.0f), vec3( 1.0f,  1.0f, -1.0f), vec3( 1.0f, -1.0f, -1.0f), 0);
+        add_quad(vec3(-1.0f, -1.0f, -1.0f), vec3(-1.0f, -1.0f,  1.0f), vec3(-1.0f,  1.0f,  1.0f), vec3(-1.0f,  1.0f, -1.0f), 2);
+        add_quad(vec3( 1.0f, -1.0f, -1.0f), vec3( 1.0f,  1.0f, -1.0f), vec3( 1.0f,  1.0f,  1.0f), vec3( 1.0f, -1.0f,  1.0f), 0);
+
+        // Light
+        add_quad(vec3(-0.3f, 0.99f, -0.3f), vec3(-0.3f, 0.99f, 0.3f), vec3(0.3f, 0.99f, 0.3f), vec3(0.3f, 0.99f, -0.3f), 1);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            float x = -0.8f + 0.16f * i;
+            add_quad(vec3(x, -1.0f, 0.0f), vec3(x + 0.1f, -1.0f, 0.0f), vec3(x + 0.1f, -0.2f, 0.1f), vec3(x, -0.2f, 0.1f), 2);
+        }
+
+        for (auto const& t : triangles)
+        {
+            normals.push_back(normalize(cross(t.e1, t.e2)));
+        }
+
+        matte<float> white;
+        white.ca() = from_rgb(vec3(0.0f));
+        white.cd() = from_rgb(vec3(0.7f));
+        white.ka() = 0.0f;
+        white.kd() = 1.0f;
+
+        emissive<float> light;
+        light.ce() = from_rgb(vec3(1.0f));
+        light.ls() = 8.0f;
+
+        plastic<float> red;
+        red.ca() = from_rgb(vec3(0.0f));
+        red.cd() = from_rgb(vec3(0.8f, 0.2f, 0.2f));
+        red.cs() = from_rgb(vec3(0.3f));
+        red.ka() = 0.0f;
+        red.kd() = 1.0f;
+        red.ks() = 1.0f;
+        red.specular_exp() = 32.0f;
+
+        materials.push_back(white);
+        materials.push_back(light);
+        materials.push_back(red);
+
+        for (auto const& t : triangles)
+        {
+            if (t.geom_id == 1)
+            {
+                area_light<float, triangle_type> al(t);
+                al.set_cl(vec3(1.0f));
+                al.set_kl(8.0f);
+                lights.push_back(al);
+            }
+        }
+
+        binned_sah_builder builder;
+        bvh = builder.build(index_bvh<triangle_type>{}, triangles.data(), triangles.size());
+        refs.push_back(bvh.ref());
+
+        cam.set_viewport(0, 0, width, height);
+        cam.perspective(45.0f * constants::degrees_to_radians<float>(), 1.0f, 0.1f, 100.0f);
+        cam.look_at(vec3(0.0f, 0.0f, 3.5f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    auto kernel_params()
+        -> decltype(make_kernel_params(
+                normals_per_face_binding{},
+                refs.data(),
+                refs.data(),
+                normals.data(),
+                normals.data(),
+                materials.data(),
+                lights.data(),
+                lights.data()
+                ))
+    {
+        return make_kernel_params(
+                normals_per_face_binding{},
+                refs.data(),
+                refs.data() + refs.size(),
+                normals.data(),
+                normals.data(),
+                materials.data(),
+                lights.data(),
+                lights.data() + lights.size(),
+                4,                  // bounces
+                1e-4f,              // epsilon
+                vec4(0.0f),         // background
+                vec4(0.1f)          // ambient
+                );
+    }
+};
+
+using rt_type = simple_buffer_rt<PF_RGBA32F, PF_UNSPECIFIED>;
+
+// Average the color buffers of several frames
+template <typename Sched, typename Kernel>
+static aligned_vector<vec4> render(Sched& sched, Kernel kernel, test_scene const& scene, int width, int height, int frames)
+{
+    rt_type rt;
+    rt.resize(width, height);
+
+    aligned_vector<vec4> result(width * height, vec4(0.0f));
+
+    for (int f = 0; f < frames; ++f)
+    {
+        sched.frame(kernel, make_sched_params(pixel_sampler::jittered_type{}, scene.cam, rt));
+
+        for (int i = 0; i < width * height; ++i)
+        {
+            result[i] += rt.color()[i] / static_cast<float>(frames);
+        }
+    }
+
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Test gather_lanes() and scatter_lanes()
+//
+
+TEST(Wavefront, GatherScatter)
+{
+    aligned_vector<vec3> values(6);
+    unsigned queue[] = { 5, 3, 1 };
+
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = vec3(static_cast<float>(i));
+    }
+
+    auto v = detail::gather_lanes<simd::float4>(3, [&](unsigned i) { return values[queue[i]]; });
+    auto lanes = detail::unpack_lanes(v);
+
+    EXPECT_FLOAT_EQ(lanes[0].x, 5.0f);
+    EXPECT_FLOAT_EQ(lanes[1].y, 3.0f);
+    EXPECT_FLOAT_EQ(lanes[2].z, 1.0f);
+    EXPECT_FLOAT_EQ(lanes[3].x, 1.0f); // padded with last valid lane
+
+    auto valid = detail::unpack_mask(detail::valid_lanes<simd::float4>(3));
+    EXPECT_TRUE(valid[0]);
+    EXPECT_TRUE(valid[2]);
+    EXPECT_FALSE(valid[3]);
+
+    // Only valid lanes are written back
+    unsigned num_written = 0;
+    detail::scatter_lanes(3, v * simd::float4(2.0f), [&](unsigned i, vec3 const& x)
+    {
+        values[queue[i]] = x;
+        ++num_written;
+    });
+
+    EXPECT_EQ(num_written, 3U);
+    EXPECT_FLOAT_EQ(values[5].x, 10.0f);
+    EXPECT_FLOAT_EQ(values[3].x, 6.0f);
+    EXPECT_FLOAT_EQ(values[1].x, 2.0f);
+    EXPECT_FLOAT_EQ(values[0].x, 0.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Test material_sort_key() and with_simd_material()
+//
+
+// Material without a SIMD type
+template <typename T>
+struct scalar_only_material
+{
+    using scalar_type = T;
+};
+
+TEST(Wavefront, SimdMaterial)
+{
+    using M = generic_material<matte<float>, plastic<float>, scalar_only_material<float>>;
+
+    M mat1 = matte<float>();
+    M mat2 = plastic<float>();
+    M mat3 = scalar_only_material<float>();
+
+    // Keys group by material type first, then by index
+    EXPECT_LT(detail::material_sort_key(mat1, 7), detail::material_sort_key(mat2, 0));
+    EXPECT_LT(detail::material_sort_key(mat2, 0), detail::material_sort_key(mat2, 1));
+    EXPECT_LT(detail::material_sort_key(mat2, 1), detail::material_sort_key(mat3, 0));
+    EXPECT_NE(detail::material_sort_key(mat1, 0), 0U);
+
+    plastic<float> p;
+    p.cd() = from_rgb(vec3(0.5f));
+    p.kd() = 0.75f;
+    mat2 = p;
+
+    int num_calls = 0;
+
+    auto func = [&](auto const& mat4)
+    {
+        using M4 = typename std::decay<decltype(mat4)>::type;
+        EXPECT_TRUE((std::is_same<M4, plastic<simd::float4>>::value));
+
+        auto kd = detail::unpack_lanes(mat4.kd());
+
+        for (int i = 0; i < 4; ++i)
+        {
+            EXPECT_FLOAT_EQ(kd[i], 0.75f);
+        }
+
+        ++num_calls;
+    };
+
+    EXPECT_TRUE(detail::with_simd_material<simd::float4>(mat2, func));
+    EXPECT_TRUE(detail::with_simd_material<simd::float4>(p, func));
+    EXPECT_EQ(num_calls, 2);
+
+    // No SIMD type
+    EXPECT_FALSE(detail::with_simd_material<simd::float4>(mat3, func));
+    EXPECT_EQ(num_calls, 2);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Packet width only affects which packets are material-coherent (and
+// are thus shaded with SIMD instead of per-lane code), the estimate
+// must be the same
+//
+
+TEST(Wavefront, PacketWidthIndependent)
+{
+    int width = 32;
+    int height = 32;
+    int frames = 16;
+
+    test_scene scene(width, height);
+    auto kparams = scene.kernel_params();
+    pathtracing::wavefront_kernel<decltype(kparams)> kernel{kparams};
+
+    tiled_sched<basic_ray<simd::float4>> sched4(2);
+    tiled_sched<basic_ray<simd::float8>> sched8(2);
+
+    auto img4 = render(sched4, kernel, scene, width, height, frames);
+    auto img8 = render(sched8, kernel, scene, width, height, frames);
+
+    double mean4 = 0.0;
+    double mean8 = 0.0;
+
+    for (int i = 0; i < width * height; ++i)
+    {
+        EXPECT_FLOAT_EQ(img4[i].w, img8[i].w);
+
+        mean4 += img4[i].x + img4[i].y + img4[i].z;
+        mean8 += img8[i].x + img8[i].y + img8[i].z;
+    }
+
+    EXPECT_GT(mean4, 0.0);
+    EXPECT_NEAR(mean8 / mean4, 1.0, 0.02);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Wavefront and megakernel compute the same estimate
+//
+
+TEST(Wavefront, MatchesMegakernel)
+{
+    int width = 32;
+    int height = 32;
+    int frames = 64;
+
+    test_scene scene(width, height);
+    auto kparams = scene.kernel_params();
+
+    tiled_sched<basic_ray<simd::float4>> sched(2);
+
+    auto mega = render(sched, pathtracing::kernel<decltype(kparams)>{kparams}, scene, width, height, frames);
+    auto wave = render(sched, pathtracing::wavefront_kernel<decltype(kparams)>{kparams}, scene, width, height, frames);
+
+    double mean_mega = 0.0;
+    double mean_wave = 0.0;
+
+    for (int i = 0; i < width * height; ++i)
+    {
+        // Background pixels and hit flags must match exactly
+        EXPECT_FLOAT_EQ(mega[i].w, wave[i].w);
+
+        mean_mega += mega[i].x + mega[i].y + mega[i].z;
+        mean_wave += wave[i].x + wave[i].y + wave[i].z;
+    }
+
+    EXPECT_GT(mean_mega, 0.0);
+    EXPECT_NEAR(mean_wave / mean_mega, 1.0, 0.02);
+}
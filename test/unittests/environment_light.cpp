@@ -0,0 +1,216 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <visionaray/math/simd/simd.h>
+#include <visionaray/math/math.h>
+#include <visionaray/texture/texture.h>
+#include <visionaray/array.h>
+#include <visionaray/environment_light.h>
+#include <visionaray/random_generator.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+using env_light_type = environment_light<float, texture_ref<vec4, 2>>;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// Dim environment w/ one bright spot
+static texture<vec4, 2> make_env_map(int width, int height)
+{
+    std::vector<vec4> texels(width * height);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            float f = 0.1f + 0.05f * ((x + y) % 3);
+
+            if (x == width / 4 && y == height / 3)
+            {
+                f = 1000.0f;
+            }
+
+            texels[y * width + x] = vec4(f, f, f, 1.0f);
+        }
+    }
+
+    texture<vec4, 2> tex(width, height);
+    tex.set_address_mode(Clamp);
+    tex.set_filter_mode(Nearest);
+    tex.reset(texels.data());
+    return tex;
+}
+
+static env_light_type make_env_light(texture<vec4, 2> const& tex, environment_map_distribution const& dist)
+{
+    env_light_type light;
+    light.texture() = texture_ref<vec4, 2>(tex);
+    light.scale() = from_rgb(vec3(1.0f));
+    light.set_light_to_world_transform(mat4::rotation(normalize(vec3(1.0f, 2.0f, 3.0f)), 0.7f));
+    light.set_distribution(dist.ref());
+    return light;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// sample() reports the pdf that pdf() computes for the sampled direction
+//
+
+TEST(EnvironmentLight, SampleMatchesPdf)
+{
+    auto tex = make_env_map(64, 32);
+    environment_map_distribution dist(tex);
+    auto light = make_env_light(tex, dist);
+
+    ASSERT_TRUE(light.importance_sampled());
+
+    random_generator<float> gen(0);
+
+    // Directions close to texel borders may map back to the neighbor
+    int const num_samples = 10000;
+    int mismatches = 0;
+
+    for (int i = 0; i < num_samples; ++i)
+    {
+        auto ls = light.sample(vec3(0.0f), gen);
+
+        ASSERT_GT(ls.pdf, 0.0f);
+        EXPECT_NEAR(length(ls.dir), 1.0f, 1e-5f);
+        EXPECT_TRUE(std::isinf(ls.dist));
+
+        if (std::abs(ls.pdf - light.pdf(ls.dir)) > ls.pdf * 1e-2f)
+        {
+            ++mismatches;
+        }
+    }
+
+    EXPECT_LT(mismatches, num_samples / 1000);
+
+    // Lights w/o distribution are not importance sampled
+    env_light_type unsampled;
+    unsampled.texture() = texture_ref<vec4, 2>(tex);
+    unsampled.set_light_to_world_transform(mat4::identity());
+
+    EXPECT_FALSE(unsampled.importance_sampled());
+    EXPECT_FLOAT_EQ(unsampled.pdf(vec3(0.0f, 1.0f, 0.0f)), 0.0f);
+    EXPECT_FLOAT_EQ(unsampled.sample(vec3(0.0f), gen).pdf, 0.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The pdf integrates to one over the sphere, the importance sampled
+// estimate of the integral over the environment converges
+//
+
+TEST(EnvironmentLight, Integral)
+{
+    auto tex = make_env_map(64, 32);
+    environment_map_distribution dist(tex);
+    auto light = make_env_light(tex, dist);
+
+    // Reference: sum over texels times their solid angle
+    int width = 64;
+    int height = 32;
+
+    double reference = 0.0;
+
+    for (int y = 0; y < height; ++y)
+    {
+        double theta0 = constants::pi<double>() * y / height;
+        double theta1 = constants::pi<double>() * (y + 1) / height;
+        double solid_angle = constants::two_pi<double>() / width * (std::cos(theta0) - std::cos(theta1));
+
+        for (int x = 0; x < width; ++x)
+        {
+            reference += tex.data()[y * width + x].x * solid_angle;
+        }
+    }
+
+    // The pdf integrates to one, evaluated at texel centers
+    double pdf_integral = 0.0;
+
+    for (int y = 0; y < height; ++y)
+    {
+        double theta0 = constants::pi<double>() * y / height;
+        double theta1 = constants::pi<double>() * (y + 1) / height;
+        double solid_angle = constants::two_pi<double>() / width * (std::cos(theta0) - std::cos(theta1));
+
+        float theta = constants::pi<float>() * (y + 0.5f) / height;
+
+        for (int x = 0; x < width; ++x)
+        {
+            float phi = constants::two_pi<float>() * (x + 0.5f) / width;
+            vec3 d(std::sin(theta) * std::sin(phi), std::cos(theta), std::sin(theta) * std::cos(phi));
+            vec3 dir = (light.light_to_world_transform() * vec4(d, 0.0f)).xyz();
+
+            pdf_integral += light.pdf(dir) * solid_angle;
+        }
+    }
+
+    EXPECT_NEAR(pdf_integral, 1.0, 1e-3);
+
+    // Importance sampled estimate
+    random_generator<float> gen(1);
+
+    int const num_samples = 1 << 18;
+
+    double estimate = 0.0;
+
+    for (int i = 0; i < num_samples; ++i)
+    {
+        auto ls = light.sample(vec3(0.0f), gen);
+        estimate += ls.intensity.x / ls.pdf / num_samples;
+    }
+
+    EXPECT_NEAR(estimate / reference, 1.0, 0.02);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// SIMD samples match the scalar ones lane by lane
+//
+
+TEST(EnvironmentLight, SIMD)
+{
+    auto tex = make_env_map(32, 16);
+    environment_map_distribution dist(tex);
+    auto light = make_env_light(tex, dist);
+
+    using S = simd::float4;
+
+    array<unsigned, 4> seeds = {{ 1, 2, 3, 4 }};
+    random_generator<S> gen1(seeds);
+    random_generator<S> gen2(seeds);
+
+    for (int iter = 0; iter < 64; ++iter)
+    {
+        auto ls = light.sample(vector<3, S>(S(0.0f)), gen1);
+        auto pdf = light.pdf(ls.dir);
+
+        simd::aligned_array_t<S> pdfs;
+        store(pdfs, ls.pdf);
+
+        simd::aligned_array_t<S> pdfs2;
+        store(pdfs2, pdf);
+
+        simd::aligned_array_t<S> dir_x;
+        store(dir_x, ls.dir.x);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            auto ls1 = light.sample(vec3(0.0f), gen2.get_generator(i));
+            EXPECT_NEAR(pdfs[i], ls1.pdf, ls1.pdf * 1e-3f);
+            EXPECT_NEAR(pdfs2[i], ls1.pdf, ls1.pdf * 1e-2f);
+            EXPECT_NEAR(dir_x[i], ls1.dir.x, 1e-4f);
+        }
+    }
+}
@@ -1,8 +1,12 @@
 // This file is distributed under the MIT license.
 // See the LICENSE file for details.
 
+#include <visionaray/math/simd/simd.h>
 #include <visionaray/array.h>
 #include <visionaray/generic_material.h>
+#include <visionaray/random_generator.h>
+#include <visionaray/shade_record.h>
+#include <visionaray/surface_interaction.h>
 
 #include <gtest/gtest.h>
 
@@ -31,6 +35,40 @@ struct cast_visitor
 };
 
 
+// Material without a SIMD type, evaluated lane by lane
+template <typename T>
+struct scalar_only_material
+{
+    using scalar_type = T;
+
+    spectrum<T> ambient() const
+    {
+        return spectrum<T>(0.5f);
+    }
+
+    template <typename SR>
+    spectrum<T> shade(SR const& sr) const
+    {
+        return spectrum<T>(sr.normal.x + 2.0f);
+    }
+
+    template <typename SR, typename U, typename Interaction, typename Generator>
+    spectrum<U> sample(SR const& sr, vector<3, U>& refl_dir, U& pdf, Interaction& inter, Generator& gen) const
+    {
+        refl_dir = sr.normal;
+        pdf = gen.next() + 1.0f;
+        inter = surface_interaction::Unspecified;
+        return spectrum<U>(3.0f);
+    }
+
+    template <typename SR, typename Interaction>
+    T pdf(SR const&, Interaction const&) const
+    {
+        return T(4.0f);
+    }
+};
+
+
 //-------------------------------------------------------------------------------------------------
 // Test simd::(un)pack()
 //
@@ -118,3 +156,151 @@ TEST(GenericMaterial, SIMD)
     }
     EXPECT_FLOAT_EQ( m4.ls(), em.ls() );
 }
+
+
+//-------------------------------------------------------------------------------------------------
+// Test masked SIMD dispatch, must match per-lane evaluation
+//
+
+TEST(GenericMaterial, MaskedDispatch)
+{
+    using S = simd::float4;
+
+    using material_type = generic_material<
+        plastic<float>,
+        mirror<float>,
+        matte<float>,
+        scalar_only_material<float>
+        >;
+
+    plastic<float> pl1;
+    pl1.ca() = from_rgb(vec3(0.1f));
+    pl1.cd() = from_rgb(vec3(0.0f, 0.1f, 0.2f));
+    pl1.cs() = from_rgb(vec3(0.0f, 0.2f, 0.4f));
+    pl1.ka() = 1.0f;
+    pl1.kd() = 1.0f;
+    pl1.ks() = 0.5f;
+    pl1.specular_exp() = 16.0f;
+
+    plastic<float> pl2 = pl1;
+    pl2.cd() = from_rgb(vec3(0.8f, 0.1f, 0.1f));
+    pl2.specular_exp() = 64.0f;
+
+    matte<float> ma;
+    ma.ca() = from_rgb(vec3(0.2f));
+    ma.cd() = from_rgb(vec3(1.0f, 0.0f, 0.0f));
+    ma.ka() = 1.0f;
+    ma.kd() = 1.0f;
+
+    mirror<float> mi;
+    mi.cr() = from_rgb(vec3(1.0f));
+    mi.kr() = 1.0f;
+    mi.ior() = spectrum<float>(1.34f);
+    mi.absorption() = spectrum<float>(0.0f);
+
+    array<material_type, 4> mats{{
+            material_type(pl1),
+            material_type(ma),
+            material_type(pl2),
+            material_type(scalar_only_material<float>())
+            }};
+
+    auto simd_material = simd::pack(mats);
+
+    array<shade_record<float>, 4> srs;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        srs[i].normal = normalize(vec3(0.1f * i, 1.0f, 0.0f));
+        srs[i].geometric_normal = vec3(0.0f, 1.0f, 0.0f);
+        srs[i].view_dir = normalize(vec3(0.3f, 1.0f, 0.2f * i));
+        srs[i].tex_color = vec3(1.0f);
+        srs[i].light_dir = normalize(vec3(-0.3f, 1.0f, 0.1f * i));
+        srs[i].light_intensity = vec3(1.0f);
+    }
+
+    array<vec3, 4> ns;
+    array<vec3, 4> gns;
+    array<vec3, 4> vds;
+    array<vec3, 4> lds;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        ns[i] = srs[i].normal;
+        gns[i] = srs[i].geometric_normal;
+        vds[i] = srs[i].view_dir;
+        lds[i] = srs[i].light_dir;
+    }
+
+    shade_record<S> sr;
+    sr.normal = simd::pack(ns);
+    sr.geometric_normal = simd::pack(gns);
+    sr.view_dir = simd::pack(vds);
+    sr.tex_color = vector<3, S>(1.0f);
+    sr.light_dir = simd::pack(lds);
+    sr.light_intensity = vector<3, S>(1.0f);
+
+    // ambient(), shade() and pdf()
+
+    auto amb = simd::unpack(simd_material.ambient().samples());
+    auto shaded = simd::unpack(simd_material.shade(sr).samples());
+
+    simd::int_type_t<S> inter(surface_interaction::Diffuse);
+    simd::aligned_array_t<S> pdfs;
+    simd::store(pdfs, simd_material.pdf(sr, inter));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        auto amb_ref = mats[i].ambient();
+        auto shaded_ref = mats[i].shade(srs[i]);
+        float pdf_ref = mats[i].pdf(srs[i], int(surface_interaction::Diffuse));
+
+        for (int j = 0; j < spectrum<float>::num_samples; ++j)
+        {
+            EXPECT_FLOAT_EQ(amb[i][j], amb_ref[j]);
+            EXPECT_NEAR(shaded[i][j], shaded_ref[j], 1e-5f);
+        }
+
+        EXPECT_NEAR(pdfs[i], pdf_ref, 1e-5f);
+    }
+
+    // sample(): only mirror is deterministic, check interactions
+
+    mats[1] = material_type(mi);
+    simd_material = simd::pack(mats);
+
+    random_generator<S> gen;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        gen.get_generator(i) = random_generator<float>(i);
+    }
+
+    vector<3, S> refl_dir;
+    S pdf;
+    simd::int_type_t<S> sampled_inter;
+    simd_material.sample(sr, refl_dir, pdf, sampled_inter, gen);
+
+    auto rds = simd::unpack(refl_dir);
+    simd::aligned_array_t<simd::int_type_t<S>> inters;
+    simd::store(inters, sampled_inter);
+    simd::store(pdfs, pdf);
+
+    random_generator<float> gen1(1);
+    vec3 rd_ref;
+    float pdf_ref = 0.0f;
+    int inter_ref = 0;
+    mats[1].sample(srs[1], rd_ref, pdf_ref, inter_ref, gen1);
+
+    EXPECT_EQ(inters[1], inter_ref);
+    EXPECT_FLOAT_EQ(pdfs[1], pdf_ref);
+    EXPECT_NEAR(rds[1].x, rd_ref.x, 1e-5f);
+    EXPECT_NEAR(rds[1].y, rd_ref.y, 1e-5f);
+    EXPECT_NEAR(rds[1].z, rd_ref.z, 1e-5f);
+
+    EXPECT_TRUE(inters[0] == surface_interaction::Diffuse || inters[0] == surface_interaction::GlossyReflection);
+    EXPECT_TRUE(inters[2] == surface_interaction::Diffuse || inters[2] == surface_interaction::GlossyReflection);
+    EXPECT_EQ(inters[3], surface_interaction::Unspecified);
+    EXPECT_GE(pdfs[3], 1.0f);
+    EXPECT_NEAR(rds[3].x, srs[3].normal.x, 1e-6f);
+}
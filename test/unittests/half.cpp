@@ -0,0 +1,439 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include <visionaray/detail/pixel_access.h>
+#include <visionaray/math/math.h>
+#include <visionaray/texture/texture.h>
+#include <visionaray/aligned_vector.h>
+#include <visionaray/pixel_traits.h>
+
+#include <gtest/gtest.h>
+
+#include "texture_helpers.h"
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+static half make_half(uint16_t bits)
+{
+    half h;
+    h.value = bits;
+    return h;
+}
+
+static uint32_t float_bits(float f)
+{
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+// Interesting floats: specials, boundaries and random values over the whole range
+static std::vector<float> test_floats()
+{
+    std::vector<float> result = {
+            0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 65504.0f, -65504.0f, 65519.0f, 65520.0f, 1e6f,
+            std::ldexp(1.0f, -14), std::ldexp(1.0f, -24), std::ldexp(1.0f, -25), std::ldexp(1.5f, -25),
+            std::ldexp(1.0f, -26), 1.0f + std::ldexp(1.0f, -11), 1.0f + std::ldexp(3.0f, -11),
+            std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+            std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max()
+            };
+
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<uint32_t> dist;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        uint32_t u = dist(rng);
+
+        // Concentrate on exponents that map to halfs
+        u = (u & 0x807FFFFFU) | ((100U + (u >> 23) % 50U) << 23);
+
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        result.push_back(f);
+    }
+
+    return result;
+}
+
+template <typename F>
+static float first_lane(F const& f)
+{
+    simd::aligned_array_t<F> lanes;
+    store(lanes, f);
+    return lanes[0];
+}
+
+static float first_lane(float f)
+{
+    return f;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Conversions to half round to nearest even, conversions to float are exact
+//
+
+TEST(Half, Conversion)
+{
+    EXPECT_EQ(half(0.0f).value, 0x0000);
+    EXPECT_EQ(half(-0.0f).value, 0x8000);
+    EXPECT_EQ(half(1.0f).value, 0x3C00);
+    EXPECT_EQ(half(-2.0f).value, 0xC000);
+    EXPECT_EQ(half(65504.0f).value, 0x7BFF);
+
+    // Subnormals
+    EXPECT_EQ(half(std::ldexp(1.0f, -14)).value, 0x0400);
+    EXPECT_EQ(half(std::ldexp(1.0f, -24)).value, 0x0001);
+    EXPECT_EQ(half(std::ldexp(1.0f, -25)).value, 0x0000);
+    EXPECT_EQ(half(std::ldexp(1.5f, -25)).value, 0x0001);
+
+    // Ties to even
+    EXPECT_EQ(half(1.0f + std::ldexp(1.0f, -11)).value, 0x3C00);
+    EXPECT_EQ(half(1.0f + std::ldexp(3.0f, -11)).value, 0x3C02);
+
+    // Overflow
+    EXPECT_EQ(half(65519.0f).value, 0x7BFF);
+    EXPECT_EQ(half(65520.0f).value, 0x7C00);
+    EXPECT_EQ(half(std::numeric_limits<float>::infinity()).value, 0x7C00);
+    EXPECT_EQ(half(-std::numeric_limits<float>::infinity()).value, 0xFC00);
+    EXPECT_TRUE(std::isnan(static_cast<float>(half(std::numeric_limits<float>::quiet_NaN()))));
+
+    EXPECT_FLOAT_EQ(static_cast<float>(make_half(0x3555)), 0.333251953125f);
+    EXPECT_FLOAT_EQ(static_cast<float>(make_half(0x0001)), std::ldexp(1.0f, -24));
+    EXPECT_FLOAT_EQ(static_cast<float>(make_half(0x03FF)), std::ldexp(1023.0f, -24));
+    EXPECT_EQ(static_cast<float>(make_half(0xFC00)), -std::numeric_limits<float>::infinity());
+
+    // Round trip all halfs, compare w/ the software implementation
+    for (uint32_t i = 0; i < 0x10000; ++i)
+    {
+        uint16_t bits = static_cast<uint16_t>(i);
+        float f = make_half(bits);
+
+        if (std::isnan(f))
+        {
+            // Hardware conversions may quiet signaling NaNs
+            EXPECT_EQ(bits & 0x7C00, 0x7C00);
+            EXPECT_TRUE(std::isnan(detail::half_to_float_soft(bits)));
+        }
+        else
+        {
+            EXPECT_EQ(float_bits(f), float_bits(detail::half_to_float_soft(bits)));
+            EXPECT_EQ(half(f).value, bits);
+        }
+    }
+
+    // Hardware and software conversions agree
+    for (float f : test_floats())
+    {
+        EXPECT_EQ(half(f).value, detail::float_to_half_soft(f));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// SIMD conversions match the scalar ones
+//
+
+template <typename F>
+static void test_simd_conversion()
+{
+    using I = simd::int_type_t<F>;
+    static const int N = simd::num_elements<F>::value;
+
+    auto floats = test_floats();
+
+    for (size_t i = 0; i + N <= floats.size(); i += N)
+    {
+        simd::aligned_array_t<F> in;
+        std::memcpy(&in[0], &floats[i], sizeof(in));
+
+        simd::aligned_array_t<I> bits;
+        store(bits, simd::float_to_half(F(in)));
+
+        simd::aligned_array_t<F> out;
+        store(out, simd::half_to_float(I(bits)));
+
+        for (int j = 0; j < N; ++j)
+        {
+            uint16_t expected = half(in[j]).value;
+
+            if ((expected & 0x7FFF) > 0x7C00)
+            {
+                // NaN, payloads may differ
+                EXPECT_EQ(bits[j] & 0xFFFF7C00, 0x7C00 | (expected & 0x8000));
+                EXPECT_TRUE(std::isnan(out[j]));
+            }
+            else
+            {
+                EXPECT_EQ(bits[j], expected);
+                EXPECT_EQ(float_bits(out[j]), float_bits(make_half(expected)));
+            }
+        }
+    }
+}
+
+TEST(Half, SIMDConversion)
+{
+    test_simd_conversion<simd::float4>();
+    test_simd_conversion<simd::float8>();
+    test_simd_conversion<simd::float16>();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Half textures filter like float textures w/ the same texels
+//
+
+TEST(Half, Texture)
+{
+    unsigned w = 37;
+    unsigned h = 23;
+
+    std::default_random_engine rng(0);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+
+    // Texels that are exactly representable as halfs
+    aligned_vector<float> data(w * h);
+    aligned_vector<half> data_h(w * h);
+    aligned_vector<vec4> data4(w * h);
+
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data_h[i] = half(dist(rng));
+        data[i] = data_h[i];
+        data4[i] = vec4(half(dist(rng)), half(dist(rng)), half(dist(rng)), data[i]);
+    }
+
+    texture<float, 2> ref(w, h);
+    ref.reset(data.data());
+
+    texture<half, 2> tex(w, h);
+    tex.reset(data_h.data());
+
+    texture<vec4, 2> ref4(w, h);
+    ref4.reset(data4.data());
+
+    texture<vector<4, half>, 2> tex4(w, h);
+    tex4.reset(data4.data(), PF_RGBA32F, PF_RGBA16F);
+
+    EXPECT_EQ(tex4.data()[5].w.value, data_h[5].value);
+
+    tex_address_mode address_modes[] = { Wrap, Clamp };
+    tex_filter_mode filter_modes[] = { Nearest, Linear, BSpline };
+
+    for (auto am : address_modes)
+    {
+        for (auto fm : filter_modes)
+        {
+            ref.set_address_mode(am);
+            ref.set_filter_mode(fm);
+            tex.set_address_mode(am);
+            tex.set_filter_mode(fm);
+            ref4.set_address_mode(am);
+            ref4.set_filter_mode(fm);
+            tex4.set_address_mode(am);
+            tex4.set_filter_mode(fm);
+
+            // Scalar fetches return float, not half
+            compare_fetches<float>(tex, ref);
+            compare_fetches4<float>(tex4, ref4);
+
+            // SIMD fetches through views
+            texture<half, 2>::ref_type tex_ref(tex);
+            texture<float, 2>::ref_type ref_ref(ref);
+            texture<vector<4, half>, 2>::ref_type tex4_ref(tex4);
+            texture<vec4, 2>::ref_type ref4_ref(ref4);
+
+            compare_fetches<simd::float4>(tex_ref, ref_ref);
+            compare_fetches<simd::float8>(tex_ref, ref_ref);
+            compare_fetches<simd::float16>(tex_ref, ref_ref);
+
+            compare_fetches4<simd::float4>(tex4_ref, ref4_ref);
+            compare_fetches4<simd::float8>(tex4_ref, ref4_ref);
+            compare_fetches4<simd::float16>(tex4_ref, ref4_ref);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Accumulate in float, store to RGBA16F buffers
+//
+
+template <typename F>
+static void test_accumulation()
+{
+    static_assert(std::is_same<pixel_traits<PF_RGBA16F>::type, vector<4, half>>::value, "Type mismatch");
+    static_assert(std::is_same<pixel_traits<PF_RGB16F>::type, vector<3, half>>::value, "Type mismatch");
+    static_assert(std::is_same<pixel_traits<PF_R16F>::type, half>::value, "Type mismatch");
+
+    using namespace detail;
+
+    // Not a multiple of the packet size
+    int width = 7;
+    int height = 5;
+
+    aligned_vector<vector<4, half>> accum(width * height, vector<4, half>(0.0f));
+    aligned_vector<vec4> ref(width * height, vec4(0.0f));
+
+    int pw = packet_size<F>::w;
+    int ph = packet_size<F>::h;
+
+    // Running mean of the frames
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        float n = frame + 1.0f;
+
+        for (int y = 0; y < height; y += ph)
+        {
+            for (int x = 0; x < width; x += pw)
+            {
+                vector<4, F> color(F(frame * 0.3f), F(1.0f), F(frame * 2.0f), F(1.0f));
+
+                pixel_access::blend(
+                        pixel_format_constant<PF_RGBA16F>{},
+                        pixel_format_constant<PF_RGBA32F>{},
+                        x,
+                        y,
+                        width,
+                        height,
+                        color,
+                        accum.data(),
+                        F(1.0f / n),
+                        F(1.0f - 1.0f / n)
+                        );
+
+                pixel_access::blend(
+                        pixel_format_constant<PF_RGBA32F>{},
+                        pixel_format_constant<PF_RGBA32F>{},
+                        x,
+                        y,
+                        width,
+                        height,
+                        color,
+                        ref.data(),
+                        F(1.0f / n),
+                        F(1.0f - 1.0f / n)
+                        );
+            }
+        }
+    }
+
+    for (int i = 0; i < width * height; ++i)
+    {
+        vec4 a(accum[i]);
+
+        for (int d = 0; d < 4; ++d)
+        {
+            EXPECT_NEAR(a[d], ref[i][d], std::abs(ref[i][d]) * 2e-3f);
+        }
+    }
+
+    // Read back as float
+    vector<4, F> color;
+    pixel_access::get(
+            pixel_format_constant<PF_RGBA32F>{},
+            pixel_format_constant<PF_RGBA16F>{},
+            0,
+            0,
+            width,
+            height,
+            color,
+            accum.data()
+            );
+
+    EXPECT_FLOAT_EQ(first_lane(color.z), static_cast<float>(accum[0].z));
+}
+
+TEST(Half, Accumulation)
+{
+    test_accumulation<float>();
+    test_accumulation<simd::float4>();
+    test_accumulation<simd::float8>();
+    test_accumulation<simd::float16>();
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// RGBA16F accumulation buffers stop converging: the running mean a only
+// changes if a sample x of frame n differs by |x - a| / n >= ulp(a) / 2,
+// i.e. not after 2048 to 4096 * |x - a| / a frames
+//
+
+TEST(Half, AccumulationLimit)
+{
+    using namespace detail;
+
+    vector<4, half> accum(0.0f);
+    vec4 ref(0.0f);
+
+    // Mean 1.0, samples deviate by 0.25 -> the half mean freezes after
+    // 512 to 1024 frames
+    int last_change = 0;
+
+    for (int frame = 0; frame < 4096; ++frame)
+    {
+        float n = frame + 1.0f;
+        float value = frame % 2 == 0 ? 1.25f : 0.75f;
+        vec4 color(value, value, value, 1.0f);
+
+        vector<4, half> prev = accum;
+
+        pixel_access::blend(
+                pixel_format_constant<PF_RGBA16F>{},
+                pixel_format_constant<PF_RGBA32F>{},
+                0,
+                0,
+                1,
+                1,
+                color,
+                &accum,
+                1.0f / n,
+                1.0f - 1.0f / n
+                );
+
+        pixel_access::blend(
+                pixel_format_constant<PF_RGBA32F>{},
+                pixel_format_constant<PF_RGBA32F>{},
+                0,
+                0,
+                1,
+                1,
+                color,
+                &ref,
+                1.0f / n,
+                1.0f - 1.0f / n
+                );
+
+        if (accum.x.value != prev.x.value)
+        {
+            last_change = frame;
+        }
+
+        // Within the limit, the half mean is within two ulps of the float mean
+        if (frame < 256)
+        {
+            EXPECT_NEAR(static_cast<float>(accum.x), ref.x, 2.0f / 1024.0f);
+        }
+    }
+
+    EXPECT_GE(last_change, 512);
+    EXPECT_LE(last_change, 1024);
+    EXPECT_NEAR(ref.x, 1.0f, 1e-3f);
+    EXPECT_NEAR(static_cast<float>(accum.x), 1.0f, 4.0f / 1024.0f);
+}
@@ -0,0 +1,308 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <visionaray/math/simd/simd.h>
+#include <visionaray/math/math.h>
+#include <visionaray/array.h>
+#include <visionaray/area_light.h>
+#include <visionaray/directional_light.h>
+#include <visionaray/generic_light.h>
+#include <visionaray/get_normal.h>
+#include <visionaray/light_alias_table.h>
+#include <visionaray/point_light.h>
+#include <visionaray/random_generator.h>
+#include <visionaray/sampling.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+using triangle_light = area_light<float, basic_triangle<3, float>>;
+using light_type = generic_light<point_light<float>, triangle_light, directional_light<float>>;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// A few bright lights among many dim ones, every other light is a triangle
+static std::vector<light_type> make_lights(size_t num_lights)
+{
+    std::default_random_engine rng(42);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    auto rand_vec = [&]() { return vec3(dist(rng), dist(rng), dist(rng)); };
+
+    std::vector<light_type> lights;
+
+    for (size_t i = 0; i < num_lights; ++i)
+    {
+        float kl = i % 17 == 0 ? 100.0f : 0.1f + i % 5;
+
+        if (i % 2 == 0)
+        {
+            point_light<float> pl;
+            pl.set_cl(vec3(1.0f));
+            pl.set_kl(kl);
+            pl.set_position(rand_vec());
+            pl.set_constant_attenuation(1.0f);
+            pl.set_linear_attenuation(0.0f);
+            pl.set_quadratic_attenuation(0.0f);
+            lights.push_back(pl);
+        }
+        else
+        {
+            basic_triangle<3, float> tri(rand_vec(), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+            tri.geom_id = static_cast<unsigned>(i % 3);
+            tri.prim_id = static_cast<unsigned>(i);
+
+            triangle_light al(tri);
+            al.set_cl(vec3(1.0f));
+            al.set_kl(kl);
+            lights.push_back(al);
+        }
+    }
+
+    return lights;
+}
+
+template <typename T>
+static void test_simd(light_alias_table_ref const& ref, int num_lights)
+{
+    using I = simd::int_type_t<T>;
+    using float_array = simd::aligned_array_t<T>;
+    using int_array = simd::aligned_array_t<I>;
+
+    enum { N = simd::num_elements<T>::value };
+
+    vector<3, T> pos(0.0f);
+    vector<3, T> n(0.0f, 1.0f, 0.0f);
+
+    std::default_random_engine rng(7);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::uniform_int_distribution<int> ids(0, num_lights + 2);
+
+    for (int iter = 0; iter < 256; ++iter)
+    {
+        float_array uf;
+        int_array geom_ids;
+        int_array prim_ids;
+
+        for (int i = 0; i < N; ++i)
+        {
+            uf[i] = dist(rng);
+            geom_ids[i] = ids(rng) % 4;
+            prim_ids[i] = ids(rng);
+        }
+
+        T pmf;
+        I light_id = ref.sample(num_lights, pos, n, T(uf), pmf);
+
+        int_array light_ids;
+        store(light_ids, light_id);
+
+        float_array pmfs;
+        store(pmfs, pmf);
+
+        float_array emitter_pmfs;
+        store(emitter_pmfs, ref.emitter_pmf(num_lights, pos, n, I(geom_ids), I(prim_ids)));
+
+        for (int i = 0; i < N; ++i)
+        {
+            float p = 0.0f;
+            EXPECT_EQ(light_ids[i], ref.sample(num_lights, vec3(0.0f), vec3(0.0f), uf[i], p));
+            EXPECT_FLOAT_EQ(pmfs[i], p);
+
+            float e = ref.emitter_pmf(num_lights, vec3(0.0f), vec3(0.0f), geom_ids[i], prim_ids[i]);
+            EXPECT_FLOAT_EQ(emitter_pmfs[i], e);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Lights are picked proportional to their power
+//
+
+TEST(LightAliasTable, SampleMatchesPmf)
+{
+    auto lights = make_lights(300);
+
+    light_alias_table table(lights.begin(), lights.end());
+    auto ref = table.ref();
+
+    int num_lights = static_cast<int>(lights.size());
+
+    EXPECT_EQ(table.num_lights(), lights.size());
+
+    float sum = 0.0f;
+
+    for (int i = 0; i < num_lights; ++i)
+    {
+        sum += ref.pmf(i);
+    }
+
+    EXPECT_NEAR(sum, 1.0f, 1e-5f);
+
+    // Points lights w/ the same intensity emit 2pi times the power of a unit area triangle
+    auto pl0 = lights[0].as<point_light<float>>();
+    auto pl2 = lights[2].as<point_light<float>>();
+    auto al1 = lights[1].as<triangle_light>();
+    ASSERT_TRUE(pl0 != nullptr && pl2 != nullptr && al1 != nullptr);
+
+    EXPECT_NEAR(ref.pmf(0) / ref.pmf(2), pl0->intensity(vec3(0.0f)).x / pl2->intensity(vec3(0.0f)).x, 1e-4f);
+
+    // Stratified u: the fraction of samples per light converges to its pmf
+    int const num_samples = 1 << 18;
+
+    std::vector<int> counts(num_lights);
+
+    for (int i = 0; i < num_samples; ++i)
+    {
+        float u = (i + 0.5f) / num_samples;
+
+        float pmf = 0.0f;
+        int light_id = ref.sample(num_lights, vec3(0.0f), vec3(0.0f), u, pmf);
+
+        ASSERT_GE(light_id, 0);
+        ASSERT_LT(light_id, num_lights);
+        ASSERT_FLOAT_EQ(pmf, ref.pmf(light_id));
+        ++counts[light_id];
+    }
+
+    for (int i = 0; i < num_lights; ++i)
+    {
+        EXPECT_NEAR(counts[i] / static_cast<float>(num_samples), ref.pmf(i), 1e-4f);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Lights w/o bounds get the mean power, lights w/o power are never picked
+//
+
+TEST(LightAliasTable, Unbounded)
+{
+    std::vector<light_type> lights(3);
+
+    point_light<float> pl;
+    pl.set_cl(vec3(1.0f));
+    pl.set_kl(1.0f);
+    pl.set_position(vec3(0.0f));
+    pl.set_constant_attenuation(1.0f);
+    pl.set_linear_attenuation(0.0f);
+    pl.set_quadratic_attenuation(0.0f);
+    lights[0] = pl;
+
+    pl.set_kl(0.0f);
+    lights[1] = pl;
+
+    directional_light<float> dl;
+    dl.set_cl(vec3(1.0f));
+    dl.set_kl(1.0f);
+    dl.set_direction(vec3(0.0f, -1.0f, 0.0f));
+    dl.set_angular_diameter(0.0f);
+    lights[2] = dl;
+
+    light_alias_table table(lights.begin(), lights.end());
+    auto ref = table.ref();
+
+    EXPECT_FLOAT_EQ(ref.pmf(0), 0.5f);
+    EXPECT_FLOAT_EQ(ref.pmf(1), 0.0f);
+    EXPECT_FLOAT_EQ(ref.pmf(2), 0.5f);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        float pmf = 0.0f;
+        EXPECT_NE(ref.sample(3, vec3(0.0f), vec3(0.0f), i / 1000.0f, pmf), 1);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Area lights are found by the ids of their geometry
+//
+
+TEST(LightAliasTable, EmitterPmf)
+{
+    auto lights = make_lights(31);
+
+    light_alias_table table(lights.begin(), lights.end());
+    auto ref = table.ref();
+
+    int num_lights = static_cast<int>(lights.size());
+
+    for (int i = 0; i < num_lights; ++i)
+    {
+        auto al = lights[i].as<triangle_light>();
+
+        if (al != nullptr)
+        {
+            int geom_id = static_cast<int>(al->geometry().geom_id);
+            int prim_id = static_cast<int>(al->geometry().prim_id);
+            EXPECT_FLOAT_EQ(ref.emitter_pmf(num_lights, vec3(0.0f), vec3(0.0f), geom_id, prim_id), ref.pmf(i));
+        }
+    }
+
+    // Point lights have even indices, no geometry with these ids
+    EXPECT_FLOAT_EQ(ref.emitter_pmf(num_lights, vec3(0.0f), vec3(0.0f), 0, 0), 0.0f);
+    EXPECT_FLOAT_EQ(ref.emitter_pmf(num_lights, vec3(0.0f), vec3(0.0f), 3, 1), 0.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// SIMD sample() and emitter_pmf() match the scalar versions
+//
+
+TEST(LightAliasTable, SIMD)
+{
+    auto lights = make_lights(57);
+
+    light_alias_table table(lights.begin(), lights.end());
+    auto ref = table.ref();
+
+    int num_lights = static_cast<int>(lights.size());
+
+    test_simd<simd::float4>(ref, num_lights);
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX)
+    test_simd<simd::float8>(ref, num_lights);
+#endif
+#if VSNRAY_SIMD_ISA_GE(VSNRAY_SIMD_ISA_AVX512F)
+    test_simd<simd::float16>(ref, num_lights);
+#endif
+
+    // sample_random_light() folds the selection probability into the pdf
+    using S = simd::float4;
+
+    array<unsigned, 4> seeds = {{ 1, 2, 3, 4 }};
+    random_generator<S> gen1(seeds);
+    random_generator<S> gen2(seeds);
+
+    vector<3, S> pos(0.5f, 0.5f, 0.5f);
+    vector<3, S> n(0.0f, 1.0f, 0.0f);
+
+    auto ls = sample_random_light(lights.begin(), lights.end(), ref, pos, n, gen1);
+
+    S pmf;
+    auto light_id = ref.sample(num_lights, pos, n, gen2.next(), pmf);
+
+    simd::aligned_array_t<simd::int4> light_ids;
+    store(light_ids, light_id);
+
+    simd::aligned_array_t<S> pdf;
+    store(pdf, ls.pdf);
+
+    simd::aligned_array_t<S> pmfs;
+    store(pmfs, pmf);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        auto ls1 = lights[light_ids[i]].sample(vec3(0.5f, 0.5f, 0.5f), gen2.get_generator(i));
+        EXPECT_GT(pdf[i], 0.0f);
+        EXPECT_FLOAT_EQ(pdf[i], ls1.pdf * pmfs[i]);
+    }
+}
@@ -0,0 +1,319 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <visionaray/math/simd/simd.h>
+#include <visionaray/math/math.h>
+#include <visionaray/array.h>
+#include <visionaray/area_light.h>
+#include <visionaray/directional_light.h>
+#include <visionaray/generic_light.h>
+#include <visionaray/get_normal.h>
+#include <visionaray/light_bvh.h>
+#include <visionaray/light_selector.h>
+#include <visionaray/point_light.h>
+#include <visionaray/random_generator.h>
+#include <visionaray/sampling.h>
+#include <visionaray/spot_light.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+using triangle_light = area_light<float, basic_triangle<3, float>>;
+using light_type = generic_light<point_light<float>, spot_light<float>, triangle_light, directional_light<float>>;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+static std::vector<light_type> make_lights(size_t num_lights, bool with_directional = false)
+{
+    std::default_random_engine rng(42);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> power(0.1f, 10.0f);
+
+    auto rand_vec = [&]() { return vec3(dist(rng), dist(rng), dist(rng)); };
+
+    std::vector<light_type> lights;
+
+    for (size_t i = 0; i < num_lights; ++i)
+    {
+        if (i % 3 == 0)
+        {
+            point_light<float> pl;
+            pl.set_cl(vec3(1.0f));
+            pl.set_kl(power(rng));
+            pl.set_position(rand_vec());
+            pl.set_constant_attenuation(1.0f);
+            pl.set_linear_attenuation(0.0f);
+            pl.set_quadratic_attenuation(0.0f);
+            lights.push_back(pl);
+        }
+        else if (i % 3 == 1)
+        {
+            spot_light<float> sl;
+            sl.set_cl(vec3(1.0f));
+            sl.set_kl(power(rng));
+            sl.set_position(rand_vec());
+            sl.set_spot_direction(normalize(rand_vec()));
+            sl.set_spot_cutoff(constants::pi<float>() / 4.0f);
+            sl.set_spot_exponent(1.0f);
+            sl.set_constant_attenuation(1.0f);
+            sl.set_linear_attenuation(0.0f);
+            sl.set_quadratic_attenuation(0.0f);
+            lights.push_back(sl);
+        }
+        else
+        {
+            vec3 v1 = rand_vec();
+            basic_triangle<3, float> tri(v1, vec3(1.0f, 0.0f, 0.0f), normalize(rand_vec()));
+            tri.geom_id = 7;
+            tri.prim_id = static_cast<unsigned>(i);
+
+            triangle_light al(tri);
+            al.set_cl(vec3(1.0f));
+            al.set_kl(power(rng));
+            lights.push_back(al);
+        }
+    }
+
+    if (with_directional)
+    {
+        directional_light<float> dl;
+        dl.set_cl(vec3(1.0f));
+        dl.set_kl(1.0f);
+        dl.set_direction(vec3(0.0f, -1.0f, 0.0f));
+        dl.set_angular_diameter(0.0f);
+        lights.push_back(dl);
+    }
+
+    return lights;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// sample() picks lights with the probability reported by pmf()
+//
+
+TEST(LightBVH, SampleMatchesPmf)
+{
+    auto lights = make_lights(300);
+
+    light_bvh bvh(lights.begin(), lights.end());
+    auto ref = bvh.ref();
+
+    EXPECT_EQ(bvh.num_lights(), lights.size());
+    EXPECT_EQ(bvh.num_nodes(), 2 * lights.size() - 1);
+
+    int num_lights = static_cast<int>(lights.size());
+
+    vec3 positions[] = { vec3(0.0f), vec3(5.0f, -3.0f, 2.0f), vec3(-20.0f, 0.0f, 0.0f) };
+    vec3 normals[] = { vec3(0.0f), vec3(0.0f, 1.0f, 0.0f), normalize(vec3(1.0f, 1.0f, 0.0f)) };
+
+    for (auto pos : positions)
+    {
+        for (auto n : normals)
+        {
+            // Stratified u: the fraction of samples per light converges to its pmf
+            int const num_samples = 1 << 18;
+
+            std::vector<int> counts(num_lights);
+
+            for (int i = 0; i < num_samples; ++i)
+            {
+                float u = (i + 0.5f) / num_samples;
+
+                float pmf = 0.0f;
+                int light_id = ref.sample(num_lights, pos, n, u, pmf);
+
+                if (light_id >= 0)
+                {
+                    ASSERT_LT(light_id, num_lights);
+                    ASSERT_GT(pmf, 0.0f);
+                    ASSERT_NEAR(pmf, ref.pmf(pos, n, light_id), 1e-5f);
+                    ++counts[light_id];
+                }
+            }
+
+            float sum = 0.0f;
+
+            for (int i = 0; i < num_lights; ++i)
+            {
+                float pmf = ref.pmf(pos, n, i);
+                EXPECT_NEAR(counts[i] / static_cast<float>(num_samples), pmf, 1e-3f);
+                sum += pmf;
+            }
+
+            EXPECT_LE(sum, 1.0f + 1e-4f);
+            EXPECT_GT(sum, 0.5f);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Closer lights are picked more often
+//
+
+TEST(LightBVH, Importance)
+{
+    std::vector<point_light<float>> lights(2);
+
+    for (auto& pl : lights)
+    {
+        pl.set_cl(vec3(1.0f));
+        pl.set_kl(1.0f);
+        pl.set_constant_attenuation(1.0f);
+        pl.set_linear_attenuation(0.0f);
+        pl.set_quadratic_attenuation(0.0f);
+    }
+
+    lights[0].set_position(vec3(-10.0f, 0.0f, 0.0f));
+    lights[1].set_position(vec3( 10.0f, 0.0f, 0.0f));
+
+    light_bvh bvh(lights.begin(), lights.end());
+    auto ref = bvh.ref();
+
+    EXPECT_FLOAT_EQ(ref.pmf(vec3(0.0f), vec3(0.0f), 0), 0.5f);
+    EXPECT_FLOAT_EQ(ref.pmf(vec3(0.0f), vec3(0.0f), 1), 0.5f);
+
+    EXPECT_GT(ref.pmf(vec3(-8.0f, 0.0f, 0.0f), vec3(0.0f), 0), 0.9f);
+
+    // Lights in the plane of the surface do not contribute
+    vec3 pos(-10.0f, 0.0f, 5.0f);
+    vec3 n(1.0f, 0.0f, 0.0f);
+    EXPECT_FLOAT_EQ(ref.pmf(pos, n, 0), 0.0f);
+    EXPECT_FLOAT_EQ(ref.pmf(pos, n, 1), 1.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Lights w/o bounds are picked uniformly, the BVH counts as one of them
+//
+
+TEST(LightBVH, InfiniteLights)
+{
+    auto lights = make_lights(10, true);
+
+    light_bvh bvh(lights.begin(), lights.end());
+    auto ref = bvh.ref();
+
+    int num_lights = static_cast<int>(lights.size());
+    int dir_light = num_lights - 1;
+
+    vec3 pos(1.0f, 2.0f, 3.0f);
+    vec3 n(0.0f);
+
+    EXPECT_FLOAT_EQ(ref.pmf(pos, n, dir_light), 0.5f);
+
+    float pmf = 0.0f;
+    EXPECT_EQ(ref.sample(num_lights, pos, n, 0.25f, pmf), dir_light);
+    EXPECT_FLOAT_EQ(pmf, 0.5f);
+
+    int light_id = ref.sample(num_lights, pos, n, 0.75f, pmf);
+    EXPECT_NE(light_id, dir_light);
+    EXPECT_FLOAT_EQ(pmf, ref.pmf(pos, n, light_id));
+    EXPECT_LE(pmf, 0.5f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Area lights are found by the ids of their geometry
+//
+
+TEST(LightBVH, EmitterPmf)
+{
+    auto lights = make_lights(30);
+
+    light_bvh bvh(lights.begin(), lights.end());
+    auto ref = bvh.ref();
+
+    int num_lights = static_cast<int>(lights.size());
+
+    vec3 pos(0.0f);
+    vec3 n(0.0f, 1.0f, 0.0f);
+
+    for (int i = 0; i < num_lights; ++i)
+    {
+        auto al = lights[i].as<triangle_light>();
+
+        if (al != nullptr)
+        {
+            EXPECT_FLOAT_EQ(ref.emitter_pmf(num_lights, pos, n, 7, static_cast<int>(al->geometry().prim_id)), ref.pmf(pos, n, i));
+        }
+    }
+
+    // Point lights are never hit, no geometry with these ids
+    EXPECT_FLOAT_EQ(ref.emitter_pmf(num_lights, pos, n, 7, 0), 0.0f);
+    EXPECT_FLOAT_EQ(ref.emitter_pmf(num_lights, pos, n, 8, 2), 0.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Selection probability is folded into the light sample's pdf, the
+// uniform selector reproduces the selector-less overloads
+//
+
+TEST(LightBVH, SampleRandomLight)
+{
+    auto lights = make_lights(30);
+
+    light_bvh bvh(lights.begin(), lights.end());
+
+    vec3 pos(0.5f, 0.5f, 0.5f);
+    vec3 n(0.0f, 1.0f, 0.0f);
+
+    for (unsigned seed = 0; seed < 32; ++seed)
+    {
+        random_generator<float> gen1(seed);
+        random_generator<float> gen2(seed);
+        random_generator<float> gen3(seed);
+
+        auto ls1 = sample_random_light(lights.begin(), lights.end(), pos, gen1);
+        auto ls2 = sample_random_light(lights.begin(), lights.end(), uniform_light_selector{}, pos, n, gen2);
+
+        EXPECT_FLOAT_EQ(ls1.dist, ls2.dist);
+        EXPECT_FLOAT_EQ(ls1.pdf / lights.size(), ls2.pdf);
+
+        float u = gen3.next();
+        float pmf = 0.0f;
+        int light_id = bvh.ref().sample(static_cast<int>(lights.size()), pos, n, u, pmf);
+        ASSERT_GE(light_id, 0);
+        auto ls3 = lights[light_id].sample(pos, gen3);
+
+        random_generator<float> gen4(seed);
+        auto ls4 = sample_random_light(lights.begin(), lights.end(), bvh.ref(), pos, n, gen4);
+
+        EXPECT_FLOAT_EQ(ls3.dist, ls4.dist);
+        EXPECT_FLOAT_EQ(ls3.pdf * pmf, ls4.pdf);
+    }
+
+    // SIMD, lanes sampled with the scalar selector
+    using S = simd::float4;
+
+    array<unsigned, 4> seeds = {{ 1, 2, 3, 4 }};
+    random_generator<S> gen(seeds);
+
+    auto ls = sample_random_light(
+            lights.begin(),
+            lights.end(),
+            bvh.ref(),
+            vector<3, S>(pos),
+            vector<3, S>(n),
+            gen
+            );
+
+    simd::aligned_array_t<S> pdf;
+    store(pdf, ls.pdf);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_GT(pdf[i], 0.0f);
+    }
+}
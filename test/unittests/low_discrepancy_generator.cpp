@@ -0,0 +1,313 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <cstddef>
+#include <set>
+#include <type_traits>
+#include <vector>
+
+#include <visionaray/math/simd/simd.h>
+#include <visionaray/math/constants.h>
+#include <visionaray/low_discrepancy_generator.h>
+#include <visionaray/make_generator.h>
+#include <visionaray/pixel_sampler_types.h>
+#include <visionaray/random_generator.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// Samples [0..n) of pixel (x, y), dimensions [0..dims)
+template <typename Generator>
+static std::vector<std::vector<float>> draw(int x, int y, int n, int dims)
+{
+    std::vector<std::vector<float>> result(dims, std::vector<float>(n));
+
+    for (int i = 0; i < n; ++i)
+    {
+        Generator gen(x, y, i);
+
+        for (int d = 0; d < dims; ++d)
+        {
+            result[d][i] = gen.next();
+        }
+    }
+
+    return result;
+}
+
+// Each of the n intervals [k/n..(k+1)/n) contains one point
+static bool stratified_1d(std::vector<float> const& u, int n)
+{
+    std::set<int> cells;
+
+    for (int i = 0; i < n; ++i)
+    {
+        EXPECT_GE(u[i], 0.0f);
+        EXPECT_LT(u[i], 1.0f);
+        cells.insert(static_cast<int>(u[i] * n));
+    }
+
+    return static_cast<int>(cells.size()) == n;
+}
+
+// (0,m,2)-net in base 2: all elementary intervals of volume 1/2^m contain one point
+static bool stratified_2d(std::vector<float> const& u, std::vector<float> const& v, int m)
+{
+    int n = 1 << m;
+
+    for (int a = 0; a <= m; ++a)
+    {
+        int nx = 1 << a;
+        int ny = 1 << (m - a);
+
+        std::set<int> cells;
+
+        for (int i = 0; i < n; ++i)
+        {
+            int cx = static_cast<int>(u[i] * nx);
+            int cy = static_cast<int>(v[i] * ny);
+            cells.insert(cy * nx + cx);
+        }
+
+        if (static_cast<int>(cells.size()) != n)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// RMS error over pixels of the estimate of a smooth 2D or 4D integral,
+// dimensions are taken after the first two (pixel jitter)
+template <typename Generator>
+static double integration_error(int n, int dims)
+{
+    double exact = dims == 2
+        ? (2.0 / constants::pi<double>()) * (1.0 / 3.0)
+        : (2.0 / constants::pi<double>()) * (1.0 / 3.0) * 0.5 * 0.5;
+
+    double sum_sq = 0.0;
+    int num_pixels = 64;
+
+    for (int p = 0; p < num_pixels; ++p)
+    {
+        double estimate = 0.0;
+
+        for (int i = 0; i < n; ++i)
+        {
+            Generator gen(p % 8, p / 8, i);
+
+            gen.next();
+            gen.next();
+
+            double x = gen.next();
+            double y = gen.next();
+            double z = dims == 2 ? 1.0 : gen.next();
+            double w = dims == 2 ? 1.0 : gen.next();
+
+            estimate += std::sin(constants::pi<double>() * x) * y * y * z * w;
+        }
+
+        estimate /= n;
+        sum_sq += (estimate - exact) * (estimate - exact);
+    }
+
+    return std::sqrt(sum_sq / num_pixels);
+}
+
+// Adapts random_generator to the (x, y, sample) constructor
+struct pseudo_random_generator : random_generator<float>
+{
+    pseudo_random_generator(int x, int y, int sample)
+        : random_generator<float>(make_random_seed(y * 8 + x, sample))
+    {
+    }
+};
+
+template <typename Generator>
+static void test_simd()
+{
+    using S = simd::float4;
+    using I = simd::int4;
+
+    I x(0, 1, 2, 3);
+    I y(5, 5, 6, 6);
+    I sample(0, 7, 100, 12345);
+
+    Generator gen(x, y, sample);
+
+    simd::aligned_array_t<I> xs;
+    simd::aligned_array_t<I> ys;
+    simd::aligned_array_t<I> samples;
+    store(xs, x);
+    store(ys, y);
+    store(samples, sample);
+
+    for (int d = 0; d < 8; ++d)
+    {
+        simd::aligned_array_t<S> values;
+        store(values, gen.next());
+
+        for (int i = 0; i < 4; ++i)
+        {
+            typename Generator::generator_type scalar(xs[i], ys[i], samples[i]);
+
+            for (int dd = 0; dd < d; ++dd)
+            {
+                scalar.next();
+            }
+
+            EXPECT_FLOAT_EQ(values[i], scalar.next());
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Stratification of the first samples of a pixel
+//
+
+TEST(LowDiscrepancyGenerator, Sobol)
+{
+    int const m = 8;
+    int const n = 1 << m;
+
+    for (int p = 0; p < 4; ++p)
+    {
+        auto u = draw<sobol_generator<float>>(p, 3 * p, n, 6);
+
+        // Each pair of dimensions is a (0,m,2)-net
+        EXPECT_TRUE(stratified_2d(u[0], u[1], m));
+        EXPECT_TRUE(stratified_2d(u[2], u[3], m));
+        EXPECT_TRUE(stratified_2d(u[4], u[5], m));
+
+        // Also every prefix of length 2^k
+        EXPECT_TRUE(stratified_2d(u[2], u[3], 4));
+    }
+
+    // Pixels are decorrelated
+    auto u0 = draw<sobol_generator<float>>(0, 0, 4, 2);
+    auto u1 = draw<sobol_generator<float>>(1, 0, 4, 2);
+    EXPECT_NE(u0[0][0], u1[0][0]);
+}
+
+TEST(LowDiscrepancyGenerator, Halton)
+{
+    int const n2 = 256;
+    int const n3 = 243;
+    int const n5 = 125;
+
+    for (int p = 0; p < 4; ++p)
+    {
+        auto u = draw<halton_generator<float>>(p, 0, n2, 3);
+
+        EXPECT_TRUE(stratified_1d(u[0], n2));
+        EXPECT_TRUE(stratified_1d(u[1], n3));
+        EXPECT_TRUE(stratified_1d(u[2], n5));
+    }
+
+    // Base 311 for dimension 63, wraps around afterwards w/ a new scramble
+    EXPECT_EQ(detail::halton_base(63), 311u);
+    EXPECT_EQ(detail::halton_base(64), 2u);
+}
+
+TEST(LowDiscrepancyGenerator, BlueNoise)
+{
+    int const m = 8;
+    int const n = 1 << m;
+
+    // Shifted lattice points: one point per interval in each dimension
+    for (int p = 0; p < 4; ++p)
+    {
+        auto u = draw<blue_noise_generator<float>>(7 * p, p, n, 4);
+
+        for (int d = 0; d < 4; ++d)
+        {
+            EXPECT_TRUE(stratified_1d(u[d], n));
+        }
+    }
+
+    // The mask is a permutation of the ranks
+    auto const& mask = detail::get_blue_noise_mask();
+    int const size = detail::blue_noise_mask::Size;
+
+    std::set<unsigned> values(mask.values, mask.values + size * size);
+    EXPECT_EQ(values.size(), static_cast<size_t>(size * size));
+
+    // Blue noise: neighboring values differ more than those of white noise
+    // (mean absolute difference 1/3)
+    double diff = 0.0;
+
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            float v = detail::fixed_point_to_float(mask.values[y * size + x]);
+            float r = detail::fixed_point_to_float(mask.values[y * size + (x + 1) % size]);
+            diff += std::abs(v - r);
+        }
+    }
+
+    EXPECT_GT(diff / (size * size), 0.4);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Low-discrepancy generators estimate smooth integrals w/ lower error
+//
+
+TEST(LowDiscrepancyGenerator, Convergence)
+{
+    int const n = 256;
+
+    double random_error_2d = integration_error<pseudo_random_generator>(n, 2);
+    double random_error_4d = integration_error<pseudo_random_generator>(n, 4);
+
+    EXPECT_LT(integration_error<sobol_generator<float>>(n, 2), random_error_2d * 0.25);
+    EXPECT_LT(integration_error<halton_generator<float>>(n, 2), random_error_2d * 0.25);
+    EXPECT_LT(integration_error<blue_noise_generator<float>>(n, 2), random_error_2d * 0.25);
+
+    // Padded Sobol pairs its 2D sequences randomly, the gain is smaller
+    // for integrands that couple the pairs
+    EXPECT_LT(integration_error<sobol_generator<float>>(n, 4), random_error_4d * 0.8);
+    EXPECT_LT(integration_error<halton_generator<float>>(n, 4), random_error_4d * 0.5);
+    EXPECT_LT(integration_error<blue_noise_generator<float>>(n, 4), random_error_4d * 0.5);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// SIMD generators and selection w/ pixel samplers
+//
+
+TEST(LowDiscrepancyGenerator, SIMD)
+{
+    test_simd<sobol_generator<simd::float4>>();
+    test_simd<halton_generator<simd::float4>>();
+    test_simd<blue_noise_generator<simd::float4>>();
+}
+
+TEST(LowDiscrepancyGenerator, MakePixelGenerator)
+{
+    auto gen1 = make_pixel_generator(float{}, pixel_sampler::sobol_type{}, 3, 4, 16, 5);
+    EXPECT_TRUE((std::is_same<decltype(gen1), sobol_generator<float>>::value));
+    EXPECT_FLOAT_EQ(gen1.next(), sobol_generator<float>(3, 4, 5).next());
+
+    auto gen2 = make_pixel_generator(float{}, pixel_sampler::halton_blend_type{}, 3, 4, 16, 5);
+    EXPECT_TRUE((std::is_same<decltype(gen2), halton_generator<float>>::value));
+
+    auto gen3 = make_pixel_generator(simd::float4{}, pixel_sampler::blue_noise_type{}, simd::int4(3), simd::int4(4), 16, simd::int4(5));
+    EXPECT_TRUE((std::is_same<decltype(gen3), blue_noise_generator<simd::float4>>::value));
+
+    // Pseudo random generators are seeded as before
+    auto gen4 = make_pixel_generator(float{}, pixel_sampler::jittered_blend_type{}, 3, 4, 16, 5);
+    random_generator<float> gen5(make_random_seed(4 * 16 + 3, 5));
+    EXPECT_FLOAT_EQ(gen4.next(), gen5.next());
+}
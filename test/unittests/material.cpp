@@ -197,3 +197,40 @@ TEST(Material, SIMD)
     EXPECT_FLOAT_EQ( emm[2].ls(), em2.ls() );
     EXPECT_FLOAT_EQ( emm[3].ls(), em3.ls() );
 }
+
+TEST(Material, SIMDGlassMetal)
+{
+    array<glass<float>, 4> gls;
+    array<metal<float>, 4> mes;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        gls[i].ct() = from_rgb(vec3(0.1f * i, 0.2f, 0.3f));
+        gls[i].kt() = 0.9f - 0.1f * i;
+        gls[i].cr() = from_rgb(vec3(0.3f, 0.2f * i, 0.1f));
+        gls[i].kr() = 0.1f * i;
+        gls[i].ior() = spectrum<float>(1.3f + 0.1f * i);
+
+        mes[i].roughness() = 0.25f * i;
+        mes[i].ior() = spectrum<float>(0.2f + 0.1f * i);
+        mes[i].absorption() = spectrum<float>(3.0f + i);
+    }
+
+    auto gll = unpack(simd::pack(gls));
+    auto mee = unpack(simd::pack(mes));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < spectrum<float>::num_samples; ++j)
+        {
+            EXPECT_FLOAT_EQ( gll[i].ct()[j], gls[i].ct()[j] );
+            EXPECT_FLOAT_EQ( gll[i].cr()[j], gls[i].cr()[j] );
+            EXPECT_FLOAT_EQ( gll[i].ior()[j], gls[i].ior()[j] );
+            EXPECT_FLOAT_EQ( mee[i].ior()[j], mes[i].ior()[j] );
+            EXPECT_FLOAT_EQ( mee[i].absorption()[j], mes[i].absorption()[j] );
+        }
+        EXPECT_FLOAT_EQ( gll[i].kt(), gls[i].kt() );
+        EXPECT_FLOAT_EQ( gll[i].kr(), gls[i].kr() );
+        EXPECT_FLOAT_EQ( mee[i].roughness(), mes[i].roughness() );
+    }
+}
@@ -299,6 +299,9 @@ static void test_math()
         EXPECT_TRUE( all(-ai     == I(0) - ai) );
         EXPECT_TRUE( all(ai + ai == ai * I(2)) );
         EXPECT_TRUE( all(ai - ai == I(0)) );
+
+        EXPECT_TRUE( all(min(ai, I(7)) == select(ai < I(7), ai, I(7))) );
+        EXPECT_TRUE( all(max(ai, I(7)) == select(ai > I(7), ai, I(7))) );
     }
 
     // modulo
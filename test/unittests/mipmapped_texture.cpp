@@ -0,0 +1,337 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <cstddef>
+
+#include <visionaray/math/math.h>
+#include <visionaray/texture/texture.h>
+#include <visionaray/aligned_vector.h>
+#include <visionaray/get_surface.h>
+#include <visionaray/kernels.h>
+#include <visionaray/material.h>
+#include <visionaray/point_light.h>
+#include <visionaray/traverse.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// Texture w/ texel values f(x, y)
+template <typename T, typename Func>
+static texture<T, 2> make_texture(unsigned width, unsigned height, Func f)
+{
+    aligned_vector<T> data(width * height);
+
+    for (unsigned y = 0; y < height; ++y)
+    {
+        for (unsigned x = 0; x < width; ++x)
+        {
+            data[y * width + x] = f(x, y);
+        }
+    }
+
+    texture<T, 2> tex(width, height);
+    tex.reset(data.data());
+    tex.set_address_mode(Wrap);
+    tex.set_filter_mode(Linear);
+    return tex;
+}
+
+// Normalized coordinate of the center of texel x
+static float texel_center(unsigned x, unsigned size)
+{
+    return (x + 0.5f) / size;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Pyramid sizes and box filtered texel values
+//
+
+TEST(MipmappedTexture, Levels)
+{
+    auto base = make_texture<float>(8, 4, [](unsigned x, unsigned y) { return static_cast<float>(y * 8 + x); });
+    mipmapped_texture<float, 2> tex(base);
+
+    ASSERT_EQ(tex.num_levels(), 4U);
+    EXPECT_EQ(tex.level(1).width(), 4U);
+    EXPECT_EQ(tex.level(1).height(), 2U);
+    EXPECT_EQ(tex.level(2).width(), 2U);
+    EXPECT_EQ(tex.level(2).height(), 1U);
+    EXPECT_EQ(tex.level(3).width(), 1U);
+    EXPECT_EQ(tex.level(3).height(), 1U);
+
+    // Mean of texels (2x,2y), (2x+1,2y), (2x,2y+1), (2x+1,2y+1)
+    for (unsigned y = 0; y < 2; ++y)
+    {
+        for (unsigned x = 0; x < 4; ++x)
+        {
+            float expected = (2 * y * 8 + 2 * x) + 0.5f + 4.0f;
+            EXPECT_FLOAT_EQ(tex.level(1).data()[y * 4 + x], expected);
+        }
+    }
+
+    // Level 2 has one row
+    EXPECT_FLOAT_EQ(tex.level(2).data()[0], (4.5f + 6.5f + 20.5f + 22.5f) / 4.0f);
+
+    // Sampler state is inherited by all levels
+    EXPECT_EQ(tex.level(3).get_filter_mode(), Linear);
+    EXPECT_EQ(tex.level(3).get_address_mode(0), Wrap);
+
+    // Non power of two sizes, and limited number of levels
+    mipmapped_texture<float, 2> npot(make_texture<float>(5, 3, [](unsigned, unsigned) { return 1.0f; }));
+    ASSERT_EQ(npot.num_levels(), 3U);
+    EXPECT_EQ(npot.level(1).width(), 2U);
+    EXPECT_EQ(npot.level(1).height(), 1U);
+    EXPECT_FLOAT_EQ(npot.level(2).data()[0], 1.0f);
+
+    mipmapped_texture<float, 2> limited(base, 2);
+    EXPECT_EQ(limited.num_levels(), 2U);
+
+    // Copies reference their own levels
+    mipmapped_texture<float, 2> copy(tex);
+    EXPECT_NE(copy.level_refs()[1].data(), tex.level_refs()[1].data());
+    EXPECT_EQ(copy.level_refs()[1].data(), copy.level(1).data());
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// RGBA8 and sRGB textures
+//
+
+TEST(MipmappedTexture, Formats)
+{
+    using texel = vector<4, unorm<8>>;
+
+    auto checker = [](unsigned x, unsigned y)
+    {
+        float v = (x + y) % 2 == 0 ? 1.0f : 0.0f;
+        return texel(v, v, v, 1.0f);
+    };
+
+    mipmapped_texture<texel, 2> tex(make_texture<texel>(4, 4, checker));
+
+    for (unsigned l = 1; l < tex.num_levels(); ++l)
+    {
+        vec4 t(tex.level(l).data()[0]);
+        EXPECT_NEAR(t.x, 0.5f, 1.0f / 255.0f);
+        EXPECT_FLOAT_EQ(t.w, 1.0f);
+    }
+
+    // sRGB textures are averaged in linear space
+    auto base = make_texture<texel>(4, 4, checker);
+    base.set_color_space(sRGB);
+
+    mipmapped_texture<texel, 2> srgb(base);
+
+    vec4 t(srgb.level(1).data()[0]);
+    EXPECT_NEAR(t.x, std::pow(0.5f, 1.0f / 2.2f), 1.0f / 255.0f);
+    EXPECT_FLOAT_EQ(t.w, 1.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Sampling w/ a level of detail
+//
+
+TEST(MipmappedTexture, Lod)
+{
+    // Checkerboard, all coarser levels are 0.5
+    auto checker = [](unsigned x, unsigned y) { return (x + y) % 2 == 0 ? 1.0f : 0.0f; };
+
+    mipmapped_texture<float, 2> tex(make_texture<float>(16, 16, checker));
+    mipmapped_texture_ref<float, 2> ref(tex);
+
+    EXPECT_EQ(ref.num_levels(), 5U);
+    EXPECT_EQ(ref.width(), 16U);
+
+    vec2 coord(texel_center(2, 16), texel_center(4, 16));
+
+    EXPECT_FLOAT_EQ(tex2D(ref, coord), 1.0f);
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, 0.0f), 1.0f);
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, 0.5f), 0.75f);
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, 1.0f), 0.5f);
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, 10.0f), 0.5f);
+
+    // Magnification and invalid lods sample the base level
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, -2.0f), 1.0f);
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, NAN), 1.0f);
+
+    // Nearest level
+    tex.set_mipmap_filter_mode(MipmapNearest);
+    ref = mipmapped_texture_ref<float, 2>(tex);
+
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, 0.4f), 1.0f);
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, 0.6f), 0.5f);
+
+    // Lanes w/ different levels
+    tex.set_mipmap_filter_mode(MipmapLinear);
+    ref = mipmapped_texture_ref<float, 2>(tex);
+
+    float lods[] = { 0.0f, 0.25f, 0.5f, 3.0f };
+    simd::float4 lod(lods);
+
+    simd::aligned_array_t<simd::float4> values;
+    store(values, tex2D(ref, vector<2, simd::float4>(coord), lod));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_FLOAT_EQ(values[i], tex2D(ref, coord, lods[i]));
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Sampling w/ derivatives
+//
+
+TEST(MipmappedTexture, Derivatives)
+{
+    // Horizontal stripes, coarser levels are 0.5
+    auto stripes = [](unsigned /* x */, unsigned y) { return y % 2 == 0 ? 1.0f : 0.0f; };
+
+    mipmapped_texture<float, 2> tex(make_texture<float>(16, 16, stripes));
+    mipmapped_texture_ref<float, 2> ref(tex);
+
+    vec2 coord(texel_center(8, 16), texel_center(4, 16));
+
+    // Isotropic, one texel per pixel
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, vec2(1.0f / 16, 0.0f), vec2(0.0f, 1.0f / 16)), 1.0f);
+
+    // Four texels along the stripes: isotropic filtering blurs across them
+    vec2 ddx(4.0f / 16, 0.0f);
+    vec2 ddy(0.0f, 1.0f / 16);
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, ddx, ddy), 0.5f);
+
+    // Anisotropic filtering stays at level 0
+    tex.set_mipmap_filter_mode(MipmapAnisotropic);
+    ref = mipmapped_texture_ref<float, 2>(tex);
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, ddx, ddy), 1.0f);
+
+    // Same footprint across the stripes
+    EXPECT_FLOAT_EQ(tex2D(ref, coord, vec2(0.0f, 4.0f / 16), vec2(1.0f / 16, 0.0f)), 0.5f);
+
+    // SIMD, lanes w/ different numbers of probes
+    vector<2, simd::float4> ddx4(
+            simd::float4(1.0f / 16, 2.0f / 16, 4.0f / 16, 32.0f / 16),
+            simd::float4(0.0f)
+            );
+    vector<2, simd::float4> ddy4(simd::float4(0.0f), simd::float4(1.0f / 16));
+
+    simd::aligned_array_t<simd::float4> values;
+    store(values, tex2D(ref, vector<2, simd::float4>(coord), ddx4, ddy4));
+
+    auto lanes = simd::unpack(ddx4);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_FLOAT_EQ(values[i], tex2D(ref, coord, lanes[i], ddy));
+    }
+
+    // Zero derivatives take a single probe at level 0, the weights of
+    // several probes would not add up exactly
+    auto constant = [](unsigned /* x */, unsigned /* y */) { return 0.1f; };
+
+    mipmapped_texture<float, 2> uniform(make_texture<float>(16, 16, constant));
+    uniform.set_mipmap_filter_mode(MipmapAnisotropic);
+    uniform.set_max_anisotropy(3);
+    mipmapped_texture_ref<float, 2> uniform_ref(uniform);
+
+    EXPECT_EQ(tex2D(uniform_ref, coord, vec2(0.0f), vec2(0.0f)), tex2D(uniform_ref, coord, 0.0f));
+
+    // Textures w/o mip levels ignore derivatives and lods
+    auto plain = make_texture<float>(16, 16, stripes);
+    texture_ref<float, 2> plain_ref(plain);
+    EXPECT_FLOAT_EQ(tex2D(plain_ref, coord, ddx, ddy), 1.0f);
+    EXPECT_FLOAT_EQ(tex2D(plain_ref, coord, 4.0f), 1.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// get_surface() w/ ray cones selects the level of detail
+//
+
+TEST(MipmappedTexture, Surface)
+{
+    // Quad in the z = 0 plane, w/ a checkerboard of 64x64 texels
+    aligned_vector<basic_triangle<3, float>> triangles;
+    aligned_vector<vec3> normals;
+    aligned_vector<vec2> tex_coords;
+
+    vec3 v1(-1.0f, -1.0f, 0.0f);
+    vec3 v2( 1.0f, -1.0f, 0.0f);
+    vec3 v3( 1.0f,  1.0f, 0.0f);
+    vec3 v4(-1.0f,  1.0f, 0.0f);
+
+    triangles.emplace_back(v1, v2 - v1, v3 - v1);
+    triangles.emplace_back(v1, v3 - v1, v4 - v1);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        triangles[i].prim_id = i;
+        triangles[i].geom_id = 0;
+        normals.push_back(vec3(0.0f, 0.0f, 1.0f));
+    }
+
+    tex_coords.push_back(vec2(0.0f, 0.0f));
+    tex_coords.push_back(vec2(1.0f, 0.0f));
+    tex_coords.push_back(vec2(1.0f, 1.0f));
+    tex_coords.push_back(vec2(0.0f, 0.0f));
+    tex_coords.push_back(vec2(1.0f, 1.0f));
+    tex_coords.push_back(vec2(0.0f, 1.0f));
+
+    auto checker = [](unsigned x, unsigned y) { return (x + y) % 2 == 0 ? vec4(1.0f) : vec4(0.0f, 0.0f, 0.0f, 1.0f); };
+    mipmapped_texture<vec4, 2> tex(make_texture<vec4>(64, 64, checker));
+
+    aligned_vector<mipmapped_texture_ref<vec4, 2>> textures(1, mipmapped_texture_ref<vec4, 2>(tex));
+    aligned_vector<matte<float>> materials(1);
+    aligned_vector<point_light<float>> lights;
+
+    auto params = make_kernel_params(
+            normals_per_face_binding{},
+            triangles.data(),
+            triangles.data() + triangles.size(),
+            normals.data(),
+            normals.data(),
+            tex_coords.data(),
+            materials.data(),
+            textures.data(),
+            lights.data(),
+            lights.data()
+            );
+
+    // Ray through the center of a texel, w/ cones of 1/32 and 1/4 of the quad's width
+    vec3 target(-1.0f + 2.0f * texel_center(40, 64), -1.0f + 2.0f * texel_center(20, 64), 0.0f);
+    basic_ray<float> ray(target + vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, -1.0f));
+
+    auto hr = closest_hit(ray, triangles.data(), triangles.data() + triangles.size());
+    ASSERT_TRUE(hr.hit);
+    hr.isect_pos = ray.ori + ray.dir * hr.t;
+
+    EXPECT_FLOAT_EQ(get_surface(hr, params).tex_color.x, 1.0f);
+    EXPECT_FLOAT_EQ(get_surface(hr, params, ray).tex_color.x, 1.0f);
+
+    ray.cone_spread = 2.0f / 32.0f;
+    EXPECT_FLOAT_EQ(get_surface(hr, params, ray).tex_color.x, 0.5f);
+
+    // SIMD
+    basic_ray<simd::float4> ray4 = simd::pack(array<basic_ray<float>, 4>{{ ray, ray, ray, ray }});
+    ray4.cone_spread = simd::float4(0.0f, 2.0f / 64.0f, 2.0f / 32.0f, 0.5f);
+
+    auto hr4 = closest_hit(ray4, triangles.data(), triangles.data() + triangles.size());
+    hr4.isect_pos = ray4.ori + ray4.dir * hr4.t;
+
+    simd::aligned_array_t<simd::float4> values;
+    store(values, get_surface(hr4, params, ray4).tex_color.x);
+
+    EXPECT_FLOAT_EQ(values[0], 1.0f);
+    EXPECT_FLOAT_EQ(values[1], 1.0f);
+    EXPECT_FLOAT_EQ(values[2], 0.5f);
+    EXPECT_FLOAT_EQ(values[3], 0.5f);
+}
@@ -0,0 +1,436 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+#include <visionaray/math/math.h>
+#include <visionaray/texture/texture.h>
+#include <visionaray/aligned_vector.h>
+#include <visionaray/pinhole_camera.h>
+#include <visionaray/scheduler.h>
+#include <visionaray/simple_buffer_rt.h>
+
+#include <common/page_file.h>
+
+#include <gtest/gtest.h>
+
+#include "texture_helpers.h"
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// Texels encode their level and position
+static float texel_value(unsigned level, unsigned x, unsigned y)
+{
+    return static_cast<float>(level * 1000000 + y * 1000 + x);
+}
+
+struct test_source
+{
+    std::atomic<unsigned>* num_loads;
+
+    bool operator()(unsigned level, unsigned page_x, unsigned page_y, float* dst) const
+    {
+        ++*num_loads;
+
+        for (unsigned y = 0; y < detail::PageSize; ++y)
+        {
+            for (unsigned x = 0; x < detail::PageSize; ++x)
+            {
+                dst[y * detail::PageSize + x] = texel_value(
+                        level,
+                        page_x * detail::PageSize + x,
+                        page_y * detail::PageSize + y
+                        );
+            }
+        }
+
+        return true;
+    }
+};
+
+// Nearest fetch of texel (x,y)
+template <typename Tex>
+static float fetch(Tex const& tex, unsigned x, unsigned y)
+{
+    return tex2D(tex, vec2((x + 0.5f) / tex.width(), (y + 0.5f) / tex.height()));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Levels down to one page, pages numbered level by level
+//
+
+TEST(PagedTexture, Layout)
+{
+    unsigned num_pages = 0;
+    auto levels = detail::make_paged_levels(300, 130, num_pages);
+
+    ASSERT_EQ(levels.size(), size_t(4));
+
+    EXPECT_EQ(levels[0].width, 300U);
+    EXPECT_EQ(levels[0].height, 130U);
+    EXPECT_EQ(levels[0].num_pages_x, 5U);
+    EXPECT_EQ(levels[0].first_page, 0U);
+
+    EXPECT_EQ(levels[1].width, 150U);
+    EXPECT_EQ(levels[1].height, 65U);
+    EXPECT_EQ(levels[1].first_page, 15U);
+
+    EXPECT_EQ(levels[2].width, 75U);
+    EXPECT_EQ(levels[2].height, 32U);
+    EXPECT_EQ(levels[2].first_page, 21U);
+
+    EXPECT_EQ(levels[3].width, 37U);
+    EXPECT_EQ(levels[3].height, 16U);
+    EXPECT_EQ(levels[3].first_page, 23U);
+
+    EXPECT_EQ(num_pages, 24U);
+
+    // Small textures consist of a single page
+    levels = detail::make_paged_levels(64, 7, num_pages);
+    EXPECT_EQ(levels.size(), size_t(1));
+    EXPECT_EQ(num_pages, 1U);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Missing pages are requested and loaded by update(), fetches fall back to
+// the pinned level meanwhile
+//
+
+TEST(PagedTexture, Residency)
+{
+    page_cache cache;
+    std::atomic<unsigned> num_loads(0);
+
+    {
+        paged_texture<float, 2> tex(300, 130, test_source{ &num_loads }, cache);
+        tex.set_filter_mode(Nearest);
+        tex.set_address_mode(Clamp);
+
+        EXPECT_EQ(tex.num_levels(), 4U);
+
+        // Only the pinned level was loaded
+        EXPECT_EQ(num_loads, 1U);
+        EXPECT_EQ(cache.resident_bytes(), size_t(64 * 64 * 4));
+
+        // Fall back to level 3
+        EXPECT_FLOAT_EQ(fetch(tex, 200, 100), texel_value(3, 25, 12));
+        EXPECT_FLOAT_EQ(fetch(tex, 201, 101), texel_value(3, 25, 12));
+        EXPECT_EQ(cache.hits(), uint64_t(0));
+        EXPECT_EQ(cache.misses(), uint64_t(2));
+
+        // Loads the page of level 0 and the page of level 2, the next level
+        // above the fallback, once
+        cache.update();
+        EXPECT_EQ(num_loads, 3U);
+        EXPECT_EQ(cache.num_resident_pages(), size_t(2));
+
+        EXPECT_FLOAT_EQ(fetch(tex, 200, 100), texel_value(0, 200, 100));
+        EXPECT_FLOAT_EQ(fetch(tex, 255, 127), texel_value(0, 255, 127));
+        EXPECT_EQ(cache.hits(), uint64_t(2));
+
+        // Texels outside the page of level 0 fall back to level 2 now
+        EXPECT_FLOAT_EQ(fetch(tex, 150, 70), texel_value(2, 37, 17));
+        EXPECT_EQ(cache.misses(), uint64_t(3));
+
+        // Texels outside both pages still fall back to level 3, also for views
+        paged_texture<float, 2>::ref_type ref(tex);
+        EXPECT_FLOAT_EQ(fetch(ref, 299, 0), texel_value(3, 36, 0));
+        EXPECT_EQ(cache.misses(), uint64_t(4));
+
+        cache.reset_counters();
+        EXPECT_EQ(cache.hits(), uint64_t(0));
+        EXPECT_EQ(cache.misses(), uint64_t(0));
+
+        // SIMD fetches count per lane
+        simd::float4 u(0.1f, 0.9f, 0.9f, 0.9f);
+        simd::float4 v(0.1f, 0.9f, 0.9f, 0.9f);
+        tex2D(ref, vector<2, simd::float4>(u, v));
+        EXPECT_EQ(cache.misses(), uint64_t(4));
+
+        // Pages of level 0 and 1 for (150,70), of level 0 and 2 for (299,0),
+        // of level 0 and 1 for (30,13), and of level 0 for (270,117), whose
+        // level 2 page was already requested by (299,0)
+        cache.update();
+        EXPECT_EQ(num_loads, 10U);
+    }
+
+    // Textures release their pages
+    EXPECT_EQ(cache.resident_bytes(), size_t(0));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The least recently used pages are evicted when the cache is full
+//
+
+TEST(PagedTexture, Eviction)
+{
+    size_t page_bytes = 64 * 64 * sizeof(float);
+
+    page_cache cache(2 * page_bytes);
+    std::atomic<unsigned> num_loads(0);
+
+    paged_texture<float, 2> tex(256, 64, test_source{ &num_loads }, cache);
+    tex.set_filter_mode(Nearest);
+
+    // Frame 1: pages 0 and 1 of level 0, and page 0 of level 1. Only page
+    // 0 of each level fits
+    fetch(tex, 0, 0);
+    fetch(tex, 64, 0);
+    cache.update();
+    EXPECT_EQ(cache.num_resident_pages(), size_t(2));
+
+    // Frame 2: page 0 used, page 2 requested -> page 0 of level 1 is evicted,
+    // the request for page 1 of level 1 is dropped
+    EXPECT_FLOAT_EQ(fetch(tex, 0, 0), texel_value(0, 0, 0));
+    EXPECT_FLOAT_EQ(fetch(tex, 128, 0), texel_value(2, 32, 0));
+    cache.update();
+    EXPECT_EQ(cache.num_resident_pages(), size_t(2));
+    EXPECT_FLOAT_EQ(fetch(tex, 0, 0), texel_value(0, 0, 0));
+    EXPECT_FLOAT_EQ(fetch(tex, 128, 0), texel_value(0, 128, 0));
+    EXPECT_FLOAT_EQ(fetch(tex, 64, 0), texel_value(2, 16, 0));
+
+    // Frame 3: all resident pages were used, the requests are dropped
+    cache.update();
+    EXPECT_EQ(cache.num_resident_pages(), size_t(2));
+    EXPECT_FLOAT_EQ(fetch(tex, 64, 0), texel_value(2, 16, 0));
+    EXPECT_EQ(num_loads, 4U);
+
+    // Memory is bounded, apart from the pinned page
+    EXPECT_EQ(cache.resident_bytes(), 3 * page_bytes);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Pages that fail to load are not published and are requested again
+//
+
+TEST(PagedTexture, FailedLoads)
+{
+    page_cache cache;
+    std::atomic<unsigned> num_loads(0);
+    bool fail = true;
+
+    auto source = [&](unsigned level, unsigned page_x, unsigned page_y, float* dst)
+    {
+        return (level != 0 || !fail) && test_source{ &num_loads }(level, page_x, page_y, dst);
+    };
+
+    paged_texture<float, 2> tex(128, 64, source, cache);
+    tex.set_filter_mode(Nearest);
+
+    EXPECT_FLOAT_EQ(fetch(tex, 0, 0), texel_value(1, 0, 0));
+    cache.update();
+    EXPECT_EQ(cache.num_resident_pages(), size_t(0));
+    EXPECT_EQ(cache.resident_bytes(), size_t(64 * 64 * 4));
+
+    fail = false;
+
+    EXPECT_FLOAT_EQ(fetch(tex, 0, 0), texel_value(1, 0, 0));
+    cache.update();
+    EXPECT_EQ(cache.num_resident_pages(), size_t(1));
+    EXPECT_FLOAT_EQ(fetch(tex, 0, 0), texel_value(0, 0, 0));
+    EXPECT_EQ(num_loads, 2U);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Threads count hits and misses locally, schedulers add them once per tile
+//
+
+struct fetch_kernel
+{
+    paged_texture<float, 2>::ref_type tex;
+
+    template <typename R>
+    result_record<float> operator()(R /* */) const
+    {
+        result_record<float> result;
+        result.color = vec4(tex2D(tex, vec2(0.1f, 0.1f)));
+        result.hit = true;
+        return result;
+    }
+};
+
+TEST(PagedTexture, Counters)
+{
+    page_cache cache;
+    std::atomic<unsigned> num_loads(0);
+
+    paged_texture<float, 2> tex(128, 64, test_source{ &num_loads }, cache);
+    tex.set_filter_mode(Nearest);
+
+    // Counts of other threads are added by flush_page_counters()
+    std::thread thread([&]()
+    {
+        fetch(tex, 0, 0);
+        fetch(tex, 1, 0);
+        flush_page_counters();
+    });
+    thread.join();
+
+    EXPECT_EQ(cache.hits(), uint64_t(0));
+    EXPECT_EQ(cache.misses(), uint64_t(2));
+
+    cache.update();
+    cache.reset_counters();
+
+    // One fetch per pixel on the scheduler's threads
+    int const width = 40;
+    int const height = 20;
+
+    simple_buffer_rt<PF_RGBA32F, PF_UNSPECIFIED> rt;
+    rt.resize(width, height);
+
+    pinhole_camera cam;
+    cam.set_viewport(0, 0, width, height);
+    cam.perspective(45.0f * constants::degrees_to_radians<float>(), 2.0f, 0.1f, 100.0f);
+    cam.look_at(vec3(0.0f, 0.0f, 3.5f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+    tiled_sched<basic_ray<float>> sched(2);
+    auto sparams = make_sched_params(cam, rt);
+    sched.frame(fetch_kernel{ paged_texture<float, 2>::ref_type(tex) }, sparams);
+
+    EXPECT_EQ(cache.hits(), uint64_t(width * height));
+    EXPECT_EQ(cache.misses(), uint64_t(0));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Fully resident paged textures return the same values as row-major textures
+//
+
+TEST(PagedTexture, Fetch)
+{
+    unsigned w = 200;
+    unsigned h = 130;
+
+    std::default_random_engine rng(0);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    aligned_vector<float> data(w * h);
+
+    for (auto& t : data)
+    {
+        t = dist(rng);
+    }
+
+    texture<float, 2> ref(w, h);
+    ref.reset(data.data());
+
+    auto source = [&](unsigned level, unsigned page_x, unsigned page_y, float* dst)
+    {
+        // Only level 0 is compared
+        for (unsigned y = 0; y < detail::PageSize; ++y)
+        {
+            for (unsigned x = 0; x < detail::PageSize; ++x)
+            {
+                unsigned xx = page_x * detail::PageSize + x;
+                unsigned yy = page_y * detail::PageSize + y;
+                dst[y * detail::PageSize + x] = level == 0 && xx < w && yy < h ? data[yy * w + xx] : 0.0f;
+            }
+        }
+
+        return true;
+    };
+
+    page_cache cache;
+    paged_texture<float, 2> tex(w, h, source, cache);
+
+    // Touch all pages
+    tex.set_filter_mode(Nearest);
+
+    for (unsigned y = 0; y < h; y += detail::PageSize)
+    {
+        for (unsigned x = 0; x < w; x += detail::PageSize)
+        {
+            fetch(tex, x, y);
+        }
+    }
+
+    cache.update();
+
+    // Not w/ Mirror, where BSpline may access row -1 and row-major textures
+    // read outside their data
+    tex_address_mode address_modes[] = { Wrap, Clamp };
+    tex_filter_mode filter_modes[] = { Nearest, Linear, BSpline };
+
+    for (auto am : address_modes)
+    {
+        for (auto fm : filter_modes)
+        {
+            tex.set_address_mode(am);
+            tex.set_filter_mode(fm);
+            ref.set_address_mode(am);
+            ref.set_filter_mode(fm);
+
+            compare_fetches<float>(tex, ref);
+            compare_fetches<simd::float4>(tex, texture<float, 2>::ref_type(ref));
+            compare_fetches<simd::float8>(paged_texture<float, 2>::ref_type(tex), texture<float, 2>::ref_type(ref));
+        }
+    }
+
+    EXPECT_EQ(cache.misses(), uint64_t(12));
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Page files store all levels
+//
+
+TEST(PagedTexture, PageFile)
+{
+    unsigned w = 150;
+    unsigned h = 70;
+
+    using T = vector<4, unorm<8>>;
+    aligned_vector<T> data(w * h);
+
+    for (unsigned y = 0; y < h; ++y)
+    {
+        for (unsigned x = 0; x < w; ++x)
+        {
+            data[y * w + x] = T(x / 255.0f, y / 255.0f, 0.5f, 1.0f);
+        }
+    }
+
+    texture<T, 2> ref(w, h);
+    ref.reset(data.data());
+    ref.set_filter_mode(Nearest);
+
+    char const* filename = "paged_texture_test.vptx";
+    ASSERT_TRUE(write_page_file(filename, ref));
+
+    {
+        page_file file(filename);
+        ASSERT_TRUE(file.good());
+        EXPECT_EQ(file.width(), w);
+        EXPECT_EQ(file.height(), h);
+        EXPECT_EQ(file.texel_bytes(), sizeof(T));
+
+        page_cache cache;
+        paged_texture<T, 2> tex(w, h, file.source<T>(), cache);
+        tex.set_filter_mode(Nearest);
+
+        // Level 2 (37x17) is the fallback
+        mipmapped_texture<T, 2> mipmaps(ref);
+        auto fallback = tex2D(mipmaps.level(2), vec2(8.5f / w, 8.5f / h));
+        EXPECT_TRUE(equal(tex2D(tex, vec2(8.5f / w, 8.5f / h)), fallback));
+
+        cache.update();
+        EXPECT_TRUE(equal(tex2D(tex, vec2(8.5f / w, 8.5f / h)), tex2D(ref, vec2(8.5f / w, 8.5f / h))));
+    }
+
+    std::remove(filename);
+}
@@ -0,0 +1,191 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cmath>
+#include <vector>
+
+#include <visionaray/math/simd/simd.h>
+#include <visionaray/array.h>
+#include <visionaray/make_random_seed.h>
+#include <visionaray/random_generator.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// Chi-squared statistic of a histogram of n samples w/ num_bins bins
+template <typename Generator>
+static double chi_squared(Generator& gen, int n, int num_bins)
+{
+    std::vector<int> bins(num_bins, 0);
+
+    for (int i = 0; i < n; ++i)
+    {
+        float u = gen.next();
+
+        EXPECT_GE(u, 0.0f);
+        EXPECT_LT(u, 1.0f);
+
+        ++bins[static_cast<int>(u * num_bins)];
+    }
+
+    double expected = static_cast<double>(n) / num_bins;
+    double result = 0.0;
+
+    for (int b : bins)
+    {
+        result += (b - expected) * (b - expected) / expected;
+    }
+
+    return result;
+}
+
+// Lane i of the SIMD generator matches the scalar generator w/ seed[i]
+template <typename S>
+static void test_simd()
+{
+    using G = random_generator<S>;
+
+    int const N = simd::num_elements<S>::value;
+
+    array<unsigned, N> seeds;
+
+    for (int i = 0; i < N; ++i)
+    {
+        seeds[i] = make_random_seed(i, 17);
+    }
+
+    G gen(seeds);
+
+    std::vector<random_generator<float>> scalar;
+
+    for (int i = 0; i < N; ++i)
+    {
+        scalar.emplace_back(seeds[i]);
+    }
+
+    for (int iter = 0; iter < 100; ++iter)
+    {
+        simd::aligned_array_t<S> values;
+        store(values, gen.next());
+
+        for (int i = 0; i < N; ++i)
+        {
+            EXPECT_EQ(values[i], scalar[i].next());
+        }
+
+        // Lanes advanced through get_generator() continue from there
+        if (iter % 10 == 0)
+        {
+            gen.get_generator(iter % N).next();
+            scalar[iter % N].next();
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Samples are uniformly distributed in [0..1)
+//
+
+TEST(RandomGenerator, Uniform)
+{
+    random_generator<float> gen(make_random_seed(3, 5));
+
+    int const n = 1 << 20;
+    int const num_bins = 256;
+
+    // 255 degrees of freedom, p = 0.001 at 330.5
+    EXPECT_LT(chi_squared(gen, n, num_bins), 330.5);
+
+    // Pairs of consecutive samples are uniformly distributed in [0..1)^2
+    std::vector<int> bins(64 * 64, 0);
+
+    for (int i = 0; i < n; ++i)
+    {
+        int x = static_cast<int>(gen.next() * 64);
+        int y = static_cast<int>(gen.next() * 64);
+        ++bins[y * 64 + x];
+    }
+
+    double expected = static_cast<double>(n) / bins.size();
+    double chi2 = 0.0;
+
+    for (int b : bins)
+    {
+        chi2 += (b - expected) * (b - expected) / expected;
+    }
+
+    // 4095 degrees of freedom, p = 0.001 at 4394
+    EXPECT_LT(chi2, 4394.0);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Generators w/ consecutive seeds are not correlated
+//
+
+TEST(RandomGenerator, Seeds)
+{
+    int const num_seeds = 1024;
+    int const n = 64;
+
+    // Same seed, same sequence
+    random_generator<float> gen1(42);
+    random_generator<float> gen2(42);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        EXPECT_EQ(gen1.next(), gen2.next());
+    }
+
+    // Correlation of the i-th samples of generators w/ seeds s and s + 1
+    double sum_xy = 0.0;
+    double sum_x = 0.0;
+    double sum_y = 0.0;
+    double sum_xx = 0.0;
+    double sum_yy = 0.0;
+    int count = 0;
+
+    for (int s = 0; s < num_seeds; s += 2)
+    {
+        random_generator<float> a(s);
+        random_generator<float> b(s + 1);
+
+        for (int i = 0; i < n; ++i)
+        {
+            double x = a.next();
+            double y = b.next();
+            sum_xy += x * y;
+            sum_x += x;
+            sum_y += y;
+            sum_xx += x * x;
+            sum_yy += y * y;
+            ++count;
+        }
+    }
+
+    double cov = sum_xy / count - (sum_x / count) * (sum_y / count);
+    double var_x = sum_xx / count - (sum_x / count) * (sum_x / count);
+    double var_y = sum_yy / count - (sum_y / count) * (sum_y / count);
+
+    // 32768 pairs, standard deviation of the correlation is ~0.0055
+    EXPECT_LT(std::abs(cov / std::sqrt(var_x * var_y)), 0.03);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// SIMD generators
+//
+
+TEST(RandomGenerator, SIMD)
+{
+    test_simd<simd::float4>();
+    test_simd<simd::float8>();
+    test_simd<simd::float16>();
+}
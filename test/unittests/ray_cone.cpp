@@ -0,0 +1,159 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <visionaray/math/math.h>
+#include <visionaray/matrix_camera.h>
+#include <visionaray/pinhole_camera.h>
+#include <visionaray/ray_cone.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+struct test_hit_record
+{
+    int prim_id = 0;
+    float t = 0.0f;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Primary rays have the spread angle (or width) of one pixel
+//
+
+TEST(RayCone, Cameras)
+{
+    float const fovy = 90.0f * constants::degrees_to_radians<float>();
+
+    pinhole_camera cam;
+    cam.set_viewport(0, 0, 100, 100);
+    cam.perspective(fovy, 1.0f, 0.1f, 100.0f);
+    cam.look_at(vec3(0.0f, 0.0f, 5.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    cam.begin_frame();
+
+    // 2 * tan(fovy / 2) / height
+    auto r = cam.primary_ray(basic_ray<float>{}, 50.0f, 50.0f, 100.0f, 100.0f);
+    EXPECT_FLOAT_EQ(r.cone_width, 0.0f);
+    EXPECT_FLOAT_EQ(r.cone_spread, 0.02f);
+
+    auto r4 = cam.primary_ray(basic_ray<simd::float4>{}, simd::float4(0.0f), simd::float4(0.0f), simd::float4(100.0f), simd::float4(100.0f));
+    for (auto const& lane : simd::unpack(r4))
+    {
+        EXPECT_FLOAT_EQ(lane.cone_width, 0.0f);
+        EXPECT_FLOAT_EQ(lane.cone_spread, 0.02f);
+    }
+
+    // Image regions magnify
+    cam.set_image_region(box2f(vec2(0.25f), vec2(0.75f)));
+    r = cam.primary_ray(basic_ray<float>{}, 50.0f, 50.0f, 100.0f, 100.0f);
+    EXPECT_FLOAT_EQ(r.cone_spread, 0.01f);
+
+    // Same w/ matrix camera
+    matrix_camera mcam(cam.get_view_matrix(), cam.get_proj_matrix());
+    mcam.begin_frame();
+
+    r = mcam.primary_ray(basic_ray<float>{}, 50.0f, 50.0f, 100.0f, 100.0f);
+    EXPECT_FLOAT_EQ(r.cone_width, 0.0f);
+    EXPECT_FLOAT_EQ(r.cone_spread, 0.02f);
+
+    // Parallel projection: constant width
+    mat4 ortho = mat4::identity();
+    ortho(0, 0) = 0.5f;
+    ortho(1, 1) = 0.5f;
+    ortho(2, 2) = -0.1f;
+
+    mcam.set_proj_matrix(ortho);
+    mcam.begin_frame();
+
+    r = mcam.primary_ray(basic_ray<float>{}, 50.0f, 50.0f, 100.0f, 100.0f);
+    EXPECT_FLOAT_EQ(r.cone_width, 0.04f);
+    EXPECT_FLOAT_EQ(r.cone_spread, 0.0f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Propagation, SIMD conversions
+//
+
+TEST(RayCone, Propagate)
+{
+    basic_ray<float> r(vec3(0.0f), vec3(0.0f, 0.0f, -1.0f));
+    EXPECT_FLOAT_EQ(r.cone_width, 0.0f);
+    EXPECT_FLOAT_EQ(r.cone_spread, 0.0f);
+
+    r.cone_spread = 0.01f;
+    EXPECT_FLOAT_EQ(cone_width(r, 10.0f), 0.1f);
+
+    propagate_cone(r, 10.0f);
+    EXPECT_FLOAT_EQ(r.cone_width, 0.1f);
+    EXPECT_FLOAT_EQ(r.cone_spread, 0.01f);
+
+    propagate_cone(r, 5.0f, 0.01f);
+    EXPECT_FLOAT_EQ(r.cone_width, 0.15f);
+    EXPECT_FLOAT_EQ(r.cone_spread, 0.02f);
+
+    array<basic_ray<float>, 4> rays;
+    for (int i = 0; i < 4; ++i)
+    {
+        rays[i] = r;
+        rays[i].cone_width = static_cast<float>(i);
+    }
+
+    auto packet = simd::pack(rays);
+    propagate_cone(packet, simd::float4(10.0f));
+
+    auto lanes = simd::unpack(packet);
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_FLOAT_EQ(lanes[i].cone_width, i + 0.2f);
+        EXPECT_FLOAT_EQ(lanes[i].cone_spread, 0.02f);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Level of detail on a triangle w/ one texel per (1/256)^2 world units
+//
+
+TEST(RayCone, TextureLod)
+{
+    basic_triangle<3, float> tri(vec3(0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+    vec2 tex_coords[] = { vec2(0.0f, 0.0f), vec2(1.0f, 0.0f), vec2(0.0f, 1.0f) };
+
+    basic_ray<float> r(vec3(0.25f, 0.25f, 1.0f), vec3(0.0f, 0.0f, -1.0f));
+    r.cone_spread = 1.0f / 256.0f;
+
+    test_hit_record hr;
+
+    // One texel per pixel
+    hr.t = 1.0f;
+    EXPECT_NEAR(texture_lod(tex_coords, hr, tri, r, 256, 256), 0.0f, 1e-5f);
+
+    // Four times farther away
+    hr.t = 4.0f;
+    EXPECT_NEAR(texture_lod(tex_coords, hr, tri, r, 256, 256), 2.0f, 1e-5f);
+
+    // Texture w/ 4x the texels
+    EXPECT_NEAR(texture_lod(tex_coords, hr, tri, r, 512, 512), 3.0f, 1e-5f);
+
+    // Grazing angle, cos(theta) = 1/2
+    r.dir = normalize(vec3(0.0f, std::sqrt(3.0f), -1.0f));
+    EXPECT_NEAR(texture_lod(tex_coords, hr, tri, r, 256, 256), 3.0f, 1e-5f);
+
+    // Magnification
+    hr.t = 0.25f;
+    r.dir = vec3(0.0f, 0.0f, -1.0f);
+    EXPECT_NEAR(texture_lod(tex_coords, hr, tri, r, 256, 256), -2.0f, 1e-5f);
+
+    // No cone, or not a triangle: finest level
+    r.cone_spread = 0.0f;
+    EXPECT_FLOAT_EQ(texture_lod(tex_coords, hr, tri, r, 256, 256), 0.0f);
+
+    r.cone_spread = 1.0f / 256.0f;
+    EXPECT_FLOAT_EQ(texture_lod(tex_coords, hr, basic_sphere<float>(vec3(0.0f), 1.0f), r, 256, 256), 0.0f);
+}
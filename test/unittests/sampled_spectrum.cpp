@@ -0,0 +1,257 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <visionaray/detail/color_conversion.h>
+#include <visionaray/detail/spd/blackbody.h>
+#include <visionaray/detail/spd/d65.h>
+#include <visionaray/math/math.h>
+#include <visionaray/aligned_vector.h>
+#include <visionaray/generic_material.h>
+#include <visionaray/kernels.h>
+#include <visionaray/material.h>
+#include <visionaray/pinhole_camera.h>
+#include <visionaray/point_light.h>
+#include <visionaray/sampled_spectrum.h>
+#include <visionaray/scheduler.h>
+#include <visionaray/simple_buffer_rt.h>
+
+#include <gtest/gtest.h>
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+// Average of the hero wavelength estimates for stratified hero wavelengths
+template <size_t N, typename SPD>
+static vec3 estimate_rgb(SPD const& spd, int num_strata = 1024)
+{
+    vec3 rgb(0.0f);
+
+    for (int i = 0; i < num_strata; ++i)
+    {
+        auto wl = sample_wavelengths<N>((i + 0.5f) / num_strata);
+        rgb += to_rgb(sample_spd(spd, wl), wl);
+    }
+
+    return rgb / static_cast<float>(num_strata);
+}
+
+// Same for an RGB reflectance under an RGB illuminant
+template <size_t N>
+static vec3 estimate_rgb(vec3 reflectance, vec3 illuminant, int num_strata = 1024)
+{
+    vec3 rgb(0.0f);
+
+    for (int i = 0; i < num_strata; ++i)
+    {
+        auto wl = sample_wavelengths<N>((i + 0.5f) / num_strata);
+        rgb_upsampler<N, float> up(wl);
+        rgb += to_rgb(up.reflectance(reflectance) * up.illuminant(illuminant), wl);
+    }
+
+    return rgb / static_cast<float>(num_strata);
+}
+
+struct constant_spd
+{
+    float operator()(float /* lambda */) const { return 1.0f; }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Wavelengths are equidistant (modulo the wavelength range), also w/ SIMD
+//
+
+TEST(SampledSpectrum, Wavelengths)
+{
+    float lmin = sampled_wavelengths<4, float>::lambda_min;
+    float lmax = sampled_wavelengths<4, float>::lambda_max;
+    float range = lmax - lmin;
+
+    for (float u : { 0.0f, 0.1f, 0.5f, 0.9f, 0.999f })
+    {
+        auto wl = sample_wavelengths<4>(u);
+
+        EXPECT_FLOAT_EQ(wl.lambda[0], lmin + u * range);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            EXPECT_GE(wl.lambda[i], lmin);
+            EXPECT_LT(wl.lambda[i], lmax);
+
+            float d = wl.lambda[(i + 1) % 4] - wl.lambda[i];
+            d = d < 0.0f ? d + range : d;
+            EXPECT_NEAR(d, range / 4.0f, 1e-3f);
+        }
+    }
+
+    auto wl = sample_wavelengths<8>(simd::float4(0.0f, 0.25f, 0.5f, 0.75f));
+    auto blackbody_values = sample_spd(blackbody(3000.0f), wl);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        simd::aligned_array_t<simd::float4> lambda;
+        simd::aligned_array_t<simd::float4> values;
+        store(lambda, wl.lambda[i]);
+        store(values, blackbody_values[i]);
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            EXPECT_FLOAT_EQ(values[lane], blackbody(3000.0f)(lambda[lane]));
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Hero wavelength estimates converge to the integrals of spd_to_rgb()
+//
+
+TEST(SampledSpectrum, ToRGB)
+{
+    auto check = [](vec3 a, vec3 b, float tolerance)
+    {
+        EXPECT_NEAR(a.x, b.x, tolerance);
+        EXPECT_NEAR(a.y, b.y, tolerance);
+        EXPECT_NEAR(a.z, b.z, tolerance);
+    };
+
+    check(estimate_rgb<4>(constant_spd{}), spd_to_rgb(constant_spd{}, 380.0f, 720.0f, 0.1f), 1e-3f);
+    check(estimate_rgb<8>(spd_d65{}), spd_to_rgb(spd_d65{}, 380.0f, 720.0f, 0.1f), 1e-3f);
+
+    blackbody bb(2500.0f);
+    vec3 expected = spd_to_rgb(bb, 380.0f, 720.0f, 0.1f, false);
+    check(estimate_rgb<4>(bb) / expected.y, expected / expected.y, 1e-3f);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Upsampled RGB colors convert back to approximately the same RGB colors
+//
+
+TEST(SampledSpectrum, Upsampling)
+{
+    // White reflectance under white light is white
+    vec3 white = estimate_rgb<4>(vec3(1.0f), vec3(1.0f));
+    EXPECT_NEAR(white.x, 1.0f, 0.02f);
+    EXPECT_NEAR(white.y, 1.0f, 0.02f);
+    EXPECT_NEAR(white.z, 1.0f, 0.02f);
+
+    for (vec3 rgb : { vec3(0.5f, 0.5f, 0.5f), vec3(0.8f, 0.2f, 0.1f), vec3(0.1f, 0.6f, 0.3f), vec3(0.2f, 0.3f, 0.9f) })
+    {
+        // Reflectance under white light
+        vec3 r = estimate_rgb<4>(rgb, vec3(1.0f));
+        EXPECT_NEAR(r.x, rgb.x, 0.1f);
+        EXPECT_NEAR(r.y, rgb.y, 0.1f);
+        EXPECT_NEAR(r.z, rgb.z, 0.1f);
+
+        // Illuminant seen by a white surface
+        vec3 i = estimate_rgb<4>(vec3(1.0f), rgb);
+        EXPECT_NEAR(i.x, rgb.x, 0.1f);
+        EXPECT_NEAR(i.y, rgb.y, 0.1f);
+        EXPECT_NEAR(i.z, rgb.z, 0.1f);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The path tracer w/ hero wavelengths converges to about the RGB result
+//
+
+TEST(SampledSpectrum, PathTracer)
+{
+    using material_type = generic_material<matte<float>, plastic<float>>;
+    using render_target_type = simple_buffer_rt<PF_RGBA32F, PF_UNSPECIFIED, PF_RGBA32F>;
+
+    int const width = 16;
+    int const height = 16;
+
+    aligned_vector<basic_sphere<float>> spheres;
+    aligned_vector<material_type> materials;
+    aligned_vector<point_light<float>> lights;
+
+    basic_sphere<float> s(vec3(0.0f), 1.0f);
+    s.prim_id = 0;
+    s.geom_id = 0;
+    spheres.push_back(s);
+
+    basic_sphere<float> floor(vec3(0.0f, -101.0f, 0.0f), 100.0f);
+    floor.prim_id = 1;
+    floor.geom_id = 1;
+    spheres.push_back(floor);
+
+    matte<float> m;
+    m.ca() = from_rgb(vec3(0.0f));
+    m.ka() = 0.0f;
+    m.cd() = from_rgb(vec3(0.8f, 0.3f, 0.1f));
+    m.kd() = 1.0f;
+    materials.push_back(m);
+
+    m.cd() = from_rgb(vec3(0.2f, 0.4f, 0.8f));
+    materials.push_back(m);
+
+    point_light<float> light;
+    light.set_cl(vec3(1.0f, 0.9f, 0.8f));
+    light.set_kl(1.0f);
+    light.set_position(vec3(2.0f, 4.0f, 3.0f));
+    light.set_constant_attenuation(1.0f);
+    light.set_linear_attenuation(0.0f);
+    light.set_quadratic_attenuation(0.0f);
+    lights.push_back(light);
+
+    pinhole_camera cam;
+    cam.set_viewport(0, 0, width, height);
+    cam.perspective(45.0f * constants::degrees_to_radians<float>(), 1.0f, 0.1f, 100.0f);
+    cam.look_at(vec3(0.0f, 0.0f, 4.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+    auto kparams = make_kernel_params(
+            spheres.data(),
+            spheres.data() + spheres.size(),
+            materials.data(),
+            lights.data(),
+            lights.data() + lights.size(),
+            4,
+            1e-3f
+            );
+
+    auto render = [&](auto kernel, render_target_type& rt)
+    {
+        tiled_sched<basic_ray<simd::float4>> sched(2);
+
+        rt.resize(width, height);
+        rt.clear_accum_buffer();
+
+        pixel_sampler::jittered_blend_type blend;
+        blend.spp = 256;
+        blend.sfactor = 1.0f;
+        blend.dfactor = 0.0f;
+
+        kernel.params = kparams;
+
+        auto sparams = make_sched_params(blend, cam, rt);
+        sched.frame(kernel, sparams);
+
+        vec3 mean(0.0f);
+
+        for (int i = 0; i < width * height; ++i)
+        {
+            mean += rt.color()[i].xyz();
+        }
+
+        return mean / static_cast<float>(width * height);
+    };
+
+    render_target_type rgb_rt;
+    vec3 rgb = render(pathtracing::kernel<decltype(kparams)>{}, rgb_rt);
+
+    render_target_type hero_rt;
+    vec3 hero = render(pathtracing::kernel<decltype(kparams), hero_transport<4>>{}, hero_rt);
+
+    EXPECT_GT(rgb.x, 0.05f);
+    EXPECT_NEAR(hero.x, rgb.x, 0.1f * rgb.x);
+    EXPECT_NEAR(hero.y, rgb.y, 0.1f * rgb.y);
+    EXPECT_NEAR(hero.z, rgb.z, 0.1f * rgb.z);
+}
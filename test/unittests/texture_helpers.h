@@ -0,0 +1,117 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#pragma once
+
+#ifndef VSNRAY_TEST_UNITTESTS_TEXTURE_HELPERS_H
+#define VSNRAY_TEST_UNITTESTS_TEXTURE_HELPERS_H 1
+
+#include <cstddef>
+#include <random>
+#include <type_traits>
+
+#include <visionaray/math/math.h>
+#include <visionaray/texture/texture.h>
+
+#include <gtest/gtest.h>
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers shared by the texture tests
+//
+
+// Compare scalars or SIMD vectors, all lanes must be equal
+template <typename F>
+inline bool equal(F const& a, F const& b)
+{
+    return visionaray::all(a == b);
+}
+
+template <size_t N, typename F>
+inline bool equal(visionaray::vector<N, F> const& a, visionaray::vector<N, F> const& b)
+{
+    for (size_t d = 0; d < N; ++d)
+    {
+        if (!visionaray::all(a[d] == b[d]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Load float or SIMD float from an aligned array
+template <typename F>
+inline F make_float(float const* values)
+{
+    return F(values);
+}
+
+template <>
+inline float make_float(float const* values)
+{
+    return values[0];
+}
+
+// Compare fetches at random coordinates in [min_coord..max_coord)
+template <typename F, typename Tex, typename Ref>
+inline void compare_fetches(Tex const& tex, Ref const& ref, float min_coord = -0.5f, float max_coord = 1.5f)
+{
+    using namespace visionaray;
+
+    std::default_random_engine rng(0);
+    std::uniform_real_distribution<float> dist(min_coord, max_coord);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        VSNRAY_ALIGN(64) float u[simd::num_elements<F>::value];
+        VSNRAY_ALIGN(64) float v[simd::num_elements<F>::value];
+
+        for (int j = 0; j < simd::num_elements<F>::value; ++j)
+        {
+            u[j] = dist(rng);
+            v[j] = dist(rng);
+        }
+
+        vector<2, F> coord(make_float<F>(u), make_float<F>(v));
+
+        auto a = tex2D(tex, coord);
+        auto b = tex2D(ref, coord);
+
+        static_assert(std::is_same<decltype(a), decltype(b)>::value, "Type mismatch");
+        EXPECT_TRUE(equal(a, b));
+    }
+}
+
+// Same, for textures whose fetches return different types, compared as
+// vector<4, F>
+template <typename F, typename Tex, typename Ref>
+inline void compare_fetches4(Tex const& tex, Ref const& ref, float min_coord = -0.5f, float max_coord = 1.5f)
+{
+    using namespace visionaray;
+
+    std::default_random_engine rng(0);
+    std::uniform_real_distribution<float> dist(min_coord, max_coord);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        VSNRAY_ALIGN(64) float u[simd::num_elements<F>::value];
+        VSNRAY_ALIGN(64) float v[simd::num_elements<F>::value];
+
+        for (int j = 0; j < simd::num_elements<F>::value; ++j)
+        {
+            u[j] = dist(rng);
+            v[j] = dist(rng);
+        }
+
+        vector<2, F> coord(make_float<F>(u), make_float<F>(v));
+
+        vector<4, F> a = tex2D(tex, coord);
+        vector<4, F> b = tex2D(ref, coord);
+
+        EXPECT_TRUE(equal(a, b));
+    }
+}
+
+#endif // VSNRAY_TEST_UNITTESTS_TEXTURE_HELPERS_H
@@ -0,0 +1,134 @@
+// This file is distributed under the MIT license.
+// See the LICENSE file for details.
+
+#include <cstddef>
+#include <random>
+
+#include <visionaray/math/math.h>
+#include <visionaray/texture/texture.h>
+#include <visionaray/aligned_vector.h>
+
+#include <gtest/gtest.h>
+
+#include "texture_helpers.h"
+
+using namespace visionaray;
+
+
+//-------------------------------------------------------------------------------------------------
+// Helpers
+//
+
+template <typename Tex, typename Ref>
+static void compare_all_modes(Tex& tex, Ref& ref)
+{
+    tex_address_mode address_modes[] = { Wrap, Mirror, Clamp };
+    tex_filter_mode filter_modes[] = { Nearest, Linear, BSpline };
+
+    for (auto am : address_modes)
+    {
+        for (auto fm : filter_modes)
+        {
+            tex.set_address_mode(am);
+            tex.set_filter_mode(fm);
+            ref.set_address_mode(am);
+            ref.set_filter_mode(fm);
+
+            compare_fetches<float>(tex, ref, -1.5f, 2.5f);
+            compare_fetches<float>(typename Tex::ref_type(tex), typename Ref::ref_type(ref), -1.5f, 2.5f);
+
+            // Row-major textures only support SIMD coordinates w/ refs
+            compare_fetches<simd::float4>(tex, typename Ref::ref_type(ref), -1.5f, 2.5f);
+            compare_fetches<simd::float8>(typename Tex::ref_type(tex), typename Ref::ref_type(ref), -1.5f, 2.5f);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Tiled layout: 8x8 tiles, Morton order inside the tiles
+//
+
+TEST(TiledTexture, Layout)
+{
+    EXPECT_EQ(detail::tiled_index(0U, 0U, 4U), size_t(0));
+    EXPECT_EQ(detail::tiled_index(1U, 0U, 4U), size_t(1));
+    EXPECT_EQ(detail::tiled_index(0U, 1U, 4U), size_t(2));
+    EXPECT_EQ(detail::tiled_index(1U, 1U, 4U), size_t(3));
+    EXPECT_EQ(detail::tiled_index(7U, 7U, 4U), size_t(63));
+    EXPECT_EQ(detail::tiled_index(8U, 0U, 4U), size_t(64));
+    EXPECT_EQ(detail::tiled_index(0U, 8U, 4U), size_t(4 * 64));
+
+    // SIMD indices match the scalar ones
+    simd::int4 x(1, 7, 8, 13);
+    simd::int4 y(0, 7, 3, 9);
+    simd::aligned_array_t<simd::int4> index;
+    store(index, detail::tiled_index(x, y, 4U));
+
+    EXPECT_EQ(index[0], 1);
+    EXPECT_EQ(index[1], 63);
+    EXPECT_EQ(index[2], static_cast<int>(detail::tiled_index(8U, 3U, 4U)));
+    EXPECT_EQ(index[3], static_cast<int>(detail::tiled_index(13U, 9U, 4U)));
+
+    // Odd sizes are padded to whole tiles
+    tiled_texture<float, 2> tex(13, 9);
+    EXPECT_EQ(tex.width(), 13U);
+    EXPECT_EQ(tex.height(), 9U);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Fetches return the same values as w/ row-major textures
+//
+
+TEST(TiledTexture, Fetch)
+{
+    // Odd size, RGBA8
+    {
+        unsigned w = 37;
+        unsigned h = 21;
+
+        std::default_random_engine rng(0);
+        std::uniform_int_distribution<int> dist(0, 255);
+
+        using T = vector<4, unorm<8>>;
+        aligned_vector<T> data(w * h);
+
+        for (auto& t : data)
+        {
+            t = T(dist(rng) / 255.0f, dist(rng) / 255.0f, dist(rng) / 255.0f, dist(rng) / 255.0f);
+        }
+
+        tiled_texture<T, 2> tex(w, h);
+        tex.reset(data.data());
+
+        texture<T, 2> ref(w, h);
+        ref.reset(data.data());
+
+        compare_all_modes(tex, ref);
+    }
+
+    // Large enough to be converted in parallel, float
+    {
+        unsigned w = 200;
+        unsigned h = 130;
+
+        std::default_random_engine rng(0);
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+        aligned_vector<float> data(w * h);
+
+        for (auto& t : data)
+        {
+            t = dist(rng);
+        }
+
+        tiled_texture<float, 2> tex(w, h);
+        tex.reset(data.data());
+
+        texture<float, 2> ref(w, h);
+        ref.reset(data.data());
+
+        compare_all_modes(tex, ref);
+    }
+}